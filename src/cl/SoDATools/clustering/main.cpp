@@ -93,7 +93,8 @@ void printHelp()
           "\"hamming_dist_cols(%)\":25,"<<endl<<
           "\"test_clusters_dump\":\"../testclusterdump.txt\","<<endl<<
           "\"codeelement_clusters_dump\":\"../codelemclusterdump.txt\","<<endl<<
-          "\"0cluster(%)\":80"<<endl<<"}"<<endl<<endl;
+          "\"0cluster(%)\":80,"<<endl<<
+          "\"threads\":0"<<endl<<"}"<<endl<<endl;
 
 
     cout<<"{"<<endl<<
@@ -104,8 +105,15 @@ void printHelp()
           "\"0cluster(%)\":80,"<<endl<<
           "\"test_clusters_dump\":\"../testclusterdump.txt\","<<endl<<
           "\"codeelement_clusters_dump\":\"../codelemclusterdump.txt\","<<endl<<
-          "\"cluster-number\":5"<<endl<<"}"<<endl;
-    cout<<"index: 0 - ochiai ; 1 - dice ; 2 - jaccard and limit=-1.0 == no limit"<<endl<<endl;
+          "\"cluster-number\":5,"<<endl<<
+          "\"top-k\":0,"<<endl<<
+          "\"method\":\"k-means\","<<endl<<
+          "\"distance\":\"hamming\","<<endl<<
+          "\"seed\":0,"<<endl<<
+          "\"threads\":0"<<endl<<"}"<<endl;
+    cout<<"index: 0 - ochiai ; 1 - dice ; 2 - jaccard and limit=-1.0 == no limit"<<endl;
+    cout<<"top-k: number of kept similarities per row, 0 == all ; method: k-means (on the similarities) or k-medoids (on the rows) ;"<<endl<<
+          "distance: hamming or jaccard distance of k-medoids ; seed: seed of the k-medoids initialization"<<endl<<endl;
 
 
     cout<<"{"<<endl<<
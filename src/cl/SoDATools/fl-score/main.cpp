@@ -31,13 +31,13 @@
 #include <boost/program_options.hpp>
 
 #include <rapidjson/document.h>
-#include <rapidjson/prettywriter.h>
-#include <rapidjson/ostreamwrapper.h>
 
 #include "data/CClusterDefinition.h"
+#include "data/CFLMetricTable.h"
 #include "data/CSelectionData.h"
 #include "engine/CKernel.h"
 #include "util/CTestSuiteScore.h"
+#include "util/CThreadPool.h"
 
 
 using namespace soda;
@@ -72,7 +72,8 @@ int main(int argc, char* argv[]) {
             ("changeset,d", value<String>(), "Changeset binary")
             ("output-dir,o", value<String>(), "Output directory")
             ("globalize,g", "Globalize")
-            ("filter-to-coverage,f", "Filter to coverage");
+            ("filter-to-coverage,f", "Filter to coverage")
+            ("jobs,j", value<unsigned int>()->default_value(1), "Number of threads (0 means the number of hardware threads)");
 
     variables_map vm;
     positional_options_description p;
@@ -127,6 +128,8 @@ int main(int argc, char* argv[]) {
     }
     String chPath = vm["changeset"].as<String>();
 
+    unsigned int numOfThreads = CThreadPool(vm["jobs"].as<unsigned int>()).getNumOfThreads();
+
     clusterList.clear();
 
     CSelectionData selectionData;
@@ -148,7 +151,7 @@ int main(int argc, char* argv[]) {
     }
 
     if (vm.count("filter-to-coverage")) {
-        selectionData.filterToCoverage();
+        selectionData.filterToCoverage(numOfThreads);
     }
 
     (std::cerr << "[INFO] Running cluster algorithm: " << clusterAlgorithm->getName() << " ...").flush();
@@ -168,38 +171,48 @@ int main(int argc, char* argv[]) {
             std::cerr << "[WARNING] Revision '" << revision << " is missing from changeset." << std::endl;
             continue;
         }
-        rapidjson::Document result;
-        result.SetObject();
+        FLMetricTables result;
 
         IntVector failedCodeElements;
 
         std::cerr << "[INFO] Calculating scores for revision: " << revision << std::endl;
 
-        for (IndexType cid = 0; cid < selectionData.getChangeset()->getCodeElements().size(); cid++) {
-            if (selectionData.getChangeset()->isChanged(revision, selectionData.getChangeset()->getCodeElements().getValue(cid))) {
-                failedCodeElements.push_back(selectionData.translateCodeElementIdFromChangesetToCoverage(cid));
-                //break;
-            }
+        IntVector changedCodeElements = selectionData.getChangeset()->getCodeElementIds(revision);
+        for (IntVector::iterator cidIt = changedCodeElements.begin(); cidIt != changedCodeElements.end(); cidIt++) {
+            failedCodeElements.push_back(selectionData.translateCodeElementIdFromChangesetToCoverage(*cidIt));
         }
 
         IFaultLocalizationTechniquePlugin *commonTechnique = kernel.getFaultLocalizationTechniquePluginManager().getPlugin("common");
 
         commonTechnique->init(&selectionData, &clusterList, revision, failedCodeElements);
+        commonTechnique->setNumOfThreads(numOfThreads);
         commonTechnique->calculate(result);
 
+        // The techniques depend only on the common values, so they are calculated concurrently
+        // on their own copy of the tables and their columns are merged in a fixed order.
+        std::vector<IFaultLocalizationTechniquePlugin*> techniques;
         for (IndexType i = 0; i < faultLocalizationTechniques.size(); i++) {
-            std::string flTechniqueName = faultLocalizationTechniques[i];
-            IFaultLocalizationTechniquePlugin *technique = kernel.getFaultLocalizationTechniquePluginManager().getPlugin(flTechniqueName);
+            techniques.push_back(kernel.getFaultLocalizationTechniquePluginManager().getPlugin(faultLocalizationTechniques[i]));
+        }
+        std::vector<FLMetricTables> techniqueResults(techniques.size(), result);
 
-            technique->init(&selectionData, &clusterList, revision, failedCodeElements);
-            technique->calculate(result);
+        CThreadPool(numOfThreads).run(techniques.size(), [&](IndexType i) {
+            techniques[i]->init(&selectionData, &clusterList, revision, failedCodeElements);
+            techniques[i]->setNumOfThreads(std::max<unsigned int>(1, numOfThreads / techniques.size()));
+            techniques[i]->calculate(techniqueResults[i]);
+        });
 
-            IFaultLocalizationTechniquePlugin::FLScore flScores = technique->getFlScore();
+        for (IndexType i = 0; i < techniques.size(); i++) {
+            IFaultLocalizationTechniquePlugin *technique = techniques[i];
+            IFaultLocalizationTechniquePlugin::FLScore &flScores = technique->getFlScore();
             std::map<String, CClusterDefinition>::iterator it;
             for (it = clusterList.begin(); it != clusterList.end(); it++) {
+                CFLMetricTable &table = result[it->first];
+                table.addDoubleColumn(technique->getName()) = techniqueResults[i][it->first].getDoubleColumn(technique->getName());
+
                 for (IndexType j = 0; j < failedCodeElements.size(); j++) {
                     IndexType cid = failedCodeElements[j];
-                    if (std::find(it->second.getCodeElements().begin(), it->second.getCodeElements().end(), cid) != it->second.getCodeElements().end()) {
+                    if (table.getRow(cid) != CFLMetricTable::NO_ROW) {
                         std::cout << revision << ";" << technique->getName() << ";" << it->first << ";" << selectionData.getCoverage()->getCodeElements().getValue(cid) << ";" << flScores[it->first][cid] << std::endl;
                     }
                 }
@@ -214,10 +227,7 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
-        rapidjson::OStreamWrapper os(outputFileStream);
-        rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(os);
-
-        result.Accept(writer);
+        CFLMetricTable::writeJson(outputFileStream, result);
     }
 
     return 0;
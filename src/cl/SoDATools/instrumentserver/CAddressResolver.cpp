@@ -18,33 +18,345 @@
  *  You should have received a copy of the GNU Lesser General Public License
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "boost/bind.hpp"
+#include "boost/filesystem.hpp"
+
 #include "CAddressResolver.h"
+#include "CElfSymbolizer.h"
 
 
 namespace soda {
 
-std::string CAddressResolver::resolve(const std::string &binaryFullPath, const int address)
+namespace {
+
+/**
+ * @brief Maximum number of addresses on the command line of one addr2line process.
+ */
+const IndexType ADDR2LINE_CHUNK_SIZE = 1024;
+
+} // namespace
+
+CAddressResolver::CAddressResolver(const String &baseDir, const String &cacheDir, ResolvedCallback callback) :
+    m_baseDir(baseDir),
+    m_cacheDir(cacheDir),
+    m_callback(callback),
+    m_binaries(new std::map<String, Binary>()),
+    m_queue(new std::vector<Request>()),
+    m_pending(0),
+    m_stop(false),
+    m_worker(NULL)
+{
+    if (!m_cacheDir.empty() && !openCacheDir(m_cacheDir)) {
+        std::cerr << "[WARNING] The symbol cache is disabled, " << m_cacheDir << " must be a directory of the current user which other users can not write." << std::endl;
+        m_cacheDir.clear();
+    }
+    m_worker = new boost::thread(boost::bind(&CAddressResolver::run, this));
+}
+
+CAddressResolver::~CAddressResolver()
+{
     {
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_stop = true;
+        m_condition.notify_all();
+    }
+    m_worker->join();
+    delete m_worker;
+
+    saveCache();
+    for (std::map<String, Binary>::iterator it = m_binaries->begin(); it != m_binaries->end(); ++it) {
+        delete it->second.symbolizer;
+    }
+    delete m_binaries;
+    delete m_queue;
+}
+
+void CAddressResolver::enqueue(const String &testcaseName, const String &binaryPath, const int address)
+{
+    Request request;
+    request.testcaseName = testcaseName;
+    request.binaryPath = binaryPath;
+    request.address = address;
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_queue->push_back(request);
+    m_pending++;
+    m_condition.notify_all();
+}
+
+void CAddressResolver::flush()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    while (m_pending > 0) {
+        m_condition.wait(lock);
+    }
+}
+
+void CAddressResolver::run()
+{
+    while (true) {
+        std::vector<Request> batch;
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            while (m_queue->empty() && !m_stop) {
+                m_condition.wait(lock);
+            }
+            if (m_queue->empty()) {
+                return;
+            }
+            // Take every queued request, they are resolved together.
+            batch.swap(*m_queue);
+        }
+
+        processBatch(batch);
+
+        boost::mutex::scoped_lock lock(m_mutex);
+        m_pending -= batch.size();
+        m_condition.notify_all();
+    }
+}
+
+void CAddressResolver::processBatch(std::vector<Request> &batch)
+{
+    boost::mutex::scoped_lock lock(m_binariesMutex);
+
+    // Group the unresolved addresses by binaries.
+    std::map<String, std::vector<int> > unresolved;
+    for (std::vector<Request>::iterator it = batch.begin(); it != batch.end(); ++it) {
+        Binary &binary = getBinary(it->binaryPath);
+        if (binary.addresses.find(it->address) == binary.addresses.end()) {
+            unresolved[it->binaryPath].push_back(it->address);
+        }
+    }
+
+    for (std::map<String, std::vector<int> >::iterator it = unresolved.begin(); it != unresolved.end(); ++it) {
+        Binary &binary = getBinary(it->first);
+        std::vector<int> &addresses = it->second;
+        std::sort(addresses.begin(), addresses.end());
+        addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+        // The addresses which are not in the line table are resolved by addr2line.
+        StringVector resolved(addresses.size());
+        std::vector<int> rest;
+        std::vector<IndexType> restIndices;
+        for (IndexType i = 0; i < addresses.size(); ++i) {
+            if (binary.symbolizer == NULL || !binary.symbolizer->resolve((unsigned int)addresses[i], resolved[i])) {
+                rest.push_back(addresses[i]);
+                restIndices.push_back(i);
+            }
+        }
+        if (!rest.empty()) {
+            StringVector output;
+            try {
+                output = resolve(getFullPath(it->first), rest);
+            } catch (CException &e) {
+                output.clear();
+            }
+            output.resize(rest.size());
+            for (IndexType i = 0; i < rest.size(); ++i) {
+                resolved[restIndices[i]] = output[i];
+            }
+        }
+        // The failed translations are not cached, they are retried by the next run.
+        for (IndexType i = 0; i < addresses.size(); ++i) {
+            if (!resolved[i].empty()) {
+                binary.addresses[addresses[i]] = resolved[i];
+                binary.modified = true;
+            }
+        }
+    }
+
+    for (std::vector<Request>::iterator it = batch.begin(); it != batch.end(); ++it) {
+        std::map<int, String> &addresses = (*m_binaries)[it->binaryPath].addresses;
+        std::map<int, String>::iterator address = addresses.find(it->address);
+        m_callback(it->testcaseName, it->binaryPath, it->address, address != addresses.end() ? address->second : String("[SODA]not-resolved"));
+    }
+}
+
+String CAddressResolver::getFullPath(const String &binaryPath)
+{
+    if (!boost::filesystem::exists(binaryPath.c_str()) || boost::filesystem::is_directory(binaryPath.c_str())) {
+        return m_baseDir + "/" + binaryPath;
+    }
+    return binaryPath;
+}
+
+CAddressResolver::Binary& CAddressResolver::getBinary(const String &binaryPath)
+{
+    std::map<String, Binary>::iterator it = m_binaries->find(binaryPath);
+    if (it != m_binaries->end()) {
+        return it->second;
+    }
+
+    Binary &binary = (*m_binaries)[binaryPath];
+    binary.modified = false;
+    String fullPath = getFullPath(binaryPath);
+    binary.symbolizer = new CElfSymbolizer();
+    if (!binary.symbolizer->load(fullPath)) {
+        delete binary.symbolizer;
+        binary.symbolizer = NULL;
+    }
+
+    if (m_cacheDir.empty()) {
+        return binary;
+    }
+
+    // The cache is identified by the path and the build-id, or the modification time and size of the binary.
+    String id = binary.symbolizer != NULL ? binary.symbolizer->getBuildId() : "";
+    if (id.empty()) {
+        struct stat st;
+        if (stat(fullPath.c_str(), &st) < 0) {
+            return binary;
+        }
+        std::ostringstream stamp;
+        stamp << "t" << st.st_mtime << "-" << st.st_size;
+        id = stamp.str();
+    }
+    u_int64_t hash = 14695981039346656037ULL;
+    for (String::iterator c = fullPath.begin(); c != fullPath.end(); ++c) {
+        hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+    }
+    std::ostringstream file;
+    file << m_cacheDir << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << "-" << id << ".symbols";
+    binary.cacheFile = file.str();
+
+    std::ifstream in(binary.cacheFile.c_str());
+    String line;
+    if (in && std::getline(in, line) && line == fullPath) {
+        while (std::getline(in, line)) {
+            size_t tab = line.find('\t');
+            if (tab == String::npos) {
+                continue;
+            }
+            binary.addresses[(int)std::strtoul(line.substr(0, tab).c_str(), NULL, 16)] = line.substr(tab + 1);
+        }
+    }
+    return binary;
+}
+
+bool CAddressResolver::openCacheDir(const String &cacheDir)
+{
+    boost::filesystem::path path(cacheDir);
+    try {
+        if (path.has_parent_path()) {
+            boost::filesystem::create_directories(path.parent_path());
+        }
+    } catch (boost::filesystem::filesystem_error &e) {
+        return false;
+    }
+    if (mkdir(cacheDir.c_str(), 0700) < 0 && errno != EEXIST) {
+        return false;
+    }
+
+    struct stat st;
+    if (lstat(cacheDir.c_str(), &st) < 0) {
+        return false;
+    }
+    return S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+void CAddressResolver::saveCache()
+{
+    boost::mutex::scoped_lock lock(m_binariesMutex);
+    for (std::map<String, Binary>::iterator it = m_binaries->begin(); it != m_binaries->end(); ++it) {
+        Binary &binary = it->second;
+        if (!binary.modified || binary.cacheFile.empty()) {
+            continue;
+        }
+        // The cache is written into a temporary file first, so a concurrent reader never sees a partial file.
+        std::ostringstream tmpFile;
+        tmpFile << binary.cacheFile << "." << getpid() << ".tmp";
+        {
+            std::ofstream out(tmpFile.str().c_str());
+            out << getFullPath(it->first) << std::endl;
+            for (std::map<int, String>::iterator address = binary.addresses.begin(); address != binary.addresses.end(); ++address) {
+                out << std::hex << (unsigned int)address->first << std::dec << "\t" << address->second << std::endl;
+            }
+            out.close();
+            if (out.fail()) {
+                std::cerr << "[WARNING] Can not write the symbol cache: " << tmpFile.str() << std::endl;
+                std::remove(tmpFile.str().c_str());
+                continue;
+            }
+        }
+        if (std::rename(tmpFile.str().c_str(), binary.cacheFile.c_str()) != 0) {
+            std::cerr << "[WARNING] Can not write the symbol cache: " << binary.cacheFile << std::endl;
+            std::remove(tmpFile.str().c_str());
+            continue;
+        }
+        binary.modified = false;
+    }
+}
+
+std::string CAddressResolver::resolve(const std::string &binaryFullPath, const int address)
+{
+    std::ostringstream command;
+    command << "addr2line -C -f -p -e " << binaryFullPath << " 0x" << std::hex << address;
+
+    FILE *pf;
+    pf = popen(command.str().c_str(), "r");
+    if (!pf) {
+        throw CException("soda::CAddressResolver::resolve", "Can not run addr2line");
+    }
+    String output = "";
+    char *buf = new char[3072];
+    if (fgets(buf, 3072, pf) != NULL) {
+        output = String(buf);
+    }
+
+    delete buf;
+    pclose(pf);
+
+    return output;
+}
+
+StringVector CAddressResolver::resolve(const std::string &binaryFullPath, const std::vector<int> &addresses)
+{
+    StringVector output;
+    char *buf = new char[3072];
+    // The addresses are passed in chunks to keep the command line of addr2line short.
+    for (IndexType begin = 0; begin < addresses.size(); begin += ADDR2LINE_CHUNK_SIZE) {
+        IndexType end = std::min(begin + ADDR2LINE_CHUNK_SIZE, (IndexType)addresses.size());
         std::ostringstream command;
-        command << "addr2line -C -f -p -e " << binaryFullPath << " 0x" << std::hex << address;
+        command << "addr2line -C -f -p -e " << binaryFullPath << std::hex;
+        for (IndexType i = begin; i < end; ++i) {
+            command << " 0x" << (unsigned int)addresses[i];
+        }
 
         FILE *pf;
         pf = popen(command.str().c_str(), "r");
         if (!pf) {
+            delete[] buf;
             throw CException("soda::CAddressResolver::resolve", "Can not run addr2line");
         }
-        String output = "";
-        char *buf = new char[3072];
-        if (fgets(buf, 3072, pf) != NULL) {
-            output = String(buf);
+        IndexType read = 0;
+        while (read < end - begin && fgets(buf, 3072, pf) != NULL) {
+            String line = String(buf);
+            while (!line.empty() && (line[line.length() - 1] == '\n' || line[line.length() - 1] == '\r')) {
+                line.erase(line.length() - 1);
+            }
+            output.push_back(line);
+            read++;
         }
-
-        delete buf;
         pclose(pf);
 
-        return output;
+        // The rest of the chunk is not resolved, it is marked by empty strings.
+        output.resize(end, "");
     }
 
+    delete[] buf;
+
+    return output;
+}
+
 } /* namespace soda */
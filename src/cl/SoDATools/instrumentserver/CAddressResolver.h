@@ -23,17 +23,166 @@
 #define CADDRESSRESOLVER_H
 
 #include <cstdio>
-//#include <unistd.h>
+#include <map>
 #include <string>
+#include <vector>
+
+#include "boost/function.hpp"
+#include "boost/thread.hpp"
 
 #include "exception/CException.h"
 
 namespace soda {
 
+class CElfSymbolizer;
+
+/**
+ * @brief Translates the addresses of the instrumented binaries to function
+ *        names and locations. The requests are queued and processed in batches
+ *        by a worker thread, so the reader threads of the sockets never wait
+ *        for the translation. The ELF files are read by CElfSymbolizer, the
+ *        other binaries are resolved with addr2line. The results can be stored in
+ *        a private cache directory for each binary path and build-id.
+ */
 class CAddressResolver
 {
 public:
+    /**
+     * @brief Called by the worker thread for every processed request.
+     *        The parameters are the test case name, the binary path, the
+     *        address and the resolved "function at file:line" string.
+     */
+    typedef boost::function<void(const String&, const String&, const int, const String&)> ResolvedCallback;
+
+    /**
+     * @brief Creates a new CAddressResolver instance and starts its worker thread.
+     * @param baseDir  The directory of the relative binary paths.
+     * @param cacheDir  The directory of the persistent cache, empty string disables the cache.
+     * @param callback  The function receiving the results.
+     */
+    CAddressResolver(const String &baseDir, const String &cacheDir, ResolvedCallback callback);
+
+    /**
+     * @brief Processes the pending requests, stops the worker thread and saves the cache.
+     */
+    ~CAddressResolver();
+
+    /**
+     * @brief Queues an address for translation.
+     * @param testcaseName  The test case which called the function.
+     * @param binaryPath  The path of the binary as reported by the instrumented code.
+     * @param address  The address of the function.
+     */
+    void enqueue(const String &testcaseName, const String &binaryPath, const int address);
+
+    /**
+     * @brief Waits until every queued request is processed.
+     */
+    void flush();
+
+    /**
+     * @brief Writes the new entries of the cache into the cache directory.
+     */
+    void saveCache();
+
+    /**
+     * @brief Creates the cache directory with 0700 permissions if it does not exist.
+     * @param cacheDir  The directory of the persistent cache.
+     * @return False if the directory can not be created, it is not owned by the current
+     *         user or other users can write it, so the cached names can not be trusted.
+     */
+    static bool openCacheDir(const String &cacheDir);
+
+    /**
+     * @brief Resolves an address with addr2line.
+     * @param binaryFullPath  The path of the binary.
+     * @param address  The address of the function.
+     * @return The output line of addr2line.
+     */
     static std::string resolve(const std::string &binaryFullPath, const int address);
+
+    /**
+     * @brief Resolves several addresses of a binary with addr2line. The
+     *        addresses are passed in bounded chunks, one process per chunk.
+     * @param binaryFullPath  The path of the binary.
+     * @param addresses  The addresses of the functions.
+     * @return The output lines of addr2line without line endings, one for every
+     *         address. The addresses addr2line failed on have empty strings.
+     */
+    static StringVector resolve(const std::string &binaryFullPath, const std::vector<int> &addresses);
+
+private:
+    CAddressResolver(const CAddressResolver&);
+    CAddressResolver& operator=(const CAddressResolver&);
+
+    /**
+     * @brief A queued translation request.
+     */
+    struct Request {
+        String testcaseName;
+        String binaryPath;
+        int address;
+    };
+
+    /**
+     * @brief The symbolizer and the resolved addresses of a binary.
+     */
+    struct Binary {
+        CElfSymbolizer *symbolizer;
+        std::map<int, String> addresses;
+        String cacheFile;
+        bool modified;
+    };
+
+    /**
+     * @brief The loop of the worker thread.
+     */
+    void run();
+
+    /**
+     * @brief Resolves a batch of requests grouped by binaries and calls the callback.
+     * @param batch  The requests.
+     */
+    void processBatch(std::vector<Request> &batch);
+
+    /**
+     * @brief Returns the data of the binary, loads it at the first use.
+     * @param binaryPath  The path of the binary as reported by the instrumented code.
+     * @return The data of the binary.
+     */
+    Binary& getBinary(const String &binaryPath);
+
+    /**
+     * @brief Returns the path of the binary relative to the base directory if it does not exist.
+     * @param binaryPath  The reported path.
+     * @return The path to be opened.
+     */
+    String getFullPath(const String &binaryPath);
+
+    String m_baseDir;
+    String m_cacheDir;
+    ResolvedCallback m_callback;
+
+    /**
+     * @brief The binaries by their reported paths.
+     */
+    std::map<String, Binary> *m_binaries;
+    boost::mutex m_binariesMutex;
+
+    /**
+     * @brief The queued requests.
+     */
+    std::vector<Request> *m_queue;
+
+    /**
+     * @brief Number of the queued and the currently processed requests.
+     */
+    IndexType m_pending;
+
+    bool m_stop;
+    boost::mutex m_mutex;
+    boost::condition_variable m_condition;
+    boost::thread *m_worker;
 };
 
 } /* namespace soda */
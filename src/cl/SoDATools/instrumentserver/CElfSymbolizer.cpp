@@ -0,0 +1,773 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CElfSymbolizer.h"
+#include "exception/CException.h"
+
+namespace soda {
+
+namespace {
+
+/* DWARF constants of the line number program. */
+const unsigned char DW_LNS_copy = 1;
+const unsigned char DW_LNS_advance_pc = 2;
+const unsigned char DW_LNS_advance_line = 3;
+const unsigned char DW_LNS_set_file = 4;
+const unsigned char DW_LNS_const_add_pc = 8;
+const unsigned char DW_LNS_fixed_advance_pc = 9;
+const unsigned char DW_LNE_end_sequence = 1;
+const unsigned char DW_LNE_set_address = 2;
+const unsigned char DW_LNE_define_file = 3;
+
+/* DWARF constants of the compilation unit entries. */
+const u_int64_t DW_AT_stmt_list = 0x10;
+const u_int64_t DW_AT_comp_dir = 0x1b;
+const unsigned int DW_UT_type = 2;
+const unsigned int DW_UT_skeleton = 4;
+const unsigned int DW_UT_split_compile = 5;
+const unsigned int DW_UT_split_type = 6;
+
+const u_int64_t DW_LNCT_path = 1;
+const u_int64_t DW_LNCT_directory_index = 2;
+
+const u_int64_t DW_FORM_addr = 0x01;
+const u_int64_t DW_FORM_block2 = 0x03;
+const u_int64_t DW_FORM_block4 = 0x04;
+const u_int64_t DW_FORM_block = 0x09;
+const u_int64_t DW_FORM_block1 = 0x0a;
+const u_int64_t DW_FORM_data1 = 0x0b;
+const u_int64_t DW_FORM_data2 = 0x05;
+const u_int64_t DW_FORM_data4 = 0x06;
+const u_int64_t DW_FORM_data8 = 0x07;
+const u_int64_t DW_FORM_data16 = 0x1e;
+const u_int64_t DW_FORM_flag = 0x0c;
+const u_int64_t DW_FORM_sdata = 0x0d;
+const u_int64_t DW_FORM_string = 0x08;
+const u_int64_t DW_FORM_strp = 0x0e;
+const u_int64_t DW_FORM_line_strp = 0x1f;
+const u_int64_t DW_FORM_udata = 0x0f;
+const u_int64_t DW_FORM_ref_addr = 0x10;
+const u_int64_t DW_FORM_ref1 = 0x11;
+const u_int64_t DW_FORM_ref2 = 0x12;
+const u_int64_t DW_FORM_ref4 = 0x13;
+const u_int64_t DW_FORM_ref8 = 0x14;
+const u_int64_t DW_FORM_ref_udata = 0x15;
+const u_int64_t DW_FORM_indirect = 0x16;
+const u_int64_t DW_FORM_sec_offset = 0x17;
+const u_int64_t DW_FORM_exprloc = 0x18;
+const u_int64_t DW_FORM_flag_present = 0x19;
+const u_int64_t DW_FORM_strx = 0x1a;
+const u_int64_t DW_FORM_addrx = 0x1b;
+const u_int64_t DW_FORM_ref_sup4 = 0x1c;
+const u_int64_t DW_FORM_strp_sup = 0x1d;
+const u_int64_t DW_FORM_ref_sig8 = 0x20;
+const u_int64_t DW_FORM_implicit_const = 0x21;
+const u_int64_t DW_FORM_loclistx = 0x22;
+const u_int64_t DW_FORM_rnglistx = 0x23;
+const u_int64_t DW_FORM_ref_sup8 = 0x24;
+const u_int64_t DW_FORM_strx1 = 0x25;
+const u_int64_t DW_FORM_strx2 = 0x26;
+const u_int64_t DW_FORM_strx3 = 0x27;
+const u_int64_t DW_FORM_strx4 = 0x28;
+const u_int64_t DW_FORM_addrx1 = 0x29;
+const u_int64_t DW_FORM_addrx2 = 0x2a;
+const u_int64_t DW_FORM_addrx3 = 0x2b;
+const u_int64_t DW_FORM_addrx4 = 0x2c;
+const u_int64_t DW_FORM_GNU_addr_index = 0x1f01;
+const u_int64_t DW_FORM_GNU_str_index = 0x1f02;
+const u_int64_t DW_FORM_GNU_ref_alt = 0x1f20;
+const u_int64_t DW_FORM_GNU_strp_alt = 0x1f21;
+
+/**
+ * @brief Bounds checked little-endian reader of a memory area.
+ */
+class CReader
+{
+public:
+    CReader(const unsigned char *begin, const unsigned char *end) :
+        m_pos(begin),
+        m_end(end)
+    {}
+
+    bool atEnd() const { return m_pos >= m_end; }
+    const unsigned char* position() const { return m_pos; }
+
+    void skip(u_int64_t n)
+    {
+        check(n);
+        m_pos += n;
+    }
+
+    u_int64_t readFixed(unsigned int n)
+    {
+        check(n);
+        u_int64_t value = 0;
+        for (unsigned int i = 0; i < n; ++i) {
+            value |= u_int64_t(m_pos[i]) << (8 * i);
+        }
+        m_pos += n;
+        return value;
+    }
+
+    u_int64_t readULEB()
+    {
+        u_int64_t value = 0;
+        unsigned int shift = 0;
+        unsigned char byte;
+        do {
+            check(1);
+            byte = *m_pos++;
+            if (shift < 64) {
+                value |= u_int64_t(byte & 0x7f) << shift;
+            }
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+    int64_t readSLEB()
+    {
+        int64_t value = 0;
+        unsigned int shift = 0;
+        unsigned char byte;
+        do {
+            check(1);
+            byte = *m_pos++;
+            if (shift < 64) {
+                value |= int64_t(byte & 0x7f) << shift;
+            }
+            shift += 7;
+        } while (byte & 0x80);
+        if (shift < 64 && (byte & 0x40)) {
+            value |= -(int64_t(1) << shift);
+        }
+        return value;
+    }
+
+    String readString()
+    {
+        const unsigned char *start = m_pos;
+        while (m_pos < m_end && *m_pos) {
+            ++m_pos;
+        }
+        check(1);
+        String s((const char*)start, m_pos - start);
+        ++m_pos;
+        return s;
+    }
+
+private:
+    void check(u_int64_t n)
+    {
+        if (u_int64_t(m_end - m_pos) < n) {
+            throw CException("soda::CElfSymbolizer::load()", "Unexpected end of section.");
+        }
+    }
+
+    const unsigned char *m_pos;
+    const unsigned char *m_end;
+};
+
+/**
+ * @brief Returns the null terminated string at the offset of a string section.
+ */
+String sectionString(const unsigned char *section, size_t size, u_int64_t offset)
+{
+    if (section == NULL || offset >= size) {
+        throw CException("soda::CElfSymbolizer::load()", "Invalid string offset.");
+    }
+    const char *s = (const char*)section + offset;
+    return String(s, strnlen(s, size - offset));
+}
+
+/**
+ * @brief Joins the compilation directory, the include directory and the file
+ *        name like addr2line does.
+ * @param compDir  The compilation directory, empty string if it is unknown.
+ * @param dirs  The include directories of the line table.
+ * @param dir  The directory index of the file, 0 is the compilation directory.
+ * @param file  The file name.
+ * @return The path or empty string if the path is relative to the unknown
+ *         compilation directory.
+ */
+String joinPath(const String &compDir, const StringVector &dirs, u_int64_t dir, const String &file)
+{
+    if (!file.empty() && file[0] == '/') {
+        return file;
+    }
+    String directory = dir > 0 && dir < dirs.size() ? dirs[dir] : "";
+    if (directory.empty() || directory[0] != '/') {
+        if (compDir.empty()) {
+            return "";
+        }
+        directory = directory.empty() ? compDir : compDir + "/" + directory;
+    }
+    return directory + "/" + file;
+}
+
+/**
+ * @brief Reads the value of an attribute and returns it if it is a string or a constant.
+ */
+u_int64_t readAttribute(CReader &reader, u_int64_t form, int64_t implicitConst, unsigned int version, unsigned int offsetSize,
+                        unsigned int addressSize, const unsigned char *str, size_t strSize,
+                        const unsigned char *lineStr, size_t lineStrSize, String &text, bool &isText)
+{
+    isText = false;
+    switch (form) {
+    case DW_FORM_string: text = reader.readString(); isText = true; return 0;
+    case DW_FORM_strp: text = sectionString(str, strSize, reader.readFixed(offsetSize)); isText = true; return 0;
+    case DW_FORM_line_strp: text = sectionString(lineStr, lineStrSize, reader.readFixed(offsetSize)); isText = true; return 0;
+    case DW_FORM_addr: return reader.readFixed(addressSize);
+    case DW_FORM_data1: case DW_FORM_ref1: case DW_FORM_flag: case DW_FORM_strx1: case DW_FORM_addrx1: return reader.readFixed(1);
+    case DW_FORM_data2: case DW_FORM_ref2: case DW_FORM_strx2: case DW_FORM_addrx2: return reader.readFixed(2);
+    case DW_FORM_strx3: case DW_FORM_addrx3: return reader.readFixed(3);
+    case DW_FORM_data4: case DW_FORM_ref4: case DW_FORM_ref_sup4: case DW_FORM_strx4: case DW_FORM_addrx4: return reader.readFixed(4);
+    case DW_FORM_data8: case DW_FORM_ref8: case DW_FORM_ref_sig8: case DW_FORM_ref_sup8: return reader.readFixed(8);
+    case DW_FORM_data16: reader.skip(16); return 0;
+    case DW_FORM_sdata: return reader.readSLEB();
+    case DW_FORM_udata: case DW_FORM_ref_udata: case DW_FORM_strx: case DW_FORM_addrx: case DW_FORM_loclistx:
+    case DW_FORM_rnglistx: case DW_FORM_GNU_addr_index: case DW_FORM_GNU_str_index:
+        return reader.readULEB();
+    case DW_FORM_ref_addr: return reader.readFixed(version <= 2 ? addressSize : offsetSize);
+    case DW_FORM_sec_offset: case DW_FORM_strp_sup: case DW_FORM_GNU_ref_alt: case DW_FORM_GNU_strp_alt:
+        return reader.readFixed(offsetSize);
+    case DW_FORM_block1: reader.skip(reader.readFixed(1)); return 0;
+    case DW_FORM_block2: reader.skip(reader.readFixed(2)); return 0;
+    case DW_FORM_block4: reader.skip(reader.readFixed(4)); return 0;
+    case DW_FORM_block: case DW_FORM_exprloc: reader.skip(reader.readULEB()); return 0;
+    case DW_FORM_flag_present: return 1;
+    case DW_FORM_implicit_const: return implicitConst;
+    case DW_FORM_indirect:
+        return readAttribute(reader, reader.readULEB(), implicitConst, version, offsetSize, addressSize, str, strSize,
+                             lineStr, lineStrSize, text, isText);
+    default:
+        throw CException("soda::CElfSymbolizer::load()", "Unsupported form in the debug info.");
+    }
+}
+
+/**
+ * @brief Reads the compilation directories of the units from the debug info.
+ * @return The compilation directories by the offsets of their line tables.
+ */
+std::map<u_int64_t, String> readCompDirs(const unsigned char *info, size_t infoSize, const unsigned char *abbrev, size_t abbrevSize,
+                                         const unsigned char *str, size_t strSize, const unsigned char *lineStr, size_t lineStrSize)
+{
+    std::map<u_int64_t, String> compDirs;
+    CReader unit(info, info + infoSize);
+    while (!unit.atEnd()) {
+        unsigned int offsetSize = 4;
+        u_int64_t length = unit.readFixed(4);
+        if (length == 0xffffffff) {
+            offsetSize = 8;
+            length = unit.readFixed(8);
+        }
+        const unsigned char *unitStart = unit.position();
+        unit.skip(length);
+        CReader reader(unitStart, unitStart + length);
+
+        unsigned int version = reader.readFixed(2);
+        if (version < 2 || version > 5) {
+            continue;
+        }
+        unsigned int addressSize;
+        u_int64_t abbrevOffset;
+        if (version >= 5) {
+            unsigned int type = reader.readFixed(1);
+            addressSize = reader.readFixed(1);
+            abbrevOffset = reader.readFixed(offsetSize);
+            if (type == DW_UT_skeleton || type == DW_UT_split_compile) {
+                reader.skip(8);
+            } else if (type == DW_UT_type || type == DW_UT_split_type) {
+                continue;
+            }
+        } else {
+            abbrevOffset = reader.readFixed(offsetSize);
+            addressSize = reader.readFixed(1);
+        }
+        if (abbrev == NULL || abbrevOffset >= abbrevSize) {
+            continue;
+        }
+
+        // The first entry of the unit is the compilation unit.
+        u_int64_t code = reader.readULEB();
+        CReader declarations(abbrev + abbrevOffset, abbrev + abbrevSize);
+        u_int64_t declaration = declarations.readULEB();
+        while (declaration != 0 && declaration != code) {
+            declarations.readULEB();
+            declarations.skip(1);
+            for (u_int64_t name = declarations.readULEB(), form = declarations.readULEB(); name != 0 || form != 0;
+                    name = declarations.readULEB(), form = declarations.readULEB()) {
+                if (form == DW_FORM_implicit_const) {
+                    declarations.readSLEB();
+                }
+            }
+            declaration = declarations.readULEB();
+        }
+        if (declaration == 0) {
+            continue;
+        }
+        declarations.readULEB();
+        declarations.skip(1);
+
+        bool hasLineTable = false;
+        u_int64_t lineTable = 0;
+        String compDir;
+        for (u_int64_t name = declarations.readULEB(), form = declarations.readULEB(); name != 0 || form != 0;
+                name = declarations.readULEB(), form = declarations.readULEB()) {
+            int64_t implicitConst = form == DW_FORM_implicit_const ? declarations.readSLEB() : 0;
+            String text;
+            bool isText;
+            u_int64_t value = readAttribute(reader, form, implicitConst, version, offsetSize, addressSize, str, strSize,
+                                            lineStr, lineStrSize, text, isText);
+            if (name == DW_AT_stmt_list && !isText) {
+                hasLineTable = true;
+                lineTable = value;
+            } else if (name == DW_AT_comp_dir && isText) {
+                compDir = text;
+            }
+        }
+        if (hasLineTable && !compDir.empty()) {
+            compDirs[lineTable] = compDir;
+        }
+    }
+    return compDirs;
+}
+
+} // namespace
+
+CElfSymbolizer::CElfSymbolizer() :
+    m_symbols(new std::vector<Symbol>()),
+    m_lines(new std::vector<LineRange>()),
+    m_files(new StringVector())
+{
+}
+
+CElfSymbolizer::~CElfSymbolizer()
+{
+    delete m_symbols;
+    delete m_lines;
+    delete m_files;
+}
+
+const String& CElfSymbolizer::getBuildId() const
+{
+    return m_buildId;
+}
+
+bool CElfSymbolizer::load(const String &binaryPath)
+{
+    m_symbols->clear();
+    m_lines->clear();
+    m_files->clear();
+    m_buildId.clear();
+
+    int fd = open(binaryPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < EI_NIDENT) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void *memory = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    const unsigned char *data = static_cast<const unsigned char*>(memory);
+    bool loaded = false;
+    if (memcmp(data, ELFMAG, SELFMAG) == 0 && data[EI_DATA] == ELFDATA2LSB) {
+        try {
+            if (data[EI_CLASS] == ELFCLASS64) {
+                readElf<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(data, size);
+                loaded = true;
+            } else if (data[EI_CLASS] == ELFCLASS32) {
+                readElf<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(data, size);
+                loaded = true;
+            }
+        } catch (CException &e) {
+            loaded = false;
+        }
+    }
+    munmap(memory, size);
+
+    if (!loaded) {
+        m_symbols->clear();
+        m_lines->clear();
+        m_files->clear();
+    }
+    return loaded;
+}
+
+template<class Ehdr, class Shdr, class Sym>
+void CElfSymbolizer::readElf(const unsigned char *data, size_t size)
+{
+    if (size < sizeof(Ehdr)) {
+        throw CException("soda::CElfSymbolizer::load()", "Truncated ELF header.");
+    }
+    const Ehdr *header = reinterpret_cast<const Ehdr*>(data);
+    if (header->e_shoff == 0 || header->e_shentsize != sizeof(Shdr) ||
+            header->e_shoff + u_int64_t(header->e_shnum) * sizeof(Shdr) > size || header->e_shstrndx >= header->e_shnum) {
+        throw CException("soda::CElfSymbolizer::load()", "Invalid section header table.");
+    }
+    const Shdr *sections = reinterpret_cast<const Shdr*>(data + header->e_shoff);
+
+    struct Contents {
+        const unsigned char *data;
+        size_t size;
+    };
+    const Shdr &names = sections[header->e_shstrndx];
+    if (names.sh_offset + names.sh_size > size) {
+        throw CException("soda::CElfSymbolizer::load()", "Invalid section name table.");
+    }
+
+    const Shdr *symtab = NULL;
+    Contents debugInfo = { NULL, 0 };
+    Contents debugAbbrev = { NULL, 0 };
+    Contents debugLine = { NULL, 0 };
+    Contents debugLineStr = { NULL, 0 };
+    Contents debugStr = { NULL, 0 };
+    for (IndexType i = 0; i < header->e_shnum; ++i) {
+        const Shdr &section = sections[i];
+        if (section.sh_type != SHT_NOBITS && section.sh_offset + section.sh_size > size) {
+            throw CException("soda::CElfSymbolizer::load()", "Invalid section.");
+        }
+        String name = sectionString(data + names.sh_offset, names.sh_size, section.sh_name);
+        Contents contents = { data + section.sh_offset, (size_t)section.sh_size };
+
+        if (section.sh_type == SHT_SYMTAB) {
+            symtab = &section;
+        } else if (section.sh_type == SHT_NOTE && name == ".note.gnu.build-id") {
+            CReader reader(contents.data, contents.data + contents.size);
+            u_int64_t nameSize = reader.readFixed(4);
+            u_int64_t descSize = reader.readFixed(4);
+            u_int64_t type = reader.readFixed(4);
+            reader.skip((nameSize + 3) & ~u_int64_t(3));
+            if (type == NT_GNU_BUILD_ID) {
+                std::ostringstream id;
+                id << std::hex << std::setfill('0');
+                for (u_int64_t j = 0; j < descSize; ++j) {
+                    id << std::setw(2) << reader.readFixed(1);
+                }
+                m_buildId = id.str();
+            }
+        } else if (name.compare(0, 7, ".zdebug") == 0 || (name.compare(0, 6, ".debug") == 0 && (section.sh_flags & SHF_COMPRESSED))) {
+            throw CException("soda::CElfSymbolizer::load()", "Compressed debug sections are not supported.");
+        } else {
+            if (name == ".debug_info") {
+                debugInfo = contents;
+            } else if (name == ".debug_abbrev") {
+                debugAbbrev = contents;
+            } else if (name == ".debug_line") {
+                debugLine = contents;
+            } else if (name == ".debug_line_str") {
+                debugLineStr = contents;
+            } else if (name == ".debug_str") {
+                debugStr = contents;
+            }
+        }
+    }
+
+    // Without symbol table addr2line uses the debug information which is not read here.
+    if (symtab == NULL || symtab->sh_link >= header->e_shnum || symtab->sh_entsize != sizeof(Sym)) {
+        throw CException("soda::CElfSymbolizer::load()", "There is no symbol table.");
+    }
+    const Shdr &strtab = sections[symtab->sh_link];
+    const Sym *symbols = reinterpret_cast<const Sym*>(data + symtab->sh_offset);
+    IndexType numOfSymbols = symtab->sh_size / sizeof(Sym);
+    for (IndexType i = 0; i < numOfSymbols; ++i) {
+        const Sym &symbol = symbols[i];
+        unsigned char type = ELF64_ST_TYPE(symbol.st_info);
+        if ((type != STT_FUNC && type != STT_GNU_IFUNC) || symbol.st_shndx == SHN_UNDEF || symbol.st_value == 0) {
+            continue;
+        }
+        Symbol function;
+        function.address = symbol.st_value;
+        function.size = symbol.st_size;
+        function.name = sectionString(data + strtab.sh_offset, strtab.sh_size, symbol.st_name);
+        m_symbols->push_back(function);
+    }
+    std::stable_sort(m_symbols->begin(), m_symbols->end());
+
+    if (debugLine.data != NULL) {
+        std::map<u_int64_t, String> compDirs;
+        if (debugInfo.data != NULL) {
+            compDirs = readCompDirs(debugInfo.data, debugInfo.size, debugAbbrev.data, debugAbbrev.size,
+                                    debugStr.data, debugStr.size, debugLineStr.data, debugLineStr.size);
+        }
+        readLineTable(debugLine.data, debugLine.size, debugLineStr.data, debugLineStr.size, debugStr.data, debugStr.size, compDirs);
+    }
+}
+
+void CElfSymbolizer::readLineTable(const unsigned char *data, size_t size, const unsigned char *lineStr, size_t lineStrSize,
+                                   const unsigned char *str, size_t strSize, const std::map<u_int64_t, String> &compDirs)
+{
+    CReader unit(data, data + size);
+    while (!unit.atEnd()) {
+        // Header of the line number program.
+        std::map<u_int64_t, String>::const_iterator compDirIt = compDirs.find(unit.position() - data);
+        String compDir = compDirIt != compDirs.end() ? compDirIt->second : "";
+        unsigned int offsetSize = 4;
+        u_int64_t length = unit.readFixed(4);
+        if (length == 0xffffffff) {
+            offsetSize = 8;
+            length = unit.readFixed(8);
+        }
+        const unsigned char *unitStart = unit.position();
+        unit.skip(length);
+        CReader reader(unitStart, unitStart + length);
+
+        unsigned int version = reader.readFixed(2);
+        if (version < 2 || version > 5) {
+            throw CException("soda::CElfSymbolizer::load()", "Unsupported line table version.");
+        }
+        if (version >= 5) {
+            reader.skip(2); // address_size, segment_selector_size
+        }
+        u_int64_t headerLength = reader.readFixed(offsetSize);
+        const unsigned char *programStart = reader.position() + headerLength;
+        unsigned int minInstLength = reader.readFixed(1);
+        if (version >= 4) {
+            reader.skip(1); // maximum_operations_per_instruction
+        }
+        reader.skip(1); // default_is_stmt
+        int lineBase = (signed char)reader.readFixed(1);
+        unsigned int lineRange = reader.readFixed(1);
+        unsigned int opcodeBase = reader.readFixed(1);
+        if (lineRange == 0 || opcodeBase == 0) {
+            throw CException("soda::CElfSymbolizer::load()", "Invalid line table header.");
+        }
+        std::vector<unsigned int> opcodeLengths(opcodeBase, 0);
+        for (unsigned int i = 1; i < opcodeBase; ++i) {
+            opcodeLengths[i] = reader.readFixed(1);
+        }
+
+        // Directories and files, the values are indices of m_files.
+        StringVector dirs;
+        std::vector<IndexType> files;
+        if (version >= 5) {
+            for (int table = 0; table < 2; ++table) {
+                unsigned int formatCount = reader.readFixed(1);
+                std::vector<std::pair<u_int64_t, u_int64_t> > format;
+                for (unsigned int i = 0; i < formatCount; ++i) {
+                    u_int64_t type = reader.readULEB();
+                    format.push_back(std::make_pair(type, reader.readULEB()));
+                }
+                u_int64_t count = reader.readULEB();
+                for (u_int64_t i = 0; i < count; ++i) {
+                    String path;
+                    u_int64_t dir = 0;
+                    for (IndexType j = 0; j < format.size(); ++j) {
+                        u_int64_t value = 0;
+                        String text;
+                        switch (format[j].second) {
+                        case DW_FORM_string: text = reader.readString(); break;
+                        case DW_FORM_line_strp: text = sectionString(lineStr, lineStrSize, reader.readFixed(offsetSize)); break;
+                        case DW_FORM_strp: text = sectionString(str, strSize, reader.readFixed(offsetSize)); break;
+                        case DW_FORM_udata: value = reader.readULEB(); break;
+                        case DW_FORM_data1: value = reader.readFixed(1); break;
+                        case DW_FORM_data2: value = reader.readFixed(2); break;
+                        case DW_FORM_data4: value = reader.readFixed(4); break;
+                        case DW_FORM_data8: value = reader.readFixed(8); break;
+                        case DW_FORM_data16: reader.skip(16); break;
+                        case DW_FORM_block: reader.skip(reader.readULEB()); break;
+                        default:
+                            throw CException("soda::CElfSymbolizer::load()", "Unsupported form in the line table header.");
+                        }
+                        if (format[j].first == DW_LNCT_path) {
+                            path = text;
+                        } else if (format[j].first == DW_LNCT_directory_index) {
+                            dir = value;
+                        }
+                    }
+                    if (table == 0) {
+                        dirs.push_back(path);
+                        // The directory 0 is the compilation directory.
+                        if (i == 0 && compDir.empty() && !path.empty() && path[0] == '/') {
+                            compDir = path;
+                        }
+                    } else {
+                        files.push_back(m_files->size());
+                        m_files->push_back(joinPath(compDir, dirs, dir, path));
+                    }
+                }
+            }
+        } else {
+            // The directory 0 is the compilation directory which is only available from the debug info.
+            dirs.push_back("");
+            for (String dir = reader.readString(); !dir.empty(); dir = reader.readString()) {
+                dirs.push_back(dir);
+            }
+            files.push_back(m_files->size());
+            m_files->push_back("??");
+            for (String file = reader.readString(); !file.empty(); file = reader.readString()) {
+                u_int64_t dir = reader.readULEB();
+                reader.readULEB();
+                reader.readULEB();
+                files.push_back(m_files->size());
+                m_files->push_back(joinPath(compDir, dirs, dir, file));
+            }
+        }
+
+        if (programStart > unitStart + length) {
+            throw CException("soda::CElfSymbolizer::load()", "Invalid line table header length.");
+        }
+
+        // The line number program.
+        CReader program(programStart, unitStart + length);
+        u_int64_t address = 0;
+        u_int64_t file = 1;
+        int64_t line = 1;
+        std::vector<LineRange> sequence;
+        while (!program.atEnd()) {
+            unsigned char opcode = program.readFixed(1);
+            bool emit = false;
+            bool endSequence = false;
+            if (opcode >= opcodeBase) {
+                unsigned int adjusted = opcode - opcodeBase;
+                address += (adjusted / lineRange) * minInstLength;
+                line += lineBase + int(adjusted % lineRange);
+                emit = true;
+            } else if (opcode == 0) {
+                u_int64_t extLength = program.readULEB();
+                if (extLength == 0) {
+                    continue;
+                }
+                const unsigned char *extEnd = program.position() + extLength;
+                unsigned char extOpcode = program.readFixed(1);
+                if (extOpcode == DW_LNE_end_sequence) {
+                    emit = true;
+                    endSequence = true;
+                } else if (extOpcode == DW_LNE_set_address) {
+                    address = program.readFixed(extLength - 1 > 8 ? 8 : extLength - 1);
+                } else if (extOpcode == DW_LNE_define_file) {
+                    String name = program.readString();
+                    u_int64_t dir = program.readULEB();
+                    files.push_back(m_files->size());
+                    m_files->push_back(joinPath(compDir, dirs, dir, name));
+                }
+                program.skip(extEnd - program.position());
+            } else if (opcode == DW_LNS_copy) {
+                emit = true;
+            } else if (opcode == DW_LNS_advance_pc) {
+                address += program.readULEB() * minInstLength;
+            } else if (opcode == DW_LNS_advance_line) {
+                line += program.readSLEB();
+            } else if (opcode == DW_LNS_set_file) {
+                file = program.readULEB();
+            } else if (opcode == DW_LNS_const_add_pc) {
+                address += ((255 - opcodeBase) / lineRange) * minInstLength;
+            } else if (opcode == DW_LNS_fixed_advance_pc) {
+                address += program.readFixed(2);
+            } else {
+                for (unsigned int i = 0; i < opcodeLengths[opcode]; ++i) {
+                    program.readULEB();
+                }
+            }
+
+            if (emit) {
+                // The previous row covers the addresses up to the current one.
+                if (!sequence.empty()) {
+                    sequence.back().end = address;
+                }
+                if (!endSequence) {
+                    LineRange range;
+                    range.begin = address;
+                    range.end = address;
+                    range.file = file < files.size() ? files[file] : files.empty() ? 0 : files[0];
+                    range.line = line;
+                    sequence.push_back(range);
+                } else {
+                    for (IndexType i = 0; i < sequence.size(); ++i) {
+                        if (sequence[i].begin < sequence[i].end) {
+                            m_lines->push_back(sequence[i]);
+                        }
+                    }
+                    sequence.clear();
+                    address = 0;
+                    file = 1;
+                    line = 1;
+                }
+            }
+        }
+    }
+    if (m_files->empty()) {
+        m_files->push_back("??");
+    }
+    std::stable_sort(m_lines->begin(), m_lines->end());
+}
+
+bool CElfSymbolizer::resolve(u_int64_t address, String &output) const
+{
+    String function = "??";
+    std::vector<Symbol>::const_iterator symbol = std::upper_bound(m_symbols->begin(), m_symbols->end(), Symbol{address, 0, ""});
+    while (symbol != m_symbols->begin()) {
+        --symbol;
+        if (symbol->address == address || address < symbol->address + symbol->size) {
+            function = symbol->name;
+            if (function.compare(0, 2, "_Z") == 0) {
+                int status = 0;
+                char *demangled = abi::__cxa_demangle(function.c_str(), NULL, NULL, &status);
+                if (status == 0 && demangled != NULL) {
+                    function = demangled;
+                }
+                free(demangled);
+            }
+            break;
+        }
+        // Symbols at the same address are checked too.
+        if (symbol == m_symbols->begin() || (symbol - 1)->address != symbol->address) {
+            break;
+        }
+    }
+
+    std::vector<LineRange>::const_iterator range = std::upper_bound(m_lines->begin(), m_lines->end(), LineRange{address, 0, 0, 0});
+    if (range == m_lines->begin() || address >= (range - 1)->end) {
+        return false;
+    }
+    --range;
+    // The path of the file could not be resolved without the compilation directory.
+    if ((*m_files)[range->file].empty()) {
+        return false;
+    }
+    std::ostringstream location;
+    location << function << " at " << (*m_files)[range->file] << ":" << range->line;
+    output = location.str();
+    return true;
+}
+
+} /* namespace soda */
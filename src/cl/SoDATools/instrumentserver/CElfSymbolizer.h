@@ -0,0 +1,126 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CELFSYMBOLIZER_H
+#define CELFSYMBOLIZER_H
+
+#include <map>
+#include <vector>
+
+#include "data/SoDALibDefs.h"
+
+namespace soda {
+
+/**
+ * @brief Translates the addresses of a binary to function names and source
+ *        locations. The symbol table and the DWARF line table of the ELF file
+ *        are read once when the binary is loaded.
+ */
+class CElfSymbolizer
+{
+public:
+    CElfSymbolizer();
+    ~CElfSymbolizer();
+
+    /**
+     * @brief Loads the symbol and line tables of the binary.
+     * @param binaryPath  The path of the binary.
+     * @return False if the file is not a supported ELF file, so the
+     *         addresses should be resolved by addr2line.
+     */
+    bool load(const String &binaryPath);
+
+    /**
+     * @brief Returns the build-id of the binary as a hexadecimal string.
+     * @return The build-id or empty string if the binary has no build-id note.
+     */
+    const String& getBuildId() const;
+
+    /**
+     * @brief Resolves an address in the same format as "addr2line -C -f -p".
+     * @param address  The address of the function.
+     * @param output  The function name and the location without line ending.
+     * @return False if the address is not covered by the line table. addr2line
+     *         reads the debug info in this case, so it should be used instead.
+     */
+    bool resolve(u_int64_t address, String &output) const;
+
+private:
+    CElfSymbolizer(const CElfSymbolizer&);
+    CElfSymbolizer& operator=(const CElfSymbolizer&);
+
+    /**
+     * @brief A function symbol.
+     */
+    struct Symbol {
+        u_int64_t address;
+        u_int64_t size;
+        String name;
+
+        bool operator<(const Symbol &other) const { return address < other.address; }
+    };
+
+    /**
+     * @brief An address range of the line table.
+     */
+    struct LineRange {
+        u_int64_t begin;
+        u_int64_t end;
+        IndexType file;
+        IndexType line;
+
+        bool operator<(const LineRange &other) const { return begin < other.begin; }
+    };
+
+    template<class Ehdr, class Shdr, class Sym>
+    void readElf(const unsigned char *data, size_t size);
+
+    /**
+     * @brief Reads the line tables of the units.
+     * @param compDirs  The compilation directories by the offsets of the line
+     *                  tables. The files of the units without compilation
+     *                  directory have empty paths when they are relative.
+     */
+    void readLineTable(const unsigned char *data, size_t size, const unsigned char *lineStr, size_t lineStrSize,
+                       const unsigned char *str, size_t strSize, const std::map<u_int64_t, String> &compDirs);
+
+    /**
+     * @brief The function symbols ordered by address.
+     */
+    std::vector<Symbol> *m_symbols;
+
+    /**
+     * @brief The non-empty ranges of the line table ordered by address.
+     */
+    std::vector<LineRange> *m_lines;
+
+    /**
+     * @brief The source file paths referenced by the line ranges, empty string
+     *        if the path is unknown.
+     */
+    StringVector *m_files;
+
+    String m_buildId;
+};
+
+} /* namespace soda */
+
+#endif /* CELFSYMBOLIZER_H */
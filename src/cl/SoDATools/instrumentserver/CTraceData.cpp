@@ -19,6 +19,8 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <iostream>
+
 #include "CTraceData.h"
 #include "exception/CException.h"
 
@@ -26,7 +28,9 @@ namespace soda {
 
 CTraceData::CTraceData(const String& coverageFileName, const String& baseDir ) :
     m_coverageMatrix(new CCoverageMatrix()),
+    m_coverageBuilder(new CCoverageMatrixBuilder()),
     m_coverageFilePath(coverageFileName),
+    m_addressShards(new AddressShard[NUM_OF_ADDRESS_SHARDS]),
     m_codeElementLocations(new std::set<std::string>()),
     m_baseDir(baseDir)
 {}
@@ -34,12 +38,16 @@ CTraceData::CTraceData(const String& coverageFileName, const String& baseDir ) :
 CTraceData::~CTraceData()
 {
     delete m_coverageMatrix;
+    delete m_coverageBuilder;
+    delete[] m_addressShards;
     delete m_codeElementLocations;
 }
 
 void CTraceData::save()
 {
     m_coverageMutex.lock();
+    m_coverageBuilder->build(*m_coverageMatrix);
+    m_coverageBuilder->clear();
     m_coverageMatrix->save(m_coverageFilePath);
     m_coverageMutex.unlock();
 }
@@ -47,31 +55,71 @@ void CTraceData::save()
 void CTraceData::setCoverage(const String &test, const String &codeElementName)
 {
     m_coverageMutex.lock();
-    m_coverageMatrix->addOrSetRelation(test, codeElementName, true);
+    m_coverageBuilder->addOrSetRelation(test, codeElementName, true);
+    m_coverageMutex.unlock();
+}
+
+void CTraceData::setCoverage(const String &test, const std::set<String> &codeElementNames)
+{
+    m_coverageMutex.lock();
+    for (std::set<String>::const_iterator it = codeElementNames.begin(); it != codeElementNames.end(); ++it) {
+        m_coverageBuilder->addOrSetRelation(test, *it, true);
+    }
     m_coverageMutex.unlock();
 }
 
+bool CTraceData::getBinaryId(const String &binaryPath, bool create, u_int64_t &id)
+{
+    {
+        boost::shared_lock<boost::shared_mutex> lock(m_binaryIdsMutex);
+        std::map<String, u_int64_t>::const_iterator it = m_binaryIds.find(binaryPath);
+        if (it != m_binaryIds.end()) {
+            id = it->second;
+            return true;
+        }
+    }
+    if (!create) {
+        return false;
+    }
+    boost::unique_lock<boost::shared_mutex> lock(m_binaryIdsMutex);
+    std::map<String, u_int64_t>::iterator it = m_binaryIds.find(binaryPath);
+    if (it == m_binaryIds.end()) {
+        it = m_binaryIds.insert(std::make_pair(binaryPath, (u_int64_t)m_binaryIds.size())).first;
+    }
+    id = it->second;
+    return true;
+}
+
+CTraceData::AddressShard& CTraceData::getAddressShard(u_int64_t key)
+{
+    return m_addressShards[((key * 0x9E3779B97F4A7C15ULL) >> 32) & (NUM_OF_ADDRESS_SHARDS - 1)];
+}
+
 bool CTraceData::getCodeElementName(const String &binaryPath, const int address, String &function)
 {
-    m_addressMapMutex.lock();
-    if (m_addressMap.find(binaryPath) == m_addressMap.end()) {
-        m_addressMapMutex.unlock();
+    u_int64_t id;
+    if (!getBinaryId(binaryPath, false, id)) {
         return false;
     }
-    if (m_addressMap[binaryPath].find(address) == m_addressMap[binaryPath].end()) {
-        m_addressMapMutex.unlock();
+    u_int64_t key = (id << 32) | (unsigned int)address;
+    AddressShard &shard = getAddressShard(key);
+    boost::shared_lock<boost::shared_mutex> lock(shard.mutex);
+    std::unordered_map<u_int64_t, String>::const_iterator it = shard.names.find(key);
+    if (it == shard.names.end()) {
         return false;
     }
-    function = m_addressMap[binaryPath][address];
-    m_addressMapMutex.unlock();
+    function = it->second;
     return true;
 }
 
 void CTraceData::addCodeElementName(const String &binaryPath, const int address, const String &codeElementName)
 {
-    m_addressMapMutex.lock();
-    m_addressMap[binaryPath][address] = codeElementName;
-    m_addressMapMutex.unlock();
+    u_int64_t id;
+    getBinaryId(binaryPath, true, id);
+    u_int64_t key = (id << 32) | (unsigned int)address;
+    AddressShard &shard = getAddressShard(key);
+    boost::unique_lock<boost::shared_mutex> lock(shard.mutex);
+    shard.names[key] = codeElementName;
 }
 
 void CTraceData::addCodeElementLocation(const String &location)
@@ -86,6 +134,27 @@ std::set<std::string>& CTraceData::getCodeElementLocations()
     return *m_codeElementLocations;
 }
 
+void CTraceData::addResolvedFunction(const String &test, const String &binaryPath, const int address, const String &resolved)
+{
+    String function = "";
+    if (!getCodeElementName(binaryPath, address, function)) {
+        // The address can not be resolved.
+        if (resolved.find("??") != std::string::npos) {
+            return;
+        }
+
+        function = resolved.substr(0, resolved.find(" at "));
+
+        std::cerr << "Function: " << function << std::endl;
+
+        addCodeElementLocation(resolved);
+        addCodeElementName(binaryPath, address, function);
+    }
+    if (!test.empty()) {
+        setCoverage(test, function);
+    }
+}
+
 String CTraceData::getBaseDir()
 {
     return m_baseDir;
@@ -22,8 +22,11 @@
 #ifndef CTRACEDATA_H
 #define CTRACEDATA_H
 
+#include <unordered_map>
+
 #include "boost/thread.hpp"
 #include "data/CCoverageMatrix.h"
+#include "data/CCoverageMatrixBuilder.h"
 
 namespace soda {
 
@@ -59,6 +62,13 @@ public:
      */
     virtual void setCoverage(const String &test, const String &codeElementName);
 
+    /**
+     * @brief Sets the coverage of several functions in the test at once.
+     * @param test  The name of the test.
+     * @param codeElementNames  The names of the functions.
+     */
+    virtual void setCoverage(const String &test, const std::set<String> &codeElementNames);
+
     /**
      * @brief Returns true if the code element name exists.
      * @param binaryPath  The path to the binary which contains the function.
@@ -84,6 +94,16 @@ public:
 
     virtual std::set<std::string>& getCodeElementLocations();
 
+    /**
+     * @brief Stores the result of an address translation and sets the coverage
+     *        of the function in the test.
+     * @param test  The name of the test, the coverage is not set if it is empty.
+     * @param binaryPath  The path of the binary which contains the function.
+     * @param address  The address of the function.
+     * @param resolved  The "function at location" string of the address.
+     */
+    virtual void addResolvedFunction(const String &test, const String &binaryPath, const int address, const String &resolved);
+
     /**
      * @brief Returns the base directory where the executed binaries can be
      *        found.
@@ -97,6 +117,11 @@ private:
      */
     CCoverageMatrix *m_coverageMatrix;
 
+    /**
+     * @brief Collects the relations until the next save.
+     */
+    CCoverageMatrixBuilder *m_coverageBuilder;
+
     /**
      * @brief A mutex to prevent parallel access to the coverage matrix.
      */
@@ -108,15 +133,49 @@ private:
     String           m_coverageFilePath;
 
     /**
-     * @brief Stores the code element names and their address to speed up lookup
-     *        process.
+     * @brief Returns the identifier of the binary path.
+     * @param binaryPath  The path of the binary.
+     * @param create  Registers the path if it is not known yet.
+     * @param id  The identifier of the binary.
+     * @return False if the path is not known and it was not registered.
+     */
+    bool getBinaryId(const String &binaryPath, bool create, u_int64_t &id);
+
+    /**
+     * @brief A part of the address cache with its own lock.
+     */
+    struct AddressShard {
+        boost::shared_mutex mutex;
+        std::unordered_map<u_int64_t, String> names;
+    };
+
+    /**
+     * @brief Returns the shard of the address cache storing the key.
+     * @param key  The binary identifier and the address.
+     * @return The shard.
+     */
+    AddressShard& getAddressShard(u_int64_t key);
+
+    /**
+     * @brief Number of the address cache shards, must be a power of two.
+     */
+    static const IndexType NUM_OF_ADDRESS_SHARDS = 16;
+
+    /**
+     * @brief Stores the code element names by binary identifier and address
+     *        to speed up lookup process. The lookups of the shards can run parallel.
+     */
+    AddressShard *m_addressShards;
+
+    /**
+     * @brief The identifiers of the binary paths.
      */
-    std::map<String, std::map<int, String> > m_addressMap;
+    std::map<String, u_int64_t> m_binaryIds;
 
     /**
-     * @brief A mutex to prevent parallel access to the address map.
+     * @brief A mutex to prevent parallel modification of the binary identifiers.
      */
-    boost::mutex  m_addressMapMutex;
+    boost::shared_mutex m_binaryIdsMutex;
 
     /**
      * @brief Stores the location of code elements in the source files.
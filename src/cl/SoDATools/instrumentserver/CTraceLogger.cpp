@@ -19,22 +19,29 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <iostream>
 #include <sstream>
 
-#include "boost/filesystem.hpp"
-
 #include "CTraceLogger.h"
 #include "exception/CException.h"
-#include "CAddressResolver.h"
 
 namespace soda {
 
-CTraceLogger::CTraceLogger(int socket, CTraceData *data) :
+CTraceLogger::CTraceLogger(int socket, CTraceData *data, CAddressResolver *resolver) :
     m_socket(socket),
-    m_data(data)
+    m_data(data),
+    m_resolver(resolver),
+    m_readBuffer(READ_BUFFER_SIZE),
+    m_readPos(0),
+    m_readEnd(0),
+    m_shm(NULL)
 {
 }
 
@@ -43,6 +50,13 @@ CTraceLogger::CTraceLogger(const CTraceLogger &obj)
     m_testcaseName = std::string(obj.m_testcaseName);
     m_socket = obj.m_socket;
     m_data = obj.m_data;
+    m_resolver = obj.m_resolver;
+    m_coverage = obj.m_coverage;
+    m_readBuffer = obj.m_readBuffer;
+    m_readPos = obj.m_readPos;
+    m_readEnd = obj.m_readEnd;
+    m_shm = obj.m_shm;
+    m_modules = obj.m_modules;
 }
 
 CTraceLogger::~CTraceLogger()
@@ -54,8 +68,13 @@ void CTraceLogger::operator()()
     bool isOpen = true;
     while (isOpen) {
         char type;
+        if (m_shm != NULL) {
+            waitForMessage();
+        }
         /* read returns zero, the client closed the connection. */
-        if (read(m_socket, &type, sizeof (type)) == 0) {
+        if (readSocket(&type, sizeof (type)) <= 0) {
+            closeSharedMemory();
+            flushCoverage();
             return;
         }
         switch (type) {
@@ -68,7 +87,12 @@ void CTraceLogger::operator()()
         case INSTRUMENT_FUNCTION_EXIT_MSG:
             handleFunctionExitMessage();
             break;
+        case INSTRUMENT_SHM_MSG:
+            handleSharedMemoryMessage();
+            break;
         case INSTRUMENT_CLOSE_MSG:
+            closeSharedMemory();
+            flushCoverage();
             close(m_socket);
             isOpen = false;
             (std::cout << " done." << std::endl).flush();
@@ -84,15 +108,16 @@ void CTraceLogger::handleTestMessage()
     ssize_t len;
     size_t length;
     char* text;
+    flushCoverage();
     m_testcaseName = "";
     // Read the length of the test name.
-    len = read(m_socket, &length, sizeof (length));
+    len = readSocket(&length, sizeof (length));
     if (len < 0) {
         return;
     }
     text = new char[length];
     // Read the test name.
-    len = read(m_socket, text, length);
+    len = readSocket(text, length);
     if (len < 0) {
         return;
     }
@@ -105,96 +130,207 @@ void CTraceLogger::handleTestMessage()
 }
 
 
-String CTraceLogger::handleFunctionMessage()
+void CTraceLogger::handleSharedMemoryMessage()
 {
-    ssize_t len;
     size_t length;
-    int address;
-    char* text;
-    String function = "";
-
-    // Read the length of the binary path.
-    len = read(m_socket, &length, sizeof (length));
-    if (len < 0) {
-        return function;
+    char ack = 0;
+    if (readSocket(&length, sizeof (length)) <= 0) {
+        return;
+    }
+    char name[INSTRUMENT_SHM_NAME];
+    if (length == 0 || length > INSTRUMENT_SHM_NAME) {
+        // Skip the name, so the next message is read from its beginning, and refuse the shared memory.
+        for (size_t skipped = 0; skipped < length; ) {
+            ssize_t len = readSocket(name, std::min(length - skipped, sizeof(name)));
+            if (len <= 0) {
+                return;
+            }
+            skipped += len;
+        }
+    } else {
+        if (readSocket(name, length) != (ssize_t)length) {
+            return;
+        }
+        name[length - 1] = '\0';
+        openSharedMemory(name);
+        ack = (m_shm != NULL);
     }
 
-    text = new char[length];
-    // Read path.
-    len = read(m_socket, text, length);
-    if (len < 0) {
-        delete text;
-        return function;
+    // The client falls back to the socket messages if the answer is not 1.
+    if (write(m_socket, &ack, sizeof(ack)) < 0) {
+        closeSharedMemory();
     }
+}
 
-    // Read the address.
-    len = read(m_socket, &address, sizeof(address));
-    if (len < 0) {
-        delete text;
-        return function;
+void CTraceLogger::openSharedMemory(const char *name)
+{
+    closeSharedMemory();
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return;
+    }
+    void *memory = mmap(NULL, sizeof(instrument_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return;
     }
+    m_shm = static_cast<instrument_shm_t*>(memory);
+    if (m_shm->magic != INSTRUMENT_SHM_MAGIC || m_shm->version != INSTRUMENT_SHM_VERSION) {
+        closeSharedMemory();
+    }
+}
 
-    String binaryPath = String(text);
+void CTraceLogger::closeSharedMemory()
+{
+    if (m_shm == NULL) {
+        return;
+    }
+    drainRings();
+    uint32_t overflowed = __atomic_load_n(&m_shm->numOfOverflowedEvents, __ATOMIC_RELAXED);
+    if (overflowed > 0) {
+        std::cerr << "[WARNING] " << overflowed << " events of test " << m_testcaseName
+                  << " did not fit into the shared memory and were sent through the socket." << std::endl;
+    }
+    munmap(m_shm, sizeof(instrument_shm_t));
+    m_shm = NULL;
+    m_modules.clear();
+}
 
-    if (!m_data->getCodeElementName(binaryPath, address, function)) {
-        String resolved = translateAddressToFunction(binaryPath, address);
+IndexType CTraceLogger::drainRings()
+{
+    static const uint64_t BATCH_SIZE = 256;
+    IndexType drained = 0;
+    for (IndexType i = 0; i < INSTRUMENT_MAX_RINGS; ++i) {
+        instrument_ring_t *ring = &m_shm->rings[i];
+        uint64_t available;
+        while ((available = instrument_ring_available(ring)) != 0) {
+            uint64_t count = std::min(available, BATCH_SIZE);
+            for (uint64_t k = 0; k < count; ++k) {
+                const instrument_event_t &event = *instrument_ring_peek(ring, k);
+                if (event.module >= m_modules.size()) {
+                    uint32_t numOfModules = __atomic_load_n(&m_shm->numOfModules, __ATOMIC_ACQUIRE);
+                    for (uint32_t j = m_modules.size(); j < numOfModules && j < INSTRUMENT_MAX_MODULES; ++j) {
+                        m_modules.push_back(String(m_shm->modules[j], strnlen(m_shm->modules[j], INSTRUMENT_MODULE_PATH)));
+                    }
+                    if (event.module >= m_modules.size()) {
+                        continue;
+                    }
+                }
+                if (m_testcaseName.length() == 0) {
+                    continue;
+                }
+                coverFunction(m_modules[event.module], (int)event.address);
+            }
+            // Release the processed slots to the producer.
+            instrument_ring_release(ring, count);
+            drained += count;
+        }
+    }
+    return drained;
+}
 
-        // The address can not be resolved.
-        if (resolved.find("??") != std::string::npos) {
-            delete text;
-            return function;
+void CTraceLogger::waitForMessage()
+{
+    struct pollfd pfd;
+    pfd.fd = m_socket;
+    pfd.events = POLLIN;
+    while (m_readPos == m_readEnd) {
+        IndexType drained = drainRings();
+        // Keep draining without sleeping while the producers are active.
+        if (poll(&pfd, 1, drained ? 0 : 1) != 0) {
+            return;
         }
+    }
+}
 
+ssize_t CTraceLogger::readSocket(void *data, size_t size)
+{
+    char *out = static_cast<char*>(data);
+    size_t copied = 0;
+    while (copied < size) {
+        if (m_readPos == m_readEnd) {
+            ssize_t len = read(m_socket, &m_readBuffer[0], m_readBuffer.size());
+            if (len <= 0) {
+                return copied ? (ssize_t)copied : len;
+            }
+            m_readPos = 0;
+            m_readEnd = len;
+        }
+        size_t n = std::min(size - copied, m_readEnd - m_readPos);
+        memcpy(out + copied, &m_readBuffer[m_readPos], n);
+        m_readPos += n;
+        copied += n;
+    }
+    return copied;
+}
 
-        function = resolved.substr(0, resolved.find(" at "));
+bool CTraceLogger::readFunctionMessage(String &binaryPath, int &address)
+{
+    ssize_t len;
+    size_t length;
+    char* text;
 
-        std::cerr << "Function: " << function << std::endl;
+    // Read the length of the binary path.
+    len = readSocket(&length, sizeof (length));
+    if (len <= 0) {
+        return false;
+    }
 
-        m_data->addCodeElementLocation(resolved);
-        m_data->addCodeElementName(binaryPath, address, function);
+    text = new char[length];
+    // Read path.
+    len = readSocket(text, length);
+    if (len <= 0) {
+        delete[] text;
+        return false;
     }
+    binaryPath = String(text, strnlen(text, length));
 
     /* Free the buffer. */
-    delete text;    
+    delete[] text;
 
-    return function;
+    // Read the address.
+    len = readSocket(&address, sizeof(address));
+    return len > 0;
 }
 
-
-void CTraceLogger::handleFunctionEnterMessage()
+void CTraceLogger::coverFunction(const String &binaryPath, const int address)
 {
     if (m_testcaseName.length() == 0) {
         return;
     }
 
-    String function = handleFunctionMessage();
-    if (!function.length()) {
-        return;
+    String function;
+    if (m_data->getCodeElementName(binaryPath, address, function)) {
+        m_coverage.insert(function);
+    } else {
+        // The coverage is set by the resolver when the name is available.
+        m_resolver->enqueue(m_testcaseName, binaryPath, address);
+    }
+}
+
+void CTraceLogger::handleFunctionEnterMessage()
+{
+    String binaryPath;
+    int address;
+    if (readFunctionMessage(binaryPath, address)) {
+        coverFunction(binaryPath, address);
     }
-    m_data->setCoverage(m_testcaseName, function);
 }
 
 void CTraceLogger::handleFunctionExitMessage()
 {
-    // Do nothing now.
+    // Read the message, the exits are not used now.
+    String binaryPath;
+    int address;
+    readFunctionMessage(binaryPath, address);
 }
 
-String CTraceLogger::translateAddressToFunction(const String &binaryPath, const int address)
+void CTraceLogger::flushCoverage()
 {
-    String binaryFullPath = binaryPath;
-    if (!boost::filesystem::exists(binaryPath.c_str()) || boost::filesystem::is_directory(binaryPath.c_str())) {
-        binaryFullPath = m_data->getBaseDir() + "/" + binaryPath;
+    if (m_testcaseName.length() != 0 && !m_coverage.empty()) {
+        m_data->setCoverage(m_testcaseName, m_coverage);
     }
-    String output;
-    try {
-        output = CAddressResolver::resolve(binaryFullPath, address);
-    } catch (CException &e) {
-        output = "[SODA]not-resolved";
-    }
-
-    if (!output.empty())
-        output.erase(output.length() - 2, 2); // remove line ending
-    return output;
+    m_coverage.clear();
 }
 
 int CTraceLogger::getSocket()
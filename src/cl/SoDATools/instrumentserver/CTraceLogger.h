@@ -24,8 +24,11 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
+#include "CAddressResolver.h"
 #include "CTraceData.h"
+#include "instrumenter/instrument_ring.h"
 
 namespace soda {
 
@@ -42,8 +45,9 @@ public:
      *        the socket and saves the informations in the data.
      * @param socket  The socket identifier.
      * @param data  The CTraceData instance.
+     * @param resolver  Translates the new addresses in the background.
      */
-    CTraceLogger(int socket, CTraceData *data);
+    CTraceLogger(int socket, CTraceData *data, CAddressResolver *resolver);
     CTraceLogger(const CTraceLogger &obj);
     ~CTraceLogger();
 
@@ -64,6 +68,34 @@ private:
      */
     void handleTestMessage();
 
+    /**
+     * @brief Maps the shared memory of the instrumented process and
+     *        acknowledges it through the socket.
+     */
+    void handleSharedMemoryMessage();
+
+    /**
+     * @brief Maps the shared memory, m_shm stays null if it is not a valid instrument shared memory.
+     * @param name  The name of the shared memory object.
+     */
+    void openSharedMemory(const char *name);
+
+    /**
+     * @brief Unmaps the shared memory.
+     */
+    void closeSharedMemory();
+
+    /**
+     * @brief Processes the events written into the rings of the shared memory.
+     * @return The number of processed events.
+     */
+    IndexType drainRings();
+
+    /**
+     * @brief Waits for the next socket message while draining the rings.
+     */
+    void waitForMessage();
+
     /**
      * @brief Handles the function enter message.
      */
@@ -75,20 +107,33 @@ private:
     void handleFunctionExitMessage();
 
     /**
-     * @brief Reads the information of a function message from the socket and
-     *        returns the name of the function.
-     * @return The name of the function.
+     * @brief Reads from the socket through the read buffer of the connection.
+     * @param data  The destination.
+     * @param size  Number of bytes to read.
+     * @return Number of bytes read, or the result of read() if nothing was read.
      */
-    String handleFunctionMessage();
+    ssize_t readSocket(void *data, size_t size);
 
     /**
-     * @brief Translates the addres to a function name.
-     * @param binaryPath  The path of the binary which contains the function
-     *                   at address.
+     * @brief Reads the information of a function message from the socket.
+     * @param binaryPath  The path of the binary which contains the function.
      * @param address  The address of the function.
-     * @return The name of the function.
+     * @return False if the message can not be read.
+     */
+    bool readFunctionMessage(String &binaryPath, int &address);
+
+    /**
+     * @brief Collects the function covered by the actual test. The unknown
+     *        addresses are passed to the address resolver.
+     * @param binaryPath  The path of the binary which contains the function.
+     * @param address  The address of the function.
+     */
+    void coverFunction(const String &binaryPath, const int address);
+
+    /**
+     * @brief Merges the functions covered by the actual test into the trace data.
      */
-    String translateAddressToFunction(const String &binaryPath, const int address);
+    void flushCoverage();
 
 private:
     /**
@@ -106,6 +151,39 @@ private:
      */
     CTraceData *m_data;
 
+    /**
+     * @brief Translates the addresses to function names.
+     */
+    CAddressResolver *m_resolver;
+
+    /**
+     * @brief The functions covered by the actual test since the last merge.
+     */
+    std::set<String> m_coverage;
+
+    /**
+     * @brief Size of the read buffer of the socket.
+     */
+    static const size_t READ_BUFFER_SIZE = 65536;
+
+    /**
+     * @brief Buffers the socket, so the small message fields do not need separate system calls.
+     */
+    std::vector<char> m_readBuffer;
+    size_t m_readPos;
+    size_t m_readEnd;
+
+    /**
+     * @brief The shared memory of the instrumented process or NULL if the
+     *        events come through the socket.
+     */
+    instrument_shm_t *m_shm;
+
+    /**
+     * @brief The paths of the binaries registered in the shared memory.
+     */
+    StringVector m_modules;
+
     /**
      * @brief Types of the messages.
      */
@@ -113,7 +191,8 @@ private:
         INSTRUMENT_TEST_MSG = 1,
         INSTRUMENT_FUNCTION_ENTER_MSG,
         INSTRUMENT_FUNCTION_EXIT_MSG,
-        INSTRUMENT_CLOSE_MSG
+        INSTRUMENT_CLOSE_MSG,
+        INSTRUMENT_SHM_MSG
     };
 };
 
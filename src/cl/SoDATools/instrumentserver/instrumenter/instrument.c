@@ -30,6 +30,11 @@
   *       variable is set.
   *       You have to define the actual test inside the TEST_NAME environmental
   *       variable.
+  *       Only the first call of every function is reported. The events are
+  *       written into per-thread ring buffers in a shared memory which is
+  *       drained by the server. If the server does not accept the shared
+  *       memory or a ring stays full, the events are sent through the socket.
+  *       Link with -ldl (and -lrt on older glibc).
   */
 
 #ifndef _GNU_SOURCE
@@ -42,15 +47,34 @@
 #include <stdint.h>
 #include <string.h>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unistd.h>
 
+#include "instrument_ring.h"
+
 #define INSTRUMENT_TEST_MSG           1
 #define INSTRUMENT_FUNCTION_ENTER_MSG 2
 #define INSTRUMENT_FUNCTION_EXIT_MSG  3
 #define INSTRUMENT_CLOSE_MSG          4
+#define INSTRUMENT_SHM_MSG            5
+
+/* Size of the set of the already reported addresses, must be a power of two. */
+#define INSTRUMENT_SEEN_SIZE          (1 << 16)
+/* Number of the probed slots before an address is reported again. */
+#define INSTRUMENT_SEEN_PROBES        64
+/* Time to wait for the server to map the shared memory. */
+#define INSTRUMENT_ACK_TIMEOUT_MS     1000
+/* Size of the buffer of a function message written at once. */
+#define INSTRUMENT_MESSAGE_SIZE       4096
+/* Number of yields while the ring is full before the event is sent through the socket. */
+#define INSTRUMENT_MAX_SPINS          (1 << 20)
 
 #ifdef __cplusplus
 extern "C" {
@@ -66,16 +90,41 @@ void __cyg_profile_func_exit(void *, void *) __attribute__ ((no_instrument_funct
 void send_test_message(char *test) __attribute__ ((no_instrument_function));
 void send_close_message() __attribute__ ((no_instrument_function));
 void send_func_message(char type, const char * binaryPath, int *address) __attribute__ ((no_instrument_function));
+int open_shared_memory() __attribute__ ((no_instrument_function));
+int first_hit(void *func) __attribute__ ((no_instrument_function));
+int find_module(Dl_info *info) __attribute__ ((no_instrument_function));
+int push_event(uint32_t module, uint64_t address) __attribute__ ((no_instrument_function));
+void prepare_fork(void) __attribute__ ((no_instrument_function));
+void parent_after_fork(void) __attribute__ ((no_instrument_function));
+void child_after_fork(void) __attribute__ ((no_instrument_function));
 
 #ifdef __cplusplus
 }
 #endif
 
 pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t module_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t shared_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 const char* const socketName = "/tmp/instrument-server";
 int socket_fd = -1;
 
+/* Set when the session is open, the hooks return immediately otherwise. */
+volatile int instrument_enabled = 0;
+/* Set in a forked child, which sends its events through the socket of the parent and does not close the session. */
+int instrument_forked = 0;
+/* Prevents reporting the functions called by the hooks. */
+__thread int in_hook = 0;
+
+instrument_shm_t *shm = NULL;
+__thread instrument_ring_t *thread_ring = NULL;
+/* Base addresses of the registered binaries, guarded by module_mutex. */
+uintptr_t module_bases[INSTRUMENT_MAX_MODULES];
+uint32_t num_of_modules = 0;
+
+/* Set of the reported function addresses. Zero marks an empty slot. */
+uintptr_t seen[INSTRUMENT_SEEN_SIZE];
+
 /**
  * @brief Sends the actual test name to the instrument server.
  * @param test The name of the test.
@@ -101,6 +150,7 @@ void send_close_message()
         char type = INSTRUMENT_CLOSE_MSG;
         write(socket_fd, &type, sizeof(type));
         close(socket_fd);
+        socket_fd = -1;
     }
 }
 
@@ -114,6 +164,17 @@ void send_func_message(char type, const char * binaryPath, int *address)
 {
     if (socket_fd != -1) {
         size_t len = strlen(binaryPath) + 1;
+        char message[INSTRUMENT_MESSAGE_SIZE];
+        size_t size = sizeof(type) + sizeof(len) + len + sizeof(int);
+        if (size <= sizeof(message)) {
+            /* A single write, so the messages of a forked child and its parent are not interleaved. */
+            memcpy(message, &type, sizeof(type));
+            memcpy(message + sizeof(type), &len, sizeof(len));
+            memcpy(message + sizeof(type) + sizeof(len), binaryPath, len);
+            memcpy(message + sizeof(type) + sizeof(len) + len, &address, sizeof(int));
+            write(socket_fd, message, size);
+            return;
+        }
         write(socket_fd, &type, sizeof(type));
         write(socket_fd, &len, sizeof(len));
         write(socket_fd, binaryPath, len);
@@ -121,6 +182,194 @@ void send_func_message(char type, const char * binaryPath, int *address)
     }
 }
 
+/**
+ * @brief Creates the shared memory, sends its name to the instrument server
+ *        and waits until the server maps it.
+ * @return Non-zero if the events can be written into the shared memory.
+ */
+int open_shared_memory()
+{
+    char name[INSTRUMENT_SHM_NAME];
+    snprintf(name, sizeof(name), "/soda-instrument-%d-%ld", (int)getpid(), (long)time(NULL));
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return 0;
+    }
+    if (ftruncate(fd, sizeof(instrument_shm_t)) < 0) {
+        close(fd);
+        shm_unlink(name);
+        return 0;
+    }
+    void *memory = mmap(NULL, sizeof(instrument_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name);
+        return 0;
+    }
+    shm = (instrument_shm_t *)memory;
+    shm->magic = INSTRUMENT_SHM_MAGIC;
+    shm->version = INSTRUMENT_SHM_VERSION;
+
+    char type = INSTRUMENT_SHM_MSG;
+    size_t len = strlen(name) + 1;
+    write(socket_fd, &type, sizeof(type));
+    write(socket_fd, &len, sizeof(len));
+    write(socket_fd, name, len);
+
+    /* The server answers with a single byte, older servers do not answer at all. */
+    char ack = 0;
+    struct pollfd pfd;
+    pfd.fd = socket_fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, INSTRUMENT_ACK_TIMEOUT_MS) <= 0 || read(socket_fd, &ack, sizeof(ack)) != sizeof(ack)) {
+        ack = 0;
+    }
+    shm_unlink(name);
+
+    if (ack != 1) {
+        munmap(shm, sizeof(instrument_shm_t));
+        shm = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Inserts the address into the set of the reported functions.
+ * @param func The address of the function.
+ * @return Non-zero if the function was not reported before.
+ */
+int first_hit(void *func)
+{
+    uintptr_t key = (uintptr_t) func;
+    uint64_t hash = ((uint64_t) key * 0x9E3779B97F4A7C15ULL) >> 32;
+    int i;
+    for (i = 0; i < INSTRUMENT_SEEN_PROBES; i++) {
+        uintptr_t *slot = &seen[(hash + i) & (INSTRUMENT_SEEN_SIZE - 1)];
+        uintptr_t value = __atomic_load_n(slot, __ATOMIC_RELAXED);
+        if (value == key) {
+            return 0;
+        }
+        if (value == 0) {
+            if (__atomic_compare_exchange_n(slot, &value, key, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                return 1;
+            }
+            if (value == key) {
+                return 0;
+            }
+        }
+    }
+    /* The neighbourhood is full, the server ignores the repeated events. */
+    return 1;
+}
+
+/**
+ * @brief Returns the index of the binary in the module table of the shared
+ *        memory and registers it if necessary.
+ * @param info The result of dladdr.
+ * @return The index of the binary or INSTRUMENT_MAX_MODULES if the table is full.
+ */
+int find_module(Dl_info *info)
+{
+    uint32_t i;
+    int module = INSTRUMENT_MAX_MODULES;
+    pthread_mutex_lock(&module_mutex);
+    for (i = 0; i < num_of_modules; i++) {
+        if (module_bases[i] == (uintptr_t) info->dli_fbase) {
+            module = i;
+            break;
+        }
+    }
+    if (module == INSTRUMENT_MAX_MODULES && num_of_modules < INSTRUMENT_MAX_MODULES
+            && strlen(info->dli_fname) < INSTRUMENT_MODULE_PATH) {
+        module = num_of_modules++;
+        module_bases[module] = (uintptr_t) info->dli_fbase;
+        strcpy(shm->modules[module], info->dli_fname);
+        /* Publish the path before the server can see an event referring to it. */
+        __atomic_store_n(&shm->numOfModules, num_of_modules, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&module_mutex);
+    return module;
+}
+
+/**
+ * @brief Writes an event into the ring of the current thread.
+ * @param module The index of the binary.
+ * @param address The address of the function.
+ * @return Non-zero if the event is written, zero if the ring stayed full.
+ */
+int push_event(uint32_t module, uint64_t address)
+{
+    instrument_ring_t *ring = thread_ring;
+    if (ring == NULL) {
+        uint32_t index = __atomic_fetch_add(&shm->numOfRings, 1, __ATOMIC_RELAXED) + 1;
+        ring = thread_ring = &shm->rings[index < INSTRUMENT_MAX_RINGS ? index : 0];
+    }
+
+    int shared = (ring == &shm->rings[0]);
+    if (shared) {
+        pthread_mutex_lock(&shared_ring_mutex);
+    }
+
+    long spins = 0;
+    while (!instrument_ring_push(ring, module, address)) {
+        if (++spins > INSTRUMENT_MAX_SPINS) {
+            /* The server does not drain the ring, the caller sends the event through the socket. */
+            if (shared) {
+                pthread_mutex_unlock(&shared_ring_mutex);
+            }
+            __atomic_fetch_add(&shm->numOfOverflowedEvents, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+        sched_yield();
+    }
+
+    if (shared) {
+        pthread_mutex_unlock(&shared_ring_mutex);
+    }
+    return 1;
+}
+
+/**
+ * @brief Locks the mutexes before fork, so the child does not inherit them locked by another thread.
+ */
+void prepare_fork(void)
+{
+    pthread_mutex_lock(&log_mutex);
+    pthread_mutex_lock(&module_mutex);
+    pthread_mutex_lock(&shared_ring_mutex);
+}
+
+/**
+ * @brief Unlocks the mutexes in the parent after fork.
+ */
+void parent_after_fork(void)
+{
+    pthread_mutex_unlock(&shared_ring_mutex);
+    pthread_mutex_unlock(&module_mutex);
+    pthread_mutex_unlock(&log_mutex);
+}
+
+/**
+ * @brief Detaches the child from the shared memory after fork. The rings are
+ *        single-producer, so the child must not write into the rings of the
+ *        parent, its events are sent through the socket instead.
+ */
+void child_after_fork(void)
+{
+    pthread_mutex_unlock(&shared_ring_mutex);
+    pthread_mutex_unlock(&module_mutex);
+    pthread_mutex_unlock(&log_mutex);
+
+    instrument_forked = 1;
+    thread_ring = NULL;
+    if (shm != NULL) {
+        munmap(shm, sizeof(instrument_shm_t));
+        shm = NULL;
+    }
+}
+
 /**
  * @brief Runs when the program starts and ff the INSTRUMENT environmental
  *        variable is available.
@@ -130,10 +379,6 @@ void send_func_message(char type, const char * binaryPath, int *address)
 void main_constructor(void)
 {
     if (getenv("INSTRUMENT") != NULL) {
-        /* Open instrument file */
-        pthread_mutex_lock(&log_mutex);
-        unsetenv("INSTRUMENT");
-
         char *test = getenv("TEST_NAME");
         if (test == NULL) {
             fprintf(stderr, "Test is NULL!!\n");
@@ -143,8 +388,9 @@ void main_constructor(void)
         struct sockaddr_un name;
         /* Create the socket. */
         socket_fd = socket (PF_LOCAL, SOCK_STREAM, 0);
-        if (socket < 0) {
+        if (socket_fd < 0) {
             fprintf(stderr, "Can not create socket.\n");
+            socket_fd = -1;
             return;
         }
         /* Store the server’s name in the socket address. */
@@ -154,13 +400,15 @@ void main_constructor(void)
         int result = connect (socket_fd, (struct sockaddr*)&name, SUN_LEN(&name));
         if (result < 0) {
             fprintf(stderr, "Can not connect to server.\n");
+            close(socket_fd);
             socket_fd = -1;
             return;
         }
         send_test_message(test);
+        open_shared_memory();
+        pthread_atfork(prepare_fork, parent_after_fork, child_after_fork);
 
-        setenv("INSTRUMENT", "1", 1);
-        pthread_mutex_unlock(&log_mutex);
+        instrument_enabled = 1;
     }
 }
 
@@ -170,63 +418,59 @@ void main_constructor(void)
  */
 void main_destructor(void)
 {
-    if (getenv("INSTRUMENT") != NULL) {
-        // Close file and clear test name.
-        pthread_mutex_lock(&log_mutex);
-        unsetenv("INSTRUMENT");
-
-        send_close_message();
+    if (instrument_enabled) {
+        instrument_enabled = 0;
 
-        setenv("INSTRUMENT", "1", 1);
+        // Close the session, the server drains the rings before closing.
+        // The session belongs to the parent, a forked child only closes its copy of the socket.
+        pthread_mutex_lock(&log_mutex);
+        if (instrument_forked) {
+            close(socket_fd);
+            socket_fd = -1;
+        } else {
+            send_close_message();
+        }
         pthread_mutex_unlock(&log_mutex);
     }
 }
 
 /**
- * @brief Runs before every function call. Sends the details of the actual
+ * @brief Runs before every function call. Reports the first call of the
  *        function to the instrument server.
  * @param func The address of the function.
  * @param callsite The address from the function was called.
  */
 void __cyg_profile_func_enter(void *func, void *callsite)
 {
-    if (getenv("INSTRUMENT") != NULL) {
-        pthread_mutex_lock(&log_mutex);
-        unsetenv("INSTRUMENT");
+    if (!instrument_enabled || in_hook) {
+        return;
+    }
+    in_hook = 1;
+    if (first_hit(func)) {
         Dl_info info;
         if (dladdr(func, &info)) {
+            uint64_t address = (uint64_t) func;
             if (strstr(info.dli_fname, ".so")) {
-                send_func_message(INSTRUMENT_FUNCTION_ENTER_MSG, info.dli_fname, (int *)((uint64_t) func - (uint64_t) info.dli_fbase));
-            } else {
-                send_func_message(INSTRUMENT_FUNCTION_ENTER_MSG, info.dli_fname, (int *)func);
+                address = (uint64_t) func - (uint64_t) info.dli_fbase;
+            }
+            int module = shm != NULL ? find_module(&info) : INSTRUMENT_MAX_MODULES;
+            /* The function is already marked as reported, so an event which does not fit into the ring is sent through the socket. */
+            if (module >= INSTRUMENT_MAX_MODULES || !push_event(module, address)) {
+                pthread_mutex_lock(&log_mutex);
+                send_func_message(INSTRUMENT_FUNCTION_ENTER_MSG, info.dli_fname, (int *)address);
+                pthread_mutex_unlock(&log_mutex);
             }
         }
-        setenv("INSTRUMENT", "1", 1);
-        pthread_mutex_unlock(&log_mutex);
     }
-	
+    in_hook = 0;
 }
 
 /**
- * @brief Runs after every function call. Sends the details of the actual
- *        function to the instrument server.
+ * @brief Runs after every function call. The server does not use the exit
+ *        events, so nothing is sent.
  * @param func The address of the function.
  * @param callsite The address from the function was called.
  */
 void __cyg_profile_func_exit(void *func, void *callsite)
 {
-    if (getenv("INSTRUMENT") != NULL) {
-        pthread_mutex_lock(&log_mutex);
-        unsetenv("INSTRUMENT");
-        Dl_info info;
-        if (dladdr(func, &info)) {
-            if (strstr(info.dli_fname, ".so")) {
-                send_func_message(INSTRUMENT_FUNCTION_EXIT_MSG, info.dli_fname, (int *)((uint64_t) func - (uint64_t) info.dli_fbase));
-            } else {
-                send_func_message(INSTRUMENT_FUNCTION_EXIT_MSG, info.dli_fname, (int *)func);
-            }
-        }
-        setenv("INSTRUMENT", "1", 1);
-        pthread_mutex_unlock(&log_mutex);
-    }
 }
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+  * @file This file contains the layout of the shared memory used by the
+  *       instrumented programs and the instrument server.
+  *       Every thread of the instrumented program writes the function
+  *       addresses into its own single-producer single-consumer ring buffer
+  *       and the instrument server drains the rings in batches.
+  *       The name of the shared memory object is sent through the socket
+  *       with an INSTRUMENT_SHM_MSG message.
+  */
+
+#ifndef INSTRUMENT_RING_H
+#define INSTRUMENT_RING_H
+
+#include <stdint.h>
+
+#define INSTRUMENT_SHM_MAGIC      0x52446f53
+#define INSTRUMENT_SHM_VERSION    2
+
+/* Number of the rings. The first ring is shared by the threads which do not get an own ring. */
+#define INSTRUMENT_MAX_RINGS      64
+/* Number of events in a ring, must be a power of two. */
+#define INSTRUMENT_RING_CAPACITY  4096
+/* Number of the binaries which can be registered. */
+#define INSTRUMENT_MAX_MODULES    256
+#define INSTRUMENT_MODULE_PATH    512
+/* Maximal length of the name of the shared memory object. */
+#define INSTRUMENT_SHM_NAME       64
+
+/**
+ * @brief A function enter event.
+ */
+typedef struct {
+    /* Offset of the function in the shared object or its address in the executable. */
+    uint64_t address;
+    /* Index of the binary in the module table. */
+    uint32_t module;
+    uint32_t reserved;
+} instrument_event_t;
+
+/**
+ * @brief A ring buffer. The head is written only by the producer thread and
+ *        the tail is written only by the instrument server. They are in
+ *        separate cache lines.
+ */
+typedef struct {
+    volatile uint64_t head;
+    char padding1[56];
+    volatile uint64_t tail;
+    char padding2[56];
+    instrument_event_t events[INSTRUMENT_RING_CAPACITY];
+} instrument_ring_t;
+
+/**
+ * @brief The shared memory of an instrumented process.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    /* Number of the rings claimed by the threads. */
+    volatile uint32_t numOfRings;
+    /* Number of the registered binaries. The paths are written before the counter is increased. */
+    volatile uint32_t numOfModules;
+    /* Number of the events which were sent through the socket because their ring was full. */
+    volatile uint32_t numOfOverflowedEvents;
+    uint32_t reserved;
+    char modules[INSTRUMENT_MAX_MODULES][INSTRUMENT_MODULE_PATH];
+    instrument_ring_t rings[INSTRUMENT_MAX_RINGS];
+} instrument_shm_t;
+
+/* The ring functions must not be reported when the instrumented program is built with -finstrument-functions. */
+#define INSTRUMENT_RING_INLINE static inline __attribute__ ((no_instrument_function))
+
+/**
+ * @brief Writes an event into the ring. Only the producer of the ring may call it.
+ * @return Non-zero if the event is written, zero if the ring is full.
+ */
+INSTRUMENT_RING_INLINE int instrument_ring_push(instrument_ring_t *ring, uint32_t module, uint64_t address)
+{
+    uint64_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= INSTRUMENT_RING_CAPACITY) {
+        return 0;
+    }
+    instrument_event_t *event = &ring->events[head & (INSTRUMENT_RING_CAPACITY - 1)];
+    event->address = address;
+    event->module = module;
+    /* Publish the event after it is written. */
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ * @brief Returns the number of the events which can be read. Only the consumer of the ring may call it.
+ */
+INSTRUMENT_RING_INLINE uint64_t instrument_ring_available(const instrument_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - ring->tail;
+}
+
+/**
+ * @brief Returns the index-th unread event. Only the consumer of the ring may call it.
+ */
+INSTRUMENT_RING_INLINE const instrument_event_t *instrument_ring_peek(const instrument_ring_t *ring, uint64_t index)
+{
+    return &ring->events[(ring->tail + index) & (INSTRUMENT_RING_CAPACITY - 1)];
+}
+
+/**
+ * @brief Releases the first count unread events to the producer. Only the consumer of the ring may call it.
+ */
+INSTRUMENT_RING_INLINE void instrument_ring_release(instrument_ring_t *ring, uint64_t count)
+{
+    __atomic_store_n(&ring->tail, ring->tail + count, __ATOMIC_RELEASE);
+}
+
+#endif /* INSTRUMENT_RING_H */
@@ -38,9 +38,11 @@
 #include <unistd.h>
 #include <vector>
 
+#include "boost/bind.hpp"
 #include "boost/program_options.hpp"
 #include "boost/thread.hpp"
 
+#include "CAddressResolver.h"
 #include "CTraceData.h"
 #include "CTraceLogger.h"
 
@@ -54,10 +56,12 @@ std::string socketName;
 std::vector<int> sockets;
 std::vector<boost::thread *> threads;
 CTraceData *data;
+CAddressResolver *resolver;
 int serverSocket;
 String coverageFilePath;
 String baseDir;
 String codeElementPath;
+String symbolCacheDir;
 bool dumpCodeElements = false;
 
 /**
@@ -97,6 +101,10 @@ void signalHandler(int signal)
     std::cerr << std::endl;
     threads.clear();
 
+    // Wait for the addresses still being translated.
+    resolver->flush();
+    delete resolver;
+
     for (std::vector<int>::iterator it = sockets.begin(); it != sockets.end(); it++) {
         close(*it);
     }
@@ -155,6 +163,9 @@ int processArgs(int ac, char *av[])
         codeElementPath = vm["dump-code-elements"].as<String>();
     }
     socketName = vm["socket-file"].as<String>();
+    if (vm.count("symbol-cache")) {
+        symbolCacheDir = vm["symbol-cache"].as<String>();
+    }
 
     // Create signal handler.
     struct sigaction sigIntHandler;
@@ -169,9 +180,10 @@ int processArgs(int ac, char *av[])
     startServer();
     std::cout << "Server started. Press CTRL+c to save results and finish execution." << std::endl;
     data = new CTraceData(coverageFilePath, baseDir);
+    resolver = new CAddressResolver(baseDir, symbolCacheDir, boost::bind(&CTraceData::addResolvedFunction, data, _1, _2, _3, _4));
     do {
         struct sockaddr_un clientName;
-        socklen_t clientNameLength;
+        socklen_t clientNameLength = sizeof(clientName);
 
         /* Accept a connection. */
         int clientSocket = accept(serverSocket, (struct sockaddr*)&clientName, &clientNameLength);
@@ -180,7 +192,7 @@ int processArgs(int ac, char *av[])
             continue;
 
         /* Handle the connection. */
-        CTraceLogger logger = CTraceLogger(clientSocket, data);
+        CTraceLogger logger = CTraceLogger(clientSocket, data, resolver);
         // Start a thread.
         boost::thread *thread = new boost::thread(logger);
         // Save it for later use.
@@ -202,6 +214,7 @@ int main(int argc, char *argv[])
             ("coverage-data,c", po::value<String>(), "output file containing the coverage matrix")
             ("socket-file,s", po::value<String>()->default_value("/tmp/instrument-server"), "the temporary file that can be used for communication")
             ("dump-code-elements", po::value<String>(), "output file containing the code elements and their location")
+            ("symbol-cache", po::value<String>(), "private directory of the cached function names of the binaries, it is created with 0700 permissions (the cache is disabled by default)")
     ;
 
     if (argc < 2) {
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+  * @file Synthetic load generator for the instrument server.
+  *       Starts several processes which connect to the server in parallel and
+  *       send function enter messages of the functions of this binary through
+  *       the socket protocol. Prints the number of messages sent per second.
+  *       Compile with -no-pie -g so the server can resolve the addresses:
+  *         gcc -no-pie -g -o load-generator load-generator.c -ldl
+  *       Usage: load-generator <processes> <tests per process> <messages per test> [socket]
+  */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INSTRUMENT_TEST_MSG           1
+#define INSTRUMENT_FUNCTION_ENTER_MSG 2
+#define INSTRUMENT_CLOSE_MSG          4
+
+#define FUNCTION(N) void function##N(void) { }
+#define FUNCTIONS8(N) FUNCTION(N##0) FUNCTION(N##1) FUNCTION(N##2) FUNCTION(N##3) \
+                      FUNCTION(N##4) FUNCTION(N##5) FUNCTION(N##6) FUNCTION(N##7)
+FUNCTIONS8(1) FUNCTIONS8(2) FUNCTIONS8(3) FUNCTIONS8(4)
+FUNCTIONS8(5) FUNCTIONS8(6) FUNCTIONS8(7) FUNCTIONS8(8)
+
+#define REF8(N) function##N##0, function##N##1, function##N##2, function##N##3, \
+                function##N##4, function##N##5, function##N##6, function##N##7
+void (*functions[])(void) = { REF8(1), REF8(2), REF8(3), REF8(4), REF8(5), REF8(6), REF8(7), REF8(8) };
+#define NUM_OF_FUNCTIONS (sizeof(functions) / sizeof(functions[0]))
+
+/**
+ * @brief Writes the whole buffer into the socket.
+ */
+static void write_all(int fd, const void *data, size_t size)
+{
+    const char *p = (const char *)data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) {
+            perror("write");
+            exit(1);
+        }
+        p += n;
+        size -= n;
+    }
+}
+
+/**
+ * @brief Runs the tests of one process.
+ */
+static void run_tests(int process, int tests, int messages, const char *socketName)
+{
+    int t, m;
+    for (t = 0; t < tests; t++) {
+        struct sockaddr_un name;
+        int fd = socket(PF_LOCAL, SOCK_STREAM, 0);
+        name.sun_family = AF_LOCAL;
+        strcpy(name.sun_path, socketName);
+        if (fd < 0 || connect(fd, (struct sockaddr*)&name, SUN_LEN(&name)) < 0) {
+            perror("connect");
+            exit(1);
+        }
+
+        char test[64];
+        char type = INSTRUMENT_TEST_MSG;
+        size_t len;
+        snprintf(test, sizeof(test), "load-test-%d-%d", process, t);
+        len = strlen(test) + 1;
+        write_all(fd, &type, sizeof(type));
+        write_all(fd, &len, sizeof(len));
+        write_all(fd, test, len);
+
+        for (m = 0; m < messages; m++) {
+            void *func = (void *)functions[(m * 7 + t) % NUM_OF_FUNCTIONS];
+            Dl_info info;
+            if (!dladdr(func, &info)) {
+                continue;
+            }
+            int address = (int)(uint64_t)func;
+            if (strstr(info.dli_fname, ".so")) {
+                address = (int)((uint64_t)func - (uint64_t)info.dli_fbase);
+            }
+            type = INSTRUMENT_FUNCTION_ENTER_MSG;
+            len = strlen(info.dli_fname) + 1;
+            write_all(fd, &type, sizeof(type));
+            write_all(fd, &len, sizeof(len));
+            write_all(fd, info.dli_fname, len);
+            write_all(fd, &address, sizeof(address));
+        }
+
+        type = INSTRUMENT_CLOSE_MSG;
+        write_all(fd, &type, sizeof(type));
+        close(fd);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s <processes> <tests per process> <messages per test> [socket]\n", argv[0]);
+        return 1;
+    }
+    int processes = atoi(argv[1]);
+    int tests = atoi(argv[2]);
+    int messages = atoi(argv[3]);
+    const char *socketName = argc > 4 ? argv[4] : "/tmp/instrument-server";
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int p;
+    for (p = 0; p < processes; p++) {
+        if (fork() == 0) {
+            run_tests(p, tests, messages, socketName);
+            _exit(0);
+        }
+    }
+    int status, failed = 0;
+    while (wait(&status) > 0) {
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    double total = (double)processes * tests * messages;
+    printf("%d process(es), %.0f message(s) in %.3f s: %.0f messages/s\n", processes, total, seconds, total / seconds);
+    return failed ? 1 : 0;
+}
@@ -39,6 +39,7 @@ using namespace soda;
 po::options_description desc("Allowed options");
 CKernel kernel;
 CSelectionData selectionData;
+unsigned int numOfThreads = 1;
 
 void printPluginNames(const String &type, const std::vector<String> &plugins)
 {
@@ -83,7 +84,7 @@ double coverage(IntVector &testIds)
 double partitionMetric(CClusterDefinition &cluster)
 {
     CPartitionAlgorithm algorithm;
-    algorithm.compute(selectionData, cluster);
+    algorithm.compute(selectionData, cluster, numOfThreads);
 
     CPartitionAlgorithm::PartitionInfo &partitionInfo = algorithm.getPartitionInfo();
     CPartitionAlgorithm::PartitionData &partitions = algorithm.getPartitions();
@@ -147,6 +148,10 @@ int processArgs(options_description desc, int ac, char* av[])
     String pluginName = vm["plugin"].as<String>();
     ITestSuitePrioritizationPlugin *plugin;
     plugin = kernel.getTestSuitePrioritizationPluginManager().getPlugin(pluginName);
+    if (vm.count("jobs")) {
+        numOfThreads = vm["jobs"].as<unsigned int>();
+    }
+    plugin->setNumOfThreads(numOfThreads);
     plugin->init(&selectionData, &kernel);
 
     String mode = vm["mode"].as<String>();
@@ -259,6 +264,7 @@ int main(int argc, char *argv[])
         ("plugin,p", value<String>(), "Name of the prioritization plugin to use")
         ("list-prioritization-plugins,l", "Lists the prioritization plugins")
         ("mode,m", value<String>(), "Can be: size, max-coverage, max-partition")
+        ("jobs", value<unsigned int>(), "Number of threads used by the prioritization and the partition metric (0 means the number of hardware threads)")
         ;
 
     if (argc < 2) {
@@ -35,9 +35,11 @@
 #include <rapidjson/filewritestream.h>
 
 #include "data/CClusterDefinition.h"
+#include "data/CFLMetricTable.h"
 #include "data/CSelectionData.h"
 #include "engine/CKernel.h"
 #include "util/CTestSuiteScore.h"
+#include "util/CThreadPool.h"
 
 
 using namespace soda;
@@ -54,6 +56,7 @@ void createJsonFile();
 
 CKernel kernel;
 
+unsigned int numOfThreads = 1;
 IndexType revision;
 String projectName;
 String outputDir;
@@ -71,10 +74,15 @@ int main(int argc, char* argv[]) {
             ("help,h", "Prints help message")
             ("create-json-file,j", "Creates a sample json file")
             ("list-cluster-algorithms,c", "Lists the cluster algorithms")
-            ("list-fault-localization-techniques,f", "Lists the fault localization technique plugins");
+            ("list-fault-localization-techniques,f", "Lists the fault localization technique plugins")
+            ("jobs", value<unsigned int>(&numOfThreads), "Number of threads used to process the clusters (0 means the number of hardware threads)")
+            ("config", value<String>(), "Json configuration file or directory");
+
+    positional_options_description p;
+    p.add("config", 1);
 
     variables_map vm;
-    store(parse_command_line(argc, argv, desc), vm);
+    store(command_line_parser(argc, argv).options(desc).positional(p).run(), vm);
     notify(vm);
 
     if (argc < 2) {
@@ -103,7 +111,13 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
-    return loadJsonFiles(String(argv[1]));
+    if (!vm.count("config")) {
+        std::cerr << "[ERROR] Missing configuration file path." << std::endl;
+        return 1;
+    }
+
+    numOfThreads = CThreadPool(numOfThreads).getNumOfThreads();
+    return loadJsonFiles(vm["config"].as<String>());
 }
 
 void createJsonFile()
@@ -119,8 +133,8 @@ void printHelp()
               << std::endl << std::endl;
     std::cout << "USAGE:" << std::endl
               << "\ttest-suite-score [-h|c|f|j]" << std::endl
-              << "\ttest-suite-score json file path" << std::endl
-              << "\ttest-suite-score directory which contains one or more json files" << std::endl << std::endl;
+              << "\ttest-suite-score [--jobs N] json file path" << std::endl
+              << "\ttest-suite-score [--jobs N] directory which contains one or more json files" << std::endl << std::endl;
     std::cout << "Json configuration file format:" << std::endl
               << getJsonString();
 }
@@ -194,7 +208,7 @@ int loadJsonFiles(String path)
     return 0;
 }
 
-void calculateFlTechnique(CSelectionData &selectionData, const String &name, rapidjson::Document &results)
+void calculateFlTechnique(CSelectionData &selectionData, const String &name, FLMetricTables &results)
 {
     IFaultLocalizationTechniquePlugin *flTechnique = kernel.getFaultLocalizationTechniquePluginManager().getPlugin(name);
 
@@ -207,41 +221,35 @@ void calculateFlTechnique(CSelectionData &selectionData, const String &name, rap
 
     (std::cerr << "[INFO] Calculating fault localization values: " << flTechnique->getName() << " ...").flush();
     flTechnique->init(&selectionData, &clusterList, revision, IntVector());
+    flTechnique->setNumOfThreads(numOfThreads);
     flTechnique->calculate(results);
     flTechniquesCalculated.insert(name);
     (std::cerr << " done." << std::endl).flush();
 }
 
-void saveMutationMetrics(CSelectionData &selectionData, rapidjson::Document & results, StringVector &buggedCEs, bool full) {
-    std::stringstream sbflStream;
+void saveMutationMetrics(CSelectionData &selectionData, FLMetricTables &results, StringVector &buggedCEs, bool full) {
+    std::ofstream sbflStream(String(outputDir + "/" + projectName + "-sbfl.csv").c_str());
+    std::set<String> bugged(buggedCEs.begin(), buggedCEs.end());
 
     // header of the output file
     // TODO: Changeable header for statements
     sbflStream << "Function;";
-    for (rapidjson::Value::MemberIterator metricIt = results.MemberBegin()->value.MemberBegin()->value.MemberBegin(); metricIt != results.MemberBegin()->value.MemberBegin()->value.MemberEnd(); ++metricIt) {
-        sbflStream << metricIt->name.GetString() << ";";
+    if (!results.empty()) {
+        results.begin()->second.writeCsvHeader(sbflStream, ";");
     }
     // append bugged header if exists
     sbflStream << "Bugged;";
     sbflStream << std::endl;
 
     if (full) {
-        for (rapidjson::Value::MemberIterator ceIt = results["full"].MemberBegin(); ceIt != results["full"].MemberEnd(); ceIt++) {
-            auto ceName = selectionData.getCoverage()->getCodeElements().getValue(std::stoul(ceIt->name.GetString()));
-            sbflStream << ceName << ";";
-            for (rapidjson::Value::MemberIterator valueIt = ceIt->value.MemberBegin(); valueIt != ceIt->value.MemberEnd(); ++valueIt) {
-
-                if (valueIt->value.IsUint64()) {
-                    sbflStream << valueIt->value.GetUint64();
-                }
-                else if (valueIt->value.IsDouble()) {
-                    sbflStream << valueIt->value.GetDouble();
-                }
-                sbflStream << ";";
-
-            }
+        const CFLMetricTable &table = results["full"];
+        const IntVector &codeElements = table.getCodeElements();
 
-            sbflStream << (std::find(buggedCEs.begin(), buggedCEs.end(), ceName) != buggedCEs.end() ? "1" : "0");
+        for (IndexType row = 0; row < codeElements.size(); row++) {
+            String ceName = selectionData.getCoverage()->getCodeElements().getValue(codeElements[row]);
+            sbflStream << ceName << ";";
+            table.writeCsvRow(sbflStream, row, ";");
+            sbflStream << (bugged.count(ceName) ? "1" : "0");
             sbflStream << std::endl;
         }
     }
@@ -249,11 +257,7 @@ void saveMutationMetrics(CSelectionData &selectionData, rapidjson::Document & re
         // TODO: implement output generation for multiple clusters
     }
 
-    {
-        std::ofstream out(String(outputDir + "/" + projectName + "-sbfl.csv").c_str());
-        out << sbflStream.str();
-        out.close();
-    }
+    sbflStream.close();
 }
 
 void processJsonFiles(String path)
@@ -353,7 +357,7 @@ void processJsonFiles(String path)
 
         if (reader["filter-to-coverage"].GetBool()) {
             (std::cerr << "[INFO] Filtering to coverage ...").flush();
-            selectionData.filterToCoverage();
+            selectionData.filterToCoverage(numOfThreads);
             (std::cerr << " done" << std::endl).flush();
         }
 
@@ -399,8 +403,7 @@ void processJsonFiles(String path)
             fdScoreStream.close();
         }*/
 
-        rapidjson::Document results;
-        results.SetObject();
+        FLMetricTables results;
         for (auto flTechnique : faultLocalizationTechniques) {
             calculateFlTechnique(selectionData, flTechnique, results);
 
@@ -24,6 +24,7 @@
 
 #include "CComputeSelectionMetrics.h"
 #include "exception/CException.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
@@ -82,8 +83,13 @@ void CComputeSelectionMetrics::runMeasurementForOneSelectionSize(RevNumType rev,
     IntVector selectedTestcases;
     m_prioAlg->fillSelection(selectedTestcases, size);
 
+    IndexType nofWords = CBitOperations::numOfWords(m_data->getResults()->getNumOfTestcases());
+    std::vector<WordType> executed(nofWords, 0);
+    std::vector<WordType> passed(nofWords, 0);
+    m_data->getResults()->copyResults(rev, executed.data(), passed.data());
+
     pdata->nofSelected = selectedTestcases.size();
-    pdata->nofFailed = m_data->getResults()->getExecutionBitList(rev).count() - m_data->getResults()->getPassedBitList(rev).count();
+    pdata->nofFailed = CBitOperations::count(executed.data(), nofWords) - CBitOperations::count(passed.data(), nofWords);
     pdata->nofHit = 0;
 
     for (IntVector::iterator tcit = selectedTestcases.begin(); tcit != selectedTestcases.end(); tcit++) {
@@ -99,8 +105,9 @@ void CComputeSelectionMetrics::runMeasurementForOneSelectionSize(RevNumType rev,
             continue;
         }
 
-        if (m_data->getResults()->getExecutionBitList(rev)[tcid] &&
-                !(m_data->getResults()->getPassedBitList(rev)[tcid])) {
+        IndexType w = tcid / CBitOperations::BITS_PER_WORD;
+        WordType mask = WordType(1) << (tcid % CBitOperations::BITS_PER_WORD);
+        if ((executed[w] & ~passed[w]) & mask) {
             pdata->nofHit++;
         }
 
@@ -20,6 +20,7 @@
  */
 
 #include "CRevisionFilters.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
@@ -39,12 +40,12 @@ IntVector CRevisionFilters::filterNonChangedOrNonFailed(IntVector& allrevs, CSel
         bool keepFailed = keepEmptyFailed;
 
         if (!keepFailed) {
-            const IBitList& exec=data->getResults()->getExecutionBitList(*revit);
-            const IBitList& pass=data->getResults()->getPassedBitList(*revit);
-            IndexType tcs = exec.size();
-            IndexType tid;
-            for (tid = 0; tid < tcs; tid++) {
-                if (exec[tid] && !pass[tid]) {
+            IndexType nofWords = CBitOperations::numOfWords(data->getResults()->getNumOfTestcases());
+            std::vector<WordType> exec(nofWords, 0);
+            std::vector<WordType> pass(nofWords, 0);
+            data->getResults()->copyResults(*revit, exec.data(), pass.data());
+            for (IndexType w = 0; w < nofWords; w++) {
+                if (exec[w] & ~pass[w]) {
                     keepFailed = true; //There were failed TCs in the revision
                     break;
                 }
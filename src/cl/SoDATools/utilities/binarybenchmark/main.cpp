@@ -0,0 +1,193 @@
+/*
+ * Copyright (C): 2015 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+  * @file Main program of binary benchmark.
+  *       The binary benchmark measures the save and load throughput of bit matrices in the SoDA binary format.
+  */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "data/CBitMatrix.h"
+#include "exception/CException.h"
+#include "boost/program_options.hpp"
+
+using namespace std;
+using namespace soda;
+using namespace boost::program_options;
+
+#define INFO(X) cout << "[INFO] " << X << endl
+#define ERRO(X) cerr << "[*ERROR*] " << X << endl
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+ * @brief Saves the matrix bit by bit, as the generic IBitMatrix::save() does.
+ * @param matrix  The matrix.
+ * @param out  Output stream.
+ */
+void saveBitByBit(const CBitMatrix& matrix, io::CBinaryIO* out)
+{
+    IndexType rows = matrix.getNumOfRows();
+    IndexType cols = matrix.getNumOfCols();
+
+    out->writeUInt4(io::CSoDAio::BITMATRIX);
+    out->writeULongLong8(2 * sizeof(IndexType) + io::CBitWriter::predictSize(rows * cols));
+    out->writeULongLong8(rows);
+    out->writeULongLong8(cols);
+
+    io::CBitWriter bo(out);
+    for (IndexType i = 0; i < rows; ++i) {
+        for (IndexType j = 0; j < cols; ++j) {
+            bo.writeBit(matrix.get(i, j));
+        }
+    }
+    bo.flush();
+}
+
+/**
+ * @brief Loads the matrix bit by bit, as the generic IBitMatrix::load() does.
+ * @param matrix  The matrix.
+ * @param in  Input stream.
+ */
+void loadBitByBit(CBitMatrix& matrix, io::CBinaryIO* in)
+{
+    IndexType rows = in->readULongLong8();
+    IndexType cols = in->readULongLong8();
+    matrix.resize(rows, cols);
+
+    io::CBitReader bi(in);
+    for (IndexType i = 0; i < rows; ++i) {
+        for (IndexType j = 0; j < cols; ++j) {
+            matrix.set(i, j, bi.readBit());
+        }
+    }
+    bi.reset();
+}
+
+/**
+ * @brief Returns the throughput in MB/s.
+ * @param bytes  Number of bytes processed.
+ * @param start  Start time.
+ * @param end  End time.
+ * @return Throughput in MB/s.
+ */
+double throughput(unsigned long long bytes, Clock::time_point start, Clock::time_point end)
+{
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double> >(end - start).count();
+    return (seconds > 0) ? (bytes / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    cout << "binaryBenchmark (SoDA tool)" << endl;
+    options_description desc("Allowed options");
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("rows,r", value<IndexType>()->default_value(10000), "Number of rows of the matrix")
+        ("cols,c", value<IndexType>()->default_value(10003), "Number of columns of the matrix")
+        ("density,d", value<double>()->default_value(0.1), "Ratio of the 1 bits in the matrix")
+        ("path,p", value<String>()->default_value("binaryBenchmark.SoDA"), "The path of the temporary binary file")
+        ("bit-by-bit,b", "measure the bit by bit serialization too")
+        ;
+
+    try {
+        variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+
+        if (vm.count("help")) {
+            cout << desc << endl;
+            return 0;
+        }
+
+        IndexType rows = vm["rows"].as<IndexType>();
+        IndexType cols = vm["cols"].as<IndexType>();
+        double density = vm["density"].as<double>();
+        String path = vm["path"].as<String>();
+        unsigned long long bytes = io::CBitWriter::predictSize(rows * cols);
+
+        INFO("Generating " << rows << "x" << cols << " matrix (" << bytes << " bytes) ...");
+        CBitMatrix matrix(rows, cols);
+        srand(0);
+        for (IndexType i = 0; i < rows; ++i) {
+            for (IndexType j = 0; j < cols; ++j) {
+                if (rand() < density * RAND_MAX) {
+                    matrix.set(i, j, true);
+                }
+            }
+        }
+
+        Clock::time_point start = Clock::now();
+        io::CSoDAio* out = new io::CSoDAio(path, io::CBinaryIO::omWrite);
+        matrix.save(out);
+        delete out;
+        Clock::time_point end = Clock::now();
+        INFO("save: " << throughput(bytes, start, end) << " MB/s");
+
+        CBitMatrix loaded;
+        start = Clock::now();
+        io::CSoDAio* in = new io::CSoDAio(path, io::CBinaryIO::omRead);
+        if (in->findChunkID(io::CSoDAio::BITMATRIX)) {
+            loaded.load(in);
+        }
+        delete in;
+        end = Clock::now();
+        INFO("load: " << throughput(bytes, start, end) << " MB/s");
+
+        if (loaded != matrix) {
+            ERRO("The loaded matrix differs from the saved one!");
+            return 1;
+        }
+
+        if (vm.count("bit-by-bit")) {
+            start = Clock::now();
+            out = new io::CSoDAio(path, io::CBinaryIO::omWrite);
+            saveBitByBit(matrix, out);
+            delete out;
+            end = Clock::now();
+            INFO("bit by bit save: " << throughput(bytes, start, end) << " MB/s");
+
+            start = Clock::now();
+            in = new io::CSoDAio(path, io::CBinaryIO::omRead);
+            if (in->findChunkID(io::CSoDAio::BITMATRIX)) {
+                loadBitByBit(loaded, in);
+            }
+            delete in;
+            end = Clock::now();
+            INFO("bit by bit load: " << throughput(bytes, start, end) << " MB/s");
+
+            if (loaded != matrix) {
+                ERRO("The loaded matrix differs from the saved one!");
+                return 1;
+            }
+        }
+
+        remove(path.c_str());
+    } catch (std::exception& e) {
+        ERRO(e.what());
+        return 1;
+    }
+
+    return 0;
+}
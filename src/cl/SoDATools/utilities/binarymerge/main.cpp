@@ -26,8 +26,14 @@
   */
 
 #include <iostream>
+#include "data/CBitMatrix.h"
 #include "data/CCoverageMatrix.h"
+#include "data/CDeltaBitMatrix.h"
+#include "data/CIDManager.h"
 #include "data/CResultsMatrix.h"
+#include "io/CMappedSoDAio.h"
+#include "util/CBitOperations.h"
+#include "util/CThreadPool.h"
 #include "boost/program_options.hpp"
 
 using namespace std;
@@ -38,10 +44,15 @@ using namespace boost::program_options;
 #define WARN(X) cout << "[WARNING] " << X << endl
 #define ERRO(X) cerr << "[*ERROR*] " << X << endl
 
+// Index of the rows and columns which are not present in the merged matrix.
+const IndexType NOT_MAPPED = (IndexType)-1;
+
 StringVector coveragePaths;
 StringVector resultPaths;
 vector<CCoverageMatrix*> coverageMatrices;
 vector<CResultsMatrix*> resultsMatrices;
+vector<io::CMappedSoDAio*> mappedFiles;
+unsigned int numOfThreads = 1;
 
 template<class T>
 void loadMatrices(const StringVector& paths, vector<T*>& matrices)
@@ -49,15 +60,103 @@ void loadMatrices(const StringVector& paths, vector<T*>& matrices)
     matrices.resize(paths.size());
     for (size_t i = 0; i < paths.size(); ++i) {
         cout << "[INFO] Loading data from path: " << paths[i] << " ... ";
+        // The inputs are only read, so they are used directly from the mapped files.
+        io::CMappedSoDAio* in = new io::CMappedSoDAio(paths[i]);
+        mappedFiles.push_back(in);
         matrices[i] = new T();
-        matrices[i]->load(paths[i]);
+        matrices[i]->load(in);
         cout << "done." << endl;
     }
 }
 
-CCoverageMatrix* mergeCoverage()
+/**
+ * @brief Translates the IDs of the names of an input to the IDs of the merged names.
+ * @param local  Names of the input.
+ * @param merged  Merged names.
+ * @param size  Size of the input matrix in this dimension.
+ * @param map  Merged ID of each input index.
+ */
+void mapIndices(const IIDManager& local, const IIDManager& merged, IndexType size, IntVector& map)
+{
+    map.assign(size, NOT_MAPPED);
+    for (auto id : local.getIDs()) {
+        if (id < size) {
+            map[id] = merged.getID(local.getValue(id));
+        }
+    }
+}
+
+/**
+ * @brief Copies the rows of an input matrix into the merged matrix. The cells of the input overwrite
+ *        the cells set by the previous inputs, the other cells of the merged rows are kept.
+ *        The rows are processed in parallel and only the set bits of the input are visited.
+ * @param in  Input matrix.
+ * @param filter  If it is not null, the input rows are masked with its rows.
+ * @param rowMap  Merged index of each input row.
+ * @param colMap  Merged index of each input column.
+ * @param merged  The merged matrix.
+ * @param pool  The threads processing the rows.
+ */
+void mergeRows(const IBitMatrix& in, const IBitMatrix* filter, const IntVector& rowMap, const IntVector& colMap, CBitMatrix& merged, CThreadPool& pool)
+{
+    IndexType localWords = CBitOperations::numOfWords(in.getNumOfCols());
+    IndexType mergedWords = merged.getNumOfWordsPerRow();
+
+    // Columns of the merged matrix which are overwritten by this input.
+    vector<WordType> columns(mergedWords, 0);
+    bool identity = true;
+    for (IndexType j = 0; j < colMap.size(); ++j) {
+        if (colMap[j] == NOT_MAPPED) {
+            identity = false;
+            continue;
+        }
+        columns[colMap[j] / CBitOperations::BITS_PER_WORD] |= WordType(1) << (colMap[j] % CBitOperations::BITS_PER_WORD);
+        identity = identity && colMap[j] == j;
+    }
+
+    IndexType numOfChunks = std::min<IndexType>(pool.getNumOfThreads(), rowMap.size());
+    pool.run(numOfChunks, [&](IndexType chunk) {
+        vector<WordType> local(localWords);
+        vector<WordType> mask(localWords);
+        vector<WordType> row(mergedWords);
+        IndexType end = (chunk + 1) * rowMap.size() / numOfChunks;
+        for (IndexType i = chunk * rowMap.size() / numOfChunks; i < end; ++i) {
+            if (rowMap[i] == NOT_MAPPED) {
+                continue;
+            }
+            in.copyRowWords(i, local.data());
+            if (filter) {
+                filter->copyRowWords(i, mask.data());
+                CBitOperations::bitwiseAnd(local.data(), local.data(), mask.data(), localWords);
+            }
+            CBitOperations::bitwiseAndNot(row.data(), merged.getRowWords(rowMap[i]), columns.data(), mergedWords);
+            if (identity) {
+                // The input has the same column order, whole words are copied.
+                CBitOperations::bitwiseOr(row.data(), row.data(), local.data(), localWords);
+            } else {
+                for (IndexType w = 0; w < localWords; ++w) {
+                    for (WordType word = local[w]; word; word &= word - 1) {
+                        IndexType col = colMap[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word)];
+                        if (col != NOT_MAPPED) {
+                            row[col / CBitOperations::BITS_PER_WORD] |= WordType(1) << (col % CBitOperations::BITS_PER_WORD);
+                        }
+                    }
+                }
+            }
+            merged.setRowWords(rowMap[i], row.data());
+        }
+    });
+}
+
+/**
+ * @brief Merges the coverage matrices. If a relation is present in more inputs, the value of the last one is kept.
+ * @param testcases  Merged test case names.
+ * @param codeElements  Merged code element names.
+ * @param data  Merged relations.
+ * @param pool  The threads merging the rows.
+ */
+void mergeCoverage(CIDManager& testcases, CIDManager& codeElements, CBitMatrix& data, CThreadPool& pool)
 {
-    auto merged = new CCoverageMatrix();
     IndexType sum_ce = 0, sum_tc = 0;
     for (auto cov : coverageMatrices) {
         auto num_ce = cov->getNumOfCodeElements();
@@ -65,34 +164,42 @@ CCoverageMatrix* mergeCoverage()
         INFO("Merging " << num_ce << " code element(s) and " << num_tc << " testcase(s).");
         auto ces = cov->getCodeElements().getValueList();
         for (auto ce : ces) {
-            merged->addCodeElementName(ce);
+            if (!codeElements.containsValue(ce)) {
+                codeElements.add(ce);
+            }
         }
         auto tcs = cov->getTestcases().getValueList();
         for (auto tc : tcs) {
-            merged->addTestcaseName(tc);
+            if (!testcases.containsValue(tc)) {
+                testcases.add(tc);
+            }
         }
         sum_ce += num_ce;
         sum_tc += num_tc;
     }
-    merged->refitMatrixSize();
-    auto c = merged->getNumOfCodeElements();
-    auto t = merged->getNumOfTestcases();
+    data.resize(testcases.size(), codeElements.size());
+    auto c = codeElements.size();
+    auto t = testcases.size();
     INFO("Dimensions :: merged: " << c << "×" << t << " sum: " << sum_ce << "×" << sum_tc << " (code-elements×testcases).");
+    IntVector rowMap, colMap;
     for (auto cov : coverageMatrices) {
-        auto ces = cov->getCodeElements().getValueList();
-        auto tcs = cov->getTestcases().getValueList();
-        for (auto ce : ces) {
-            for (auto tc : tcs) {
-                merged->setRelation(tc, ce, cov->getRelation(tc, ce));
-            }
-        }
+        const IBitMatrix& bits = cov->getBitMatrix();
+        mapIndices(cov->getTestcases(), testcases, bits.getNumOfRows(), rowMap);
+        mapIndices(cov->getCodeElements(), codeElements, bits.getNumOfCols(), colMap);
+        mergeRows(bits, NULL, rowMap, colMap, data, pool);
     }
-    return merged;
 }
 
-CResultsMatrix* mergeResults()
+/**
+ * @brief Merges the results matrices. If a result is present in more inputs, the value of the last one is kept.
+ * @param testcases  Merged test case names.
+ * @param revisions  Merged revisions.
+ * @param exec  Merged execution bits.
+ * @param pass  Merged passed bits.
+ * @param pool  The threads merging the rows.
+ */
+void mergeResults(CIDManager& testcases, CRevision<IndexType>& revisions, CBitMatrix& exec, CBitMatrix& pass, CThreadPool& pool)
 {
-    auto merged = new CResultsMatrix();
     IndexType sum_rev = 0, sum_tc = 0;
     for (auto res : resultsMatrices) {
         auto num_rev = res->getNumOfRevisions();
@@ -100,29 +207,40 @@ CResultsMatrix* mergeResults()
         INFO("Merging " << num_rev << " revision(s) and " << num_tc << " testcase(s).");
         auto revs = res->getRevisionNumbers();
         for (auto rev : revs) {
-            merged->addRevisionNumber(rev);
+            if (!revisions.revisionExists(rev)) {
+                IndexType index = revisions.size();
+                revisions.addRevision(rev, index);
+            }
         }
         auto tcs = res->getTestcases().getValueList();
         for (auto tc : tcs) {
-            merged->addTestcaseName(tc);
+            if (!testcases.containsValue(tc)) {
+                testcases.add(tc);
+            }
         }
         sum_rev += num_rev;
         sum_tc += num_tc;
     }
-    merged->refitMatrixSize();
-    auto r = merged->getNumOfRevisions();
-    auto t = merged->getNumOfTestcases();
+    exec.resize(revisions.size(), testcases.size());
+    pass.resize(revisions.size(), testcases.size());
+    auto r = revisions.size();
+    auto t = testcases.size();
     INFO("Dimensions :: merged: " << r << "×" << t << " sum: " << sum_rev << "×" << sum_tc << " (revisions×testcases).");
+    IntVector rowMap, colMap;
     for (auto res : resultsMatrices) {
-        auto revs = res->getRevisionNumbers();
-        auto tcs = res->getTestcases().getValueList();
-        for (auto rev : revs) {
-            for (auto tc : tcs) {
-                merged->setResult(rev, tc, res->getResult(rev, tc));
+        const IBitMatrix& execBits = res->getExecutionBitMatrix();
+        rowMap.assign(execBits.getNumOfRows(), NOT_MAPPED);
+        for (auto rev : res->getRevisionNumbers()) {
+            IndexType row = res->getRevisions().getRevision(rev);
+            if (row < rowMap.size()) {
+                rowMap[row] = revisions.getRevision(rev);
             }
         }
+        mapIndices(res->getTestcases(), testcases, execBits.getNumOfCols(), colMap);
+        mergeRows(execBits, NULL, rowMap, colMap, exec, pool);
+        // A test case is passed only if it is executed.
+        mergeRows(res->getPassedBitMatrix(), &execBits, rowMap, colMap, pass, pool);
     }
-    return merged;
 }
 
 /**
@@ -144,6 +262,8 @@ int main(int argc, char *argv[])
         ("save-coverage,C", value<String>(), "The path where the filtered coverage binary file will be stored")
         ("results,r", value<StringVector>(&resultPaths)->multitoken(), "The path to one or more results binaries")
         ("save-results,R", value<String>(), "The path where the filtered results binary file will be stored")
+        ("delta-results,d", "Store each revision of the saved results as the changes to the previous revision")
+        ("jobs,j", value<unsigned int>(&numOfThreads)->default_value(1), "Number of threads (0 means the number of hardware threads)")
         ;
 
     if (argc < 2) {
@@ -183,17 +303,29 @@ int processArgs(options_description desc, int ac, char* av[])
         /*
          * SAVE DATA
          */
+        CThreadPool pool(numOfThreads);
         if (vm.count("save-coverage")) {
             String covPath = vm["save-coverage"].as<String>();
-            auto cov = mergeCoverage();
-            cov->save(covPath);
-            delete cov;
+            CIDManager testcases, codeElements;
+            CBitMatrix data;
+            mergeCoverage(testcases, codeElements, data, pool);
+            CCoverageMatrix cov(&testcases, &codeElements, &data);
+            cov.save(covPath);
         }
         if (vm.count("save-results")) {
             String resPath = vm["save-results"].as<String>();
-            auto res = mergeResults();
-            res->save(resPath);
-            delete res;
+            CIDManager testcases;
+            CRevision<IndexType> revisions;
+            CBitMatrix exec, pass;
+            mergeResults(testcases, revisions, exec, pass, pool);
+            if (vm.count("delta-results")) {
+                CDeltaBitMatrix deltaExec(exec), deltaPass(pass);
+                CResultsMatrix res(&testcases, &revisions, &deltaExec, &deltaPass);
+                res.save(resPath);
+            } else {
+                CResultsMatrix res(&testcases, &revisions, &exec, &pass);
+                res.save(resPath);
+            }
         }
 
         /*
@@ -203,6 +335,8 @@ int processArgs(options_description desc, int ac, char* av[])
             delete cov;
         for (auto res : resultsMatrices)
             delete res;
+        for (auto in : mappedFiles)
+            delete in;
     }
     catch (exception& e) {
         ERRO(e.what());
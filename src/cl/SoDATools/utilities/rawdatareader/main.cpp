@@ -47,6 +47,8 @@ int main(int argc, char *argv[])
             ("granularity,g",   value<String>(), "granularity to read")
             ("cut-source-path,c", value<String>()->default_value(""), "removes the matched part from the code element names used by gcov reader plugin")
             ("filter-input-files,f", value<String>()->default_value(""), "regex, skips the matched input files. Multiple expressions are separated with commas. Used by gcov reader plugin")
+            ("jobs,j", value<unsigned int>()->default_value(1), "number of threads reading the coverage files (0 means the number of hardware threads). Used by gcov, jacoco-java and emma-java reader plugins")
+            ("delta-changeset", "store the changed code elements of the saved changeset delta encoded. Older tools can not read these files. Used by changeset reader plugins")
             ("list-code-elements", value<String>(), "input text file where lines contains the names of the manually instrumented methods. Used by simple-instrumentation-listener-java coverage reader plugin.")
     ;
 
@@ -146,6 +148,7 @@ int processArgs(options_description desc, int ac, char* av[])
                     CChangeset *changeset = plugin->read(path);
                     if (vm.count("output")) {
                         std::string output = vm["output"].as<std::string>();
+                        changeset->setDeltaEncoding(vm.count("delta-changeset") > 0);
                         changeset->save(output);
                     }
                     if (changeset) {
@@ -53,10 +53,13 @@ public:
 
     /**
      * @brief Create the partitions of the test suite for one revision.
+     *        The code elements covered by the same test cases of the cluster are in the same partition.
+     *        The partitions are ordered by the sum of the indices of the covering test cases in descending order.
      * @param [IN] data The input data.
      * @param [IN] cluster The clusters of test cases and code elements.
+     * @param [IN] numOfThreads Number of threads hashing the coverage columns, 0 means the number of hardware threads.
      */
-    void compute(CSelectionData &data, CClusterDefinition &cluster);
+    void compute(CSelectionData &data, CClusterDefinition &cluster, unsigned int numOfThreads = 1);
 
     /**
      * @brief Returns the info for every code element.
@@ -70,6 +73,9 @@ public:
      */
     inline PartitionData& getPartitions() { return *m_partitions; }
 private:
+    CPartitionAlgorithm(const CPartitionAlgorithm&);
+    CPartitionAlgorithm& operator=(const CPartitionAlgorithm&);
+
     PartitionInfo *m_partitionInfo;
     PartitionData     *m_partitions;
 
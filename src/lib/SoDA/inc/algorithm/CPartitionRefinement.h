@@ -0,0 +1,132 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef CPARTITIONREFINEMENT_H
+#define CPARTITIONREFINEMENT_H
+
+#include "data/SoDALibDefs.h"
+
+namespace soda {
+
+/**
+ * @brief The CPartitionRefinement class maintains the partition of the code elements by their
+ *        coverage in a growing set of test cases. Code elements are in the same block if they are
+ *        covered by exactly the same tests of the set. Adding a test splits each block by the
+ *        coverage row of the test.
+ */
+class CPartitionRefinement
+{
+public:
+
+    /**
+     * @brief Creates a partition with one block containing every code element.
+     * @param numOfCodeElements  Number of code elements.
+     */
+    explicit CPartitionRefinement(IndexType numOfCodeElements = 0);
+    ~CPartitionRefinement();
+
+    /**
+     * @brief Restores the partition with one block containing every code element.
+     * @param numOfCodeElements  Number of code elements.
+     */
+    void reset(IndexType numOfCodeElements);
+
+    /**
+     * @brief Splits every block by the coverage row of a test.
+     * @param row  The word-packed coverage row of the test.
+     */
+    void refine(const WordType* row);
+
+    /**
+     * @brief Returns the number of code element pairs that would remain in the same block
+     *        if the partition was refined by the given row. The partition is not modified,
+     *        so it can be called from multiple threads with different buffers.
+     * @param row  The word-packed coverage row of the test.
+     * @param counts  Buffer for the number of covered code elements in the blocks.
+     * @return Number of code element pairs in the same block.
+     */
+    IndexType getNumOfPairsIfRefined(const WordType* row, IntVector& counts) const;
+
+    /**
+     * @brief Returns the number of code element pairs in the same block.
+     * @return Number of code element pairs in the same block.
+     */
+    inline IndexType getNumOfPairs() const { return m_numOfPairs; }
+
+    /**
+     * @brief Returns the number of code elements.
+     * @return Number of code elements.
+     */
+    inline IndexType getNumOfCodeElements() const { return m_blockIds->size(); }
+
+    /**
+     * @brief Returns the number of blocks.
+     * @return Number of blocks.
+     */
+    inline IndexType getNumOfBlocks() const { return m_blockSizes->size(); }
+
+    /**
+     * @brief Returns the block of a code element.
+     * @param ceid  The code element id.
+     * @return The block id.
+     */
+    inline IndexType getBlockId(IndexType ceid) const { return (*m_blockIds)[ceid]; }
+
+    /**
+     * @brief Returns the number of code elements in a block.
+     * @param blockId  The block id.
+     * @return Size of the block.
+     */
+    inline IndexType getBlockSize(IndexType blockId) const { return (*m_blockSizes)[blockId]; }
+
+private:
+
+    CPartitionRefinement(const CPartitionRefinement&);
+    CPartitionRefinement& operator=(const CPartitionRefinement&);
+
+    /**
+     * @brief Counts the covered code elements of the row in each block.
+     */
+    void countCovered(const WordType* row, IntVector& counts) const;
+
+    /**
+     * @brief Block id of every code element.
+     */
+    IntVector *m_blockIds;
+
+    /**
+     * @brief Size of every block.
+     */
+    IntVector *m_blockSizes;
+
+    /**
+     * @brief Buffer of refine().
+     */
+    IntVector *m_counts;
+
+    /**
+     * @brief Number of code element pairs in the same block.
+     */
+    IndexType m_numOfPairs;
+};
+
+} /* namespace soda */
+
+#endif /* CPARTITIONREFINEMENT_H */
@@ -24,15 +24,22 @@
 #define CBITLIST_H
 
 #include "interface/IBitList.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
+class CIndexBitList;
+
 /**
- * @brief The CBitList class stores list of bit values represented as bool values in a vector.
+ * @brief The CBitList class stores list of bit values packed into 64 bit words.
+ *        A CBitList can either own its words or be a view of a row of a CBitMatrix.
+ *        The size of a view can not be changed.
  */
 class CBitList :
     public IBitList {
 
+    friend class CBitMatrix;
+
 public:
 
     /**
@@ -155,9 +162,119 @@ public:
      */
     IBitListIterator& end();
 
+    /**
+     * @brief Set the same value for the entire vector.
+     * @param value  Value to be set.
+     */
+    void setAll(const bool value = false);
+
+    /**
+     * @brief Returns the number of words used to store the bits.
+     * @return Number of words.
+     */
+    IndexType getNumOfWords() const;
+
+    /**
+     * @brief Returns the words of the list. The unused bits of the last word are zero.
+     * @return Pointer to the first word.
+     */
+    const WordType* getWords() const;
+
+    /**
+     * @brief Returns the word at the given position.
+     * @param index  Position of the word.
+     * @throw Exception if index is out of bounds.
+     * @return The word.
+     */
+    WordType getWord(IndexType index) const;
+
+    /**
+     * @brief Sets 64 bits at once. The bits of the last word beyond the size are ignored.
+     * @param index  Position of the word.
+     * @param word  The new value of the word.
+     * @throw Exception if index is out of bounds.
+     */
+    void setWord(IndexType index, WordType word);
+
+    /**
+     * @brief Sets the list to (this AND rhs).
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseAnd(const CBitList& rhs);
+
+    /**
+     * @brief Sets the list to (this OR rhs).
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseOr(const CBitList& rhs);
+
+    /**
+     * @brief Sets the list to (this XOR rhs).
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseXor(const CBitList& rhs);
+
+    /**
+     * @brief Sets the list to (this AND NOT rhs).
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseAndNot(const CBitList& rhs);
+
+    /**
+     * @brief Sets the list to (this AND rhs) without unpacking the sparse operand.
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseAnd(const CIndexBitList& rhs);
+
+    /**
+     * @brief Sets the list to (this OR rhs) without unpacking the sparse operand.
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseOr(const CIndexBitList& rhs);
+
+    /**
+     * @brief Sets the list to (this AND NOT rhs) without unpacking the sparse operand.
+     * @param rhs  Other operand, must have the same size.
+     * @throw Exception if the sizes are different.
+     */
+    void bitwiseAndNot(const CIndexBitList& rhs);
+
 private:
     class ListIterator;
 
+    /**
+     * @brief Creates a view over the given words.
+     * @param words  Words of the list, owned by the caller.
+     * @param size  Number of bits.
+     */
+    CBitList(WordType* words, IndexType size);
+
+    /**
+     * @brief Returns the words of the list.
+     * @return Pointer to the first word.
+     */
+    inline WordType* words() const
+    {
+        return m_data ? m_data->data() : m_view;
+    }
+
+    /**
+     * @brief Throws an exception if the list is a view.
+     * @param origin  Name of the calling method.
+     */
+    void checkResizable(const char* origin) const;
+
+    /**
+     * @brief Recounts the 1 elements.
+     */
+    void recount();
+
     /**
      * @brief NIY Copy constructor.
      */
@@ -172,9 +289,19 @@ private:
 private:
 
     /**
-     * @brief Bitlist represented as bool values.
+     * @brief Bitlist packed into words, null if the list is a view.
+     */
+    std::vector<WordType>* m_data;
+
+    /**
+     * @brief Words of the list if it is a view of a matrix row.
+     */
+    WordType* m_view;
+
+    /**
+     * @brief Number of elements in the vector.
      */
-    std::vector<bool>* m_data;
+    IndexType m_size;
 
     /**
      * @brief An iterator pointer to the first element of the vector.
@@ -28,8 +28,12 @@
 
 namespace soda {
 
+class CThreadPool;
+
 /**
  * @brief The CBitMatrix class stores multiple bitlists represented as a matrix.
+ *        The bits are stored in one contiguous row-major array of 64 bit words,
+ *        every row starts at a word boundary.
  */
 class CBitMatrix :
     public IBitMatrix
@@ -139,9 +143,69 @@ public:
      */
     IBitMatrixIterator& end();
 
+    /**
+     * @brief Set the same value for the entire matrix.
+     * @param value  Value to be set.
+     */
+    void setAll(const bool value = false);
+
+    /**
+     * @brief Returns the number of words used to store one row.
+     * @return Number of words per row.
+     */
+    IndexType getNumOfWordsPerRow() const;
+
+    /**
+     * @brief Returns the words of the given row. The unused bits of the last word are zero.
+     * @param row  Row number.
+     * @throw Exception if row is out of bounds.
+     * @return Pointer to the first word of the row.
+     */
+    const WordType* getRowWords(IndexType row) const;
+
+    /**
+     * @brief Overwrites the words of the given row.
+     * @param row  Row number.
+     * @param words  getNumOfWordsPerRow() words to be copied.
+     * @throw Exception if row is out of bounds.
+     */
+    void setRowWords(IndexType row, const WordType* words);
+
+    /**
+     * @brief Returns a word of the given row.
+     * @param row  Row number.
+     * @param index  Position of the word in the row.
+     * @throw Exception if row or index is out of bounds.
+     * @return The word.
+     */
+    WordType getWord(IndexType row, IndexType index) const;
+
+    /**
+     * @brief Sets a word of the given row.
+     * @param row  Row number.
+     * @param index  Position of the word in the row.
+     * @param word  The new value of the word.
+     * @throw Exception if row or index is out of bounds.
+     */
+    void setWord(IndexType row, IndexType index, WordType word);
+
+    /**
+     * @brief Overwrites the matrix with the transpose of the given matrix, the matrix is resized
+     *        to matrix.getNumOfCols() x matrix.getNumOfRows(). The transpose is done in 64x64
+     *        bit blocks, the blocks of a column word of the given matrix form a task of the pool.
+     * @param matrix  The matrix to be transposed, must not be this matrix.
+     * @param pool  The threads transposing the blocks.
+     */
+    void transpose(const IBitMatrix& matrix, CThreadPool& pool);
+
 private:
     class MatrixIterator;
 
+    /**
+     * @brief Points the row views to the current storage and updates their sizes.
+     */
+    void updateRows();
+
     /**
      * @brief NIY Copy constructor.
      */
@@ -166,9 +230,19 @@ private:
     IndexType  m_col;
 
     /**
-     * @brief Dynamic array of bitlist objects
+     * @brief Number of words used to store one row.
+     */
+    IndexType  m_wordsPerRow;
+
+    /**
+     * @brief Row-major array of the words of the matrix.
+     */
+    std::vector<WordType>* m_data;
+
+    /**
+     * @brief Bitlist views of the rows.
      */
-    CBitList* m_data;
+    std::vector<CBitList*>* m_rows;
 
     /**
      * @brief An iterator pointer to the first element of the matrix.
@@ -94,6 +94,13 @@ public:
      */
     StringVector getCodeElementNames(const RevNumType revisionNumber) const;
 
+    /**
+     * @brief Returns the ids of the changed code elements of a specified revision.
+     * @param revisionNumber  Specified revision.
+     * @return The increasing ids of the changed code elements.
+     */
+    IntVector getCodeElementIds(const RevNumType revisionNumber) const;
+
     /**
      * @brief Returns a reference to the code element object.
      * @return A reference to the code elements.
@@ -203,6 +210,21 @@ public:
      */
     virtual void addCodeElementName(const String&);
 
+    /**
+     * @brief Sets whether save() writes the changes into a delta encoded CHANGESET_DELTA chunk
+     *        instead of the CHANGESET chunk with one byte per code element. The delta encoded
+     *        chunk is smaller, but it can not be read by the tools built before it was added.
+     *        load() sets it according to the chunk of the loaded file.
+     * @param deltaEncoding  True if the CHANGESET_DELTA chunk is written.
+     */
+    virtual void setDeltaEncoding(bool deltaEncoding);
+
+    /**
+     * @brief Returns true if save() writes the delta encoded CHANGESET_DELTA chunk.
+     * @return True if the CHANGESET_DELTA chunk is written.
+     */
+    virtual bool getDeltaEncoding() const;
+
     /**
      * @brief Writes the content of a CChangeset object to the out.
      * @param out  Output stream.
@@ -249,11 +271,23 @@ private:
     virtual void saveRevisionTable(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk) const;
 
     /**
-     * @brief Loads the content of a revision table from in.
+     * @brief Writes the content of a revision table to the out, the changed code elements are delta-varint encoded.
+     * @param out  Output stream.
+     */
+    virtual void saveDeltaRevisionTable(io::CBinaryIO* out) const;
+
+    /**
+     * @brief Loads the content of a revision table from in, one byte per code element.
      * @param in  Input stream.
      */
     virtual void loadRevisionTable(io::CBinaryIO* in);
 
+    /**
+     * @brief Loads the content of a revision table from in, the changed code elements are delta-varint encoded.
+     * @param in  Input stream.
+     */
+    virtual void loadDeltaRevisionTable(io::CBinaryIO* in);
+
 private:
 
     /**
@@ -276,6 +310,11 @@ private:
      * @brief If true than the constructor creates m_changes.
      */
     bool m_createChanges;
+
+    /**
+     * @brief True if the changes are saved into a CHANGESET_DELTA chunk.
+     */
+    bool m_deltaEncoding;
 };
 
 }
@@ -28,6 +28,10 @@
 
 namespace soda {
 
+namespace io {
+class CMappedSoDAio;
+}
+
 /**
  * @brief The CCoverageMatrix class stores the test case names, code element names and a coverage matrix.
  *          The coverage matrix's rows are the test cases and the columns are the code elements.
@@ -212,6 +216,15 @@ public:
      */
     virtual void load(io::CSoDAio* in);
 
+    /**
+     * @brief Loads the content of a matrix from a memory mapped file without copying the data.
+     *        The test case list, the code element list and the bit matrix are replaced by read-only views,
+     *        which are valid while the file is mapped.
+     * @param in  Mapped input file.
+     * @throw Exception if the matrix does not own its data or the file does not contain the required chunks.
+     */
+    virtual void load(io::CMappedSoDAio* in);
+
     /**
      * @brief Loads the content of a matrix from a specified file.
      * @param filename  Name of the input file.
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CCOVERAGEMATRIXBUILDER_H
+#define CCOVERAGEMATRIXBUILDER_H
+
+#include <vector>
+
+#include "data/CCoverageMatrix.h"
+#include "data/CIDManager.h"
+
+namespace soda {
+
+/**
+ * @brief The CCoverageMatrixBuilder class collects test case, code element relations
+ *        and creates the coverage matrix from them at once. The relations are stored in
+ *        sparse rows, so adding new names does not resize the matrix.
+ *        The relations of a (test case, code element) pair are applied in the order of the additions.
+ */
+class CCoverageMatrixBuilder {
+public:
+
+    /**
+     * @brief Constructor, creates an empty CCoverageMatrixBuilder object.
+     */
+    CCoverageMatrixBuilder();
+
+    /**
+     * @brief Destroys a CCoverageMatrixBuilder object.
+     */
+    ~CCoverageMatrixBuilder();
+
+    /**
+     * @brief Returns the test case names of the builder.
+     * @return Test case names.
+     */
+    const IIDManager& getTestcases() const;
+
+    /**
+     * @brief Returns the code element names of the builder.
+     * @return Code element names.
+     */
+    const IIDManager& getCodeElements() const;
+
+    /**
+     * @brief Returns the number of the stored relations.
+     * @return Number of the stored relations, the repeated relations are counted until they are compacted.
+     */
+    IndexType getNumOfRelations() const;
+
+    /**
+     * @brief Adds a test case name if it is not present yet.
+     * @param testcaseName  Test case name.
+     * @return Index of the test case in the builder.
+     */
+    IndexType addTestcaseName(const String& testcaseName);
+
+    /**
+     * @brief Adds a code element name if it is not present yet.
+     * @param codeElementName  Code element name.
+     * @return Index of the code element in the builder.
+     */
+    IndexType addCodeElementName(const String& codeElementName);
+
+    /**
+     * @brief Adds the names if they are not present yet and stores the relation.
+     * @param testcaseName  Test case name.
+     * @param codeElementName  Code element name.
+     * @param isCovered  Value of the relation.
+     */
+    void addOrSetRelation(const String& testcaseName, const String& codeElementName, const bool isCovered=true);
+
+    /**
+     * @brief Stores the relation of an already added test case and code element.
+     * @param testcaseIdx  Index of the test case in the builder.
+     * @param codeElementIdx  Index of the code element in the builder.
+     * @param isCovered  Value of the relation.
+     * @throw Exception if one of the indices is not present in the builder.
+     */
+    void addOrSetRelation(const IndexType testcaseIdx, const IndexType codeElementIdx, const bool isCovered=true);
+
+    /**
+     * @brief Appends the names and relations of another builder.
+     * @param other  The other builder.
+     */
+    void merge(const CCoverageMatrixBuilder& other);
+
+    /**
+     * @brief Appends the names and relations of the builders in their order. The names are added
+     *        sequentially, the relations are copied in parallel, each task handles a separate range of rows.
+     * @param builders  The builders created by the threads, must not contain this builder.
+     * @param numOfThreads  Number of threads, 0 means the number of hardware threads.
+     */
+    void merge(const std::vector<CCoverageMatrixBuilder*>& builders, unsigned int numOfThreads = 0);
+
+    /**
+     * @brief Adds the names and sets the relations in the coverage matrix. The matrix is resized only once.
+     * @param coverage  The coverage matrix, can already contain names and relations.
+     */
+    void build(CCoverageMatrix& coverage) const;
+
+    /**
+     * @brief Creates a new coverage matrix from the names and relations.
+     * @return The coverage matrix, the caller must delete it.
+     */
+    CCoverageMatrix* build() const;
+
+    /**
+     * @brief Removes every name and relation from the builder.
+     */
+    void clear();
+
+private:
+
+    /**
+     * @brief Copies the rows of the builders whose target row is in the range [begin, end).
+     */
+    void mergeRows(const std::vector<CCoverageMatrixBuilder*>& builders, const std::vector<IntVector>& testcaseMaps,
+                   const std::vector<IntVector>& codeElementMaps, IndexType begin, IndexType end);
+
+    /**
+     * @brief Keeps only the last relation of each code element in the row if the row has grown enough since its last compaction.
+     */
+    void compactRow(const IndexType row);
+
+    /**
+     * @brief Test case names.
+     */
+    CIDManager* m_testcases;
+
+    /**
+     * @brief Code element names.
+     */
+    CIDManager* m_codeElements;
+
+    /**
+     * @brief Relations of the test cases, the elements are (code element index << 1 | isCovered).
+     */
+    std::vector<IntVector>* m_rows;
+
+    /**
+     * @brief Length of the rows after their last compaction.
+     */
+    IntVector* m_compactedSizes;
+
+private:
+
+    /**
+     * @brief NIY copy constructor.
+     */
+    CCoverageMatrixBuilder(const CCoverageMatrixBuilder&);
+
+    /**
+     * @brief NIY operator =.
+     */
+    CCoverageMatrixBuilder& operator=(const CCoverageMatrixBuilder&);
+};
+
+} // namespace soda
+
+#endif /* CCOVERAGEMATRIXBUILDER_H */
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDELTABITMATRIX_H
+#define CDELTABITMATRIX_H
+
+#include "interface/IBitMatrix.h"
+#include "data/CBitList.h"
+
+namespace soda {
+
+/**
+ * @brief The CDeltaBitMatrix class stores a bit matrix whose consecutive rows differ in a few
+ *        positions, e.g. the test results of a long revision history. Each row is stored as the
+ *        increasing list of the columns which are different in the previous row, so the history of
+ *        a column is the run-length encoding of its values. Every 64th row is also kept as a full
+ *        row, and the last accessed rows are decoded into a small cache of CBitList objects.
+ *        Each thread gets its own 8 decoded copies of the rows returned by getRow(), so a
+ *        returned row is valid until the thread accesses 8 other rows or the matrix is resized,
+ *        cleared or loaded. Rows which are used for longer should be copied by copyRowWords().
+ */
+class CDeltaBitMatrix :
+    public IBitMatrix
+{
+public:
+
+    /**
+     * @brief Creates an empty CDeltaBitMatrix object.
+     */
+    CDeltaBitMatrix();
+
+    /**
+     * @brief Creates a CDeltaBitMatrix object with the given size, all elements are false.
+     * @param row  Number of rows.
+     * @param col  Number of columns.
+     */
+    CDeltaBitMatrix(IndexType row, IndexType col);
+
+    /**
+     * @brief Creates a CDeltaBitMatrix object with the values of an other matrix.
+     * @param matrix  The matrix to be encoded.
+     */
+    explicit CDeltaBitMatrix(const IBitMatrix& matrix);
+
+    /**
+     * @brief Destroys a CDeltaBitMatrix object.
+     */
+    ~CDeltaBitMatrix();
+
+    /**
+     * @brief Returns the number of rows of the matrix.
+     * @return Number of rows of the matrix.
+     */
+    IndexType getNumOfRows() const;
+
+    /**
+     * @brief Returns the number of columns of the matrix.
+     * @return Number of columns of the matrix.
+     */
+    IndexType getNumOfCols() const;
+
+    /**
+     * @brief Returns the number of positions where a row differs from the previous row,
+     *        the first row is compared to an empty row.
+     * @return Number of stored changes.
+     */
+    IndexType getNumOfChanges() const;
+
+    /**
+     * @brief Returns in the given parameter how many true elements are in each row of the matrix.
+     * @param v  Vector reference.
+     */
+    void rowCounts(std::vector<IndexType> &v) const;
+
+    /**
+     * @brief Returns in the given parameter how many true elements are in each column of the matrix.
+     * @param v  Vector reference.
+     */
+    void colCounts(std::vector<IndexType> &v) const;
+
+    /**
+     * @brief Returns the value of element at the given position in the matrix.
+     *        The row is not decoded if it is not in the cache.
+     * @param row  Row of the element in the matrix.
+     * @param col  Column of the element in the matrix.
+     * @throw Exception if row or col is out of bounds.
+     * @return Value at the row x col position in the matrix.
+     */
+    bool get(IndexType row, IndexType col) const;
+
+    /**
+     * @brief Sets the value of element at the given position in the matrix. The modified row
+     *        is encoded again when an other row is accessed.
+     * @param row  Row of the element in the matrix.
+     * @param col  Column of the element in the matrix.
+     * @param value  Value to be set.
+     * @throw Exception if row or col is out of bounds.
+     */
+    void set(IndexType row, IndexType col, bool value);
+
+    /**
+     * @brief Toggles the value of element at the given position in the matrix.
+     * @param row  Row of the element in the matrix.
+     * @param col  Column of the element in the matrix.
+     * @throw Exception if row or col is out of bounds.
+     */
+    void toggleValue(IndexType row, IndexType col);
+
+    /**
+     * @brief Resizes the matrix, the new elements are false.
+     * @param newRow  Number of rows.
+     * @param newCol  Number of columns.
+     */
+    void resize(IndexType newRow, IndexType newCol);
+
+    /**
+     * @brief Removes all elements of the matrix.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the decoded row with the given index. The row is valid until the calling
+     *        thread accesses 8 other rows, its modifications are written into the matrix.
+     * @param row  Row number.
+     * @return Reference to the decoded row.
+     */
+    IBitList& operator[](IndexType row) const;
+
+    /**
+     * @brief Returns the decoded row with the given index. The row is valid until the calling
+     *        thread accesses 8 other rows, its modifications are written into the matrix.
+     * @param row  Row number.
+     * @throw Exception if row is out of bounds.
+     * @return Reference to the decoded row.
+     */
+    IBitList& getRow(IndexType row) const;
+
+    /**
+     * @brief Returns a new list of the values of the given column.
+     * @param col  Column number.
+     * @throw Exception if col is out of bounds.
+     * @return Reference to the column.
+     */
+    IBitList& getCol(IndexType col) const;
+
+    /**
+     * @brief Returns an iterator to the first element of the matrix.
+     * @return Iterator to the first element of the matrix.
+     */
+    IBitMatrixIterator& begin();
+
+    /**
+     * @brief Returns an iterator to the last element of the matrix.
+     * @return Iterator to the last element of the matrix.
+     */
+    IBitMatrixIterator& end();
+
+    /**
+     * @brief Copies the given row into CBitOperations::numOfWords(getNumOfCols()) words.
+     * @param row  Row number.
+     * @param words  Pointer to the first word.
+     * @throw Exception if row is out of bounds.
+     */
+    void copyRowWords(IndexType row, WordType* words) const;
+
+    /**
+     * @brief Overwrites the given row from CBitOperations::numOfWords(getNumOfCols()) words.
+     * @param row  Row number.
+     * @param words  Pointer to the first word.
+     * @throw Exception if row is out of bounds.
+     */
+    void setRowWords(IndexType row, const WordType* words);
+
+    /**
+     * @brief Set the same value for the entire matrix.
+     * @param value  Value to be set.
+     */
+    void setAll(const bool value = false);
+
+    /**
+     * @brief Writes the matrix in the format of a BITMATRIX chunk.
+     * @param out  Output stream.
+     * @param chunk  Type of the data.
+     */
+    void save(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk = io::CSoDAio::BITMATRIX) const;
+
+    /**
+     * @brief Reads a matrix written in the format of a BITMATRIX chunk and encodes its rows.
+     * @param in  Input stream.
+     */
+    void load(io::CBinaryIO* in);
+
+    /**
+     * @brief Writes the encoded rows: the number of rows and columns, then the number of
+     *        changed columns, the size of the delta-varint encoded columns and the encoded
+     *        columns of each row.
+     * @param out  Output stream.
+     * @param chunk  Type of the data.
+     */
+    void saveDeltas(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk) const;
+
+    /**
+     * @brief Reads the payload of a chunk written by saveDeltas().
+     * @param data  Payload of the chunk.
+     * @param length  Length of the payload.
+     * @throw Exception if the payload is invalid.
+     */
+    void loadDeltas(const char* data, unsigned long long length);
+
+private:
+    class MatrixIterator;
+    class RowList;
+    struct RowCache;
+
+    /**
+     * @brief NIY Copy constructor.
+     */
+    CDeltaBitMatrix(const CDeltaBitMatrix&);
+
+    /**
+     * @brief NIY operator =.
+     */
+    CDeltaBitMatrix& operator=(const CDeltaBitMatrix&);
+
+    /**
+     * @brief Returns the cached row, the row is decoded if it is not in the cache.
+     */
+    CBitList& cachedRow(IndexType row) const;
+
+    /**
+     * @brief Decodes the row from the nearest clean cached row or full row before it.
+     */
+    void decodeRow(IndexType row, CBitList& list) const;
+
+    /**
+     * @brief Encodes the modified row of the cache.
+     */
+    void flush() const;
+
+    /**
+     * @brief Drops the cached rows.
+     */
+    void clearCache() const;
+
+    /**
+     * @brief Recomputes the full rows from the changes.
+     */
+    void rebuildCheckpoints();
+
+private:
+
+    /**
+     * @brief Number of rows of the matrix.
+     */
+    IndexType m_row;
+
+    /**
+     * @brief Number of columns of the matrix.
+     */
+    IndexType m_col;
+
+    /**
+     * @brief The increasing columns of each row which are different in the previous row.
+     */
+    std::vector<IntVector>* m_changes;
+
+    /**
+     * @brief Full copies of every 64th row.
+     */
+    std::vector<CBitList*>* m_checkpoints;
+
+    /**
+     * @brief Decoded rows.
+     */
+    RowCache* m_cache;
+
+    /**
+     * @brief An iterator pointer to the first element of the matrix.
+     */
+    MatrixIterator* m_beginIterator;
+
+    /**
+     * @brief An iterator pointer to the last element of the matrix.
+     */
+    MatrixIterator* m_endIterator;
+};
+
+} // namespace soda
+
+#endif /* CDELTABITMATRIX_H */
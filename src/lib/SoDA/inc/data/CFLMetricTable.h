@@ -0,0 +1,263 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CFLMETRICTABLE_H
+#define CFLMETRICTABLE_H
+
+#include <deque>
+#include <map>
+#include <ostream>
+
+#include "data/SoDALibDefs.h"
+#include "rapidjson/document.h"
+
+namespace soda {
+
+/**
+ * @brief The CFLMetricTable class stores the fault localization metrics of the code elements of a cluster.
+ *        Every metric is a column of unsigned integer or double values, the rows are the code elements.
+ */
+class CFLMetricTable
+{
+public:
+
+    /**
+     * @brief Type of the values of a column.
+     */
+    typedef enum {
+        ctUInt64,
+        ctDouble
+    } eColumnType;
+
+    /**
+     * @brief Row index of the code elements missing from the table.
+     */
+    static const IndexType NO_ROW;
+
+public:
+
+    /**
+     * @brief Creates an empty table.
+     */
+    CFLMetricTable();
+
+    /**
+     * @brief Copy constructor.
+     */
+    CFLMetricTable(const CFLMetricTable &other);
+
+    /**
+     * @brief Destroys the table.
+     */
+    ~CFLMetricTable();
+
+    /**
+     * @brief Assignment operator.
+     */
+    CFLMetricTable& operator=(const CFLMetricTable &rhs);
+
+    /**
+     * @brief Sets the rows of the table and removes all of the columns.
+     * @param codeElements  Ids of the code elements in the order of the rows.
+     */
+    void setCodeElements(const IntVector &codeElements);
+
+    /**
+     * @brief Returns the ids of the code elements in the order of the rows.
+     * @return Ids of the code elements.
+     */
+    const IntVector& getCodeElements() const;
+
+    /**
+     * @brief Returns the number of rows.
+     * @return Number of rows.
+     */
+    IndexType getNumOfRows() const;
+
+    /**
+     * @brief Returns the row of a code element.
+     * @param cid  Id of the code element.
+     * @return The row of the code element or NO_ROW if it is not in the table.
+     */
+    IndexType getRow(IndexType cid) const;
+
+    /**
+     * @brief Returns true if the table has a column with the given name.
+     * @param name  Name of the column.
+     * @return True if the column exists.
+     */
+    bool hasColumn(const String &name) const;
+
+    /**
+     * @brief Returns the names of the columns in the order they were added.
+     * @return Names of the columns.
+     */
+    StringVector getColumnNames() const;
+
+    /**
+     * @brief Adds an unsigned integer column filled with zeros, or returns the existing one.
+     *        The references of the columns remain valid while new columns are added.
+     * @param name  Name of the column.
+     * @return Values of the column.
+     * @throw Exception if a double column exists with the same name.
+     */
+    IntVector& addUIntColumn(const String &name);
+
+    /**
+     * @brief Adds a double column filled with zeros, or returns the existing one.
+     *        The references of the columns remain valid while new columns are added.
+     * @param name  Name of the column.
+     * @return Values of the column.
+     * @throw Exception if an unsigned integer column exists with the same name.
+     */
+    std::vector<double>& addDoubleColumn(const String &name);
+
+    /**
+     * @brief Returns an unsigned integer column.
+     * @param name  Name of the column.
+     * @return Values of the column.
+     * @throw Exception if there is no unsigned integer column with the given name.
+     */
+    const IntVector& getUIntColumn(const String &name) const;
+
+    /**
+     * @brief Returns a double column.
+     * @param name  Name of the column.
+     * @return Values of the column.
+     * @throw Exception if there is no double column with the given name.
+     */
+    const std::vector<double>& getDoubleColumn(const String &name) const;
+
+    /**
+     * @brief Writes the names of the columns separated by the separator.
+     * @param out  Output stream.
+     * @param separator  Separator of the values.
+     */
+    void writeCsvHeader(std::ostream &out, const String &separator) const;
+
+    /**
+     * @brief Writes the values of a row separated by the separator.
+     * @param out  Output stream.
+     * @param row  Index of the row.
+     * @param separator  Separator of the values.
+     */
+    void writeCsvRow(std::ostream &out, IndexType row, const String &separator) const;
+
+    /**
+     * @brief Writes the table as a json object where the keys are the code element ids.
+     * @param out  Output stream.
+     */
+    void writeJson(std::ostream &out) const;
+
+    /**
+     * @brief Writes the table as a json object to a rapidjson writer, so the output
+     *        is formatted the same way as a json document written by the writer.
+     * @param writer  The rapidjson writer.
+     */
+    template <typename Writer>
+    void writeJson(Writer &writer) const
+    {
+        writer.StartObject();
+        for (IndexType row = 0; row < m_codeElements->size(); ++row) {
+            String ceIdStr = std::to_string((*m_codeElements)[row]);
+            writer.Key(ceIdStr.c_str(), ceIdStr.size());
+            writer.StartObject();
+            for (std::deque<Column>::const_iterator it = m_columns->begin(); it != m_columns->end(); ++it) {
+                writer.Key(it->name.c_str(), it->name.size());
+                if (it->type == ctUInt64) {
+                    writer.Uint64(it->uintValues[row]);
+                } else {
+                    writer.Double(it->doubleValues[row]);
+                }
+            }
+            writer.EndObject();
+        }
+        writer.EndObject();
+    }
+
+    /**
+     * @brief Adds the values of the given columns to a json object where the keys are the code element ids.
+     * @param object  The json object of the cluster.
+     * @param allocator  Allocator of the json document.
+     * @param columns  Names of the columns to add.
+     */
+    void toJson(rapidjson::Value &object, rapidjson::Document::AllocatorType &allocator, const StringVector &columns) const;
+
+    /**
+     * @brief Sets the rows and the unsigned integer columns from a json object where the keys are the code element ids.
+     * @param object  The json object of the cluster.
+     * @param columns  Names of the unsigned integer members to load.
+     */
+    void loadUIntColumns(const rapidjson::Value &object, const StringVector &columns);
+
+    /**
+     * @brief Writes the tables of the clusters as a json object where the keys are the names of the clusters.
+     * @param out  Output stream.
+     * @param tables  The metric tables indexed by the name of the cluster.
+     */
+    static void writeJson(std::ostream &out, const std::map<String, CFLMetricTable> &tables);
+
+private:
+
+    /**
+     * @brief A column of the table.
+     */
+    struct Column {
+        String name;
+        eColumnType type;
+        IntVector uintValues;
+        std::vector<double> doubleValues;
+    };
+
+    /**
+     * @brief Returns the column with the given name or NULL.
+     */
+    const Column* findColumn(const String &name) const;
+
+    /**
+     * @brief Adds a column or returns the existing one with the same type.
+     */
+    Column& addColumn(const String &name, eColumnType type);
+
+    /**
+     * @brief Ids of the code elements in the order of the rows.
+     */
+    IntVector *m_codeElements;
+
+    /**
+     * @brief Row of the code elements indexed by the code element id.
+     */
+    IntVector *m_rows;
+
+    /**
+     * @brief The columns in the order they were added.
+     */
+    std::deque<Column> *m_columns;
+};
+
+/**
+ * @brief The metric tables of the clusters indexed by the name of the cluster.
+ */
+typedef std::map<String, CFLMetricTable> FLMetricTables;
+
+} /* namespace soda */
+
+#endif /* CFLMETRICTABLE_H */
@@ -30,6 +30,8 @@ namespace soda {
 
 /**
  * @brief The CIDManager class manages maps of id, string and string, id pairs.
+ *        The values are stored in a string arena indexed densely by the ids,
+ *        the ids of the values are found by an open addressing hash table.
  */
 class CIDManager : public IIDManager {
 public:
@@ -85,6 +87,12 @@ public:
      */
     virtual IntVector getIDList() const;
 
+    /**
+     * @brief Returns the ordered list of the available ids without copying it.
+     * @return Reference to the list of the available ids.
+     */
+    virtual const IntVector& getIDs() const;
+
     /**
      * @brief Returns the list of the available values.
      * @return The list of the available values.
@@ -158,14 +166,82 @@ public:
 protected:
 
     /**
-     * @brief Stores id, string pairs
+     * @brief Marks the unused ids and the empty slots of the hash table.
+     */
+    static const IndexType NO_ID;
+
+    /**
+     * @brief Marks the removed slots of the hash table.
+     */
+    static const IndexType DELETED_ID;
+
+    /**
+     * @brief Position of a value in the arena.
+     */
+    struct Entry {
+        IndexType offset;
+        IndexType length;
+    };
+
+    /**
+     * @brief Adds a value with the specified id if the id is not used yet, the value can be already present.
+     */
+    void insert(const IndexType, const char* value, IndexType length);
+
+    /**
+     * @brief Returns the slot of the value in the hash table or the size of the table if it is not present.
+     */
+    IndexType findSlot(const char* value, IndexType length) const;
+
+    /**
+     * @brief Stores the id in the hash table, the table grows if it is at least half full.
+     */
+    void insertHash(const IndexType id);
+
+    /**
+     * @brief Rebuilds the hash table with the specified capacity.
+     */
+    void rehash(IndexType capacity);
+
+    /**
+     * @brief Rebuilds the arena without the removed values.
+     */
+    void compact();
+
+    /**
+     * @brief Returns the hash of a value.
+     */
+    static IndexType hash(const char* value, IndexType length);
+
+    /**
+     * @brief Stores the position of the value for each id, unused ids have NO_ID offset.
+     */
+    std::vector<Entry> m_entries;
+
+    /**
+     * @brief Stores the used ids in increasing order.
+     */
+    IntVector m_ids;
+
+    /**
+     * @brief Stores the null terminated values.
+     */
+    std::vector<char> m_arena;
+
+    /**
+     * @brief Open addressing hash table of the ids, its size is a power of 2.
+     */
+    IntVector m_table;
+
+    /**
+     * @brief Number of the used and deleted slots in the hash table.
      */
-    StringMap m_data;
+    IndexType m_tableUsed;
 
     /**
-     * @brief Stores string, id pairs
+     * @brief Number of bytes of the removed values in the arena.
      */
-    IdxStrMap m_adat;
+    IndexType m_garbage;
 };
 
 } // namespace soda
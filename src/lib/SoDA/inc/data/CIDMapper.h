@@ -35,6 +35,11 @@ namespace soda {
 class CIDMapper : public IIDManager {
 public:
 
+    /**
+     * @brief Marks the unused elements of the translation vectors.
+     */
+    static const IndexType NO_ID;
+
     /**
      * @brief Constructor, creates a CIDMapper object with the specified IIDManager
      */
@@ -71,6 +76,12 @@ public:
      */
     virtual IntVector getIDList() const;
 
+    /**
+     * @brief Returns the ordered list of the available ids without copying it.
+     * @return Reference to the list of the available ids.
+     */
+    virtual const IntVector& getIDs() const;
+
     /**
      * @brief Returns the list of the available values.
      * @return The list of the available values.
@@ -108,6 +119,15 @@ public:
      */
     virtual IndexType translateFromAnotherId(CIDMapper&, IndexType);
 
+    /**
+     * @brief Translates every id of another mapper to a local id.
+     * @param remoteMapper  The other mapper, it must use the same global manager.
+     * @param table  The local ids indexed by the ids of the other mapper, NO_ID if the id
+     *               is not used or it has no local id.
+     * @throw Exception if the mappers use different global managers.
+     */
+    virtual void getTranslationTable(const CIDMapper& remoteMapper, IntVector& table) const;
+
     /**
      * @brief Adds a value with the specified id.
      */
@@ -118,6 +138,19 @@ public:
      */
     virtual void add(const String&);
 
+    /**
+     * @brief Maps every value of the global manager which is not in the mapper yet.
+     *        The new values are added as the last elements in the order of their global ids.
+     */
+    virtual void addGlobalIds();
+
+    /**
+     * @brief Replaces the content of the mapper with the ids of another mapper, the values are not looked up.
+     * @param remoteMapper  The other mapper, it must use the same global manager.
+     * @throw Exception if the mappers use different global managers.
+     */
+    virtual void assign(const CIDMapper& remoteMapper);
+
     /**
      * @brief Removes an element by its id.
      */
@@ -148,9 +181,10 @@ public:
 protected:
 
     /**
-     * @brief Type defition of map of IndexType, IndexType pairs.
+     * @brief Returns the global id of a local id.
+     * @throw std::out_of_range If the id is not present in the Mapper.
      */
-    typedef std::map<IndexType, IndexType> maptype;
+    IndexType toGlobal(const IndexType) const;
 
     /**
      * @brief A global id to string manager object
@@ -158,14 +192,19 @@ protected:
     IIDManager *m_globalIdManager;
 
     /**
-     * @brief Map of global id, local id pairs.
+     * @brief Local ids indexed by the global ids, NO_ID if the global id is not mapped.
+     */
+    IntVector m_globalToLocal;
+
+    /**
+     * @brief Global ids indexed by the local ids, NO_ID if the local id is not used.
      */
-    maptype m_globalToLocal;
+    IntVector m_localToGlobal;
 
     /**
-     * @brief Map of local id, global id pairs.
+     * @brief The used local ids in increasing order.
      */
-    maptype m_localToGlobal;
+    IntVector m_ids;
 };
 
 } // namespace soda
@@ -28,8 +28,10 @@
 namespace soda {
 
 /**
- * @brief The CIndexBitList class stores list of bit values represented as bool values
- *          in a vector which stores the index positions of 1 values.
+ * @brief The CIndexBitList class stores list of bit values as a compressed sparse set of
+ *          the index positions of 1 values. The positions are grouped by their upper bits
+ *          into containers of 65536 positions. A container stores the sorted lower 16 bits
+ *          of its positions, or a bitmap if it has more than 4096 positions.
  */
 class CIndexBitList : public IBitList {
 
@@ -155,8 +157,58 @@ public:
      */
     IBitListIterator& end();
 
+    /**
+     * @brief Copies the positions of the true elements in increasing order to indices.
+     * @param indices  The positions, the previous content is replaced.
+     */
+    void getIndices(IntVector &indices) const;
+
+    /**
+     * @brief Replaces the true elements with the given positions.
+     * @param indices  Strictly increasing positions of the true elements.
+     * @throw Exception if the positions are not increasing or out of bounds.
+     */
+    void setIndices(const IntVector &indices);
+
+    /**
+     * @brief Set the same value for the entire vector.
+     * @param value  Value to be set.
+     */
+    void setAll(const bool value = false);
+
+    /**
+     * @brief Returns the number of true elements which are also set in the packed words,
+     *        for example in a row of a CBitMatrix.
+     * @param words  Packed bits, positions beyond the words are not counted.
+     * @param numOfWords  Number of words.
+     * @return Number of common true elements.
+     */
+    IndexType countAnd(const WordType* words, IndexType numOfWords) const;
+
+    /**
+     * @brief Computes words = words AND this.
+     * @param words  Packed bits.
+     * @param numOfWords  Number of words.
+     */
+    void bitwiseAnd(WordType* words, IndexType numOfWords) const;
+
+    /**
+     * @brief Computes words = words OR this. Positions beyond the words are ignored.
+     * @param words  Packed bits.
+     * @param numOfWords  Number of words.
+     */
+    void bitwiseOr(WordType* words, IndexType numOfWords) const;
+
+    /**
+     * @brief Computes words = words AND NOT this.
+     * @param words  Packed bits.
+     * @param numOfWords  Number of words.
+     */
+    void bitwiseAndNot(WordType* words, IndexType numOfWords) const;
+
 private:
     class ListIterator;
+    struct Container;
 
     /**
      * @brief NIY Copy constructor.
@@ -169,17 +221,37 @@ private:
      */
     CIndexBitList& operator=(const CIndexBitList&);
 
+    /**
+     * @brief Returns true if the position is stored.
+     */
+    bool contains(IndexType pos) const;
+
+    /**
+     * @brief Stores the position.
+     */
+    void add(IndexType pos);
+
+    /**
+     * @brief Removes the position.
+     */
+    void remove(IndexType pos);
+
 private:
     /**
-     * @brief Stores index positions of elements which are true in the vector.
+     * @brief Containers of the true elements ordered by the upper bits of their positions.
      */
-    std::vector<IndexType>* m_data;
+    std::vector<Container>* m_containers;
 
     /**
      * @brief Size of the bit vector.
      */
     IndexType m_size;
 
+    /**
+     * @brief Number of true elements.
+     */
+    IndexType m_count;
+
     /**
      * @brief An iterator pointer to the first element of the vector.
      */
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CMAPPEDBITMATRIX_H
+#define CMAPPEDBITMATRIX_H
+
+#include "interface/IBitMatrix.h"
+#include "data/CBitList.h"
+
+namespace soda {
+
+/**
+ * @brief The CMappedBitMatrix class is a read-only bit matrix over the payload of a
+ *        BITMATRIX-like chunk (COVERAGE, EXECUTION, PASSED) of a memory mapped SoDA file.
+ *        The bits are not copied, the payload must be valid during the lifetime of the object.
+ *        The rows returned by getRow() are decoded into CBitList objects on first access,
+ *        the references stay valid and the rows can be accessed from several threads.
+ */
+class CMappedBitMatrix :
+    public IBitMatrix
+{
+public:
+
+    /**
+     * @brief Creates a CMappedBitMatrix object over a chunk payload.
+     * @param data  Payload of the chunk: rows, columns and the bits.
+     * @param length  Length of the payload.
+     * @throw Exception if the payload is too short.
+     */
+    CMappedBitMatrix(const char* data, unsigned long long length);
+
+    /**
+     * @brief Destroys a CMappedBitMatrix object.
+     */
+    ~CMappedBitMatrix();
+
+    /**
+     * @brief Returns the number of rows of the matrix.
+     * @return Number of rows of the matrix.
+     */
+    IndexType getNumOfRows() const;
+
+    /**
+     * @brief Returns the number of columns of the matrix.
+     * @return Number of columns of the matrix.
+     */
+    IndexType getNumOfCols() const;
+
+    /**
+     * @brief Returns in the given parameter how many true elements are in each row of the matrix.
+     * @param v  Vector reference.
+     */
+    void rowCounts(std::vector<IndexType> &v) const;
+
+    /**
+     * @brief Returns in the given parameter how many true elements are in each column of the matrix.
+     * @param v  Vector reference.
+     */
+    void colCounts(std::vector<IndexType> &v) const;
+
+    /**
+     * @brief Returns the value of element at the given position in the matrix.
+     * @param row  Row of the element in the matrix.
+     * @param col  Column of the element in the matrix.
+     * @throw Exception if row or col is out of bounds.
+     * @return Value at the row x col position in the matrix.
+     */
+    bool get(IndexType row, IndexType col) const;
+
+    /**
+     * @brief Not supported, the matrix is read-only.
+     * @throw Exception in every case.
+     */
+    void set(IndexType row, IndexType col, bool value);
+
+    /**
+     * @brief Not supported, the matrix is read-only.
+     * @throw Exception in every case.
+     */
+    void toggleValue(IndexType row, IndexType col);
+
+    /**
+     * @brief Not supported, the matrix is read-only.
+     * @throw Exception in every case.
+     */
+    void resize(IndexType newRow, IndexType newCol);
+
+    /**
+     * @brief Not supported, the matrix is read-only.
+     * @throw Exception in every case.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the given row of the matrix as a bitlist.
+     * @param row  Row number.
+     * @return Row of the matrix as a bitlist.
+     */
+    IBitList& operator[](IndexType row) const;
+
+    /**
+     * @brief Returns the given row of the matrix as a bitlist.
+     * @param row  Row number.
+     * @throw Exception if row is out of bounds.
+     * @return Row of the matrix as a bitlist.
+     */
+    IBitList& getRow(IndexType row) const;
+
+    /**
+     * @brief Returns the given column of the matrix as a new bitlist.
+     * @param col  Column number.
+     * @throw Exception if col is out of bounds.
+     * @return Column of the matrix as a bitlist, must be deleted by the caller.
+     */
+    IBitList& getCol(IndexType col) const;
+
+    /**
+     * @brief Returns an iterator which points at the first element in the matrix.
+     * @return Iterator which points at first element in the matrix.
+     */
+    IBitMatrixIterator& begin();
+
+    /**
+     * @brief Returns an iterator which points at the last element in the matrix.
+     * @return Iterator which points at the last element in the matrix.
+     */
+    IBitMatrixIterator& end();
+
+    /**
+     * @brief Copies the given row into words. The bits are stored LSB first, the unused bits of the last word are zero.
+     * @param row  Row number.
+     * @param words  Destination, must hold at least (getNumOfCols() + 63) / 64 words.
+     * @throw Exception if row is out of bounds.
+     */
+    void copyRowWords(IndexType row, WordType* words) const;
+
+    /**
+     * @brief Writes the matrix by copying the mapped bits to the output stream.
+     * @param out  Output stream.
+     * @param chunk  Type of the data.
+     */
+    void save(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk = io::CSoDAio::BITMATRIX) const;
+
+private:
+    class MatrixIterator;
+    struct DecodedRows;
+
+    /**
+     * @brief NIY Copy constructor.
+     */
+    CMappedBitMatrix(const CMappedBitMatrix&);
+
+    /**
+     * @brief NIY operator =.
+     * @return Reference to a CMappedBitMatrix object.
+     */
+    CMappedBitMatrix& operator=(const CMappedBitMatrix&);
+
+    /**
+     * @brief Returns at most 64 bits from the given bit position of the mapped bits.
+     * @param pos  Bit position.
+     * @param bits  Number of bits, at most 64.
+     * @return The bits, LSB first.
+     */
+    WordType extractWord(IndexType pos, IndexType bits) const;
+
+    /**
+     * @brief Returns the value of the bit at the given position of the mapped bits.
+     * @param pos  Bit position.
+     * @return The value of the bit.
+     */
+    inline bool bitAt(IndexType pos) const
+    {
+        return (((const unsigned char*)m_bits)[pos / 8] >> (pos % 8)) & 1;
+    }
+
+private:
+
+    /**
+     * @brief Number of rows of the matrix.
+     */
+    IndexType m_row;
+
+    /**
+     * @brief Number of columns of the matrix.
+     */
+    IndexType m_col;
+
+    /**
+     * @brief The mapped bits, rows are stored continuously without padding.
+     */
+    const char* m_bits;
+
+    /**
+     * @brief Number of bytes of the mapped bits.
+     */
+    IndexType m_numOfBytes;
+
+    /**
+     * @brief Decoded rows guarded by a mutex, null if the row was not accessed yet.
+     */
+    DecodedRows* m_rows;
+
+    /**
+     * @brief An iterator pointer to the first element of the matrix.
+     */
+    MatrixIterator* m_beginIterator;
+
+    /**
+     * @brief An iterator pointer to the last element of the matrix.
+     */
+    MatrixIterator* m_endIterator;
+};
+
+} // namespace soda
+
+#endif /* CMAPPEDBITMATRIX_H */
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CMAPPEDIDMANAGER_H
+#define CMAPPEDIDMANAGER_H
+
+#include "io/CSoDAio.h"
+#include "interface/IIDManager.h"
+
+namespace soda {
+
+/**
+ * @brief The CMappedIDManager class is a read-only id manager over the payload of an
+ *        IDMANAGER-like chunk (TCLIST, PRLIST) of a memory mapped SoDA file.
+ *        The strings are not copied, the payload must be valid during the lifetime of the object.
+ */
+class CMappedIDManager : public IIDManager {
+public:
+
+    /**
+     * @brief Creates a CMappedIDManager object over a chunk payload.
+     * @param data  Payload of the chunk: number of elements and the id, string pairs.
+     * @param length  Length of the payload.
+     * @throw Exception if the payload is malformed.
+     */
+    CMappedIDManager(const char* data, unsigned long long length);
+
+    /**
+     * @brief Destroys the CMappedIDManager object.
+     */
+    ~CMappedIDManager();
+
+    /**
+     * @brief Returns true if the value is present in the Manager.
+     * @return true if the value is present in the Manager.
+     */
+    virtual bool containsValue(const String&) const;
+
+    /**
+     * @brief Returns the id of the value.
+     * @return The id of the string value.
+     * @throw std::out_of_range If the value is not present in the Manager.
+     */
+    virtual IndexType getID(const String&) const;
+
+    /**
+     * @brief Returns the value that belongs to the id.
+     * @return The value that belongs to the id.
+     * @throw std::out_of_range If the index is not present in the Manager.
+     */
+    virtual String getValue(const IndexType) const;
+
+    /**
+     * @brief Returns the list of the ids.
+     * @return The list of the ids.
+     */
+    virtual IntVector getIDList() const;
+
+    /**
+     * @brief Returns the ordered list of the available ids without copying it.
+     * @return Reference to the list of the available ids.
+     */
+    virtual const IntVector& getIDs() const;
+
+    /**
+     * @brief Returns the list of the values.
+     * @return The list of the values.
+     */
+    virtual StringVector getValueList() const;
+
+    /**
+     * @brief Returns the value that belongs to the id.
+     * @return The value that belongs to the id.
+     * @throw std::out_of_range If the index is not present in the Manager.
+     */
+    virtual String operator[](const IndexType) const;
+
+    /**
+     * @brief Returns the id of the value.
+     * @return The id of the value.
+     * @throw std::out_of_range If the value is not present in the Manager.
+     */
+    virtual IndexType operator[](const String&) const;
+
+    /**
+     * @brief Returns the largest id.
+     * @return The largest id.
+     * @throw std::length_error If the manager is empty.
+     */
+    virtual IndexType getLastIndex() const;
+
+    /**
+     * @brief Returns the number of elements.
+     * @return The number of elements.
+     */
+    virtual IndexType size() const;
+
+    /**
+     * @brief Not supported, the manager is read-only.
+     * @throw Exception in every case.
+     */
+    virtual void add(const IndexType, const String&);
+
+    /**
+     * @brief Not supported, the manager is read-only.
+     * @throw Exception in every case.
+     */
+    virtual void add(const String&);
+
+    /**
+     * @brief Not supported, the manager is read-only.
+     * @throw Exception in every case.
+     */
+    virtual void remove(const IndexType);
+
+    /**
+     * @brief Not supported, the manager is read-only.
+     * @throw Exception in every case.
+     */
+    virtual void remove(const String&);
+
+    /**
+     * @brief Not supported, the manager is read-only.
+     * @throw Exception in every case.
+     */
+    virtual void clear();
+
+    /**
+     * @brief Writes the content of the manager to the out.
+     * @param out
+     */
+    virtual void save(io::CBinaryIO* out, const io::CSoDAio::ChunkID = io::CSoDAio::IDMANAGER) const;
+
+    /**
+     * @brief Not supported, the manager is read-only.
+     * @throw Exception in every case.
+     */
+    virtual void load(io::CBinaryIO* in);
+
+private:
+
+    /**
+     * @brief NIY Copy constructor.
+     */
+    CMappedIDManager(const CMappedIDManager&);
+
+    /**
+     * @brief NIY operator =.
+     * @return Reference to a CMappedIDManager object.
+     */
+    CMappedIDManager& operator=(const CMappedIDManager&);
+
+    /**
+     * @brief Returns the position of the id in m_ids or size() if it is not present.
+     */
+    IndexType findID(const IndexType id) const;
+
+    /**
+     * @brief Returns the position of the value in m_ids or size() if it is not present.
+     */
+    IndexType findValue(const String& value) const;
+
+private:
+
+    /**
+     * @brief The payload of the chunk.
+     */
+    const char* m_payload;
+
+    /**
+     * @brief The length of the payload.
+     */
+    unsigned long long m_length;
+
+    /**
+     * @brief The ids in increasing order.
+     */
+    IntVector* m_ids;
+
+    /**
+     * @brief The values in the order of m_ids, pointing into the payload.
+     */
+    std::vector<const char*>* m_values;
+
+    /**
+     * @brief Positions in m_ids ordered by the values.
+     */
+    IntVector* m_byValue;
+};
+
+} // namespace soda
+
+#endif /* CMAPPEDIDMANAGER_H */
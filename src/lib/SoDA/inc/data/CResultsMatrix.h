@@ -30,6 +30,10 @@
 
 namespace soda {
 
+namespace io {
+class CMappedSoDAio;
+}
+
 /**
  * @brief The CResultsMatrix class stores number of test results.
  */
@@ -119,6 +123,16 @@ public:
      */
     virtual const IBitList& getPassedBitList(const int revision) const;
 
+    /**
+     * @brief Copies the results of a revision into (getNumOfTestcases() + 63) / 64 words.
+     *        It can be called in parallel even if the matrices are compressed.
+     * @param revision  Revision number.
+     * @param executed  The word-packed execution bits indexed by the test case ids.
+     * @param passed  The word-packed passed bits indexed by the test case ids.
+     * @throw Exception if the revision does not exist.
+     */
+    virtual void copyResults(const int revision, WordType* executed, WordType* passed) const;
+
     /**
      * @brief Returns the result of the specified test.
      * @param revision  Revision number.
@@ -167,6 +181,15 @@ public:
      */
     virtual void setResult(const int revision, const IndexType testcaseID, const TestResultType result);
 
+    /**
+     * @brief Overwrites the results of a revision. Different revisions can be set in parallel
+     *        if the matrices are not compressed.
+     * @param revision  Revision number.
+     * @param executed  The word-packed execution bits indexed by the test case ids.
+     * @param passed  The word-packed passed bits indexed by the test case ids.
+     */
+    virtual void setResults(const int revision, const WordType* executed, const WordType* passed);
+
     /**
      * @brief Add or set the result of a specified test.
      * @param revision  Revision number.
@@ -194,6 +217,13 @@ public:
      */
     virtual void addTestcaseName(const String&);
 
+    /**
+     * @brief Replaces the bit matrices with CDeltaBitMatrix objects, which store only the changes
+     *        between the consecutive revisions. The results are saved in the same form.
+     * @throw Exception if the CResultsMatrix does not own its bit matrices.
+     */
+    virtual void compress();
+
     /**
      * @brief Writes the content of a CResultsMatrix to out.
      * @param out
@@ -213,11 +243,21 @@ public:
     virtual void save(const String& filename) const;
 
     /**
-     * @brief Loads the content of a CResultsMatrix from in.
+     * @brief Loads the content of a CResultsMatrix from in. The delta encoded bit matrices
+     *        are kept in CDeltaBitMatrix objects if the CResultsMatrix owns its bit matrices.
      * @param in
      */
     virtual void load(io::CSoDAio* in);
 
+    /**
+     * @brief Loads the content of a CResultsMatrix from a memory mapped file without copying the data.
+     *        The test case list and the bit matrices are replaced by read-only views,
+     *        which are valid while the file is mapped. The delta encoded bit matrices are decoded.
+     * @param in  Mapped input file.
+     * @throw Exception if the CResultsMatrix does not own its data or the file does not contain the required chunks.
+     */
+    virtual void load(io::CMappedSoDAio* in);
+
     /**
      * @brief Loads the content of a CResultsMatrix from a specified file.
      * @param filename  Specified file.
@@ -61,6 +61,13 @@ public:
      */
     T& getRevision(const RevNumType rev);
 
+    /**
+     * @brief Returns a const reference to the value of the specified revision number.
+     * @param rev  Specified revision number.
+     * @return Const reference to the value of the specified revision number.
+     */
+    const T& getRevision(const RevNumType rev) const;
+
     /**
      * @brief Adds a new element to the revision map with a specified revision number and data structure pair.
      * @param revNum  Specified revision number.
@@ -28,11 +28,14 @@
 #include "data/CCoverageMatrix.h"
 #include "data/CResultsMatrix.h"
 #include "data/CBugset.h"
+#include "data/CBitList.h"
 
 namespace soda {
 
 /**
  * @brief The CSelectionData class stores compatible coverage, changeset and results data together.
+ *        The id translations between the data are looked up in dense tables, which are rebuilt
+ *        after loading, globalize() and filterToCoverage(). Ids added later are translated by the mappers.
  */
 class CSelectionData {
 public:
@@ -129,6 +132,9 @@ public:
      * @return Translated coverage code element id.
      */
     inline IndexType translateCodeElementIdFromChangesetToCoverage(IndexType localFID) {
+        if (localFID < m_changesetToCoverageCodeElements->size() && (*m_changesetToCoverageCodeElements)[localFID] != CIDMapper::NO_ID) {
+            return (*m_changesetToCoverageCodeElements)[localFID];
+        }
         return m_coverageCodeElements->translateFromAnotherId(*m_changesetCodeElements, localFID);
     }
 
@@ -138,6 +144,9 @@ public:
      * @return Translated changeset code element id.
      */
     inline IndexType translateCodeElementIdFromCoverageToChangeset(IndexType localFID) {
+        if (localFID < m_coverageToChangesetCodeElements->size() && (*m_coverageToChangesetCodeElements)[localFID] != CIDMapper::NO_ID) {
+            return (*m_coverageToChangesetCodeElements)[localFID];
+        }
         return m_changesetCodeElements->translateFromAnotherId(*m_coverageCodeElements, localFID);
     }
 
@@ -147,6 +156,9 @@ public:
      * @return Translated coverage test case id.
      */
     inline IndexType translateTestcaseIdFromResultsToCoverage(IndexType localTID) {
+        if (localTID < m_resultsToCoverageTestcases->size() && (*m_resultsToCoverageTestcases)[localTID] != CIDMapper::NO_ID) {
+            return (*m_resultsToCoverageTestcases)[localTID];
+        }
         return m_coverageTestcases->translateFromAnotherId(*m_resultsTestcases, localTID);
     }
 
@@ -156,9 +168,24 @@ public:
      * @return Translated results test case id.
      */
     inline IndexType translateTestcaseIdFromCoverageToResults(IndexType localTID) {
+        if (localTID < m_coverageToResultsTestcases->size() && (*m_coverageToResultsTestcases)[localTID] != CIDMapper::NO_ID) {
+            return (*m_coverageToResultsTestcases)[localTID];
+        }
         return m_resultsTestcases->translateFromAnotherId(*m_coverageTestcases, localTID);
     }
 
+    /**
+     * @brief Copies the results of a revision into the order of the coverage test cases.
+     *        It only reads the translation tables, so it can be called in parallel. The tables
+     *        are built when the data is loaded, call buildTranslationTables() after the test cases
+     *        are changed directly.
+     * @param revision  Revision number.
+     * @param executed  Set to the execution bits of the coverage test cases. A test case is not
+     *                  executed if it is missing from the results.
+     * @param passed  Set to the passed bits of the coverage test cases.
+     */
+    virtual void getResultsInCoverageOrder(const int revision, CBitList& executed, CBitList& passed) const;
+
     /**
      * @brief Translates a specified test case name to a coverage test case id.
      * @param name  Test case name to be translated.
@@ -175,8 +202,16 @@ public:
 
     /**
      * @brief Filters changeset and results data which are not in the coverage data.
+     *        The changeset and results use the ids of the coverage code elements and test cases afterwards.
+     * @param numOfThreads  Number of threads used to copy the revisions, 0 means the number of hardware threads.
+     */
+    virtual void filterToCoverage(unsigned int numOfThreads = 1);
+
+    /**
+     * @brief Rebuilds the id translation tables from the mappers. It is called by the load
+     *        methods, globalize() and filterToCoverage().
      */
-    virtual void filterToCoverage();
+    void buildTranslationTables();
 
 protected:
 
@@ -234,6 +269,31 @@ protected:
      * @brief Stores bug report informations.
      */
     CBugset *m_bugs;
+
+    /**
+     * @brief Coverage code element ids indexed by the changeset code element ids.
+     */
+    IntVector *m_changesetToCoverageCodeElements;
+
+    /**
+     * @brief Changeset code element ids indexed by the coverage code element ids.
+     */
+    IntVector *m_coverageToChangesetCodeElements;
+
+    /**
+     * @brief Coverage test case ids indexed by the results test case ids.
+     */
+    IntVector *m_resultsToCoverageTestcases;
+
+    /**
+     * @brief Results test case ids indexed by the coverage test case ids.
+     */
+    IntVector *m_coverageToResultsTestcases;
+
+    /**
+     * @brief True if each coverage test case has the same id in the results.
+     */
+    bool m_sameTestcaseIds;
 };
 
 } /* namespace soda*/
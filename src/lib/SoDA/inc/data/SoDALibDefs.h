@@ -41,6 +41,7 @@ class CClusterDefinition;
 #endif
 
 typedef u_int64_t IndexType;
+typedef u_int64_t WordType;
 typedef unsigned int RevNumType;
 
 typedef CBitList BitList;
@@ -23,10 +23,13 @@
 #ifndef IBITMATRIX_H
 #define IBITMATRIX_H
 
+#include <algorithm>
+
 #include "io/CSoDAio.h"
 #include "io/CBitReader.h"
 #include "io/CBitWriter.h"
 #include "IBitList.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
@@ -139,6 +142,74 @@ public:
  * Inline methods *
  ******************/
 
+    /**
+     * @brief Returns the words of the given row if the matrix is stored in word-packed form.
+     *        The bits are stored LSB first, the unused bits of the last word are zero.
+     * @param row  Row number.
+     * @return Pointer to the first word of the row or null if the matrix is not word-packed.
+     */
+    virtual const WordType* getRowWords(IndexType) const
+    {
+        return 0;
+    }
+
+    /**
+     * @brief Copies the given row into CBitOperations::numOfWords(getNumOfCols()) words.
+     *        The bits are stored LSB first, the unused bits of the last word are zero.
+     * @param row  Row number.
+     * @param words  Pointer to the first word.
+     */
+    virtual void copyRowWords(IndexType row, WordType* words) const
+    {
+        IndexType numOfWords = CBitOperations::numOfWords(getNumOfCols());
+        const WordType* rowWords = getRowWords(row);
+        if (rowWords) {
+            std::copy(rowWords, rowWords + numOfWords, words);
+            return;
+        }
+        std::fill(words, words + numOfWords, WordType(0));
+        for (IndexType j = 0; j < getNumOfCols(); ++j) {
+            if (get(row, j)) {
+                words[j / CBitOperations::BITS_PER_WORD] |= WordType(1) << (j % CBitOperations::BITS_PER_WORD);
+            }
+        }
+    }
+
+    /**
+     * @brief Overwrites the given row from CBitOperations::numOfWords(getNumOfCols()) words.
+     * @param row  Row number.
+     * @param words  Pointer to the first word.
+     */
+    virtual void setRowWords(IndexType row, const WordType* words)
+    {
+        for (IndexType j = 0; j < getNumOfCols(); ++j) {
+            set(row, j, (words[j / CBitOperations::BITS_PER_WORD] >> (j % CBitOperations::BITS_PER_WORD)) & 1);
+        }
+    }
+
+    /**
+     * @brief Returns the words of every row. The rows of a matrix which is not word-packed are copied into buffer.
+     * @param buffer  Storage of the copied rows, it must live as long as the returned pointers are used.
+     * @return Pointers to the first word of the rows.
+     */
+    std::vector<const WordType*> getPackedRows(std::vector<WordType> &buffer) const
+    {
+        IndexType numOfRows = getNumOfRows();
+        IndexType numOfWords = CBitOperations::numOfWords(getNumOfCols());
+        std::vector<const WordType*> rows(numOfRows);
+        for (IndexType i = 0; i < numOfRows; ++i) {
+            rows[i] = getRowWords(i);
+            if (rows[i] == 0) {
+                if (buffer.empty()) {
+                    buffer.resize(numOfRows * numOfWords);
+                }
+                copyRowWords(i, buffer.data() + i * numOfWords);
+                rows[i] = buffer.data() + i * numOfWords;
+            }
+        }
+        return rows;
+    }
+
     /**
      * @brief Set the same value for the entire matrix.
      * @param value  Value to be set.
@@ -173,9 +244,15 @@ public:
 
         //Write the elements
         io::CBitWriter bo = io::CBitWriter(out);
-        for (IndexType i = 0; i < rows; ++i) {
-            for (IndexType j = 0; j < cols; ++j) {
-                bo.writeBit(get(i,j));
+        if (rows > 0 && getRowWords(0)) {
+            for (IndexType i = 0; i < rows; ++i) {
+                bo.writeWords(getRowWords(i), cols);
+            }
+        } else {
+            for (IndexType i = 0; i < rows; ++i) {
+                for (IndexType j = 0; j < cols; ++j) {
+                    bo.writeBit(get(i,j));
+                }
             }
         }
         bo.flush();
@@ -191,12 +268,20 @@ public:
         IndexType col = in->readULongLong8();
 
         resize(row, col);
-        setAll();
 
         io::CBitReader bi = io::CBitReader(in);
-        for (IndexType i = 0; i < row; i++) {
-            for (IndexType j = 0; j < col; j++) {
-                set(i, j, bi.readBit());
+        if (row > 0 && getRowWords(0)) {
+            std::vector<WordType> words(CBitOperations::numOfWords(col));
+            for (IndexType i = 0; i < row; i++) {
+                bi.readWords(words.data(), col);
+                setRowWords(i, words.data());
+            }
+        } else {
+            setAll();
+            for (IndexType i = 0; i < row; i++) {
+                for (IndexType j = 0; j < col; j++) {
+                    set(i, j, bi.readBit());
+                }
             }
         }
         bi.reset();
@@ -64,6 +64,12 @@ public:
      */
     virtual IntVector getIDList() const = 0;
 
+    /**
+     * @brief Returns the ordered list of the available ids without copying it.
+     * @return Reference to the list of the available ids, it is valid until the next modification.
+     */
+    virtual const IntVector& getIDs() const = 0;
+
     /**
      * @brief Returns the list of the available values.
      * @return The list of the available values.
@@ -55,6 +55,15 @@ public:
         return (m_buffer >> m_shift++) & 1;
     }
 
+    /**
+     * @brief Reads the given number of bits into words with one call to the input stream.
+     *        The bits are stored LSB first in the words, the unused bits of the last word are set to zero.
+     *        The result is the same as reading them with readBit().
+     * @param words  Pointer to the first word, must hold at least (bits + 63) / 64 words.
+     * @param bits  Number of bits to be read.
+     */
+    void readWords(WordType* words, IndexType bits);
+
     /**
      * @brief Resets the buffer of the bit reader.
      */
@@ -79,6 +88,11 @@ private:
      * @brief Buffer of readable data.
      */
     char          m_buffer;
+
+    /**
+     * @brief Byte buffer of readWords().
+     */
+    std::vector<char> m_bytes;
 };
 
 } /* namespace io */
@@ -64,6 +64,14 @@ public:
         }
     }
 
+    /**
+     * @brief Writes the first bits of the given words with one call to the output stream.
+     *        The bits are stored LSB first in the words, the result is the same as writing them with writeBit().
+     * @param words  Pointer to the first word.
+     * @param bits  Number of bits to be written.
+     */
+    void writeWords(const WordType* words, IndexType bits);
+
     /**
      * @brief Writes the content of the buffer to the output stream immediately.
      */
@@ -90,6 +98,11 @@ private:
      * @brief Buffer of writable data.
      */
     char          m_buffer;
+
+    /**
+     * @brief Byte buffer of writeWords().
+     */
+    std::vector<char> m_bytes;
 };
 
 } /* namespace io */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CDELTACODER_H
+#define CDELTACODER_H
+
+#include <vector>
+
+#include "data/SoDALibDefs.h"
+
+namespace soda { namespace io {
+
+/**
+ * @brief The CDeltaCoder class encodes increasing positions as the LEB128 varints
+ *        of the differences of the consecutive positions.
+ */
+class CDeltaCoder {
+public:
+
+    /**
+     * @brief Returns the number of bytes of the encoded positions.
+     * @param indices  Increasing positions.
+     * @return Size of the encoded data.
+     */
+    static IndexType predictSize(const IntVector &indices);
+
+    /**
+     * @brief Encodes the positions into the buffer.
+     * @param indices  Increasing positions.
+     * @param buffer  Output buffer, it is only enlarged if needed.
+     * @return The number of bytes written to the buffer.
+     */
+    static IndexType encode(const IntVector &indices, std::vector<unsigned char> &buffer);
+
+    /**
+     * @brief Decodes count positions encoded by encode().
+     * @param data  Encoded data.
+     * @param size  Size of the data.
+     * @param count  Number of positions.
+     * @param indices  The decoded positions.
+     * @return False if the data ends before count positions.
+     */
+    static bool decode(const unsigned char *data, IndexType size, IndexType count, IntVector &indices);
+};
+
+} /* namespace io */
+
+} /* namespace soda */
+
+#endif /* CDELTACODER_H */
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CMAPPEDSODAIO_H
+#define CMAPPEDSODAIO_H
+
+#include "io/CSoDAio.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace soda { namespace io {
+
+/**
+ * @brief The CMappedSoDAio class is a read-only, memory mapped view of a SoDA file.
+ *        The chunks are indexed once when the file is opened, the payloads can be accessed without copying.
+ *        The data structures created over the mapped payloads are valid until the file is closed.
+ */
+class CMappedSoDAio {
+public:
+
+    /**
+     * @brief Position of a chunk in the mapped file.
+     */
+    struct ChunkInfo {
+        CSoDAio::ChunkID id;
+        unsigned long long offset;
+        unsigned long long length;
+    };
+
+    /**
+     * @brief Constructor, creates an empty CMappedSoDAio.
+     */
+    CMappedSoDAio();
+
+    /**
+     * @brief Creates a CMappedSoDAio object and maps the given file.
+     * @param filename File name.
+     * @throw CIOException if the file can not be mapped or it is not a SoDA file.
+     */
+    CMappedSoDAio(const char* filename);
+
+    /**
+     * @brief Creates a CMappedSoDAio object and maps the given file.
+     * @param filename File name.
+     * @throw CIOException if the file can not be mapped or it is not a SoDA file.
+     */
+    CMappedSoDAio(const String& filename);
+
+    /**
+     * @brief Destroys a CMappedSoDAio object and unmaps the file.
+     */
+    ~CMappedSoDAio();
+
+    /**
+     * @brief Maps a file and indexes its chunks, if a file is already mapped then it will be closed.
+     * @param filename File name.
+     * @throw CIOException if the file can not be mapped or it is not a SoDA file.
+     */
+    void open(const char* filename);
+
+    /**
+     * @brief Maps a file and indexes its chunks, if a file is already mapped then it will be closed.
+     * @param filename File name.
+     * @throw CIOException if the file can not be mapped or it is not a SoDA file.
+     */
+    void open(const String& filename);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Returns true if a file is mapped.
+     * @return True if a file is mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Returns the index of the chunks in file order.
+     * @return Chunk index.
+     */
+    const std::vector<ChunkInfo>& getChunks() const;
+
+    /**
+     * @brief Steps to the next chunk.
+     * @return False if there are no more chunks.
+     */
+    bool nextChunkID();
+
+    /**
+     * @brief Steps to the first chunk with the given type.
+     * @param chunkID  Type of the chunk.
+     * @return False if there is no such chunk.
+     */
+    bool findChunkID(CSoDAio::ChunkID chunkID);
+
+    /**
+     * @brief Returns the type of the current chunk.
+     * @return Type of the current chunk.
+     */
+    CSoDAio::ChunkID getChunkID() const;
+
+    /**
+     * @brief Returns the length of the current chunk.
+     * @return Length of the current chunk.
+     */
+    unsigned long long getActualLength() const;
+
+    /**
+     * @brief Returns the payload of the current chunk.
+     * @return Pointer to the first byte of the payload.
+     */
+    const char* getChunkData() const;
+
+private:
+
+    /**
+     * @brief NIY Copy constructor.
+     */
+    CMappedSoDAio(const CMappedSoDAio&);
+
+    /**
+     * @brief NIY operator =.
+     * @return Reference to a CMappedSoDAio object.
+     */
+    CMappedSoDAio& operator=(const CMappedSoDAio&);
+
+    /**
+     * @brief Builds the chunk index.
+     */
+    void indexChunks();
+
+private:
+
+    /**
+     * @brief The mapped file.
+     */
+    boost::interprocess::file_mapping* m_mapping;
+
+    /**
+     * @brief The mapped region of the file.
+     */
+    boost::interprocess::mapped_region* m_region;
+
+    /**
+     * @brief First byte of the mapped file.
+     */
+    const char* m_base;
+
+    /**
+     * @brief Size of the mapped file.
+     */
+    unsigned long long m_size;
+
+    /**
+     * @brief Chunk index.
+     */
+    std::vector<ChunkInfo>* m_chunks;
+
+    /**
+     * @brief Position of the current chunk in the index.
+     */
+    size_t m_current;
+};
+
+} /* namespace io */
+
+} /* namespace soda */
+
+#endif /* CMAPPEDSODAIO_H */
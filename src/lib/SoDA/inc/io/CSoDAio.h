@@ -23,6 +23,7 @@
 #ifndef CSODAIO_H
 #define CSODAIO_H
 
+#include <vector>
 #include "io/CBinaryIO.h"
 #include "data/SoDALibDefs.h"
 
@@ -71,9 +72,18 @@ public:
         CHANGESET,
         CODEELEMENT_TRACE,
         REVLIST,
-        BUGSET
+        BUGSET,
+        DIRECTORY,
+        CHANGESET_DELTA,
+        EXECUTION_DELTA,
+        PASSED_DELTA
     };
 
+    /**
+     * @brief Version of the chunk directory written by this implementation.
+     */
+    static const unsigned int DIRECTORY_VERSION;
+
     /**
      * @brief Opens a file, if a file is already opened than it'll close that file.
      * @param filename File name.
@@ -119,8 +129,40 @@ public:
      */
     bool findChunkID(ChunkID chunkID);
 
+    /**
+     * @brief Sets whether a chunk directory is appended to the file when it is closed in omWrite mode.
+     *        The directory is written by default.
+     * @param write True if the directory should be written.
+     */
+    void setWriteDirectory(bool write);
+
+    /**
+     * @brief Returns true if the file opened in omRead mode has a valid chunk directory.
+     * @return True if findChunkID() can seek directly to the chunks.
+     */
+    bool hasDirectory() const;
+
+    /**
+     * @brief Returns the real length of a chunk. Older versions of CRevision::save() did not count
+     *        the number of elements in the length of the REVISIONS chunk, this method corrects it.
+     * @param chunkID Chunk id.
+     * @param length Length stored in the chunk header.
+     * @param count The first 4 bytes of the chunk data.
+     * @return Length of the chunk data.
+     */
+    static unsigned long long int correctLength(ChunkID chunkID, unsigned long long int length, unsigned int count);
+
 private:
 
+    /**
+     * @brief Location of a chunk in the file.
+     */
+    struct DirectoryEntry {
+        ChunkID id;
+        unsigned long long int offset;
+        unsigned long long int length;
+    };
+
     /**
      * @brief Identifier of the file chunk.
      */
@@ -136,6 +178,26 @@ private:
      */
     std::streampos m_lastpos;
 
+    /**
+     * @brief Name of the opened file.
+     */
+    String m_filename;
+
+    /**
+     * @brief Size of the file opened in omRead mode.
+     */
+    unsigned long long int m_fileSize;
+
+    /**
+     * @brief True if the directory is written on close.
+     */
+    bool m_writeDirectory;
+
+    /**
+     * @brief Chunk directory of the file opened in omRead mode, NULL if the file has no directory.
+     */
+    std::vector<DirectoryEntry>* m_directory;
+
 private:
 
     /**
@@ -156,12 +218,33 @@ private:
      */
     static const unsigned int SoDA_MAGIC;
 
+    /**
+     * @brief Identifier of the chunk directory at the end of SoDA files.
+     */
+    static const unsigned int DIRECTORY_MAGIC;
+
     /**
      * @brief Checks if the current file with the specified open mode is a standard SoDA file.
      * @throw Exception if file magic number is not equal to SoDA magic number.
      * @throw Exception at invalid open mode.
      */
     void checkOpened(io::CBinaryIO::eOpenMode);
+
+    /**
+     * @brief Loads the chunk directory from the end of the file if there is a valid one.
+     */
+    void readDirectory();
+
+    /**
+     * @brief Appends the chunk directory to the closed file.
+     */
+    void writeDirectory();
+
+    /**
+     * @brief Seeks to the end of the current chunk.
+     * @throw Exception at unexpected end of file.
+     */
+    void skipChunk();
 };
 
 } /* namespace io */
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CXMLREADER_H
+#define CXMLREADER_H
+
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "data/SoDALibDefs.h"
+
+namespace soda { namespace io {
+
+/**
+ * @brief The CXmlReader class is a forward only, streaming reader of memory mapped XML files.
+ *        The elements and comments are returned one by one without building a tree, so the memory
+ *        used by the reader does not depend on the size of the file.
+ *        Processing instructions, the document type declaration, texts and CDATA sections are skipped.
+ *        An empty element (e.g. <counter/>) is returned as a start and an end element.
+ */
+class CXmlReader {
+public:
+
+    /**
+     * @brief The type of the current node.
+     */
+    typedef enum {
+        ntNone = 0,
+        ntStartElement,
+        ntEndElement,
+        ntComment
+    } eNodeType;
+
+    /**
+     * @brief Constructor, creates an empty CXmlReader.
+     */
+    CXmlReader();
+
+    /**
+     * @brief Creates a CXmlReader object and maps the given file.
+     * @param filename File name.
+     * @throw CIOException if the file can not be mapped.
+     */
+    CXmlReader(const String& filename);
+
+    /**
+     * @brief Destroys a CXmlReader object and unmaps the file.
+     */
+    ~CXmlReader();
+
+    /**
+     * @brief Maps a file, if a file is already mapped then it will be closed.
+     * @param filename File name.
+     * @throw CIOException if the file can not be mapped.
+     */
+    void open(const String& filename);
+
+    /**
+     * @brief Unmaps the file.
+     */
+    void close();
+
+    /**
+     * @brief Returns true if a file is mapped.
+     * @return True if a file is mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Steps to the next element or comment.
+     * @return False at the end of the document.
+     * @throw CIOException if the document is not well-formed, e.g. an end tag does not match the open element.
+     */
+    bool next();
+
+    /**
+     * @brief Returns the type of the current node.
+     * @return Type of the current node.
+     */
+    eNodeType getNodeType() const;
+
+    /**
+     * @brief Returns the number of the elements enclosing the current node.
+     * @return Depth of the current node, 0 for the root element and the top-level comments.
+     */
+    IndexType getDepth() const;
+
+    /**
+     * @brief Returns the name of the current element.
+     * @return Element name.
+     */
+    const String& getName() const;
+
+    /**
+     * @brief Returns the text of the current comment.
+     * @return Comment text.
+     */
+    const String& getComment() const;
+
+    /**
+     * @brief Returns true if the current element is named name.
+     * @param name Element name.
+     * @return True if the current element is named name.
+     */
+    bool isElement(const char* name) const;
+
+    /**
+     * @brief Reads an attribute of the current start element. The entity and character references are replaced.
+     * @param name Attribute name.
+     * @param value The value of the attribute.
+     * @return False if the element has no such attribute.
+     */
+    bool getAttribute(const char* name, String& value) const;
+
+    /**
+     * @brief Returns an attribute of the current start element.
+     * @param name Attribute name.
+     * @return The value of the attribute.
+     * @throw CIOException if the element has no such attribute.
+     */
+    String getAttribute(const char* name) const;
+
+    /**
+     * @brief Returns true if the current start element has an attribute with the given value.
+     * @param name Attribute name.
+     * @param value Expected value.
+     * @return True if the attribute exists and has the given value.
+     */
+    bool hasAttributeValue(const char* name, const char* value) const;
+
+private:
+
+    /**
+     * @brief NIY Copy constructor.
+     */
+    CXmlReader(const CXmlReader&);
+
+    /**
+     * @brief NIY operator =.
+     * @return Reference to a CXmlReader object.
+     */
+    CXmlReader& operator=(const CXmlReader&);
+
+    /**
+     * @brief Position of an attribute in the mapped file.
+     */
+    struct Attribute {
+        const char* name;
+        size_t nameLength;
+        const char* value;
+        size_t valueLength;
+    };
+
+    /**
+     * @brief Finds the raw value of an attribute of the current element.
+     */
+    const Attribute* findAttribute(const char* name) const;
+
+    /**
+     * @brief Reads a start or end tag starting after the '<' character.
+     */
+    void readTag();
+
+    /**
+     * @brief Moves the position after the given terminator.
+     */
+    void skipPast(const char* terminator);
+
+private:
+
+    /**
+     * @brief The mapped file.
+     */
+    boost::interprocess::file_mapping* m_mapping;
+
+    /**
+     * @brief The mapped region of the file.
+     */
+    boost::interprocess::mapped_region* m_region;
+
+    /**
+     * @brief Current position in the mapped file.
+     */
+    const char* m_pos;
+
+    /**
+     * @brief End of the mapped file.
+     */
+    const char* m_end;
+
+    /**
+     * @brief Type of the current node.
+     */
+    eNodeType m_nodeType;
+
+    /**
+     * @brief Depth of the current node.
+     */
+    IndexType m_depth;
+
+    /**
+     * @brief Names of the open elements, the innermost is the last one.
+     */
+    StringVector* m_openElements;
+
+    /**
+     * @brief True if the current start element is empty, so the next node is its end element.
+     */
+    bool m_emptyElement;
+
+    /**
+     * @brief Name of the current element or text of the current comment.
+     */
+    String* m_name;
+
+    /**
+     * @brief Attributes of the current start element.
+     */
+    std::vector<Attribute>* m_attributes;
+};
+
+} /* namespace io */
+
+} /* namespace soda */
+
+#endif /* CXMLREADER_H */
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CBITOPERATIONS_H
+#define CBITOPERATIONS_H
+
+#include "data/SoDALibDefs.h"
+
+namespace soda {
+
+/**
+ * @brief The CBitOperations class implements the word level kernels of the word-packed bit containers.
+ *        The bits are stored LSB first in the words, the unused bits of the last word must be zero.
+ *        The best implementation (AVX-512, AVX2 or generic) is selected at runtime by the CPU features.
+ */
+class CBitOperations
+{
+public:
+
+    /**
+     * @brief Number of bits stored in one word.
+     */
+    static const IndexType BITS_PER_WORD = 64;
+
+    /**
+     * @brief Returns the number of words needed to store the given number of bits.
+     * @param bits  Number of bits.
+     * @return Number of words.
+     */
+    static inline IndexType numOfWords(IndexType bits)
+    {
+        return (bits + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    }
+
+    /**
+     * @brief Returns the mask of the used bits in the last word of a list with the given number of bits.
+     * @param bits  Number of bits.
+     * @return Mask of the used bits in the last word.
+     */
+    static inline WordType lastWordMask(IndexType bits)
+    {
+        return (bits % BITS_PER_WORD) ? ((WordType(1) << (bits % BITS_PER_WORD)) - 1) : ~WordType(0);
+    }
+
+    /**
+     * @brief Returns the number of 1 bits in a word.
+     * @param word  The word.
+     * @return Number of 1 bits.
+     */
+    static inline unsigned int popcount(WordType word)
+    {
+#if defined(__GNUC__)
+        return __builtin_popcountll(word);
+#else
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    /**
+     * @brief Returns the index of the lowest 1 bit of a non-zero word.
+     * @param word  The word, must not be zero.
+     * @return Index of the lowest 1 bit.
+     */
+    static inline unsigned int lowestBit(WordType word)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        unsigned int index = 0;
+        while (!(word & 1)) {
+            word >>= 1;
+            index++;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * @brief Returns the number of 1 bits in the given words.
+     * @param words  Pointer to the first word.
+     * @param n  Number of words.
+     * @return Number of 1 bits.
+     */
+    static IndexType count(const WordType* words, IndexType n);
+
+    /**
+     * @brief Returns the number of 1 bits in (a AND b).
+     * @param a  Pointer to the first word of the first operand.
+     * @param b  Pointer to the first word of the second operand.
+     * @param n  Number of words.
+     * @return Number of 1 bits in the intersection.
+     */
+    static IndexType countAnd(const WordType* a, const WordType* b, IndexType n);
+
+    /**
+     * @brief Returns the number of 1 bits in (a XOR b), i.e. the Hamming distance of the operands.
+     * @param a  Pointer to the first word of the first operand.
+     * @param b  Pointer to the first word of the second operand.
+     * @param n  Number of words.
+     * @return Number of different bits.
+     */
+    static IndexType countXor(const WordType* a, const WordType* b, IndexType n);
+
+    /**
+     * @brief Computes dst = a AND b. The destination can be the same as one of the operands.
+     * @param dst  Destination words.
+     * @param a  First operand.
+     * @param b  Second operand.
+     * @param n  Number of words.
+     */
+    static void bitwiseAnd(WordType* dst, const WordType* a, const WordType* b, IndexType n);
+
+    /**
+     * @brief Computes dst = a OR b. The destination can be the same as one of the operands.
+     * @param dst  Destination words.
+     * @param a  First operand.
+     * @param b  Second operand.
+     * @param n  Number of words.
+     */
+    static void bitwiseOr(WordType* dst, const WordType* a, const WordType* b, IndexType n);
+
+    /**
+     * @brief Computes dst = a XOR b. The destination can be the same as one of the operands.
+     * @param dst  Destination words.
+     * @param a  First operand.
+     * @param b  Second operand.
+     * @param n  Number of words.
+     */
+    static void bitwiseXor(WordType* dst, const WordType* a, const WordType* b, IndexType n);
+
+    /**
+     * @brief Computes dst = a AND NOT b. The destination can be the same as one of the operands.
+     * @param dst  Destination words.
+     * @param a  First operand.
+     * @param b  Second operand.
+     * @param n  Number of words.
+     */
+    static void bitwiseAndNot(WordType* dst, const WordType* a, const WordType* b, IndexType n);
+
+    /**
+     * @brief Transposes a 64x64 bit block in place: bit c of word r is swapped with bit r of word c.
+     * @param block  The 64 words of the block.
+     */
+    static void transposeBlock(WordType* block);
+
+    /**
+     * @brief Returns the name of the implementation selected for the current CPU.
+     * @return One of "avx512", "avx2" or "generic".
+     */
+    static const char* getKernelName();
+};
+
+} // namespace soda
+
+#endif /* CBITOPERATIONS_H */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CCOVERAGESPECTRUM_H
+#define CCOVERAGESPECTRUM_H
+
+#include "data/CBitList.h"
+#include "data/CSelectionData.h"
+#include "interface/IBitMatrix.h"
+
+namespace soda {
+
+/**
+ * @brief The CCoverageSpectrum class computes the program spectrum of code elements:
+ *        the number of failed and passed test cases which cover (ef, ep) or do not cover (nf, np) them.
+ *        The coverage of the test cases is transposed into word-packed columns, so the counts of a code element
+ *        are computed as popcount(column AND failed mask) and popcount(column AND passed mask).
+ */
+class CCoverageSpectrum
+{
+public:
+
+    /**
+     * @brief Constructor, creates an empty CCoverageSpectrum object.
+     */
+    CCoverageSpectrum();
+
+    /**
+     * @brief Destroys a CCoverageSpectrum object.
+     */
+    ~CCoverageSpectrum();
+
+    /**
+     * @brief Computes the spectrum of the code elements using the test cases executed in the revision.
+     * @param data  The test suite data.
+     * @param revision  The revision of the results.
+     * @param testcases  Coverage ids of the test cases.
+     * @param codeElements  Coverage ids of the code elements.
+     */
+    void compute(CSelectionData& data, RevNumType revision, const IntVector& testcases, const IntVector& codeElements);
+
+    /**
+     * @brief Computes the spectrum of the code elements.
+     * @param coverage  The coverage matrix, its rows are the test cases.
+     * @param testcases  Rows of the executed test cases.
+     * @param failed  The i-th bit is set if the i-th test case is failed.
+     * @param codeElements  Columns of the code elements.
+     */
+    void compute(const IBitMatrix& coverage, const IntVector& testcases, const CBitList& failed, const IntVector& codeElements);
+
+    /**
+     * @brief Returns the number of failed test cases covering the code elements.
+     * @return The values in the order of the code elements.
+     */
+    const IntVector& getEf() const;
+
+    /**
+     * @brief Returns the number of passed test cases covering the code elements.
+     * @return The values in the order of the code elements.
+     */
+    const IntVector& getEp() const;
+
+    /**
+     * @brief Returns the number of failed test cases not covering the code elements.
+     * @return The values in the order of the code elements.
+     */
+    const IntVector& getNf() const;
+
+    /**
+     * @brief Returns the number of passed test cases not covering the code elements.
+     * @return The values in the order of the code elements.
+     */
+    const IntVector& getNp() const;
+
+    /**
+     * @brief Returns the number of failed test cases.
+     * @return Number of failed test cases.
+     */
+    IndexType getNumOfFailed() const;
+
+    /**
+     * @brief Returns the number of passed test cases.
+     * @return Number of passed test cases.
+     */
+    IndexType getNumOfPassed() const;
+
+private:
+
+    /**
+     * @brief Number of failed test cases covering the code elements.
+     */
+    IntVector* m_ef;
+
+    /**
+     * @brief Number of passed test cases covering the code elements.
+     */
+    IntVector* m_ep;
+
+    /**
+     * @brief Number of failed test cases not covering the code elements.
+     */
+    IntVector* m_nf;
+
+    /**
+     * @brief Number of passed test cases not covering the code elements.
+     */
+    IntVector* m_np;
+
+    /**
+     * @brief Number of failed test cases.
+     */
+    IndexType m_failed;
+
+    /**
+     * @brief Number of passed test cases.
+     */
+    IndexType m_passed;
+
+private:
+
+    /**
+     * @brief NIY copy constructor.
+     */
+    CCoverageSpectrum(const CCoverageSpectrum&);
+
+    /**
+     * @brief NIY operator =.
+     */
+    CCoverageSpectrum& operator=(const CCoverageSpectrum&);
+};
+
+} // namespace soda
+
+#endif /* CCOVERAGESPECTRUM_H */
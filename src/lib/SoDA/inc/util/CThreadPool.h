@@ -0,0 +1,92 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CTHREADPOOL_H
+#define CTHREADPOOL_H
+
+#include <boost/function.hpp>
+
+#include "data/SoDALibDefs.h"
+
+namespace soda {
+
+/**
+ * @brief The CThreadPool class runs independent tasks on multiple threads.
+ *        The tasks are identified by their index and are distributed dynamically between the threads.
+ *        The worker threads are started by the first parallel run and wait for the next run
+ *        until the pool is destroyed, the calling thread of run() works on the tasks as well.
+ */
+class CThreadPool
+{
+public:
+
+    /**
+     * @brief Creates a thread pool.
+     * @param numOfThreads  Number of threads, 0 means the number of hardware threads.
+     */
+    explicit CThreadPool(unsigned int numOfThreads = 0);
+
+    /**
+     * @brief Stops and joins the worker threads.
+     */
+    ~CThreadPool();
+
+    /**
+     * @brief Returns the number of threads.
+     * @return Number of threads.
+     */
+    unsigned int getNumOfThreads() const;
+
+    /**
+     * @brief Runs task(0) ... task(numOfTasks - 1) and waits for all of them.
+     *        If a task throws an exception, the remaining tasks are not started and the first exception is rethrown.
+     *        A run started while another run of the pool is in progress (e.g. from a task) runs its tasks on the calling thread.
+     * @param numOfTasks  Number of tasks.
+     * @param task  The function called with the index of the task.
+     */
+    void run(IndexType numOfTasks, const boost::function<void (IndexType)> &task);
+
+private:
+
+    struct SharedState;
+
+    CThreadPool(const CThreadPool&);
+    CThreadPool& operator=(const CThreadPool&);
+
+    /**
+     * @brief The loop of a worker thread.
+     */
+    void work();
+
+    /**
+     * @brief Number of threads.
+     */
+    unsigned int m_numOfThreads;
+
+    /**
+     * @brief The state shared with the worker threads.
+     */
+    SharedState *m_state;
+};
+
+} // namespace soda
+
+#endif /* CTHREADPOOL_H */
@@ -19,13 +19,65 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
-#include <iostream>
 #include <map>
 
 #include "algorithm/CPartitionAlgorithm.h"
+#include "util/CBitOperations.h"
+#include "util/CThreadPool.h"
 
 namespace soda {
 
+namespace {
+
+/**
+ * @brief Minimal number of column words hashed by one task.
+ */
+const IndexType MIN_WORDS_PER_TASK = 64;
+
+/**
+ * @brief Marks the empty slots of the hash table.
+ */
+const IndexType NO_CLASS = (IndexType)-1;
+
+/**
+ * @brief Code elements with the same coverage column.
+ */
+struct ColumnClass {
+    IndexType representative;
+    IndexType indexSum;
+    IndexType minPosition;
+    IndexType maxPosition;
+    IndexType partitionId;
+};
+
+/**
+ * @brief The splitmix64 finalizer, used to derive the random keys of the test cases.
+ */
+inline WordType mix(WordType x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline bool isSet(const WordType* row, IndexType cid)
+{
+    return (row[cid / CBitOperations::BITS_PER_WORD] >> (cid % CBitOperations::BITS_PER_WORD)) & 1;
+}
+
+bool sameColumn(const std::vector<const WordType*> &rows, IndexType a, IndexType b)
+{
+    for (IndexType j = 0; j < rows.size(); j++) {
+        if (isSet(rows[j], a) != isSet(rows[j], b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
 CPartitionAlgorithm::CPartitionAlgorithm() :
     m_partitionInfo(new PartitionInfo()),
     m_partitions(new PartitionData())
@@ -38,131 +90,142 @@ CPartitionAlgorithm::~CPartitionAlgorithm()
     delete m_partitions;
 }
 
-void CPartitionAlgorithm::compute(CSelectionData &data, CClusterDefinition &cluster)
+void CPartitionAlgorithm::compute(CSelectionData &data, CClusterDefinition &cluster, unsigned int numOfThreads)
 {
-    // std::cerr << "[INFO] Partitioning started for " << cluster.getTestCases().size() << " tests." << std::endl;
+    m_partitionInfo->clear();
+    m_partitions->clear();
+
     CCoverageMatrix *coverage = data.getCoverage();
-    //std::map<IndexType, IndexType> tcMap;
+    const IBitMatrix &matrix = coverage->getBitMatrix();
 
     IntVector testCaseIds = cluster.getTestCases();
     IntVector codeElementIds = cluster.getCodeElements();
-
-    /*for (IndexType i = 0; i < testCaseIds.size(); i++) {
-        tcMap[testCaseIds[i]] = data.translateTestcaseIdFromCoverageToResults(testCaseIds[i]);
-    }*/
-
-    std::map<IndexType, std::vector<bool> > coverageMap;
-
-    // The number of tests that covers the code elements respectively.
-    std::map<IndexType, IndexType> S;
-    // The sum of indices of test cases in the matrix that cover code elements.
-    std::multimap<IndexType, IndexType> SI;
-
-    IndexType cnt = 0;
-    for (IndexType i = 0; i < codeElementIds.size(); i++) {
-
-        if (cnt == 1000) {
-            cnt = 0;
-            (std::cerr << "[INFO] Preprocessing code element: " << i << "\r").flush();
+    IndexType nofTests = testCaseIds.size();
+    IndexType nofPositions = codeElementIds.size();
+    IndexType nofCodeElements = coverage->getNumOfCodeElements();
+    IndexType nofWords = CBitOperations::numOfWords(nofCodeElements);
+
+    // The rows of the test cases, copied if the matrix is not word-packed.
+    std::vector<const WordType*> rows(nofTests);
+    std::vector<WordType> copiedRows;
+    for (IndexType j = 0; j < nofTests; j++) {
+        rows[j] = matrix.getRowWords(testCaseIds[j]);
+        if (rows[j] == NULL) {
+            if (copiedRows.empty()) {
+                copiedRows.resize(nofTests * nofWords);
+            }
+            matrix.copyRowWords(testCaseIds[j], copiedRows.data() + j * nofWords);
+            rows[j] = copiedRows.data() + j * nofWords;
         }
+    }
 
-        IndexType cid = codeElementIds[i];
-
-        IndexType sum = 0;
-        IndexType indexSum = 0;
-
-        // Count the number of tests covering this code element and
-        // summarize these test case ids.
-        for (IndexType j = 0; j < testCaseIds.size(); j++) {
+    // The 128 bit hash of a column is the sum of the random keys of the covering test cases.
+    // The sum of the indices of the covering test cases is used for ordering the partitions.
+    std::vector<WordType> hashLow(nofCodeElements, 0);
+    std::vector<WordType> hashHigh(nofCodeElements, 0);
+    IntVector indexSums(nofCodeElements, 0);
+
+    CThreadPool pool(numOfThreads);
+    IndexType nofTasks = std::min<IndexType>(pool.getNumOfThreads(), (nofWords + MIN_WORDS_PER_TASK - 1) / MIN_WORDS_PER_TASK);
+    pool.run(nofTasks, [&](IndexType task) {
+        IndexType begin = task * nofWords / nofTasks;
+        IndexType end = (task + 1) * nofWords / nofTasks;
+        for (IndexType j = 0; j < nofTests; j++) {
             IndexType tcid = testCaseIds[j];
-            if (coverage->getBitMatrix().get(tcid, cid)) {
-                sum++;
-                indexSum += (tcid + 1);
+            WordType keyLow = mix(2 * tcid);
+            WordType keyHigh = mix(2 * tcid + 1);
+            for (IndexType w = begin; w < end; w++) {
+                for (WordType word = rows[j][w]; word; word &= word - 1) {
+                    IndexType cid = w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word);
+                    hashLow[cid] += keyLow;
+                    hashHigh[cid] += keyHigh;
+                    indexSums[cid] += tcid + 1;
+                }
+            }
+        }
+    });
+
+    // Group the code elements by their hash, the columns are compared only if the hashes are equal.
+    std::vector<ColumnClass> classes;
+    IntVector classOfPosition(nofPositions);
+    IndexType tableSize = 16;
+    while (tableSize < nofPositions * 2) {
+        tableSize *= 2;
+    }
+    IntVector table(tableSize, NO_CLASS);
+    IndexType mask = tableSize - 1;
+    for (IndexType i = 0; i < nofPositions; i++) {
+        IndexType cid = codeElementIds[i];
+        for (IndexType slot = hashLow[cid] & mask; ; slot = (slot + 1) & mask) {
+            IndexType classId = table[slot];
+            if (classId == NO_CLASS) {
+                ColumnClass newClass = { cid, indexSums[cid], i, i, 0 };
+                classOfPosition[i] = table[slot] = classes.size();
+                classes.push_back(newClass);
+                break;
+            }
+            ColumnClass &columnClass = classes[classId];
+            IndexType rep = columnClass.representative;
+            if (hashLow[rep] == hashLow[cid] && hashHigh[rep] == hashHigh[cid] && indexSums[rep] == indexSums[cid] &&
+                    sameColumn(rows, rep, cid)) {
+                columnClass.maxPosition = i;
+                classOfPosition[i] = classId;
+                break;
             }
-            coverageMap[cid].push_back(coverage->getBitMatrix().get(tcid, cid));
         }
-        //std::cerr << "[Partition] " << " Sum of cid(" << cid << "):" << sum << std::endl;
-        S[cid] = sum;
-
-        SI.insert(std::pair<IndexType, IndexType>(indexSum, cid));
-
-        cnt++;
     }
 
-    //std::cerr << std::endl << "[INFO] Preprocessing finished." << std::endl;
-    //std::cerr << std::endl << "[INFO] Started the partitioning..." << std::endl;
-
+    // The partitions are numbered by the descending index sums. The classes with the same index sum
+    // are numbered alternately by their last and first code element in the cluster, as the
+    // classes were found by the previous, multimap based implementation.
+    IntVector order(classes.size());
+    for (IndexType c = 0; c < classes.size(); c++) {
+        order[c] = c;
+    }
+    std::sort(order.begin(), order.end(), [&](IndexType a, IndexType b) {
+        return classes[a].indexSum > classes[b].indexSum;
+    });
 
-    partition_info pInfo;
     IndexType partitionId = 1;
-
-    cnt = 0;
-
-    // std::cerr << "[Partition] " << " SI.size(): " << SI.size() << std::endl;
-
-    while (!SI.empty()) {
-        cnt++;
-        if (cnt == 1000) {
-            cnt = 0;
-            (std::cerr << "[INFO] Partitioning. Code elements left: " << SI.size() << "\r").flush();
+    std::vector<bool> numbered(classes.size(), false);
+    for (IndexType begin = 0; begin < order.size(); ) {
+        IndexType end = begin + 1;
+        while (end < order.size() && classes[order[end]].indexSum == classes[order[begin]].indexSum) {
+            end++;
         }
 
-        // Get the element with biggest indexSum.
-        std::multimap<IndexType, IndexType>::reverse_iterator it;
-
-        it = SI.rbegin();
-        IndexType cid = it->second;
-        IndexType sum = it->first;
-        SI.erase(--it.base());
-
-
-        pInfo.cid = cid;
-        pInfo.partitionId = partitionId;
-        m_partitionInfo->push_back(pInfo);
-        (*m_partitions)[partitionId].insert(cid);
-        // std::cerr << "[Partition]" << " cid(" << cid << "): " << partitionId << std::endl;
-
-        std::vector<IndexType> tmp;
-
-        while (!SI.empty() && SI.rbegin()->first == sum) {
-            cnt++;
-            if (cnt == 1000) {
-                cnt = 0;
-                (std::cerr << "[INFO] Partitioning. Code elements left: " << SI.size() << "\r").flush();
-            }
-
-            it = SI.rbegin();
-            IndexType iCid = it->second;
-            SI.erase(--it.base());
-            if (S[iCid] == 0) {
-                // We do not need to compare the coverage vector of the code elements because they are not covered at all.
-                pInfo.cid = iCid;
-                m_partitionInfo->push_back(pInfo);
-                (*m_partitions)[partitionId].insert(iCid);
-                // std::cerr << "cid(" << iCid << "): " << partitionId << std::endl;
-            } else if (S[iCid] == S[cid]) {
-                if (coverageMap[cid] == coverageMap[iCid]) {
-                    pInfo.cid = iCid;
-                    m_partitionInfo->push_back(pInfo);
-                    (*m_partitions)[partitionId].insert(iCid);
-                    // std::cerr << "cid(" << iCid << "): " << partitionId << std::endl;
-                } else {
-                    tmp.push_back(iCid);
-                }
-            } else {
-                tmp.push_back(iCid);
+        IntVector byLast(order.begin() + begin, order.begin() + end);
+        IntVector byFirst(byLast);
+        std::sort(byLast.begin(), byLast.end(), [&](IndexType a, IndexType b) {
+            return classes[a].maxPosition > classes[b].maxPosition;
+        });
+        std::sort(byFirst.begin(), byFirst.end(), [&](IndexType a, IndexType b) {
+            return classes[a].minPosition < classes[b].minPosition;
+        });
+        IntVector::iterator lastIt = byLast.begin();
+        IntVector::iterator firstIt = byFirst.begin();
+        for (IndexType k = begin; k < end; k++) {
+            IntVector::iterator &it = ((k - begin) % 2 == 0) ? lastIt : firstIt;
+            while (numbered[*it]) {
+                it++;
             }
+            numbered[*it] = true;
+            classes[*it].partitionId = partitionId++;
         }
 
-        for (IndexType i = 0; i < tmp.size(); i++) {
-            SI.insert(std::pair<IndexType, IndexType>(sum, tmp[i]));
-        }
-        tmp.clear();
-
-        partitionId++;
+        begin = end;
     }
 
-    //std::cerr << std::endl << "[INFO] Partitioning FINISHED." << std::endl;
+    for (IndexType i = 0; i < nofPositions; i++) {
+        partition_info pInfo;
+        pInfo.cid = codeElementIds[i];
+        pInfo.partitionId = classes[classOfPosition[i]].partitionId;
+        m_partitionInfo->push_back(pInfo);
+        (*m_partitions)[pInfo.partitionId].insert(pInfo.cid);
+    }
+    std::stable_sort(m_partitionInfo->begin(), m_partitionInfo->end(), [](const partition_info &a, const partition_info &b) {
+        return a.partitionId < b.partitionId;
+    });
 }
 
 } /* namespace soda */
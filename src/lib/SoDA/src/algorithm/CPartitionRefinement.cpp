@@ -0,0 +1,118 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "algorithm/CPartitionRefinement.h"
+#include "util/CBitOperations.h"
+
+namespace soda {
+
+namespace {
+
+inline IndexType numOfPairs(IndexType size)
+{
+    return size * (size - 1) / 2;
+}
+
+} // namespace
+
+CPartitionRefinement::CPartitionRefinement(IndexType numOfCodeElements) :
+    m_blockIds(new IntVector()),
+    m_blockSizes(new IntVector()),
+    m_counts(new IntVector()),
+    m_numOfPairs(0)
+{
+    reset(numOfCodeElements);
+}
+
+CPartitionRefinement::~CPartitionRefinement()
+{
+    delete m_blockIds;
+    delete m_blockSizes;
+    delete m_counts;
+}
+
+void CPartitionRefinement::reset(IndexType numOfCodeElements)
+{
+    m_blockIds->assign(numOfCodeElements, 0);
+    m_blockSizes->clear();
+    if (numOfCodeElements > 0) {
+        m_blockSizes->push_back(numOfCodeElements);
+    }
+    m_numOfPairs = numOfPairs(numOfCodeElements);
+}
+
+void CPartitionRefinement::countCovered(const WordType* row, IntVector& counts) const
+{
+    counts.assign(m_blockSizes->size(), 0);
+    IndexType nofWords = CBitOperations::numOfWords(m_blockIds->size());
+    for (IndexType w = 0; w < nofWords; w++) {
+        for (WordType word = row[w]; word; word &= word - 1) {
+            counts[(*m_blockIds)[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word)]]++;
+        }
+    }
+}
+
+IndexType CPartitionRefinement::getNumOfPairsIfRefined(const WordType* row, IntVector& counts) const
+{
+    countCovered(row, counts);
+
+    IndexType pairs = 0;
+    for (IndexType b = 0; b < counts.size(); b++) {
+        pairs += numOfPairs(counts[b]) + numOfPairs((*m_blockSizes)[b] - counts[b]);
+    }
+    return pairs;
+}
+
+void CPartitionRefinement::refine(const WordType* row)
+{
+    IntVector &counts = *m_counts;
+    countCovered(row, counts);
+
+    // The covered part of a split block gets a new id, the counts are replaced by the new ids.
+    IndexType nofBlocks = m_blockSizes->size();
+    bool split = false;
+    for (IndexType b = 0; b < nofBlocks; b++) {
+        IndexType covered = counts[b];
+        IndexType size = (*m_blockSizes)[b];
+        if (covered == 0 || covered == size) {
+            counts[b] = b;
+            continue;
+        }
+        m_numOfPairs -= numOfPairs(size) - numOfPairs(covered) - numOfPairs(size - covered);
+        (*m_blockSizes)[b] = size - covered;
+        counts[b] = m_blockSizes->size();
+        m_blockSizes->push_back(covered);
+        split = true;
+    }
+    if (!split) {
+        return;
+    }
+
+    IndexType nofWords = CBitOperations::numOfWords(m_blockIds->size());
+    for (IndexType w = 0; w < nofWords; w++) {
+        for (WordType word = row[w]; word; word &= word - 1) {
+            IndexType &blockId = (*m_blockIds)[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word)];
+            blockId = counts[blockId];
+        }
+    }
+}
+
+} /* namespace soda */
@@ -21,6 +21,7 @@
  */
 
 #include "data/CBitList.h"
+#include "data/CIndexBitList.h"
 #include "exception/CException.h"
 #include "interface/IIterators.h"
 
@@ -34,51 +35,69 @@ class CBitList::ListIterator :
         public std::iterator<std::input_iterator_tag, bool> {
 
 private:
-    std::vector<bool>::iterator p;
+    const CBitList* list;
+    IndexType pos;
 
 public:
-    ListIterator() {}
-    ListIterator(std::vector<bool>::iterator it) : p(it) {}
-    ListIterator(IBitListIterator& it) : p(static_cast<CBitList::ListIterator*>(&it)->p) {}
-    ListIterator(const ListIterator& it) : p(it.p) {}
+    ListIterator() : list(0), pos(0) {}
+    ListIterator(const CBitList* l, IndexType p) : list(l), pos(p) {}
+    ListIterator(IBitListIterator& it) :
+        list(static_cast<CBitList::ListIterator*>(&it)->list),
+        pos(static_cast<CBitList::ListIterator*>(&it)->pos) {}
+    ListIterator(const ListIterator& it) : list(it.list), pos(it.pos) {}
 
     IBitListIterator& operator++()
     {
-        ++p;
+        ++pos;
         return *this;
     }
     IBitListIterator& operator++(int)
     {
-        p++;
+        pos++;
         return *this;
     }
     bool operator==(IBitListIterator& rhs)
     {
-        return (p == static_cast<CBitList::ListIterator*>(&rhs)->p);
+        return (pos == static_cast<CBitList::ListIterator*>(&rhs)->pos);
     }
     bool operator!=(IBitListIterator& rhs)
     {
-        return (p != static_cast<CBitList::ListIterator*>(&rhs)->p);
+        return (pos != static_cast<CBitList::ListIterator*>(&rhs)->pos);
     }
     bool operator*()
     {
-        return *p;
+        return (*list)[pos];
     }
 };
 
 CBitList::CBitList() :
-    m_data(new std::vector<bool>(0)),
+    m_data(new std::vector<WordType>()),
+    m_view(0),
+    m_size(0),
     m_beginIterator(0),
     m_endIterator(0),
     m_count(0)
 {}
 
 CBitList::CBitList(IndexType size) :
+    m_view(0),
+    m_size(size),
     m_beginIterator(0),
     m_endIterator(0),
     m_count(0)
 {
-    m_data = new std::vector<bool>(size);
+    m_data = new std::vector<WordType>(CBitOperations::numOfWords(size), 0);
+}
+
+CBitList::CBitList(WordType* words, IndexType size) :
+    m_data(0),
+    m_view(words),
+    m_size(size),
+    m_beginIterator(0),
+    m_endIterator(0),
+    m_count(0)
+{
+    recount();
 }
 
 CBitList::~CBitList()
@@ -88,104 +107,153 @@ CBitList::~CBitList()
     delete m_endIterator;
 }
 
+void CBitList::checkResizable(const char* origin) const
+{
+    if (!m_data)
+        throw CException(origin, "The size of a matrix row can not be changed!");
+}
+
+void CBitList::recount()
+{
+    m_count = CBitOperations::count(words(), getNumOfWords());
+}
+
 bool CBitList::front() const
 {
-    if (m_data->size() == 0)
+    if (m_size == 0)
         throw CException("soda::CBitList::front()", "The list is empty!");
 
-    return m_data->front();
+    return (*this)[0];
 }
 
 bool CBitList::back() const
 {
-    if (m_data->size() == 0)
+    if (m_size == 0)
             throw CException("soda::CBitList::back()", "The list is empty!");
 
-    return m_data->back();
+    return (*this)[m_size - 1];
 }
 
 bool CBitList::at(IndexType pos) const
 {
-    if (pos >= m_data->size() || pos < 0)
+    if (pos >= m_size)
         throw CException("soda::CBitList::at()", "Index out of bound!");
 
-    return (*m_data)[pos];
+    return (*this)[pos];
 }
 
 void CBitList::push_back(bool value){
-    m_data->push_back(value);
-    if(value) m_count++;
+    checkResizable("soda::CBitList::push_back()");
+
+    if (m_size % CBitOperations::BITS_PER_WORD == 0)
+        m_data->push_back(0);
+    m_size++;
+    if (value) {
+        (*m_data)[(m_size - 1) / CBitOperations::BITS_PER_WORD] |= WordType(1) << ((m_size - 1) % CBitOperations::BITS_PER_WORD);
+        m_count++;
+    }
 }
 
 void CBitList::set(IndexType pos, bool value)
 {
-    if (pos >= m_data->size() || pos < 0)
+    if (pos >= m_size)
         throw CException("soda::CBitList::set()", "Index out of bound!");
 
-    (*m_data)[pos] = value;
-    if(value) m_count++;
+    WordType& word = words()[pos / CBitOperations::BITS_PER_WORD];
+    WordType mask = WordType(1) << (pos % CBitOperations::BITS_PER_WORD);
+    if (value && !(word & mask)) {
+        word |= mask;
+        m_count++;
+    } else if (!value && (word & mask)) {
+        word &= ~mask;
+        m_count--;
+    }
 }
 
 void CBitList::toggleValue(IndexType pos)
 {
-    if (pos >= m_data->size() || pos < 0) {
+    if (pos >= m_size)
         throw CException("soda::CBitList::toggleValue()", "Index out of bound!");
-    } else if ((*m_data)[pos]) {
-        (*m_data)[pos] = false;
-        m_count--;
-    } else {
-        (*m_data)[pos] = true;
+
+    WordType& word = words()[pos / CBitOperations::BITS_PER_WORD];
+    WordType mask = WordType(1) << (pos % CBitOperations::BITS_PER_WORD);
+    word ^= mask;
+    if (word & mask) {
         m_count++;
+    } else {
+        m_count--;
     }
 }
 
 void CBitList::pop_back()
 {
-    if(m_data->size() == 0) {
+    if(m_size == 0) {
         throw CException("soda::CBitList::pop_back()","The list is empty!");
     }
+    checkResizable("soda::CBitList::pop_back()");
 
-    if(m_data->back()) m_count--;
-    m_data->pop_back();
+    set(m_size - 1, false);
+    m_size--;
+    m_data->resize(CBitOperations::numOfWords(m_size));
 }
 
 void CBitList::pop_front()
 {
-    if(m_data->size() == 0) {
+    if(m_size == 0) {
         throw CException("soda::CBitList::pop_front()","The list is empty!");
     }
 
-    if(m_data->front()) m_count--;
-    for(IndexType i = 1; i < m_data->size(); i++) {
-        (*m_data)[i-1] = (*m_data)[i];
-    }
-    m_data->pop_back();
+    erase(0);
 }
 
 void CBitList::erase(IndexType pos)
 {
-    if (pos >= m_data->size() || pos < 0)
+    if (pos >= m_size)
         throw CException("soda::CBitList::erase()", "Index out of bound!");
-    else if (pos == m_data->size()-1) {
-        pop_back();
-        return;
+    checkResizable("soda::CBitList::erase()");
+
+    set(pos, false);
+
+    // Shift the following bits down by one position.
+    WordType* data = m_data->data();
+    IndexType first = pos / CBitOperations::BITS_PER_WORD;
+    IndexType numOfWords = getNumOfWords();
+    WordType lowMask = (WordType(1) << (pos % CBitOperations::BITS_PER_WORD)) - 1;
+    WordType high = (data[first] & ~lowMask) >> 1;
+    data[first] = (data[first] & lowMask) | (high & ~lowMask);
+    for (IndexType i = first + 1; i < numOfWords; i++) {
+        data[i - 1] |= data[i] << (CBitOperations::BITS_PER_WORD - 1);
+        data[i] >>= 1;
     }
-    if(m_data->at(pos)) m_count--;
 
-    for(IndexType i = pos+1; i < m_data->size(); i++) {
-        (*m_data)[i-1] = (*m_data)[i];
-    }
-    m_data->pop_back();
+    m_size--;
+    m_data->resize(CBitOperations::numOfWords(m_size));
 }
 
 void CBitList::resize(IndexType newSize)
 {
-    m_data->resize(newSize, false);
+    if (newSize == m_size)
+        return;
+    checkResizable("soda::CBitList::resize()");
+
+    if (newSize < m_size) {
+        m_data->resize(CBitOperations::numOfWords(newSize));
+        if (newSize > 0)
+            m_data->back() &= CBitOperations::lastWordMask(newSize);
+        m_size = newSize;
+        recount();
+    } else {
+        m_data->resize(CBitOperations::numOfWords(newSize), 0);
+        m_size = newSize;
+    }
 }
 
 void CBitList::clear()
 {
+    checkResizable("soda::CBitList::clear()");
+
     m_data->clear();
+    m_size = 0;
     m_count = 0;
     delete m_beginIterator;
     m_beginIterator = 0;
@@ -195,7 +263,7 @@ void CBitList::clear()
 
 IndexType CBitList::size() const
 {
-    return m_data->size();
+    return m_size;
 }
 
 IndexType CBitList::count() const
@@ -205,13 +273,13 @@ IndexType CBitList::count() const
 
 bool CBitList::operator[](IndexType pos) const
 {
-    return (*m_data)[pos];
+    return (words()[pos / CBitOperations::BITS_PER_WORD] >> (pos % CBitOperations::BITS_PER_WORD)) & 1;
 }
 
 IBitListIterator& CBitList::begin()
 {
     delete m_beginIterator;
-    m_beginIterator = new CBitList::ListIterator(m_data->begin());
+    m_beginIterator = new CBitList::ListIterator(this, 0);
 
     return *m_beginIterator;
 }
@@ -219,9 +287,115 @@ IBitListIterator& CBitList::begin()
 IBitListIterator& CBitList::end()
 {
     delete m_endIterator;
-    m_endIterator = new CBitList::ListIterator(m_data->end());
+    m_endIterator = new CBitList::ListIterator(this, m_size);
 
     return *m_endIterator;
 }
 
+void CBitList::setAll(const bool value)
+{
+    IndexType numOfWords = getNumOfWords();
+    WordType* data = words();
+    for (IndexType i = 0; i < numOfWords; i++) {
+        data[i] = value ? ~WordType(0) : 0;
+    }
+    if (value && numOfWords > 0)
+        data[numOfWords - 1] &= CBitOperations::lastWordMask(m_size);
+    m_count = value ? m_size : 0;
+}
+
+IndexType CBitList::getNumOfWords() const
+{
+    return CBitOperations::numOfWords(m_size);
+}
+
+const WordType* CBitList::getWords() const
+{
+    return words();
+}
+
+WordType CBitList::getWord(IndexType index) const
+{
+    if (index >= getNumOfWords())
+        throw CException("soda::CBitList::getWord()", "Index out of bound!");
+
+    return words()[index];
+}
+
+void CBitList::setWord(IndexType index, WordType word)
+{
+    IndexType numOfWords = getNumOfWords();
+    if (index >= numOfWords)
+        throw CException("soda::CBitList::setWord()", "Index out of bound!");
+
+    if (index == numOfWords - 1)
+        word &= CBitOperations::lastWordMask(m_size);
+    WordType& old = words()[index];
+    m_count = m_count - CBitOperations::popcount(old) + CBitOperations::popcount(word);
+    old = word;
+}
+
+void CBitList::bitwiseAnd(const CBitList& rhs)
+{
+    if (rhs.m_size != m_size)
+        throw CException("soda::CBitList::bitwiseAnd()", "The sizes of the lists are different!");
+
+    CBitOperations::bitwiseAnd(words(), words(), rhs.words(), getNumOfWords());
+    recount();
+}
+
+void CBitList::bitwiseOr(const CBitList& rhs)
+{
+    if (rhs.m_size != m_size)
+        throw CException("soda::CBitList::bitwiseOr()", "The sizes of the lists are different!");
+
+    CBitOperations::bitwiseOr(words(), words(), rhs.words(), getNumOfWords());
+    recount();
+}
+
+void CBitList::bitwiseXor(const CBitList& rhs)
+{
+    if (rhs.m_size != m_size)
+        throw CException("soda::CBitList::bitwiseXor()", "The sizes of the lists are different!");
+
+    CBitOperations::bitwiseXor(words(), words(), rhs.words(), getNumOfWords());
+    recount();
+}
+
+void CBitList::bitwiseAndNot(const CBitList& rhs)
+{
+    if (rhs.m_size != m_size)
+        throw CException("soda::CBitList::bitwiseAndNot()", "The sizes of the lists are different!");
+
+    CBitOperations::bitwiseAndNot(words(), words(), rhs.words(), getNumOfWords());
+    recount();
+}
+
+void CBitList::bitwiseAnd(const CIndexBitList& rhs)
+{
+    if (rhs.size() != m_size)
+        throw CException("soda::CBitList::bitwiseAnd()", "The sizes of the lists are different!");
+
+    rhs.bitwiseAnd(words(), getNumOfWords());
+    recount();
+}
+
+void CBitList::bitwiseOr(const CIndexBitList& rhs)
+{
+    if (rhs.size() != m_size)
+        throw CException("soda::CBitList::bitwiseOr()", "The sizes of the lists are different!");
+
+    rhs.bitwiseOr(words(), getNumOfWords());
+    recount();
+}
+
+void CBitList::bitwiseAndNot(const CIndexBitList& rhs)
+{
+    if (rhs.size() != m_size)
+        throw CException("soda::CBitList::bitwiseAndNot()", "The sizes of the lists are different!");
+
+    rhs.bitwiseAndNot(words(), getNumOfWords());
+    recount();
+}
+
 } // namespace soda
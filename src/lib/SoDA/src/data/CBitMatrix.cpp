@@ -23,6 +23,9 @@
 #include "data/CBitMatrix.h"
 #include "exception/CException.h"
 #include "interface/IIterators.h"
+#include "util/CThreadPool.h"
+
+#include <algorithm>
 
 namespace soda {
 
@@ -31,79 +34,76 @@ namespace soda {
  */
 class CBitMatrix::MatrixIterator :
         public IBitMatrixIterator,
-        public std::iterator<std::input_iterator_tag, CBitList*>
+        public std::iterator<std::input_iterator_tag, bool>
 {
-    CBitList* p;
+    const CBitMatrix* m;
+    IndexType row;
     IndexType col;
 
 public:
-    MatrixIterator() : p(0), col(0) {}
-    MatrixIterator(CBitList* x) : p(x), col(0) {}
-    MatrixIterator(CBitList* x, int y) : p(x), col(y) {}
-    MatrixIterator(const MatrixIterator& it) : p(it.p), col(it.col){}
+    MatrixIterator() : m(0), row(0), col(0) {}
+    MatrixIterator(const CBitMatrix* x, IndexType r, IndexType c) : m(x), row(r), col(c) {}
+    MatrixIterator(const MatrixIterator& it) : m(it.m), row(it.row), col(it.col) {}
 
     IBitMatrixIterator& operator++()
     {
-        if(col != p->size()-1) {
+        if(col != m->m_col - 1) {
             col++;
         } else {
-            ++p;    // next row
+            ++row;   // next row
             col = 0; // first element of the new row
         }
         return *this;
     }
     IBitMatrixIterator& operator++(int)
     {
-        if(col != p->size()-1) {
-            col++;
-        } else {
-            ++p;    // next row
-            col = 0; // first element of the new row
-        }
-        return *this;
+        return ++(*this);
     }
     bool operator==(IBitMatrixIterator& rhs)
     {
-        return (p == static_cast<CBitMatrix::MatrixIterator*>(&rhs)->p) &&
+        return (row == static_cast<CBitMatrix::MatrixIterator*>(&rhs)->row) &&
                 (col == static_cast<CBitMatrix::MatrixIterator*>(&rhs)->col);
     }
     bool operator!=(IBitMatrixIterator& rhs)
     {
-        return (p != static_cast<CBitMatrix::MatrixIterator*>(&rhs)->p) ||
+        return (row != static_cast<CBitMatrix::MatrixIterator*>(&rhs)->row) ||
                 (col != static_cast<CBitMatrix::MatrixIterator*>(&rhs)->col);
     }
     bool operator*()
     {
-        return (*p).at(col);
+        return (*(*m->m_rows)[row])[col];
     }
 };
 
 CBitMatrix::CBitMatrix() :
     m_row(0),
     m_col(0),
-    m_data(0),
+    m_wordsPerRow(0),
+    m_data(new std::vector<WordType>()),
+    m_rows(new std::vector<CBitList*>()),
     m_beginIterator(0),
     m_endIterator(0)
 {}
 
 CBitMatrix::CBitMatrix(IndexType rows, IndexType cols) :
-        m_row(rows),
-        m_col(cols),
+        m_row(0),
+        m_col(0),
+        m_wordsPerRow(0),
+        m_data(new std::vector<WordType>()),
+        m_rows(new std::vector<CBitList*>()),
         m_beginIterator(0),
         m_endIterator(0)
 {
-    m_data = new CBitList[rows]();
-
-    for (IndexType i = 0; i < rows; i++) {
-        for (IndexType j = 0; j < cols; j++) {
-            m_data[i].push_back(false);
-        }
-    }
+    resize(rows, cols);
 }
 
 CBitMatrix::~CBitMatrix()
 {
-    delete [] m_data;
+    for (IndexType i = 0; i < m_rows->size(); i++) {
+        delete (*m_rows)[i];
+    }
+    delete m_rows;
+    delete m_data;
     delete m_beginIterator;
     delete m_endIterator;
 }
@@ -123,7 +123,7 @@ void CBitMatrix::rowCounts(std::vector<IndexType> &v) const
     v.clear();
     v.resize(m_row);
     for (IndexType r = 0; r < m_row; r++) {
-        v[r] = m_data[r].count();
+        v[r] = (*m_rows)[r]->count();
     }
 }
 
@@ -131,110 +131,137 @@ void CBitMatrix::colCounts(std::vector<IndexType> &v) const
 {
     v.clear();
     v.resize(m_col);
-    for (IndexType c = 0; c < m_col; c++) {
-        IndexType sum = 0;
-        for (IndexType r = 0; r < m_row; r++) {
-            if (m_data[r][c]) {
-                sum++;
+    for (IndexType r = 0; r < m_row; r++) {
+        const WordType* words = m_data->data() + r * m_wordsPerRow;
+        for (IndexType w = 0; w < m_wordsPerRow; w++) {
+            WordType word = words[w];
+            while (word) {
+                v[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word)]++;
+                word &= word - 1;
             }
         }
-        v[c] = sum;
     }
 }
 
 bool CBitMatrix::get(IndexType row, IndexType col) const
 {
-    if(row >= m_row || row < 0)
+    if(row >= m_row)
         throw CException("soda::CBitMatrix", "Index out of bound!");
-    return m_data[row].at(col);
+    return (*m_rows)[row]->at(col);
 }
 
 void CBitMatrix::set(IndexType row, IndexType col, bool value)
 {
-    if(row >= m_row || row < 0)
+    if(row >= m_row)
         throw CException("soda::CBitMatrix", "Index out of bound!");
-    m_data[row].set(col, value);
+    (*m_rows)[row]->set(col, value);
 }
 
 void CBitMatrix::toggleValue(IndexType row, IndexType col)
 {
-    if(row >= m_row || row < 0)
+    if(row >= m_row)
         throw CException("soda::CBitMatrix", "Index out of bound!");
-    if(m_data[row].at(col)) {
-        m_data[row].set(col, false);
-    } else {
-        m_data[row].set(col, true);
-    }
+    (*m_rows)[row]->toggleValue(col);
 }
 
 void CBitMatrix::resize(IndexType newRow, IndexType newCol)
 {
-    CBitList* tmp;
-    tmp = new CBitList[newRow]();
-
-    //Copy old elements
-    IndexType rowCounter = m_row;
-    IndexType colCounter = m_col;
-
-    if(newRow < m_row)
-        rowCounter = newRow;
-    if(newCol < m_col)
-        colCounter = newCol;
-
-    for(IndexType i = 0; i < rowCounter; i++){
-        for(IndexType j = 0; j < colCounter; j++) {
-            tmp[i].push_back(m_data[i].at(j));
+    IndexType newWordsPerRow = CBitOperations::numOfWords(newCol);
+    IndexType rowCounter = std::min(m_row, newRow);
+
+    if (newWordsPerRow == m_wordsPerRow) {
+        // The layout of the rows does not change, only the tail bits have to be cleared.
+        if (newCol < m_col) {
+            WordType mask = CBitOperations::lastWordMask(newCol);
+            for (IndexType i = 0; i < rowCounter; i++) {
+                (*m_data)[(i + 1) * m_wordsPerRow - 1] &= mask;
+            }
         }
-        for(IndexType j = colCounter; j < newCol; j++) {
-            tmp[i].push_back(false);
+        m_data->resize(newRow * newWordsPerRow, 0);
+    } else {
+        std::vector<WordType>* tmp = new std::vector<WordType>(newRow * newWordsPerRow, 0);
+        IndexType wordCounter = std::min(m_wordsPerRow, newWordsPerRow);
+        for (IndexType i = 0; i < rowCounter; i++) {
+            std::copy(m_data->begin() + i * m_wordsPerRow,
+                      m_data->begin() + i * m_wordsPerRow + wordCounter,
+                      tmp->begin() + i * newWordsPerRow);
+            if (newCol < m_col && newWordsPerRow > 0) {
+                (*tmp)[(i + 1) * newWordsPerRow - 1] &= CBitOperations::lastWordMask(newCol);
+            }
         }
+        delete m_data;
+        m_data = tmp;
     }
 
-    //Extend the matrix
-    for(IndexType i = rowCounter; i < newRow; i++){
-        for(IndexType j = 0; j < newCol; j++){
-            tmp[i].push_back(false);
-        }
+    for (IndexType i = newRow; i < m_rows->size(); i++) {
+        delete (*m_rows)[i];
+    }
+    m_rows->resize(newRow, 0);
+    for (IndexType i = m_row; i < newRow; i++) {
+        (*m_rows)[i] = new CBitList(0, 0);
     }
-
-    delete [] m_data;
-    m_data = tmp;
 
     m_row = newRow;
     m_col = newCol;
+    m_wordsPerRow = newWordsPerRow;
+    updateRows();
+}
+
+void CBitMatrix::updateRows()
+{
+    for (IndexType i = 0; i < m_row; i++) {
+        CBitList* row = (*m_rows)[i];
+        row->m_view = m_data->data() + i * m_wordsPerRow;
+        row->m_size = m_col;
+        row->recount();
+    }
 }
 
 void CBitMatrix::clear()
 {
-    delete [] m_data;
-    m_data = 0;
+    for (IndexType i = 0; i < m_rows->size(); i++) {
+        delete (*m_rows)[i];
+    }
+    m_rows->clear();
+    m_data->clear();
     delete m_beginIterator;
     m_beginIterator = 0;
     delete m_endIterator;
     m_endIterator = 0;
     m_col = 0;
     m_row = 0;
+    m_wordsPerRow = 0;
 }
 
 IBitList& CBitMatrix::operator[](IndexType row) const
 {
-    return m_data[row];
+    return *(*m_rows)[row];
 }
 
 IBitList& CBitMatrix::getRow(IndexType row) const
 {
-    if(row >= m_row || row < 0)
+    if(row >= m_row)
         throw CException("soda::CBitMatrix", "Index out of bound!");
 
-    return m_data[row];
+    return *(*m_rows)[row];
 }
 
 IBitList& CBitMatrix::getCol(IndexType col) const
 {
+    if(col >= m_col)
+        throw CException("soda::CBitMatrix", "Index out of bound!");
+
     CBitList* column = new CBitList(m_row);
 
-    for(IndexType i = 0; i < m_row; i++){
-        column->set(i, get(i, col));
+    IndexType wordIndex = col / CBitOperations::BITS_PER_WORD;
+    IndexType bitIndex = col % CBitOperations::BITS_PER_WORD;
+    for (IndexType i = 0; i < m_row; i += CBitOperations::BITS_PER_WORD) {
+        WordType word = 0;
+        IndexType last = std::min(m_row, i + CBitOperations::BITS_PER_WORD);
+        for (IndexType r = i; r < last; r++) {
+            word |= (((*m_data)[r * m_wordsPerRow + wordIndex] >> bitIndex) & 1) << (r - i);
+        }
+        column->setWord(i / CBitOperations::BITS_PER_WORD, word);
     }
 
     return *column;
@@ -243,15 +270,93 @@ IBitList& CBitMatrix::getCol(IndexType col) const
 IBitMatrixIterator& CBitMatrix::begin()
 {
     delete m_beginIterator;
-    m_beginIterator = new CBitMatrix::MatrixIterator(m_data);
+    m_beginIterator = new CBitMatrix::MatrixIterator(this, m_col ? 0 : m_row, 0);
     return *m_beginIterator;
 }
 
 IBitMatrixIterator& CBitMatrix::end()
 {
     delete m_endIterator;
-    m_endIterator = new CBitMatrix::MatrixIterator(m_data + m_row);
+    m_endIterator = new CBitMatrix::MatrixIterator(this, m_row, 0);
     return *m_endIterator;
 }
 
+void CBitMatrix::setAll(const bool value)
+{
+    for (IndexType i = 0; i < m_row; i++) {
+        (*m_rows)[i]->setAll(value);
+    }
+}
+
+IndexType CBitMatrix::getNumOfWordsPerRow() const
+{
+    return m_wordsPerRow;
+}
+
+const WordType* CBitMatrix::getRowWords(IndexType row) const
+{
+    if(row >= m_row)
+        throw CException("soda::CBitMatrix::getRowWords()", "Index out of bound!");
+
+    return m_data->data() + row * m_wordsPerRow;
+}
+
+void CBitMatrix::setRowWords(IndexType row, const WordType* words)
+{
+    if(row >= m_row)
+        throw CException("soda::CBitMatrix::setRowWords()", "Index out of bound!");
+
+    std::copy(words, words + m_wordsPerRow, m_data->begin() + row * m_wordsPerRow);
+    if (m_wordsPerRow > 0) {
+        (*m_data)[(row + 1) * m_wordsPerRow - 1] &= CBitOperations::lastWordMask(m_col);
+    }
+    (*m_rows)[row]->recount();
+}
+
+WordType CBitMatrix::getWord(IndexType row, IndexType index) const
+{
+    if(row >= m_row)
+        throw CException("soda::CBitMatrix::getWord()", "Index out of bound!");
+
+    return (*m_rows)[row]->getWord(index);
+}
+
+void CBitMatrix::setWord(IndexType row, IndexType index, WordType word)
+{
+    if(row >= m_row)
+        throw CException("soda::CBitMatrix::setWord()", "Index out of bound!");
+
+    (*m_rows)[row]->setWord(index, word);
+}
+
+void CBitMatrix::transpose(const IBitMatrix& matrix, CThreadPool& pool)
+{
+    if (&matrix == this)
+        throw CException("soda::CBitMatrix::transpose()", "The matrix can not be transposed into itself!");
+
+    IndexType numOfRows = matrix.getNumOfRows();
+    IndexType numOfCols = matrix.getNumOfCols();
+    resize(numOfCols, numOfRows);
+
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = matrix.getPackedRows(buffer);
+    IndexType numOfColWords = CBitOperations::numOfWords(numOfCols);
+
+    // Each task writes the words of its own 64 rows
+    pool.run(numOfColWords, [&](IndexType colWord) {
+        WordType block[CBitOperations::BITS_PER_WORD];
+        for (IndexType rowWord = 0; rowWord < m_wordsPerRow; rowWord++) {
+            for (IndexType r = 0; r < CBitOperations::BITS_PER_WORD; r++) {
+                IndexType row = rowWord * CBitOperations::BITS_PER_WORD + r;
+                block[r] = row < numOfRows ? rows[row][colWord] : 0;
+            }
+            CBitOperations::transposeBlock(block);
+            for (IndexType c = 0; c < CBitOperations::BITS_PER_WORD && colWord * CBitOperations::BITS_PER_WORD + c < numOfCols; c++) {
+                (*m_data)[(colWord * CBitOperations::BITS_PER_WORD + c) * m_wordsPerRow + rowWord] = block[c];
+            }
+        }
+    });
+    updateRows();
+}
+
 } // namespace soda
@@ -20,34 +20,79 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "data/CChangeset.h"
 #include "data/CIndexBitList.h"
 #include "data/CIDManager.h"
 #include "exception/CException.h"
+#include "io/CDeltaCoder.h"
 
 namespace soda {
 
+namespace {
+
+/**
+ * @brief Copies the positions of the changed code elements in increasing order to indices.
+ */
+void getChangedIndices(const IBitList &bitList, IntVector &indices)
+{
+    const CIndexBitList *indexBitList = dynamic_cast<const CIndexBitList*>(&bitList);
+    if (indexBitList != NULL) {
+        indexBitList->getIndices(indices);
+        return;
+    }
+
+    indices.clear();
+    for (IndexType i = 0; i < bitList.size(); i++) {
+        if (bitList[i]) {
+            indices.push_back(i);
+        }
+    }
+}
+
+/**
+ * @brief Replaces the changed code elements with the given increasing positions.
+ */
+void setChangedIndices(IBitList &bitList, const IntVector &indices)
+{
+    CIndexBitList *indexBitList = dynamic_cast<CIndexBitList*>(&bitList);
+    if (indexBitList != NULL) {
+        indexBitList->setIndices(indices);
+        return;
+    }
+
+    bitList.setAll(false);
+    for (IndexType i = 0; i < indices.size(); i++) {
+        bitList.set(indices[i], true);
+    }
+}
+
+} // namespace
+
 CChangeset::CChangeset() :
     m_codeElements(new CIDManager()),
     m_changes(new CRevision<IBitList*>()),
     m_createCodeElements(true),
-    m_createChanges(true)
+    m_createChanges(true),
+    m_deltaEncoding(false)
 { }
 
 CChangeset::CChangeset(IIDManager* codeElements) :
     m_codeElements(codeElements),
     m_changes(new CRevision<IBitList*>()),
     m_createCodeElements(false),
-    m_createChanges(true)
+    m_createChanges(true),
+    m_deltaEncoding(false)
 { }
 
 CChangeset::CChangeset(IIDManager* codeElements, CRevision<IBitList*>* changes) :
     m_codeElements(codeElements),
     m_changes(changes),
     m_createCodeElements(false),
-    m_createChanges(false)
+    m_createChanges(false),
+    m_deltaEncoding(false)
 { }
 
 CChangeset::~CChangeset()
@@ -101,17 +146,22 @@ bool CChangeset::isChanged(const RevNumType revisionNumber, const String& codeEl
 StringVector CChangeset::getCodeElementNames(const RevNumType revisionNumber) const
 {
     StringVector result;
-    IBitList* bitList = m_changes->getRevision(revisionNumber);
+    IntVector indices = getCodeElementIds(revisionNumber);
 
-    for(IndexType i = 0; i < bitList->size(); i++) {
-        if((*bitList)[i]) {
-            result.push_back(m_codeElements->getValue(i));
-        }
+    for(IntVector::const_iterator it = indices.begin(); it != indices.end(); ++it) {
+        result.push_back(m_codeElements->getValue(*it));
     }
 
     return result;
 }
 
+IntVector CChangeset::getCodeElementIds(const RevNumType revisionNumber) const
+{
+    IntVector result;
+    getChangedIndices(*m_changes->getRevision(revisionNumber), result);
+    return result;
+}
+
 const IIDManager& CChangeset::getCodeElements() const
 {
     return *m_codeElements;
@@ -221,8 +271,9 @@ void CChangeset::refitSize()
     IntVector revNums = m_changes->getRevisionNumbers();
     IndexType metNums = m_codeElements->size();
     for(IndexType i = 0; i < revNums.size(); i++) {
-        for(IndexType j = m_changes->getRevision(revNums[i])->size(); j < metNums; j++) {
-            m_changes->getRevision(revNums[i])->push_back(false);
+        IBitList* changes = m_changes->getRevision(revNums[i]);
+        if (changes->size() < metNums) {
+            changes->resize(metNums);
         }
     }
 }
@@ -232,10 +283,24 @@ void CChangeset::addCodeElementName(const String& codeElementName)
     m_codeElements->add(codeElementName);
 }
 
+void CChangeset::setDeltaEncoding(bool deltaEncoding)
+{
+    m_deltaEncoding = deltaEncoding;
+}
+
+bool CChangeset::getDeltaEncoding() const
+{
+    return m_deltaEncoding;
+}
+
 void CChangeset::save(io::CBinaryIO *out) const
 {
     m_codeElements->save(out, io::CSoDAio::PRLIST);
-    saveRevisionTable(out, io::CSoDAio::CHANGESET);
+    if (m_deltaEncoding) {
+        saveDeltaRevisionTable(out);
+    } else {
+        saveRevisionTable(out, io::CSoDAio::CHANGESET);
+    }
 }
 
 void CChangeset::load(io::CSoDAio *in)
@@ -249,6 +314,11 @@ void CChangeset::load(io::CSoDAio *in)
             isPR = true;
         } else if(in->getChunkID() == io::CSoDAio::CHANGESET) {
             loadRevisionTable(in);
+            m_deltaEncoding = false;
+            isCH = true;
+        } else if(in->getChunkID() == io::CSoDAio::CHANGESET_DELTA) {
+            loadDeltaRevisionTable(in);
+            m_deltaEncoding = true;
             isCH = true;
         }
     }
@@ -287,6 +357,8 @@ void CChangeset::saveRevisionTable(io::CBinaryIO* out, const io::CSoDAio::ChunkI
     IntVector revs = m_changes->getRevisionNumbers();
     unsigned int revNumTypeLength = sizeof(RevNumType);
     unsigned long long int length = revs.size() * (revNumTypeLength + m_codeElements->size()) + 8;
+    std::vector<char> buffer(m_codeElements->size());
+    IntVector indices;
 
     out->writeUInt4(chunk);
     out->writeULongLong8(length);
@@ -298,10 +370,49 @@ void CChangeset::saveRevisionTable(io::CBinaryIO* out, const io::CSoDAio::ChunkI
         RevNumType r = *it;
         out->writeData(&r, revNumTypeLength);
 
-        //Write bitlist
-        IBitList* bitlist = (*m_changes)[*it];
-        for(IndexType i = 0; i < bitlist->size(); ++i) {
-            out->writeBool1(bitlist->at(i));
+        //Write bitlist, one byte per code element
+        std::fill(buffer.begin(), buffer.end(), 0);
+        getChangedIndices(*(*m_changes)[*it], indices);
+        for(IndexType i = 0; i < indices.size() && indices[i] < buffer.size(); i++) {
+            buffer[indices[i]] = 1;
+        }
+        if (!buffer.empty()) {
+            out->writeData(buffer.data(), buffer.size());
+        }
+    }
+}
+
+void CChangeset::saveDeltaRevisionTable(io::CBinaryIO* out) const
+{
+    IntVector revs = m_changes->getRevisionNumbers();
+    unsigned int revNumTypeLength = sizeof(RevNumType);
+    IntVector indices;
+    std::vector<unsigned char> buffer;
+
+    // The length of the encoded changes is computed before writing the chunk header
+    unsigned long long int length = 8;
+    for(IntVector::const_iterator it = revs.begin(); it != revs.end(); it++) {
+        getChangedIndices(*(*m_changes)[*it], indices);
+        length += revNumTypeLength + 8 + io::CDeltaCoder::predictSize(indices);
+    }
+
+    out->writeUInt4(io::CSoDAio::CHANGESET_DELTA);
+    out->writeULongLong8(length);
+
+    out->writeUInt4(revs.size());
+    out->writeUInt4(m_codeElements->size());
+    for(IntVector::const_iterator it = revs.begin(); it != revs.end(); it++) {
+        //Write revision number
+        RevNumType r = *it;
+        out->writeData(&r, revNumTypeLength);
+
+        //Write the number of changes and the delta encoded positions
+        getChangedIndices(*(*m_changes)[*it], indices);
+        IndexType size = io::CDeltaCoder::encode(indices, buffer);
+        out->writeUInt4(indices.size());
+        out->writeUInt4(size);
+        if (size > 0) {
+            out->writeData(buffer.data(), size);
         }
     }
 }
@@ -310,6 +421,8 @@ void CChangeset::loadRevisionTable(io::CBinaryIO* in)
 {
     unsigned int revSize = in->readUInt4();
     IndexType nOfCodeElements = in->readUInt4();
+    std::vector<char> buffer(nOfCodeElements);
+    IntVector indices;
 
     for(RevNumType i = 0; i< revSize; i++) {
         //read revision number
@@ -317,10 +430,49 @@ void CChangeset::loadRevisionTable(io::CBinaryIO* in)
         in->readData(&rev, sizeof(RevNumType));
         addRevision(rev, nOfCodeElements);
 
-        //read bitlist;
+        //read bitlist, one byte per code element
+        if (nOfCodeElements > 0) {
+            in->readData(buffer.data(), nOfCodeElements);
+        }
+        indices.clear();
         for(IndexType mid = 0; mid < nOfCodeElements; mid++) {
-            (*m_changes)[rev]->set(mid, in->readBool1());
+            if (buffer[mid] == 1) {
+                indices.push_back(mid);
+            }
+        }
+        setChangedIndices(*(*m_changes)[rev], indices);
+    }
+}
+
+void CChangeset::loadDeltaRevisionTable(io::CBinaryIO* in)
+{
+    unsigned int revSize = in->readUInt4();
+    IndexType nOfCodeElements = in->readUInt4();
+    std::vector<unsigned char> buffer;
+    IntVector indices;
+
+    for(RevNumType i = 0; i< revSize; i++) {
+        //read revision number
+        RevNumType rev;
+        in->readData(&rev, sizeof(RevNumType));
+        addRevision(rev, nOfCodeElements);
+
+        //read the delta encoded positions
+        IndexType count = in->readUInt4();
+        IndexType size = in->readUInt4();
+        if (count > nOfCodeElements) {
+            throw CException("soda::CChangeset::loadDeltaRevisionTable()", "Invalid change list!");
+        }
+        if (buffer.size() < size) {
+            buffer.resize(size);
+        }
+        if (size > 0) {
+            in->readData(buffer.data(), size);
+        }
+        if (!io::CDeltaCoder::decode(buffer.data(), size, count, indices)) {
+            throw CException("soda::CChangeset::loadDeltaRevisionTable()", "Invalid change list!");
         }
+        setChangedIndices(*(*m_changes)[rev], indices);
     }
 }
 
@@ -25,6 +25,9 @@
 #include "data/CCoverageMatrix.h"
 #include "data/CBitMatrix.h"
 #include "data/CIDManager.h"
+#include "data/CMappedBitMatrix.h"
+#include "data/CMappedIDManager.h"
+#include "io/CMappedSoDAio.h"
 #include "exception/CException.h"
 
 namespace soda {
@@ -117,12 +120,12 @@ const IBitMatrix& CCoverageMatrix::getBitMatrix() const
 
 const IndexType CCoverageMatrix::getNumOfTestcases() const
 {
-    return m_testcases->getIDList().size();
+    return m_testcases->size();
 }
 
 const IndexType CCoverageMatrix::getNumOfCodeElements() const
 {
-    return m_codeElements->getIDList().size();
+    return m_codeElements->size();
 }
 
 bool CCoverageMatrix::isCoveredCodeElement(const String &codeElementName) const {
@@ -233,6 +236,51 @@ void CCoverageMatrix::load(io::CSoDAio *in)
     }
 }
 
+void CCoverageMatrix::load(io::CMappedSoDAio *in)
+{
+    if(!m_createTestcases || !m_createCodeElements || !m_createBitMatrix) {
+        throw CException("soda::CCoverageMatrix::load()", "Only a standalone coverage matrix can be loaded from a mapped file!");
+    }
+
+    IIDManager* testcases = 0;
+    IIDManager* codeElements = 0;
+    IBitMatrix* data = 0;
+
+    try {
+        while(in->nextChunkID()) {
+            if(in->getChunkID() == io::CSoDAio::TCLIST) {
+                delete testcases;
+                testcases = new CMappedIDManager(in->getChunkData(), in->getActualLength());
+            } else if(in->getChunkID() == io::CSoDAio::PRLIST) {
+                delete codeElements;
+                codeElements = new CMappedIDManager(in->getChunkData(), in->getActualLength());
+            } else if(in->getChunkID() == io::CSoDAio::COVERAGE) {
+                delete data;
+                data = new CMappedBitMatrix(in->getChunkData(), in->getActualLength());
+            }
+        }
+    } catch (...) {
+        delete testcases;
+        delete codeElements;
+        delete data;
+        throw;
+    }
+
+    if(!testcases || !codeElements || !data) {
+        delete testcases;
+        delete codeElements;
+        delete data;
+        throw CException("soda::CCoverageMatrix","There is no coverage info in this file!");
+    }
+
+    delete m_testcases;
+    delete m_codeElements;
+    delete m_data;
+    m_testcases = testcases;
+    m_codeElements = codeElements;
+    m_data = data;
+}
+
 void CCoverageMatrix::save(const char * filename) const
 {
     io::CSoDAio *out = new io::CSoDAio(filename, io::CBinaryIO::omWrite);
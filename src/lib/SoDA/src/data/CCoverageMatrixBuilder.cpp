@@ -0,0 +1,238 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "data/CCoverageMatrixBuilder.h"
+#include "exception/CException.h"
+#include "util/CThreadPool.h"
+
+namespace soda {
+
+namespace {
+
+/**
+ * @brief Minimal length of a row to be compacted.
+ */
+const IndexType MIN_COMPACT_SIZE = 64;
+
+bool lessCodeElement(IndexType a, IndexType b)
+{
+    return (a >> 1) < (b >> 1);
+}
+
+} // namespace
+
+CCoverageMatrixBuilder::CCoverageMatrixBuilder() :
+    m_testcases(new CIDManager()),
+    m_codeElements(new CIDManager()),
+    m_rows(new std::vector<IntVector>()),
+    m_compactedSizes(new IntVector())
+{ }
+
+CCoverageMatrixBuilder::~CCoverageMatrixBuilder()
+{
+    delete m_testcases;
+    delete m_codeElements;
+    delete m_rows;
+    delete m_compactedSizes;
+}
+
+const IIDManager& CCoverageMatrixBuilder::getTestcases() const
+{
+    return *m_testcases;
+}
+
+const IIDManager& CCoverageMatrixBuilder::getCodeElements() const
+{
+    return *m_codeElements;
+}
+
+IndexType CCoverageMatrixBuilder::getNumOfRelations() const
+{
+    IndexType sum = 0;
+    for (std::vector<IntVector>::const_iterator it = m_rows->begin(); it != m_rows->end(); ++it) {
+        sum += it->size();
+    }
+    return sum;
+}
+
+IndexType CCoverageMatrixBuilder::addTestcaseName(const String& testcaseName)
+{
+    if (!m_testcases->containsValue(testcaseName)) {
+        m_testcases->add(testcaseName);
+        m_rows->resize(m_testcases->size());
+        m_compactedSizes->resize(m_testcases->size(), 0);
+    }
+    return m_testcases->getID(testcaseName);
+}
+
+IndexType CCoverageMatrixBuilder::addCodeElementName(const String& codeElementName)
+{
+    if (!m_codeElements->containsValue(codeElementName)) {
+        m_codeElements->add(codeElementName);
+    }
+    return m_codeElements->getID(codeElementName);
+}
+
+void CCoverageMatrixBuilder::addOrSetRelation(const String& testcaseName, const String& codeElementName, const bool isCovered)
+{
+    IndexType testcaseIdx = addTestcaseName(testcaseName);
+    IndexType codeElementIdx = addCodeElementName(codeElementName);
+    (*m_rows)[testcaseIdx].push_back(codeElementIdx << 1 | (isCovered ? 1 : 0));
+    compactRow(testcaseIdx);
+}
+
+void CCoverageMatrixBuilder::addOrSetRelation(const IndexType testcaseIdx, const IndexType codeElementIdx, const bool isCovered)
+{
+    if (testcaseIdx >= m_rows->size() || codeElementIdx >= m_codeElements->size()) {
+        throw CException("soda::CCoverageMatrixBuilder::addOrSetRelation()", "The builder does not contain the item!");
+    }
+    (*m_rows)[testcaseIdx].push_back(codeElementIdx << 1 | (isCovered ? 1 : 0));
+    compactRow(testcaseIdx);
+}
+
+void CCoverageMatrixBuilder::compactRow(const IndexType row)
+{
+    IntVector& relations = (*m_rows)[row];
+    IndexType& compactedSize = (*m_compactedSizes)[row];
+    if (relations.size() < MIN_COMPACT_SIZE || relations.size() < 2 * compactedSize) {
+        return;
+    }
+
+    // The stable sort keeps the order of the relations of the same code element, the last one is kept.
+    std::stable_sort(relations.begin(), relations.end(), lessCodeElement);
+    IndexType n = 0;
+    for (IndexType i = 0; i < relations.size(); ++i) {
+        if (i + 1 == relations.size() || (relations[i + 1] >> 1) != (relations[i] >> 1)) {
+            relations[n++] = relations[i];
+        }
+    }
+    relations.resize(n);
+    compactedSize = n;
+}
+
+void CCoverageMatrixBuilder::merge(const CCoverageMatrixBuilder& other)
+{
+    std::vector<CCoverageMatrixBuilder*> builders(1, const_cast<CCoverageMatrixBuilder*>(&other));
+    merge(builders, 1);
+}
+
+void CCoverageMatrixBuilder::merge(const std::vector<CCoverageMatrixBuilder*>& builders, unsigned int numOfThreads)
+{
+    std::vector<IntVector> testcaseMaps(builders.size());
+    std::vector<IntVector> codeElementMaps(builders.size());
+
+    for (IndexType i = 0; i < builders.size(); ++i) {
+        if (builders[i] == this) {
+            throw CException("soda::CCoverageMatrixBuilder::merge()", "The builder can not be merged into itself!");
+        }
+
+        const IntVector& testcases = builders[i]->m_testcases->getIDs();
+        testcaseMaps[i].resize(testcases.size());
+        for (IndexType j = 0; j < testcases.size(); ++j) {
+            testcaseMaps[i][j] = addTestcaseName(builders[i]->m_testcases->getValue(testcases[j]));
+        }
+
+        const IntVector& codeElements = builders[i]->m_codeElements->getIDs();
+        codeElementMaps[i].resize(codeElements.size());
+        for (IndexType j = 0; j < codeElements.size(); ++j) {
+            codeElementMaps[i][j] = addCodeElementName(builders[i]->m_codeElements->getValue(codeElements[j]));
+        }
+    }
+
+    // Each task copies the relations of a separate range of target rows
+    IndexType numOfRows = m_rows->size();
+    if (numOfThreads == 1 || numOfRows < 2) {
+        mergeRows(builders, testcaseMaps, codeElementMaps, 0, numOfRows);
+        return;
+    }
+
+    CThreadPool pool(numOfThreads);
+    IndexType numOfChunks = std::min<IndexType>(pool.getNumOfThreads(), numOfRows);
+    IndexType chunkSize = (numOfRows + numOfChunks - 1) / numOfChunks;
+    pool.run(numOfChunks, [&](IndexType chunk) {
+        mergeRows(builders, testcaseMaps, codeElementMaps, chunk * chunkSize, std::min(numOfRows, (chunk + 1) * chunkSize));
+    });
+}
+
+void CCoverageMatrixBuilder::mergeRows(const std::vector<CCoverageMatrixBuilder*>& builders, const std::vector<IntVector>& testcaseMaps,
+                                       const std::vector<IntVector>& codeElementMaps, IndexType begin, IndexType end)
+{
+    for (IndexType i = 0; i < builders.size(); ++i) {
+        const std::vector<IntVector>& rows = *builders[i]->m_rows;
+        for (IndexType row = 0; row < rows.size(); ++row) {
+            IndexType target = testcaseMaps[i][row];
+            if (target < begin || target >= end) {
+                continue;
+            }
+
+            IntVector& relations = (*m_rows)[target];
+            for (IntVector::const_iterator it = rows[row].begin(); it != rows[row].end(); ++it) {
+                relations.push_back(codeElementMaps[i][*it >> 1] << 1 | (*it & 1));
+            }
+            compactRow(target);
+        }
+    }
+}
+
+void CCoverageMatrixBuilder::build(CCoverageMatrix& coverage) const
+{
+    IntVector testcaseMap(m_testcases->size());
+    for (IndexType i = 0; i < testcaseMap.size(); ++i) {
+        String name = m_testcases->getValue(i);
+        coverage.addTestcaseName(name);
+        testcaseMap[i] = coverage.getTestcases().getID(name);
+    }
+
+    IntVector codeElementMap(m_codeElements->size());
+    for (IndexType i = 0; i < codeElementMap.size(); ++i) {
+        String name = m_codeElements->getValue(i);
+        coverage.addCodeElementName(name);
+        codeElementMap[i] = coverage.getCodeElements().getID(name);
+    }
+
+    coverage.refitMatrixSize();
+
+    for (IndexType row = 0; row < m_rows->size(); ++row) {
+        const IntVector& relations = (*m_rows)[row];
+        for (IntVector::const_iterator it = relations.begin(); it != relations.end(); ++it) {
+            coverage.setRelation(testcaseMap[row], codeElementMap[*it >> 1], (*it & 1) != 0);
+        }
+    }
+}
+
+CCoverageMatrix* CCoverageMatrixBuilder::build() const
+{
+    CCoverageMatrix* coverage = new CCoverageMatrix();
+    build(*coverage);
+    return coverage;
+}
+
+void CCoverageMatrixBuilder::clear()
+{
+    m_testcases->clear();
+    m_codeElements->clear();
+    m_rows->clear();
+    m_compactedSizes->clear();
+}
+
+} // namespace soda
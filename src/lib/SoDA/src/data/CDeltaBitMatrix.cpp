@@ -0,0 +1,867 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "data/CDeltaBitMatrix.h"
+#include "exception/CException.h"
+#include "interface/IIterators.h"
+#include "io/CBitReader.h"
+#include "io/CBitWriter.h"
+#include "io/CDeltaCoder.h"
+
+namespace soda {
+
+namespace {
+
+/**
+ * @brief Every CHECKPOINT_INTERVAL-th row is stored as a full row too.
+ */
+const IndexType CHECKPOINT_INTERVAL = 64;
+
+/**
+ * @brief Number of decoded rows kept in the cache.
+ */
+const IndexType ROW_CACHE_SIZE = 8;
+
+/**
+ * @brief Number of threads whose returned rows are kept.
+ */
+const IndexType MAX_READERS = 64;
+
+/**
+ * @brief Stores the positions of the bits which are different in the two rows, previous can be null.
+ */
+void getDifferences(const WordType* current, const WordType* previous, IndexType numOfWords, IntVector& indices)
+{
+    indices.clear();
+    for (IndexType i = 0; i < numOfWords; i++) {
+        WordType word = previous ? current[i] ^ previous[i] : current[i];
+        for (; word != 0; word &= word - 1) {
+            indices.push_back(i * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word));
+        }
+    }
+}
+
+/**
+ * @brief Copies the values of a list to an other list with the same size.
+ */
+void copyList(const CBitList& from, CBitList& to)
+{
+    to.setAll(false);
+    to.bitwiseOr(from);
+}
+
+} // namespace
+
+/**
+ * @brief The CDeltaBitMatrix::RowList class is a decoded row returned by operator[], the
+ *        modifications of its values are written into the matrix.
+ */
+class CDeltaBitMatrix::RowList :
+        public CBitList
+{
+    CDeltaBitMatrix* m;
+    IndexType r;
+
+public:
+    RowList(CDeltaBitMatrix* x, IndexType col) : CBitList(col), m(x), r(0) {}
+
+    IndexType row() const
+    {
+        return r;
+    }
+
+    /**
+     * @brief Copies the values of the given row without modifying the matrix.
+     */
+    void assign(IndexType row, const CBitList& from)
+    {
+        r = row;
+        for (IndexType w = 0; w < getNumOfWords(); w++) {
+            setWord(w, from.getWords()[w]);
+        }
+    }
+
+    void set(IndexType index, bool value)
+    {
+        m->set(r, index, value);
+    }
+    void toggleValue(IndexType index)
+    {
+        m->set(r, index, !(*this)[index]);
+    }
+    void setAll(const bool value = false)
+    {
+        CBitList::setAll(value);
+        m->setRowWords(r, getWords());
+    }
+};
+
+/**
+ * @brief The CDeltaBitMatrix::RowCache struct stores the last accessed rows.
+ */
+struct CDeltaBitMatrix::RowCache {
+    struct Entry {
+        Entry() : row(0), lastUse(0), list(NULL) {}
+
+        IndexType row;
+        IndexType lastUse;
+        CBitList* list;
+    };
+
+    /**
+     * @brief The rows returned to a thread, the most recently used row is the first.
+     */
+    struct Reader {
+        Reader() : lastUse(0), rows() {}
+
+        IndexType lastUse;
+        std::vector<RowList*> rows;
+    };
+
+    typedef std::map<boost::thread::id, Reader> ReaderMap;
+
+    RowCache() :
+        entries(ROW_CACHE_SIZE),
+        clock(0),
+        modified(NULL),
+        readers()
+    {}
+
+    ~RowCache()
+    {
+        for (IndexType i = 0; i < entries.size(); i++) {
+            delete entries[i].list;
+        }
+        dropReaders();
+    }
+
+    Entry* find(IndexType row)
+    {
+        for (IndexType i = 0; i < entries.size(); i++) {
+            if (entries[i].list && entries[i].row == row) {
+                return &entries[i];
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * @brief Returns the rows of the current thread, the least recently used reader
+     *        is dropped if there are too many.
+     */
+    Reader& currentReader()
+    {
+        boost::thread::id id = boost::this_thread::get_id();
+        ReaderMap::iterator it = readers.find(id);
+        if (it == readers.end()) {
+            if (readers.size() >= MAX_READERS) {
+                ReaderMap::iterator oldest = readers.begin();
+                for (ReaderMap::iterator candidate = readers.begin(); candidate != readers.end(); ++candidate) {
+                    if (candidate->second.lastUse < oldest->second.lastUse) {
+                        oldest = candidate;
+                    }
+                }
+                deleteRows(oldest->second);
+                readers.erase(oldest);
+            }
+            it = readers.insert(std::make_pair(id, Reader())).first;
+        }
+        it->second.lastUse = ++clock;
+        return it->second;
+    }
+
+    /**
+     * @brief Calls the function for each returned copy of the row.
+     */
+    template <typename Function>
+    void forEachReturned(IndexType row, Function f)
+    {
+        for (ReaderMap::iterator it = readers.begin(); it != readers.end(); ++it) {
+            for (IndexType i = 0; i < it->second.rows.size(); i++) {
+                if (it->second.rows[i]->row() == row) {
+                    f(*it->second.rows[i]);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Deletes the returned rows of every thread.
+     */
+    void dropReaders()
+    {
+        for (ReaderMap::iterator it = readers.begin(); it != readers.end(); ++it) {
+            deleteRows(it->second);
+        }
+        readers.clear();
+    }
+
+    static void deleteRows(Reader& reader)
+    {
+        for (IndexType i = 0; i < reader.rows.size(); i++) {
+            delete reader.rows[i];
+        }
+        reader.rows.clear();
+    }
+
+    /**
+     * @brief Cached rows, the list is null if the entry is not used.
+     */
+    std::vector<Entry> entries;
+
+    IndexType clock;
+
+    /**
+     * @brief The entry whose row is modified but not encoded yet.
+     */
+    Entry* modified;
+
+    /**
+     * @brief The rows returned by operator[] to each thread, every thread has at most
+     *        ROW_CACHE_SIZE rows, so the rows of a thread are not reused by an other thread.
+     */
+    ReaderMap readers;
+
+    boost::mutex mutex;
+};
+
+/**
+ * @brief The CDeltaBitMatrix::MatrixIterator class is an iterator for CDeltaBitMatrix.
+ */
+class CDeltaBitMatrix::MatrixIterator :
+        public IBitMatrixIterator,
+        public std::iterator<std::input_iterator_tag, bool>
+{
+    const CDeltaBitMatrix* m;
+    IndexType pos;
+
+public:
+    MatrixIterator() : m(0), pos(0) {}
+    MatrixIterator(const CDeltaBitMatrix* x, IndexType p) : m(x), pos(p) {}
+    MatrixIterator(const MatrixIterator& it) : m(it.m), pos(it.pos) {}
+
+    IBitMatrixIterator& operator++()
+    {
+        ++pos;
+        return *this;
+    }
+    IBitMatrixIterator& operator++(int)
+    {
+        pos++;
+        return *this;
+    }
+    bool operator==(IBitMatrixIterator& rhs)
+    {
+        return pos == static_cast<CDeltaBitMatrix::MatrixIterator*>(&rhs)->pos;
+    }
+    bool operator!=(IBitMatrixIterator& rhs)
+    {
+        return pos != static_cast<CDeltaBitMatrix::MatrixIterator*>(&rhs)->pos;
+    }
+    bool operator*()
+    {
+        return m->get(pos / m->getNumOfCols(), pos % m->getNumOfCols());
+    }
+};
+
+CDeltaBitMatrix::CDeltaBitMatrix() :
+    m_row(0),
+    m_col(0),
+    m_changes(new std::vector<IntVector>()),
+    m_checkpoints(new std::vector<CBitList*>()),
+    m_cache(new RowCache()),
+    m_beginIterator(0),
+    m_endIterator(0)
+{}
+
+CDeltaBitMatrix::CDeltaBitMatrix(IndexType row, IndexType col) :
+    m_row(0),
+    m_col(0),
+    m_changes(new std::vector<IntVector>()),
+    m_checkpoints(new std::vector<CBitList*>()),
+    m_cache(new RowCache()),
+    m_beginIterator(0),
+    m_endIterator(0)
+{
+    resize(row, col);
+}
+
+CDeltaBitMatrix::CDeltaBitMatrix(const IBitMatrix& matrix) :
+    m_row(matrix.getNumOfRows()),
+    m_col(matrix.getNumOfCols()),
+    m_changes(new std::vector<IntVector>(matrix.getNumOfRows())),
+    m_checkpoints(new std::vector<CBitList*>()),
+    m_cache(new RowCache()),
+    m_beginIterator(0),
+    m_endIterator(0)
+{
+    IndexType numOfWords = CBitOperations::numOfWords(m_col);
+    std::vector<WordType> previous(numOfWords, 0);
+    std::vector<WordType> current(numOfWords, 0);
+    for (IndexType r = 0; r < m_row; r++) {
+        matrix.copyRowWords(r, current.data());
+        getDifferences(current.data(), previous.data(), numOfWords, (*m_changes)[r]);
+        previous.swap(current);
+    }
+    rebuildCheckpoints();
+}
+
+CDeltaBitMatrix::~CDeltaBitMatrix()
+{
+    for (IndexType i = 0; i < m_checkpoints->size(); i++) {
+        delete (*m_checkpoints)[i];
+    }
+    delete m_checkpoints;
+    delete m_changes;
+    delete m_cache;
+    delete m_beginIterator;
+    delete m_endIterator;
+}
+
+IndexType CDeltaBitMatrix::getNumOfRows() const
+{
+    return m_row;
+}
+
+IndexType CDeltaBitMatrix::getNumOfCols() const
+{
+    return m_col;
+}
+
+IndexType CDeltaBitMatrix::getNumOfChanges() const
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+
+    IndexType sum = 0;
+    for (IndexType r = 0; r < m_row; r++) {
+        sum += (*m_changes)[r].size();
+    }
+    return sum;
+}
+
+CBitList& CDeltaBitMatrix::cachedRow(IndexType row) const
+{
+    RowCache::Entry* entry = m_cache->find(row);
+    if (!entry) {
+        flush();
+
+        // Replace an unused or the least recently used entry
+        entry = &m_cache->entries[0];
+        for (IndexType i = 0; i < m_cache->entries.size() && entry->list; i++) {
+            RowCache::Entry& candidate = m_cache->entries[i];
+            if (!candidate.list || candidate.lastUse < entry->lastUse) {
+                entry = &candidate;
+            }
+        }
+
+        CBitList* list = entry->list ? entry->list : new CBitList(m_col);
+        entry->list = NULL;
+        decodeRow(row, *list);
+        entry->list = list;
+        entry->row = row;
+    }
+    entry->lastUse = ++m_cache->clock;
+    return *entry->list;
+}
+
+void CDeltaBitMatrix::decodeRow(IndexType row, CBitList& list) const
+{
+    IndexType first = row - row % CHECKPOINT_INTERVAL;
+    const CBitList* start = (*m_checkpoints)[row / CHECKPOINT_INTERVAL];
+
+    // A cached row between the full row and the requested row shortens the decoding
+    for (IndexType i = 0; i < m_cache->entries.size(); i++) {
+        const RowCache::Entry& entry = m_cache->entries[i];
+        if (entry.list && &entry != m_cache->modified && entry.row > first && entry.row <= row) {
+            start = entry.list;
+            first = entry.row;
+        }
+    }
+
+    copyList(*start, list);
+    for (IndexType r = first + 1; r <= row; r++) {
+        const IntVector& changes = (*m_changes)[r];
+        for (IndexType i = 0; i < changes.size(); i++) {
+            list.toggleValue(changes[i]);
+        }
+    }
+}
+
+void CDeltaBitMatrix::flush() const
+{
+    RowCache::Entry* entry = m_cache->modified;
+    if (!entry) {
+        return;
+    }
+
+    IndexType row = entry->row;
+    const CBitList& list = *entry->list;
+    IndexType numOfWords = list.getNumOfWords();
+
+    // The next row is decoded before the changes of the modified row are replaced
+    if (row + 1 < m_row) {
+        CBitList next(m_col);
+        decodeRow(row + 1, next);
+        getDifferences(next.getWords(), list.getWords(), numOfWords, (*m_changes)[row + 1]);
+    }
+    if (row > 0) {
+        CBitList previous(m_col);
+        decodeRow(row - 1, previous);
+        getDifferences(list.getWords(), previous.getWords(), numOfWords, (*m_changes)[row]);
+    } else {
+        getDifferences(list.getWords(), NULL, numOfWords, (*m_changes)[row]);
+    }
+    if (row % CHECKPOINT_INTERVAL == 0) {
+        copyList(list, *(*m_checkpoints)[row / CHECKPOINT_INTERVAL]);
+    }
+
+    m_cache->modified = NULL;
+}
+
+void CDeltaBitMatrix::clearCache() const
+{
+    for (IndexType i = 0; i < m_cache->entries.size(); i++) {
+        delete m_cache->entries[i].list;
+        m_cache->entries[i].list = NULL;
+    }
+    m_cache->modified = NULL;
+}
+
+void CDeltaBitMatrix::rebuildCheckpoints()
+{
+    for (IndexType i = 0; i < m_checkpoints->size(); i++) {
+        delete (*m_checkpoints)[i];
+    }
+    m_checkpoints->clear();
+
+    CBitList current(m_col);
+    for (IndexType r = 0; r < m_row; r++) {
+        const IntVector& changes = (*m_changes)[r];
+        for (IndexType i = 0; i < changes.size(); i++) {
+            current.toggleValue(changes[i]);
+        }
+        if (r % CHECKPOINT_INTERVAL == 0) {
+            CBitList* checkpoint = new CBitList(m_col);
+            copyList(current, *checkpoint);
+            m_checkpoints->push_back(checkpoint);
+        }
+    }
+}
+
+void CDeltaBitMatrix::rowCounts(std::vector<IndexType> &v) const
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+
+    v.assign(m_row, 0);
+    CBitList current(m_col);
+    for (IndexType r = 0; r < m_row; r++) {
+        const IntVector& changes = (*m_changes)[r];
+        for (IndexType i = 0; i < changes.size(); i++) {
+            current.toggleValue(changes[i]);
+        }
+        v[r] = current.count();
+    }
+}
+
+void CDeltaBitMatrix::colCounts(std::vector<IndexType> &v) const
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+
+    // The length of each run of true values is added when the run ends
+    v.assign(m_col, 0);
+    std::vector<IndexType> runStart(m_col, 0);
+    CBitList current(m_col);
+    for (IndexType r = 0; r < m_row; r++) {
+        const IntVector& changes = (*m_changes)[r];
+        for (IndexType i = 0; i < changes.size(); i++) {
+            IndexType c = changes[i];
+            if (current[c]) {
+                v[c] += r - runStart[c];
+            } else {
+                runStart[c] = r;
+            }
+            current.toggleValue(c);
+        }
+    }
+    for (IndexType c = 0; c < m_col; c++) {
+        if (current[c]) {
+            v[c] += m_row - runStart[c];
+        }
+    }
+}
+
+bool CDeltaBitMatrix::get(IndexType row, IndexType col) const
+{
+    if (row >= m_row || col >= m_col)
+        throw CException("soda::CDeltaBitMatrix", "Index out of bound!");
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    RowCache::Entry* entry = m_cache->find(row);
+    if (entry) {
+        return (*entry->list)[col];
+    }
+    flush();
+
+    IndexType first = row - row % CHECKPOINT_INTERVAL;
+    bool value = (*(*m_checkpoints)[row / CHECKPOINT_INTERVAL])[col];
+    for (IndexType r = first + 1; r <= row; r++) {
+        if (std::binary_search((*m_changes)[r].begin(), (*m_changes)[r].end(), col)) {
+            value = !value;
+        }
+    }
+    return value;
+}
+
+void CDeltaBitMatrix::set(IndexType row, IndexType col, bool value)
+{
+    if (row >= m_row || col >= m_col)
+        throw CException("soda::CDeltaBitMatrix::set()", "Index out of bound!");
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    if (m_cache->modified && m_cache->modified->row != row) {
+        flush();
+    }
+    CBitList& list = cachedRow(row);
+    if (list[col] != value) {
+        list.set(col, value);
+        m_cache->modified = m_cache->find(row);
+    }
+    m_cache->forEachReturned(row, [col, value](RowList& returned) {
+        returned.CBitList::set(col, value);
+    });
+}
+
+void CDeltaBitMatrix::toggleValue(IndexType row, IndexType col)
+{
+    set(row, col, !get(row, col));
+}
+
+void CDeltaBitMatrix::setRowWords(IndexType row, const WordType* words)
+{
+    if (row >= m_row)
+        throw CException("soda::CDeltaBitMatrix::setRowWords()", "Index out of bound!");
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    if (m_cache->modified && m_cache->modified->row != row) {
+        flush();
+    }
+    CBitList& list = cachedRow(row);
+    for (IndexType w = 0; w < list.getNumOfWords(); w++) {
+        list.setWord(w, words[w]);
+    }
+    m_cache->modified = m_cache->find(row);
+    m_cache->forEachReturned(row, [&list](RowList& returned) {
+        returned.assign(returned.row(), list);
+    });
+}
+
+void CDeltaBitMatrix::copyRowWords(IndexType row, WordType* words) const
+{
+    if (row >= m_row)
+        throw CException("soda::CDeltaBitMatrix::copyRowWords()", "Index out of bound!");
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    const CBitList& list = cachedRow(row);
+    std::copy(list.getWords(), list.getWords() + list.getNumOfWords(), words);
+}
+
+void CDeltaBitMatrix::resize(IndexType newRow, IndexType newCol)
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+    clearCache();
+
+    if (newCol < m_col) {
+        for (IndexType r = 0; r < m_row; r++) {
+            IntVector& changes = (*m_changes)[r];
+            changes.erase(std::lower_bound(changes.begin(), changes.end(), newCol), changes.end());
+        }
+    }
+    m_cache->dropReaders();
+    if (newCol != m_col) {
+        for (IndexType i = 0; i < m_checkpoints->size(); i++) {
+            (*m_checkpoints)[i]->resize(newCol);
+        }
+        m_col = newCol;
+    }
+
+    if (newRow < m_row) {
+        IndexType numOfCheckpoints = (newRow + CHECKPOINT_INTERVAL - 1) / CHECKPOINT_INTERVAL;
+        for (IndexType i = numOfCheckpoints; i < m_checkpoints->size(); i++) {
+            delete (*m_checkpoints)[i];
+        }
+        m_checkpoints->resize(numOfCheckpoints);
+        m_changes->resize(newRow);
+    } else if (newRow > m_row) {
+        // The first new row is empty, so it differs from the last row in its true values
+        CBitList last(m_col);
+        if (m_row > 0) {
+            decodeRow(m_row - 1, last);
+        }
+        m_changes->resize(newRow);
+        getDifferences(last.getWords(), NULL, last.getNumOfWords(), (*m_changes)[m_row]);
+        for (IndexType i = m_checkpoints->size(); i * CHECKPOINT_INTERVAL < newRow; i++) {
+            m_checkpoints->push_back(new CBitList(m_col));
+        }
+    }
+    m_row = newRow;
+}
+
+void CDeltaBitMatrix::clear()
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    clearCache();
+    m_cache->dropReaders();
+
+    for (IndexType i = 0; i < m_checkpoints->size(); i++) {
+        delete (*m_checkpoints)[i];
+    }
+    m_checkpoints->clear();
+    m_changes->clear();
+    m_row = 0;
+    m_col = 0;
+}
+
+IBitList& CDeltaBitMatrix::operator[](IndexType row) const
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    std::vector<RowList*>& rows = m_cache->currentReader().rows;
+
+    // The returned row becomes the most recently used row of the thread
+    IndexType i = 0;
+    while (i < rows.size() && rows[i]->row() != row) {
+        i++;
+    }
+    if (i == rows.size()) {
+        if (rows.size() < ROW_CACHE_SIZE) {
+            rows.push_back(new RowList(const_cast<CDeltaBitMatrix*>(this), m_col));
+        }
+        i = rows.size() - 1;
+        rows[i]->assign(row, cachedRow(row));
+    }
+    std::rotate(rows.begin(), rows.begin() + i, rows.begin() + i + 1);
+    return *rows[0];
+}
+
+IBitList& CDeltaBitMatrix::getRow(IndexType row) const
+{
+    if (row >= m_row)
+        throw CException("soda::CDeltaBitMatrix", "Index out of bound!");
+
+    return (*this)[row];
+}
+
+IBitList& CDeltaBitMatrix::getCol(IndexType col) const
+{
+    if (col >= m_col)
+        throw CException("soda::CDeltaBitMatrix", "Index out of bound!");
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+
+    CBitList* column = new CBitList(m_row);
+    bool value = false;
+    for (IndexType r = 0; r < m_row; r++) {
+        if (std::binary_search((*m_changes)[r].begin(), (*m_changes)[r].end(), col)) {
+            value = !value;
+        }
+        if (value) {
+            column->set(r, true);
+        }
+    }
+    return *column;
+}
+
+IBitMatrixIterator& CDeltaBitMatrix::begin()
+{
+    delete m_beginIterator;
+    m_beginIterator = new CDeltaBitMatrix::MatrixIterator(this, 0);
+    return *m_beginIterator;
+}
+
+IBitMatrixIterator& CDeltaBitMatrix::end()
+{
+    delete m_endIterator;
+    m_endIterator = new CDeltaBitMatrix::MatrixIterator(this, m_row * m_col);
+    return *m_endIterator;
+}
+
+void CDeltaBitMatrix::setAll(const bool value)
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    clearCache();
+
+    for (IndexType r = 0; r < m_row; r++) {
+        (*m_changes)[r].clear();
+    }
+    if (value && m_row > 0) {
+        IntVector& changes = (*m_changes)[0];
+        for (IndexType c = 0; c < m_col; c++) {
+            changes.push_back(c);
+        }
+    }
+    for (IndexType i = 0; i < m_checkpoints->size(); i++) {
+        (*m_checkpoints)[i]->setAll(value);
+    }
+    for (RowCache::ReaderMap::iterator it = m_cache->readers.begin(); it != m_cache->readers.end(); ++it) {
+        for (IndexType i = 0; i < it->second.rows.size(); i++) {
+            it->second.rows[i]->CBitList::setAll(value);
+        }
+    }
+}
+
+void CDeltaBitMatrix::save(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk) const
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+
+    //write ChunkID
+    out->writeUInt4(chunk);
+    //write length
+    out->writeULongLong8(2 * sizeof(IndexType) + io::CBitWriter::predictSize(m_row * m_col));
+    //Write rows count of the matrix
+    out->writeULongLong8(m_row);
+    //Write columns count of the matrix
+    out->writeULongLong8(m_col);
+
+    //Write the decoded rows
+    io::CBitWriter bo = io::CBitWriter(out);
+    CBitList current(m_col);
+    for (IndexType r = 0; r < m_row; r++) {
+        const IntVector& changes = (*m_changes)[r];
+        for (IndexType i = 0; i < changes.size(); i++) {
+            current.toggleValue(changes[i]);
+        }
+        bo.writeWords(current.getWords(), m_col);
+    }
+    bo.flush();
+}
+
+void CDeltaBitMatrix::load(io::CBinaryIO* in)
+{
+    IndexType row = in->readULongLong8();
+    IndexType col = in->readULongLong8();
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    clearCache();
+    m_cache->dropReaders();
+    m_row = row;
+    m_col = col;
+    m_changes->assign(row, IntVector());
+
+    io::CBitReader bi = io::CBitReader(in);
+    IndexType numOfWords = CBitOperations::numOfWords(col);
+    std::vector<WordType> previous(numOfWords, 0);
+    std::vector<WordType> current(numOfWords, 0);
+    for (IndexType r = 0; r < row; r++) {
+        bi.readWords(current.data(), col);
+        getDifferences(current.data(), previous.data(), numOfWords, (*m_changes)[r]);
+        previous.swap(current);
+    }
+    bi.reset();
+
+    rebuildCheckpoints();
+}
+
+void CDeltaBitMatrix::saveDeltas(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk) const
+{
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    flush();
+
+    // The length of the encoded rows is computed before writing the chunk header
+    unsigned long long int length = 2 * sizeof(IndexType);
+    for (IndexType r = 0; r < m_row; r++) {
+        length += 8 + io::CDeltaCoder::predictSize((*m_changes)[r]);
+    }
+
+    out->writeUInt4(chunk);
+    out->writeULongLong8(length);
+    out->writeULongLong8(m_row);
+    out->writeULongLong8(m_col);
+
+    std::vector<unsigned char> buffer;
+    for (IndexType r = 0; r < m_row; r++) {
+        const IntVector& changes = (*m_changes)[r];
+        IndexType size = io::CDeltaCoder::encode(changes, buffer);
+        out->writeUInt4(changes.size());
+        out->writeUInt4(size);
+        if (size > 0) {
+            out->writeData(buffer.data(), size);
+        }
+    }
+}
+
+void CDeltaBitMatrix::loadDeltas(const char* data, unsigned long long length)
+{
+    if (length < 2 * sizeof(IndexType))
+        throw CException("soda::CDeltaBitMatrix::loadDeltas()", "The chunk is too short!");
+
+    IndexType row;
+    IndexType col;
+    std::memcpy(&row, data, sizeof(IndexType));
+    std::memcpy(&col, data + sizeof(IndexType), sizeof(IndexType));
+    const unsigned char* pos = (const unsigned char*)data + 2 * sizeof(IndexType);
+    const unsigned char* end = (const unsigned char*)data + length;
+
+    // Each row has at least an 8 byte header
+    if ((length - 2 * sizeof(IndexType)) / 8 < row)
+        throw CException("soda::CDeltaBitMatrix::loadDeltas()", "The chunk is too short!");
+
+    std::vector<IntVector> changes(row);
+    for (IndexType r = 0; r < row; r++) {
+        if (end - pos < 8)
+            throw CException("soda::CDeltaBitMatrix::loadDeltas()", "The chunk is too short!");
+
+        unsigned int count;
+        unsigned int size;
+        std::memcpy(&count, pos, 4);
+        std::memcpy(&size, pos + 4, 4);
+        pos += 8;
+        if (count > col || IndexType(end - pos) < size || !io::CDeltaCoder::decode(pos, size, count, changes[r]))
+            throw CException("soda::CDeltaBitMatrix::loadDeltas()", "Invalid change list!");
+
+        const IntVector& indices = changes[r];
+        for (IndexType i = 0; i < indices.size(); i++) {
+            if (indices[i] >= col || (i > 0 && indices[i] <= indices[i - 1]))
+                throw CException("soda::CDeltaBitMatrix::loadDeltas()", "Invalid change list!");
+        }
+        pos += size;
+    }
+
+    boost::mutex::scoped_lock lock(m_cache->mutex);
+    clearCache();
+    m_cache->dropReaders();
+    m_row = row;
+    m_col = col;
+    m_changes->swap(changes);
+    rebuildCheckpoints();
+}
+
+} // namespace soda
@@ -0,0 +1,260 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "data/CFLMetricTable.h"
+#include "exception/CException.h"
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/prettywriter.h"
+
+namespace soda {
+
+const IndexType CFLMetricTable::NO_ROW = (IndexType)-1;
+
+CFLMetricTable::CFLMetricTable() :
+    m_codeElements(new IntVector()),
+    m_rows(new IntVector()),
+    m_columns(new std::deque<Column>())
+{ }
+
+CFLMetricTable::CFLMetricTable(const CFLMetricTable &other) :
+    m_codeElements(new IntVector(*other.m_codeElements)),
+    m_rows(new IntVector(*other.m_rows)),
+    m_columns(new std::deque<Column>(*other.m_columns))
+{ }
+
+CFLMetricTable::~CFLMetricTable()
+{
+    delete m_codeElements;
+    delete m_rows;
+    delete m_columns;
+}
+
+CFLMetricTable& CFLMetricTable::operator=(const CFLMetricTable &rhs)
+{
+    if (this != &rhs) {
+        *m_codeElements = *rhs.m_codeElements;
+        *m_rows = *rhs.m_rows;
+        *m_columns = *rhs.m_columns;
+    }
+    return *this;
+}
+
+void CFLMetricTable::setCodeElements(const IntVector &codeElements)
+{
+    *m_codeElements = codeElements;
+    m_columns->clear();
+    m_rows->clear();
+    for (IndexType i = 0; i < codeElements.size(); ++i) {
+        if (codeElements[i] >= m_rows->size()) {
+            m_rows->resize(codeElements[i] + 1, NO_ROW);
+        }
+        (*m_rows)[codeElements[i]] = i;
+    }
+}
+
+const IntVector& CFLMetricTable::getCodeElements() const
+{
+    return *m_codeElements;
+}
+
+IndexType CFLMetricTable::getNumOfRows() const
+{
+    return m_codeElements->size();
+}
+
+IndexType CFLMetricTable::getRow(IndexType cid) const
+{
+    return cid < m_rows->size() ? (*m_rows)[cid] : NO_ROW;
+}
+
+bool CFLMetricTable::hasColumn(const String &name) const
+{
+    return findColumn(name) != NULL;
+}
+
+StringVector CFLMetricTable::getColumnNames() const
+{
+    StringVector names;
+    for (std::deque<Column>::const_iterator it = m_columns->begin(); it != m_columns->end(); ++it) {
+        names.push_back(it->name);
+    }
+    return names;
+}
+
+IntVector& CFLMetricTable::addUIntColumn(const String &name)
+{
+    return addColumn(name, ctUInt64).uintValues;
+}
+
+std::vector<double>& CFLMetricTable::addDoubleColumn(const String &name)
+{
+    return addColumn(name, ctDouble).doubleValues;
+}
+
+const IntVector& CFLMetricTable::getUIntColumn(const String &name) const
+{
+    const Column *column = findColumn(name);
+    if (column == NULL || column->type != ctUInt64) {
+        throw CException("soda::CFLMetricTable::getUIntColumn()", "There is no unsigned integer column: " + name);
+    }
+    return column->uintValues;
+}
+
+const std::vector<double>& CFLMetricTable::getDoubleColumn(const String &name) const
+{
+    const Column *column = findColumn(name);
+    if (column == NULL || column->type != ctDouble) {
+        throw CException("soda::CFLMetricTable::getDoubleColumn()", "There is no double column: " + name);
+    }
+    return column->doubleValues;
+}
+
+void CFLMetricTable::writeCsvHeader(std::ostream &out, const String &separator) const
+{
+    for (std::deque<Column>::const_iterator it = m_columns->begin(); it != m_columns->end(); ++it) {
+        out << it->name << separator;
+    }
+}
+
+void CFLMetricTable::writeCsvRow(std::ostream &out, IndexType row, const String &separator) const
+{
+    for (std::deque<Column>::const_iterator it = m_columns->begin(); it != m_columns->end(); ++it) {
+        if (it->type == ctUInt64) {
+            out << it->uintValues[row];
+        } else {
+            out << it->doubleValues[row];
+        }
+        out << separator;
+    }
+}
+
+void CFLMetricTable::writeJson(std::ostream &out) const
+{
+    rapidjson::OStreamWrapper os(out);
+    rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(os);
+    writeJson(writer);
+}
+
+void CFLMetricTable::toJson(rapidjson::Value &object, rapidjson::Document::AllocatorType &allocator, const StringVector &columns) const
+{
+    std::vector<const Column*> selected;
+    for (StringVector::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+        const Column *column = findColumn(*it);
+        if (column == NULL) {
+            throw CException("soda::CFLMetricTable::toJson()", "There is no column: " + *it);
+        }
+        selected.push_back(column);
+    }
+
+    for (IndexType row = 0; row < m_codeElements->size(); ++row) {
+        String ceIdStr = std::to_string((*m_codeElements)[row]);
+
+        // The members are usually in the order of the rows, so the linear lookup is avoided.
+        rapidjson::Value::MemberIterator ceMember = object.MemberEnd();
+        if (row < object.MemberCount() && ceIdStr == (object.MemberBegin() + row)->name.GetString()) {
+            ceMember = object.MemberBegin() + row;
+        } else {
+            ceMember = object.FindMember(ceIdStr.c_str());
+            if (ceMember == object.MemberEnd()) {
+                object.AddMember(rapidjson::Value(ceIdStr.c_str(), allocator), rapidjson::Value(rapidjson::kObjectType), allocator);
+                ceMember = object.MemberEnd() - 1;
+            }
+        }
+
+        for (std::vector<const Column*>::const_iterator it = selected.begin(); it != selected.end(); ++it) {
+            rapidjson::Value value;
+            if ((*it)->type == ctUInt64) {
+                value.SetUint64((*it)->uintValues[row]);
+            } else {
+                value.SetDouble((*it)->doubleValues[row]);
+            }
+            ceMember->value.AddMember(rapidjson::Value((*it)->name.c_str(), allocator), value, allocator);
+        }
+    }
+}
+
+void CFLMetricTable::loadUIntColumns(const rapidjson::Value &object, const StringVector &columns)
+{
+    IntVector codeElements;
+    for (rapidjson::Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it) {
+        codeElements.push_back(std::stoul(it->name.GetString()));
+    }
+    setCodeElements(codeElements);
+
+    for (StringVector::const_iterator columnIt = columns.begin(); columnIt != columns.end(); ++columnIt) {
+        IntVector &values = addUIntColumn(*columnIt);
+        IndexType row = 0;
+        for (rapidjson::Value::ConstMemberIterator it = object.MemberBegin(); it != object.MemberEnd(); ++it, ++row) {
+            rapidjson::Value::ConstMemberIterator value = it->value.FindMember(columnIt->c_str());
+            if (value == it->value.MemberEnd()) {
+                throw CException("soda::CFLMetricTable::loadUIntColumns()", "Missing value: " + *columnIt);
+            }
+            values[row] = value->value.GetUint64();
+        }
+    }
+}
+
+void CFLMetricTable::writeJson(std::ostream &out, const std::map<String, CFLMetricTable> &tables)
+{
+    rapidjson::OStreamWrapper os(out);
+    rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(os);
+    writer.StartObject();
+    for (std::map<String, CFLMetricTable>::const_iterator it = tables.begin(); it != tables.end(); ++it) {
+        writer.Key(it->first.c_str(), it->first.size());
+        it->second.writeJson(writer);
+    }
+    writer.EndObject();
+}
+
+const CFLMetricTable::Column* CFLMetricTable::findColumn(const String &name) const
+{
+    for (std::deque<Column>::const_iterator it = m_columns->begin(); it != m_columns->end(); ++it) {
+        if (it->name == name) {
+            return &(*it);
+        }
+    }
+    return NULL;
+}
+
+CFLMetricTable::Column& CFLMetricTable::addColumn(const String &name, eColumnType type)
+{
+    for (std::deque<Column>::iterator it = m_columns->begin(); it != m_columns->end(); ++it) {
+        if (it->name == name) {
+            if (it->type != type) {
+                throw CException("soda::CFLMetricTable::addColumn()", "The column exists with a different type: " + name);
+            }
+            return *it;
+        }
+    }
+
+    m_columns->push_back(Column());
+    Column &column = m_columns->back();
+    column.name = name;
+    column.type = type;
+    if (type == ctUInt64) {
+        column.uintValues.resize(m_codeElements->size(), 0);
+    } else {
+        column.doubleValues.resize(m_codeElements->size(), 0);
+    }
+    return column;
+}
+
+} /* namespace soda */
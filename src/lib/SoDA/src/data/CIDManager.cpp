@@ -20,6 +20,8 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 #include "io/CBinaryIO.h"
@@ -27,92 +29,212 @@
 
 namespace soda {
 
-CIDManager::CIDManager()
+const IndexType CIDManager::NO_ID = (IndexType)-1;
+const IndexType CIDManager::DELETED_ID = (IndexType)-2;
+
+CIDManager::CIDManager() :
+    m_tableUsed(0),
+    m_garbage(0)
+{}
+
+CIDManager::CIDManager(const StringVector& valueList) :
+    m_tableUsed(0),
+    m_garbage(0)
 {
-    m_data.clear();
-    m_adat.clear();
+    m_entries.reserve(valueList.size());
+    m_ids.reserve(valueList.size());
+    rehash(valueList.size());
+    for (IndexType i = 0; i < valueList.size(); ++i) {
+        insert(i, valueList[i].c_str(), valueList[i].length());
+    }
 }
 
-CIDManager::CIDManager(const StringVector& valueList)
+CIDManager::CIDManager(StringMap& map) :
+    m_tableUsed(0),
+    m_garbage(0)
 {
-    m_data.clear();
-    m_adat.clear();
-    for (unsigned int i = 0; i < valueList.size(); ++i) {
-        m_data.insert(std::pair<IndexType, String>(i,valueList[i]));
-        m_adat.insert(std::pair<String, IndexType>(valueList[i],i));
+    rehash(map.size());
+    for(StringMap::const_iterator i = map.begin(); i != map.end(); ++i) {
+        insert(i->first, i->second.c_str(), i->second.length());
     }
 }
 
-CIDManager::CIDManager(StringMap& map)
+CIDManager::CIDManager(IdxStrMap& map) :
+    m_tableUsed(0),
+    m_garbage(0)
 {
-    m_data = map;
-    m_adat.clear();
-    for(StringMap::const_iterator i = m_data.begin(); i != m_data.end(); ++i) {
-        m_adat.insert(std::pair<String, IndexType>(i->second,i->first));
+    rehash(map.size());
+    for(IdxStrMap::const_iterator i = map.begin(); i != map.end(); ++i) {
+        insert(i->second, i->first.c_str(), i->first.length());
     }
+}
+
+CIDManager::~CIDManager()
+{}
 
+IndexType CIDManager::hash(const char* value, IndexType length)
+{
+    // FNV-1a
+    IndexType h = 14695981039346656037ULL;
+    for (IndexType i = 0; i < length; ++i) {
+        h ^= (unsigned char)value[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
 }
 
-CIDManager::CIDManager(IdxStrMap& map)
+IndexType CIDManager::findSlot(const char* value, IndexType length) const
 {
-    m_adat = map;
-    m_data.clear();
-    for(IdxStrMap::const_iterator i = m_adat.begin(); i != m_adat.end(); ++i) {
-        m_data.insert(std::pair<IndexType, String>(i->second,i->first));
+    if (m_table.empty()) {
+        return 0;
     }
 
+    IndexType mask = m_table.size() - 1;
+    for (IndexType slot = hash(value, length) & mask; ; slot = (slot + 1) & mask) {
+        IndexType id = m_table[slot];
+        if (id == NO_ID) {
+            return m_table.size();
+        }
+        if (id != DELETED_ID) {
+            const Entry& entry = m_entries[id];
+            if (entry.length == length && std::memcmp(&m_arena[entry.offset], value, length) == 0) {
+                return slot;
+            }
+        }
+    }
 }
 
-CIDManager::~CIDManager()
-{}
+void CIDManager::insertHash(const IndexType id)
+{
+    if ((m_tableUsed + 1) * 2 > m_table.size()) {
+        rehash(m_ids.size() + 1);
+    }
 
-bool CIDManager::containsValue(const String &value) const
+    const Entry& entry = m_entries[id];
+    IndexType mask = m_table.size() - 1;
+    IndexType slot = hash(&m_arena[entry.offset], entry.length) & mask;
+    while (m_table[slot] != NO_ID && m_table[slot] != DELETED_ID) {
+        slot = (slot + 1) & mask;
+    }
+    if (m_table[slot] == NO_ID) {
+        m_tableUsed++;
+    }
+    m_table[slot] = id;
+}
+
+void CIDManager::rehash(IndexType capacity)
 {
-    if (m_adat.find(value) == m_adat.end()) {
-        return false;
+    IndexType size = 16;
+    while (size < capacity * 2) {
+        size *= 2;
+    }
+
+    IntVector old;
+    old.swap(m_table);
+    m_table.assign(size, NO_ID);
+    m_tableUsed = 0;
+
+    // The ids are reinserted in the original order, so the duplicated values keep resolving to the same id.
+    IndexType mask = size - 1;
+    for (IntVector::const_iterator it = old.begin(); it != old.end(); ++it) {
+        if (*it == NO_ID || *it == DELETED_ID) {
+            continue;
+        }
+        const Entry& entry = m_entries[*it];
+        IndexType slot = hash(&m_arena[entry.offset], entry.length) & mask;
+        while (m_table[slot] != NO_ID) {
+            slot = (slot + 1) & mask;
+        }
+        m_table[slot] = *it;
+        m_tableUsed++;
     }
-    return true;
+}
+
+void CIDManager::insert(const IndexType id, const char* value, IndexType length)
+{
+    if (id < m_entries.size() && m_entries[id].offset != NO_ID) {
+        return;
+    }
+
+    if (id >= m_entries.size()) {
+        Entry unused = { NO_ID, 0 };
+        m_entries.resize(id + 1, unused);
+    }
+    m_entries[id].offset = m_arena.size();
+    m_entries[id].length = length;
+    m_arena.insert(m_arena.end(), value, value + length);
+    m_arena.push_back('\0');
+
+    if (m_ids.empty() || m_ids.back() < id) {
+        m_ids.push_back(id);
+    } else {
+        m_ids.insert(std::lower_bound(m_ids.begin(), m_ids.end(), id), id);
+    }
+
+    if (findSlot(value, length) >= m_table.size()) {
+        insertHash(id);
+    }
+}
+
+void CIDManager::compact()
+{
+    std::vector<char> arena;
+    arena.reserve(m_arena.size() - m_garbage);
+    for (IntVector::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it) {
+        Entry& entry = m_entries[*it];
+        IndexType offset = arena.size();
+        arena.insert(arena.end(), m_arena.begin() + entry.offset, m_arena.begin() + entry.offset + entry.length + 1);
+        entry.offset = offset;
+    }
+    m_arena.swap(arena);
+    m_garbage = 0;
+}
+
+bool CIDManager::containsValue(const String &value) const
+{
+    return findSlot(value.c_str(), value.length()) < m_table.size();
 }
 
 IndexType CIDManager::getID(const String& value) const
 {
-    IdxStrMap::const_iterator it=m_adat.find(value);
-    if(it != m_adat.end()) {
-        return it->second;
+    IndexType slot = findSlot(value.c_str(), value.length());
+    if (slot < m_table.size()) {
+        return m_table[slot];
     }
     throw std::out_of_range("Value is not present in the Manager.");
 }
 
 String CIDManager::getValue(const IndexType id) const
 {
-    return m_data.at(id);
+    if (id >= m_entries.size() || m_entries[id].offset == NO_ID) {
+        throw std::out_of_range("Index is not present in the Manager.");
+    }
+    return String(&m_arena[m_entries[id].offset], m_entries[id].length);
 }
 
 IntVector CIDManager::getIDList() const
 {
-    IntVector tmp;
-
-    for(StringMap::const_iterator it = m_data.begin() ; it != m_data.end(); it++ ) {
-        tmp.push_back(it->first);
-    }
+    return m_ids;
+}
 
-    return tmp;
+const IntVector& CIDManager::getIDs() const
+{
+    return m_ids;
 }
 
 StringVector CIDManager::getValueList() const
 {
     StringVector tmp;
-    for(StringMap::const_iterator it = m_data.begin() ; it != m_data.end(); it++ ) {
-        tmp.push_back(it->second);
+    tmp.reserve(m_ids.size());
+    for (IntVector::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it) {
+        tmp.push_back(String(&m_arena[m_entries[*it].offset], m_entries[*it].length));
     }
-
     return tmp;
-
 }
 
 String CIDManager::operator[](const IndexType id) const
 {
-    return m_data.at(id);
+    return getValue(id);
 }
 
 IndexType CIDManager::operator[](const String& codeElementName) const
@@ -122,66 +244,78 @@ IndexType CIDManager::operator[](const String& codeElementName) const
 
 IndexType CIDManager::getLastIndex() const
 {
-    if (m_data.empty()) {
+    if (m_ids.empty()) {
         throw std::length_error("The manager is empty.");
     }
-    return m_data.rbegin()->first;
+    return m_ids.back();
 }
 
 IndexType CIDManager::size() const
 {
-    return m_data.size();
+    return m_ids.size();
 }
 
 void CIDManager::add(const IndexType id, const String& value)
 {
-    if(m_adat.find(value) == m_adat.end()) {
-        m_data.insert(std::pair<IndexType, String>(id,value));
-        m_adat.insert(std::pair<String, IndexType>(value,id));
+    if (!containsValue(value)) {
+        insert(id, value.c_str(), value.length());
     }
 }
 
 void CIDManager::add(const String& value)
 {
-    IndexType id = 0;
-    try {
-        id = getLastIndex();
-        id++;
-    } catch (std::length_error &) {}
-
-    add(id, value);
+    add(m_ids.empty() ? 0 : m_ids.back() + 1, value);
 }
 
 void CIDManager::remove(const IndexType id)
 {
-    StringMap::iterator it = m_data.find(id);
-    if(it != m_data.end()) {
-        m_adat.erase(it->second);
-        m_data.erase(it);
+    if (id >= m_entries.size() || m_entries[id].offset == NO_ID) {
+        return;
+    }
+
+    Entry& entry = m_entries[id];
+    IndexType slot = findSlot(&m_arena[entry.offset], entry.length);
+    if (slot < m_table.size() && m_table[slot] == id) {
+        m_table[slot] = DELETED_ID;
+    }
+
+    m_garbage += entry.length + 1;
+    entry.offset = NO_ID;
+    entry.length = 0;
+    m_ids.erase(std::lower_bound(m_ids.begin(), m_ids.end(), id));
+    while (!m_entries.empty() && m_entries.back().offset == NO_ID) {
+        m_entries.pop_back();
+    }
+
+    if (m_garbage > m_arena.size() / 2) {
+        compact();
     }
 }
 
 void CIDManager::remove(const String& value)
 {
-    IdxStrMap::iterator it = m_adat.find(value);
-    if(it != m_adat.end()) {
-        m_data.erase(it->second);
-        m_adat.erase(it);
+    IndexType slot = findSlot(value.c_str(), value.length());
+    if (slot < m_table.size()) {
+        remove(m_table[slot]);
     }
 }
 
 void CIDManager::clear()
 {
-    m_data.clear();
-    m_adat.clear();
+    m_entries.clear();
+    m_ids.clear();
+    m_arena.clear();
+    m_table.clear();
+    m_tableUsed = 0;
+    m_garbage = 0;
 }
 
 void CIDManager::save(io::CBinaryIO *out, const io::CSoDAio::ChunkID chunk) const
 {
     unsigned long long int length = sizeof(IndexType);
-    for(StringMap::const_iterator it = m_data.begin() ; it != m_data.end(); ++it ) {
+    for (IntVector::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it) {
         length += sizeof(IndexType);
-        length += it->second.length() + 1;
+        length += m_entries[*it].length + 1;
     }
     //write ChunkID
     out->writeUInt4(chunk);
@@ -190,28 +324,27 @@ void CIDManager::save(io::CBinaryIO *out, const io::CSoDAio::ChunkID chunk) cons
     out->writeULongLong8(length);
 
     //write the number of elements
-    IndexType size = m_data.size();
+    IndexType size = m_ids.size();
     out->writeLongLong8(size);
 
     //write elements
-    for(StringMap::const_iterator it = m_data.begin() ; it != m_data.end(); ++it ) {
-        out->writeLongLong8(it->first);
-        out->writeString(it->second);
+    for (IntVector::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it) {
+        out->writeLongLong8(*it);
+        out->writeData(&m_arena[m_entries[*it].offset], m_entries[*it].length + 1);
     }
 }
 
 void CIDManager::load(io::CBinaryIO *in)
 {
-    m_data.clear();
-    m_adat.clear();
+    clear();
     IndexType size = in->readLongLong8();
 
+    m_ids.reserve(size);
+    rehash(size);
     for (IndexType i = 0; i < size; ++i) {
         IndexType index = in->readLongLong8();
         String value = in->readString();
-
-        m_data.insert(std::pair<IndexType, String>(index, value));
-        m_adat.insert(std::pair<String, IndexType>(value, index));
+        insert(index, value.c_str(), value.length());
     }
 }
 
@@ -20,6 +20,7 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <stdexcept>
 #include <boost/lexical_cast.hpp>
 
@@ -29,15 +30,22 @@
 
 namespace soda {
 
+const IndexType CIDMapper::NO_ID = (IndexType)-1;
+
 CIDMapper::CIDMapper(IIDManager * globalIdManager) : m_globalIdManager(globalIdManager)
-{
-    m_globalToLocal.clear();
-    m_localToGlobal.clear();
-}
+{}
 
 CIDMapper::~CIDMapper()
 {}
 
+IndexType CIDMapper::toGlobal(const IndexType id) const
+{
+    if (id >= m_localToGlobal.size() || m_localToGlobal[id] == NO_ID) {
+        throw std::out_of_range("Index is not present in the Mapper.");
+    }
+    return m_localToGlobal[id];
+}
+
 bool CIDMapper::containsValue(const String &value) const
 {
     if (!m_globalIdManager->containsValue(value)) {
@@ -45,11 +53,7 @@ bool CIDMapper::containsValue(const String &value) const
     }
 
     IndexType globalIdx = m_globalIdManager->getID(value);
-    if (m_globalToLocal.find(globalIdx) == m_globalToLocal.end()) {
-        return false;
-    }
-
-    return true;
+    return globalIdx < m_globalToLocal.size() && m_globalToLocal[globalIdx] != NO_ID;
 }
 
 IndexType CIDMapper::getID(const String& value) const
@@ -59,42 +63,40 @@ IndexType CIDMapper::getID(const String& value) const
     }
 
     IndexType globalIdx = m_globalIdManager->getID(value);
-
-    maptype::const_iterator it = m_globalToLocal.find(globalIdx);
-    if(it != m_globalToLocal.end()) {
-        return it->second;
+    if (globalIdx < m_globalToLocal.size() && m_globalToLocal[globalIdx] != NO_ID) {
+        return m_globalToLocal[globalIdx];
     }
     throw std::out_of_range("Value is not present in the Mapper.");
 }
 
 String CIDMapper::getValue(const IndexType id) const
 {
-    return m_globalIdManager->getValue(m_localToGlobal.at(id));
+    return m_globalIdManager->getValue(toGlobal(id));
 }
 
 IntVector CIDMapper::getIDList() const
 {
-    IntVector tmp;
-
-    for(maptype::const_iterator it = m_localToGlobal.begin() ; it != m_localToGlobal.end(); it++ ) {
-        tmp.push_back(it->first);
-    }
+    return m_ids;
+}
 
-    return tmp;
+const IntVector& CIDMapper::getIDs() const
+{
+    return m_ids;
 }
 
 StringVector CIDMapper::getValueList() const
 {
     StringVector tmp;
-    for(maptype::const_iterator it = m_localToGlobal.begin() ; it != m_localToGlobal.end(); it++ ) {
-        tmp.push_back(m_globalIdManager->getValue(it->second));
+    tmp.reserve(m_ids.size());
+    for (IntVector::const_iterator it = m_ids.begin(); it != m_ids.end(); ++it) {
+        tmp.push_back(m_globalIdManager->getValue(m_localToGlobal[*it]));
     }
     return tmp;
 }
 
 String CIDMapper::operator[](const IndexType id) const
 {
-    return m_globalIdManager->getValue(m_localToGlobal.at(id));
+    return m_globalIdManager->getValue(toGlobal(id));
 }
 
 IndexType CIDMapper::operator[](const String& codeElementName) const
@@ -104,15 +106,15 @@ IndexType CIDMapper::operator[](const String& codeElementName) const
 
 IndexType CIDMapper::getLastIndex() const
 {
-    if (m_localToGlobal.empty()) {
+    if (m_ids.empty()) {
         throw std::length_error("The manager is empty.");
     }
-    return m_localToGlobal.rbegin()->first;
+    return m_ids.back();
 }
 
 IndexType CIDMapper::size() const
 {
-    return m_localToGlobal.size();
+    return m_ids.size();
 }
 
 IndexType CIDMapper::translateFromAnotherId(CIDMapper& remoteMapper, IndexType remoteId)
@@ -121,11 +123,8 @@ IndexType CIDMapper::translateFromAnotherId(CIDMapper& remoteMapper, IndexType r
         throw CException("soda::CIDMapper::translateFromAnotherId()", "Different global ID managers are used!");
     }
 
-    IndexType globalId=remoteMapper.m_localToGlobal.at(remoteId);
-    IndexType localId =remoteId;
-    try {
-        localId=m_globalToLocal.at(globalId);
-    } catch (std::out_of_range e) {
+    IndexType globalId = remoteMapper.toGlobal(remoteId);
+    if (globalId >= m_globalToLocal.size() || m_globalToLocal[globalId] == NO_ID) {
         std::string message =
             std::string("Broken ID link, R[") +
             boost::lexical_cast<std::string>(remoteId) +
@@ -136,36 +135,97 @@ IndexType CIDMapper::translateFromAnotherId(CIDMapper& remoteMapper, IndexType r
             std::string("\"] -> L[???]");
         throw CException("soda::CIDMapper::translateFromAnotherId()", message);
     }
-    return localId;
+    return m_globalToLocal[globalId];
+}
+
+void CIDMapper::getTranslationTable(const CIDMapper& remoteMapper, IntVector& table) const
+{
+    if(remoteMapper.m_globalIdManager != m_globalIdManager) {
+        throw CException("soda::CIDMapper::getTranslationTable()", "Different global ID managers are used!");
+    }
+
+    table.assign(remoteMapper.m_localToGlobal.size(), NO_ID);
+    for (IndexType remoteId = 0; remoteId < table.size(); remoteId++) {
+        IndexType globalId = remoteMapper.m_localToGlobal[remoteId];
+        if (globalId != NO_ID && globalId < m_globalToLocal.size()) {
+            table[remoteId] = m_globalToLocal[globalId];
+        }
+    }
 }
 
 void CIDMapper::add(const IndexType id, const String& value)
 {
     m_globalIdManager->add(value);
     IndexType globalIdx = m_globalIdManager->getID(value);
-    if(m_globalToLocal.find(globalIdx) == m_globalToLocal.end()) {
-        m_localToGlobal.insert(std::pair<IndexType, IndexType>(id, globalIdx));
-        m_globalToLocal.insert(std::pair<IndexType, IndexType>(globalIdx, id));
+    if (globalIdx < m_globalToLocal.size() && m_globalToLocal[globalIdx] != NO_ID) {
+        return;
+    }
+    if (id < m_localToGlobal.size() && m_localToGlobal[id] != NO_ID) {
+        return;
+    }
+
+    if (globalIdx >= m_globalToLocal.size()) {
+        m_globalToLocal.resize(globalIdx + 1, NO_ID);
+    }
+    if (id >= m_localToGlobal.size()) {
+        m_localToGlobal.resize(id + 1, NO_ID);
+    }
+    m_globalToLocal[globalIdx] = id;
+    m_localToGlobal[id] = globalIdx;
+
+    if (m_ids.empty() || m_ids.back() < id) {
+        m_ids.push_back(id);
+    } else {
+        m_ids.insert(std::lower_bound(m_ids.begin(), m_ids.end(), id), id);
     }
 }
 
 void CIDMapper::add(const String& value)
 {
-    IndexType id = 0;
-    try {
-        id = getLastIndex();
-        id++;
-    } catch (std::length_error &) {}
+    add(m_ids.empty() ? 0 : m_ids.back() + 1, value);
+}
+
+void CIDMapper::addGlobalIds()
+{
+    const IntVector& globalIds = m_globalIdManager->getIDs();
+    if (!globalIds.empty() && globalIds.back() >= m_globalToLocal.size()) {
+        m_globalToLocal.resize(globalIds.back() + 1, NO_ID);
+    }
 
-    add(id, value);
+    IndexType id = m_ids.empty() ? 0 : m_ids.back() + 1;
+    for (IntVector::const_iterator it = globalIds.begin(); it != globalIds.end(); ++it) {
+        if (m_globalToLocal[*it] != NO_ID) {
+            continue;
+        }
+        m_globalToLocal[*it] = id;
+        m_localToGlobal.resize(id, NO_ID);
+        m_localToGlobal.push_back(*it);
+        m_ids.push_back(id++);
+    }
+}
+
+void CIDMapper::assign(const CIDMapper& remoteMapper)
+{
+    if(remoteMapper.m_globalIdManager != m_globalIdManager) {
+        throw CException("soda::CIDMapper::assign()", "Different global ID managers are used!");
+    }
+
+    m_globalToLocal = remoteMapper.m_globalToLocal;
+    m_localToGlobal = remoteMapper.m_localToGlobal;
+    m_ids = remoteMapper.m_ids;
 }
 
 void CIDMapper::remove(const IndexType id)
 {
-    maptype::iterator it = m_localToGlobal.find(id);
-    if(it != m_localToGlobal.end()) {
-        m_globalToLocal.erase(it->second);
-        m_localToGlobal.erase(it);
+    if (id >= m_localToGlobal.size() || m_localToGlobal[id] == NO_ID) {
+        return;
+    }
+
+    m_globalToLocal[m_localToGlobal[id]] = NO_ID;
+    m_localToGlobal[id] = NO_ID;
+    m_ids.erase(std::lower_bound(m_ids.begin(), m_ids.end(), id));
+    while (!m_localToGlobal.empty() && m_localToGlobal.back() == NO_ID) {
+        m_localToGlobal.pop_back();
     }
 }
 
@@ -176,10 +236,8 @@ void CIDMapper::remove(const String& value)
     }
 
     IndexType globalIdx = m_globalIdManager->getID(value);
-    maptype::iterator it = m_globalToLocal.find(globalIdx);
-    if(it != m_globalToLocal.end()) {
-        m_localToGlobal.erase(it->second);
-        m_globalToLocal.erase(it);
+    if (globalIdx < m_globalToLocal.size() && m_globalToLocal[globalIdx] != NO_ID) {
+        remove(m_globalToLocal[globalIdx]);
     }
 }
 
@@ -187,16 +245,18 @@ void CIDMapper::clear()
 {
     m_globalToLocal.clear();
     m_localToGlobal.clear();
+    m_ids.clear();
 }
 
 void CIDMapper::save(io::CBinaryIO *out, const io::CSoDAio::ChunkID chunk) const
 {
     unsigned long long int length = sizeof(IndexType);
 
-    for(maptype::const_iterator it = m_localToGlobal.begin() ; it != m_localToGlobal.end(); it++ ) {
-        length += m_globalIdManager->getValue(it->second).length();
+    StringVector values = getValueList();
+    for (StringVector::const_iterator it = values.begin(); it != values.end(); ++it) {
+        length += it->length();
     }
-    length += m_localToGlobal.size() * (1 + sizeof(IndexType));
+    length += m_ids.size() * (1 + sizeof(IndexType));
 
     //write ChunkID
     out->writeUInt4(chunk);
@@ -205,22 +265,22 @@ void CIDMapper::save(io::CBinaryIO *out, const io::CSoDAio::ChunkID chunk) const
     out->writeULongLong8(length);
 
     //write the number of elements
-    IndexType size = m_localToGlobal.size();
+    IndexType size = m_ids.size();
     out->writeLongLong8(size);
 
     //write elements
-    for(maptype::const_iterator it = m_localToGlobal.begin() ; it != m_localToGlobal.end(); it++ ) {
-        out->writeLongLong8(it->first);
-        out->writeString(m_globalIdManager->getValue(it->second));
+    for (IndexType i = 0; i < size; ++i) {
+        out->writeLongLong8(m_ids[i]);
+        out->writeString(values[i]);
     }
 }
 
 void CIDMapper::load(io::CBinaryIO *in)
 {
-    m_localToGlobal.clear();
-    m_globalToLocal.clear();
+    clear();
     IndexType size = in->readLongLong8();
 
+    m_ids.reserve(size);
     for (IndexType i = 0; i < size; ++i) {
         IndexType index = in->readLongLong8();
         String value = in->readString();
@@ -25,9 +25,184 @@
 #include "data/CIndexBitList.h"
 #include "exception/CException.h"
 #include "interface/IIterators.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
+namespace {
+
+/**
+ * @brief Number of lower position bits stored in a container.
+ */
+const unsigned int CONTAINER_BITS = 16;
+
+/**
+ * @brief Mask of the lower position bits.
+ */
+const IndexType CONTAINER_MASK = (IndexType(1) << CONTAINER_BITS) - 1;
+
+/**
+ * @brief Number of words of a bitmap container.
+ */
+const IndexType BITMAP_WORDS = (IndexType(1) << CONTAINER_BITS) / CBitOperations::BITS_PER_WORD;
+
+/**
+ * @brief Maximal number of positions of an array container, it takes the same space as a bitmap.
+ */
+const IndexType ARRAY_LIMIT = 4096;
+
+} // namespace
+
+/**
+ * @brief The CIndexBitList::Container struct stores the positions with the same upper bits.
+ */
+struct CIndexBitList::Container {
+    /**
+     * @brief Upper bits of the positions.
+     */
+    IndexType key;
+
+    /**
+     * @brief Number of stored positions.
+     */
+    IndexType count;
+
+    /**
+     * @brief Sorted lower bits of the positions, used if the bitmap is empty.
+     */
+    std::vector<u_int16_t> array;
+
+    /**
+     * @brief Lower bits of the positions as a bitmap of BITMAP_WORDS words, used above ARRAY_LIMIT positions.
+     */
+    std::vector<WordType> bitmap;
+
+    explicit Container(IndexType k) :
+        key(k),
+        count(0)
+    {}
+
+    static bool lessKey(const Container &container, IndexType k)
+    {
+        return container.key < k;
+    }
+
+    bool contains(u_int16_t low) const
+    {
+        if (!bitmap.empty()) {
+            return (bitmap[low / CBitOperations::BITS_PER_WORD] >> (low % CBitOperations::BITS_PER_WORD)) & 1;
+        }
+        return std::binary_search(array.begin(), array.end(), low);
+    }
+
+    bool add(u_int16_t low)
+    {
+        if (!bitmap.empty()) {
+            WordType bit = WordType(1) << (low % CBitOperations::BITS_PER_WORD);
+            WordType &word = bitmap[low / CBitOperations::BITS_PER_WORD];
+            if (word & bit) {
+                return false;
+            }
+            word |= bit;
+        } else {
+            std::vector<u_int16_t>::iterator it = std::lower_bound(array.begin(), array.end(), low);
+            if (it != array.end() && *it == low) {
+                return false;
+            }
+            array.insert(it, low);
+            if (array.size() > ARRAY_LIMIT) {
+                toBitmap();
+            }
+        }
+        count++;
+        return true;
+    }
+
+    bool remove(u_int16_t low)
+    {
+        if (!bitmap.empty()) {
+            WordType bit = WordType(1) << (low % CBitOperations::BITS_PER_WORD);
+            WordType &word = bitmap[low / CBitOperations::BITS_PER_WORD];
+            if (!(word & bit)) {
+                return false;
+            }
+            word &= ~bit;
+            count--;
+            if (count <= ARRAY_LIMIT) {
+                toArray();
+            }
+        } else {
+            std::vector<u_int16_t>::iterator it = std::lower_bound(array.begin(), array.end(), low);
+            if (it == array.end() || *it != low) {
+                return false;
+            }
+            array.erase(it);
+            count--;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Removes the positions whose lower bits are not less than low.
+     */
+    void truncate(IndexType low)
+    {
+        if (!bitmap.empty()) {
+            for (IndexType i = low; i < BITMAP_WORDS * CBitOperations::BITS_PER_WORD && i % CBitOperations::BITS_PER_WORD != 0; i++) {
+                bitmap[i / CBitOperations::BITS_PER_WORD] &= ~(WordType(1) << (i % CBitOperations::BITS_PER_WORD));
+            }
+            std::fill(bitmap.begin() + CBitOperations::numOfWords(low), bitmap.end(), 0);
+            count = CBitOperations::count(bitmap.data(), BITMAP_WORDS);
+            if (count <= ARRAY_LIMIT) {
+                toArray();
+            }
+        } else {
+            array.erase(std::lower_bound(array.begin(), array.end(), low), array.end());
+            count = array.size();
+        }
+    }
+
+    /**
+     * @brief Appends the positions in increasing order.
+     */
+    void getIndices(IntVector &indices) const
+    {
+        IndexType base = key << CONTAINER_BITS;
+        if (!bitmap.empty()) {
+            for (IndexType i = 0; i < BITMAP_WORDS; i++) {
+                for (WordType word = bitmap[i]; word != 0; word &= word - 1) {
+                    indices.push_back(base + i * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word));
+                }
+            }
+        } else {
+            for (std::vector<u_int16_t>::const_iterator it = array.begin(); it != array.end(); ++it) {
+                indices.push_back(base + *it);
+            }
+        }
+    }
+
+    void toBitmap()
+    {
+        bitmap.assign(BITMAP_WORDS, 0);
+        for (std::vector<u_int16_t>::const_iterator it = array.begin(); it != array.end(); ++it) {
+            bitmap[*it / CBitOperations::BITS_PER_WORD] |= WordType(1) << (*it % CBitOperations::BITS_PER_WORD);
+        }
+        std::vector<u_int16_t>().swap(array);
+    }
+
+    void toArray()
+    {
+        array.clear();
+        array.reserve(count);
+        for (IndexType i = 0; i < BITMAP_WORDS; i++) {
+            for (WordType word = bitmap[i]; word != 0; word &= word - 1) {
+                array.push_back(u_int16_t(i * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(word)));
+            }
+        }
+        std::vector<WordType>().swap(bitmap);
+    }
+};
+
 /**
  * @brief The CIndexBitList::ListIterator class is an iterator fo CIndexBitList.
  */
@@ -36,113 +211,130 @@ class CIndexBitList::ListIterator :
         public std::iterator<std::input_iterator_tag, bool> {
 private:
     IndexType p;
-    std::vector<IndexType>::iterator e;
-    std::vector<IndexType>::iterator i;
+    const CIndexBitList *l;
 
 public:
     ListIterator() :
-        p(0) {}
+        p(0),
+        l(NULL) {}
 
-    ListIterator(IndexType v, std::vector<IndexType> *c) :
+    ListIterator(IndexType v, const CIndexBitList *list) :
         p(v),
-        e(c->end()),
-        i(c->begin())
-    {
-        while ((i != e) && (*i < p)) {
-            ++i;
-        }
-    }
+        l(list) {}
 
     ListIterator(IBitListIterator& it) :
         p(static_cast<CIndexBitList::ListIterator*>(&it)->p),
-        e(static_cast<CIndexBitList::ListIterator*>(&it)->e),
-        i(static_cast<CIndexBitList::ListIterator*>(&it)->i) {}
+        l(static_cast<CIndexBitList::ListIterator*>(&it)->l) {}
 
     ListIterator(const ListIterator& it) :
         p(it.p),
-        e(it.e),
-        i(it.i) {}
+        l(it.l) {}
 
     IBitListIterator& operator++()
     {
         ++p;
-        if ((i != e) && (*i < p)) {
-            ++i;
-        }
         return *this;
     }
 
     IBitListIterator& operator++(int)
     {
         p++;
-        if((i!=e) && (*i < p)) {
-            ++i;
-        }
         return *this;
     }
 
     bool operator==(IBitListIterator& rhs)
     {
         return (p == static_cast<CIndexBitList::ListIterator*>(&rhs)->p) &&
-            (e == static_cast<CIndexBitList::ListIterator*>(&rhs)->e) &&
-            (i == static_cast<CIndexBitList::ListIterator*>(&rhs)->i);
+            (l == static_cast<CIndexBitList::ListIterator*>(&rhs)->l);
     }
 
     bool operator!=(IBitListIterator& rhs)
     {
         return (p != static_cast<CIndexBitList::ListIterator*>(&rhs)->p) ||
-            (e != static_cast<CIndexBitList::ListIterator*>(&rhs)->e) ||
-            (i != static_cast<CIndexBitList::ListIterator*>(&rhs)->i);
+            (l != static_cast<CIndexBitList::ListIterator*>(&rhs)->l);
     }
 
     bool operator*()
     {
-        return (i != e) && (*i == p);
+        return (*l)[p];
     }
 };
 
 CIndexBitList::CIndexBitList() :
-    m_data(new std::vector<IndexType>()),
+    m_containers(new std::vector<Container>()),
     m_size(0),
+    m_count(0),
     m_beginIterator(0),
     m_endIterator(0)
 {}
 
 CIndexBitList::CIndexBitList(IndexType size) :
-    m_data(new std::vector<IndexType>(/*size*/)),
+    m_containers(new std::vector<Container>()),
     m_size(size),
+    m_count(0),
     m_beginIterator(0),
     m_endIterator(0)
 {}
 
 CIndexBitList::~CIndexBitList()
 {
-    delete m_data;
+    delete m_containers;
     delete m_beginIterator;
     delete m_endIterator;
 }
 
+bool CIndexBitList::contains(IndexType pos) const
+{
+    std::vector<Container>::const_iterator it = std::lower_bound(m_containers->begin(), m_containers->end(), pos >> CONTAINER_BITS, Container::lessKey);
+    return it != m_containers->end() && it->key == (pos >> CONTAINER_BITS) && it->contains(u_int16_t(pos & CONTAINER_MASK));
+}
+
+void CIndexBitList::add(IndexType pos)
+{
+    IndexType key = pos >> CONTAINER_BITS;
+    std::vector<Container>::iterator it;
+    if (m_containers->empty() || m_containers->back().key < key) {
+        // Positions are usually added in increasing order
+        m_containers->push_back(Container(key));
+        it = m_containers->end() - 1;
+    } else {
+        it = std::lower_bound(m_containers->begin(), m_containers->end(), key, Container::lessKey);
+        if (it->key != key) {
+            it = m_containers->insert(it, Container(key));
+        }
+    }
+    if (it->add(u_int16_t(pos & CONTAINER_MASK))) {
+        m_count++;
+    }
+}
+
+void CIndexBitList::remove(IndexType pos)
+{
+    std::vector<Container>::iterator it = std::lower_bound(m_containers->begin(), m_containers->end(), pos >> CONTAINER_BITS, Container::lessKey);
+    if (it == m_containers->end() || it->key != (pos >> CONTAINER_BITS)) {
+        return;
+    }
+    if (it->remove(u_int16_t(pos & CONTAINER_MASK))) {
+        m_count--;
+        if (it->count == 0) {
+            m_containers->erase(it);
+        }
+    }
+}
+
 bool CIndexBitList::front() const
 {
     if(m_size == 0)
         throw CException("soda::CIndexBitList::front()","The list is empty!");
 
-    if(m_data->size() == 0) {
-        return false;
-    } else {
-        return m_data->front() == 0;
-    }
+    return contains(0);
 }
 bool CIndexBitList::back() const
 {
     if(m_size == 0)
         throw CException("soda::CIndexBitList::back()","The list is empty!");
 
-    if(m_data->size() == 0) {
-        return false;
-    } else {
-        return m_data->back() == m_size-1 ? true : false;
-    }
+    return contains(m_size - 1);
 }
 
 bool CIndexBitList::at(IndexType pos) const
@@ -150,13 +342,13 @@ bool CIndexBitList::at(IndexType pos) const
     if (pos >= m_size || pos < 0)
         throw CException("soda::CIndexBitList::at()", "Index out of bound!");
 
-    return std::find(m_data->begin(), m_data->end(), pos) != m_data->end();
+    return contains(pos);
 }
 
 void CIndexBitList::push_back(bool value)
 {
     if(value) {
-        m_data->push_back(m_size);
+        add(m_size);
     }
     m_size++;
 }
@@ -166,11 +358,10 @@ void CIndexBitList::set(IndexType pos, bool value)
     if (pos >= m_size || pos < 0)
         throw CException("soda::CIndexBitList::set()", "Index out of bound!");
 
-    std::vector<IndexType>::iterator it = std::find(m_data->begin(), m_data->end(), pos);
-    if( it != m_data->end() && !value) {
-        m_data->erase(it);
-    } else if (it == m_data->end() && value){
-        m_data->push_back(pos);
+    if (value) {
+        add(pos);
+    } else {
+        remove(pos);
     }
 }
 
@@ -179,11 +370,10 @@ void CIndexBitList::toggleValue(IndexType pos)
     if (pos >= m_size || pos < 0)
             throw CException("soda::CIndexBitList::toggleValue()", "Index out of bound!");
 
-    std::vector<IndexType>::iterator it = std::find(m_data->begin(), m_data->end(), pos);
-    if( it != m_data->end() ) {
-        m_data->erase(it);
+    if (contains(pos)) {
+        remove(pos);
     } else {
-        m_data->push_back(pos);
+        add(pos);
     }
 }
 
@@ -193,10 +383,7 @@ void CIndexBitList::pop_back()
         throw CException("soda::CIndexBitList::pop_back()","The list is empty!");
     }
     m_size--;
-    std::vector<IndexType>::iterator it = std::find(m_data->begin(), m_data->end(), m_size);
-    if(it != m_data->end()) {
-        m_data->erase(it);
-    }
+    remove(m_size);
 }
 
 void CIndexBitList::pop_front()
@@ -204,15 +391,7 @@ void CIndexBitList::pop_front()
     if(m_size == 0) {
         throw CException("soda::CIndexBitList::pop_front()","The list is empty!");
     }
-    m_size--;
-    std::vector<IndexType>::iterator it = std::find(m_data->begin(), m_data->end(), 0);
-    if(it != m_data->end()) {
-        m_data->erase(it);
-    }
-
-    for(std::vector<IndexType>::iterator it = m_data->begin(); it != m_data->end(); ++it) {
-        (*it)--;
-    }
+    erase(0);
 }
 
 void CIndexBitList::erase(IndexType pos)
@@ -220,25 +399,25 @@ void CIndexBitList::erase(IndexType pos)
     if (m_size <= pos || pos < 0)
         throw CException("soda::CIndexBitList::erase()", "Index out of bound!");
 
-    if (pos == (m_size - 1))
-        pop_back();
-    else
-        --m_size;
-
-    for(std::vector<IndexType>::iterator it = m_data->begin(); it != m_data->end(); ++it) {
-        if(*it == pos) {
-            it = m_data->erase(it);
-        } else if(*it > pos) {
-            (*it)--;
-        }
+    // The following positions are shifted, so the containers are rebuilt
+    IntVector indices;
+    getIndices(indices);
+    IntVector::iterator it = std::lower_bound(indices.begin(), indices.end(), pos);
+    if (it != indices.end() && *it == pos) {
+        it = indices.erase(it);
     }
+    for (; it != indices.end(); ++it) {
+        (*it)--;
+    }
+    --m_size;
+    setIndices(indices);
 }
 
 void CIndexBitList::clear()
 {
-    delete m_data;
-    m_data = 0;
+    m_containers->clear();
     m_size = 0;
+    m_count = 0;
     delete m_beginIterator;
     m_beginIterator = 0;
     delete m_endIterator;
@@ -252,18 +431,17 @@ IndexType CIndexBitList::size() const
 
 IndexType CIndexBitList::count() const
 {
-    return m_data->size();
+    return m_count;
 }
 bool CIndexBitList::operator[](IndexType pos) const
 {
-    return std::find(m_data->begin(), m_data->end(), pos) != m_data->end();
+    return pos < m_size && contains(pos);
 }
 
 IBitListIterator& CIndexBitList::begin()
 {
     delete m_beginIterator;
-    std::sort(m_data->begin(), m_data->end());
-    m_beginIterator = new CIndexBitList::ListIterator(0, m_data);
+    m_beginIterator = new CIndexBitList::ListIterator(0, this);
     return *m_beginIterator;
 
 }
@@ -271,17 +449,185 @@ IBitListIterator& CIndexBitList::begin()
 IBitListIterator& CIndexBitList::end()
 {
     delete m_endIterator;
-    m_endIterator = new CIndexBitList::ListIterator(m_size, m_data);
+    m_endIterator = new CIndexBitList::ListIterator(m_size, this);
     return *m_endIterator;
 }
 
+void CIndexBitList::getIndices(IntVector &indices) const
+{
+    indices.clear();
+    indices.reserve(m_count);
+    for (std::vector<Container>::const_iterator it = m_containers->begin(); it != m_containers->end(); ++it) {
+        it->getIndices(indices);
+    }
+}
+
+void CIndexBitList::setIndices(const IntVector &indices)
+{
+    for (IndexType i = 0; i < indices.size(); i++) {
+        if (indices[i] >= m_size || (i > 0 && indices[i] <= indices[i - 1])) {
+            throw CException("soda::CIndexBitList::setIndices()", "The indices must be increasing and less than the size!");
+        }
+    }
+
+    m_containers->clear();
+    for (IndexType i = 0; i < indices.size();) {
+        m_containers->push_back(Container(indices[i] >> CONTAINER_BITS));
+        Container &container = m_containers->back();
+        IndexType last = i;
+        while (last < indices.size() && (indices[last] >> CONTAINER_BITS) == container.key) {
+            last++;
+        }
+        container.count = last - i;
+        container.array.reserve(container.count);
+        for (; i < last; i++) {
+            container.array.push_back(u_int16_t(indices[i] & CONTAINER_MASK));
+        }
+        if (container.count > ARRAY_LIMIT) {
+            container.toBitmap();
+        }
+    }
+    m_count = indices.size();
+}
+
+void CIndexBitList::setAll(const bool value)
+{
+    m_containers->clear();
+    m_count = 0;
+    if (!value) {
+        return;
+    }
+
+    for (IndexType key = 0; (key << CONTAINER_BITS) < m_size; key++) {
+        IndexType count = std::min(CONTAINER_MASK + 1, m_size - (key << CONTAINER_BITS));
+        m_containers->push_back(Container(key));
+        Container &container = m_containers->back();
+        container.count = count;
+        if (count > ARRAY_LIMIT) {
+            container.bitmap.assign(BITMAP_WORDS, 0);
+            std::fill(container.bitmap.begin(), container.bitmap.begin() + count / CBitOperations::BITS_PER_WORD, ~WordType(0));
+            if (count % CBitOperations::BITS_PER_WORD != 0) {
+                container.bitmap[count / CBitOperations::BITS_PER_WORD] = CBitOperations::lastWordMask(count);
+            }
+        } else {
+            container.array.reserve(count);
+            for (IndexType i = 0; i < count; i++) {
+                container.array.push_back(u_int16_t(i));
+            }
+        }
+    }
+    m_count = m_size;
+}
+
+IndexType CIndexBitList::countAnd(const WordType* words, IndexType numOfWords) const
+{
+    IndexType result = 0;
+    for (std::vector<Container>::const_iterator it = m_containers->begin(); it != m_containers->end(); ++it) {
+        IndexType offset = it->key * BITMAP_WORDS;
+        if (offset >= numOfWords) {
+            break;
+        }
+        if (!it->bitmap.empty()) {
+            result += CBitOperations::countAnd(it->bitmap.data(), words + offset, std::min(BITMAP_WORDS, numOfWords - offset));
+        } else {
+            for (std::vector<u_int16_t>::const_iterator low = it->array.begin(); low != it->array.end(); ++low) {
+                IndexType w = offset + *low / CBitOperations::BITS_PER_WORD;
+                if (w >= numOfWords) {
+                    break;
+                }
+                result += (words[w] >> (*low % CBitOperations::BITS_PER_WORD)) & 1;
+            }
+        }
+    }
+    return result;
+}
+
+void CIndexBitList::bitwiseAnd(WordType* words, IndexType numOfWords) const
+{
+    IndexType next = 0;
+    for (std::vector<Container>::const_iterator it = m_containers->begin(); it != m_containers->end(); ++it) {
+        IndexType offset = it->key * BITMAP_WORDS;
+        if (offset >= numOfWords) {
+            break;
+        }
+        IndexType length = std::min(BITMAP_WORDS, numOfWords - offset);
+        std::fill(words + next, words + offset, 0);
+        if (!it->bitmap.empty()) {
+            CBitOperations::bitwiseAnd(words + offset, words + offset, it->bitmap.data(), length);
+        } else {
+            std::vector<u_int16_t>::const_iterator low = it->array.begin();
+            for (IndexType w = 0; w < length; w++) {
+                WordType mask = 0;
+                for (; low != it->array.end() && *low / CBitOperations::BITS_PER_WORD == w; ++low) {
+                    mask |= WordType(1) << (*low % CBitOperations::BITS_PER_WORD);
+                }
+                words[offset + w] &= mask;
+            }
+        }
+        next = offset + length;
+    }
+    std::fill(words + next, words + numOfWords, 0);
+}
+
+void CIndexBitList::bitwiseOr(WordType* words, IndexType numOfWords) const
+{
+    for (std::vector<Container>::const_iterator it = m_containers->begin(); it != m_containers->end(); ++it) {
+        IndexType offset = it->key * BITMAP_WORDS;
+        if (offset >= numOfWords) {
+            break;
+        }
+        if (!it->bitmap.empty()) {
+            CBitOperations::bitwiseOr(words + offset, words + offset, it->bitmap.data(), std::min(BITMAP_WORDS, numOfWords - offset));
+        } else {
+            for (std::vector<u_int16_t>::const_iterator low = it->array.begin(); low != it->array.end(); ++low) {
+                IndexType w = offset + *low / CBitOperations::BITS_PER_WORD;
+                if (w >= numOfWords) {
+                    break;
+                }
+                words[w] |= WordType(1) << (*low % CBitOperations::BITS_PER_WORD);
+            }
+        }
+    }
+}
+
+void CIndexBitList::bitwiseAndNot(WordType* words, IndexType numOfWords) const
+{
+    for (std::vector<Container>::const_iterator it = m_containers->begin(); it != m_containers->end(); ++it) {
+        IndexType offset = it->key * BITMAP_WORDS;
+        if (offset >= numOfWords) {
+            break;
+        }
+        if (!it->bitmap.empty()) {
+            CBitOperations::bitwiseAndNot(words + offset, words + offset, it->bitmap.data(), std::min(BITMAP_WORDS, numOfWords - offset));
+        } else {
+            for (std::vector<u_int16_t>::const_iterator low = it->array.begin(); low != it->array.end(); ++low) {
+                IndexType w = offset + *low / CBitOperations::BITS_PER_WORD;
+                if (w >= numOfWords) {
+                    break;
+                }
+                words[w] &= ~(WordType(1) << (*low % CBitOperations::BITS_PER_WORD));
+            }
+        }
+    }
+}
+
 void CIndexBitList::resize(IndexType newSize)
 {
-    std::sort(m_data->begin(), m_data->end());
     if(newSize < m_size) {
-        std::vector<IndexType>::iterator it;
-        for (it = m_data->begin(); (it != m_data->end()) && (*it < newSize); it++);
-        m_data->erase(it, m_data->end());
+        IndexType key = newSize >> CONTAINER_BITS;
+        std::vector<Container>::iterator it = std::lower_bound(m_containers->begin(), m_containers->end(), key, Container::lessKey);
+        if (it != m_containers->end() && it->key == key) {
+            it->truncate(newSize & CONTAINER_MASK);
+            if (it->count != 0) {
+                ++it;
+            }
+        }
+        m_containers->erase(it, m_containers->end());
+
+        m_count = 0;
+        for (it = m_containers->begin(); it != m_containers->end(); ++it) {
+            m_count += it->count;
+        }
     }
     m_size = newSize;
 }
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include <boost/thread/mutex.hpp>
+
+#include "data/CMappedBitMatrix.h"
+#include "exception/CException.h"
+#include "interface/IIterators.h"
+
+namespace soda {
+
+/**
+ * @brief The rows decoded by getRow(), they are not freed before the matrix is destroyed.
+ */
+struct CMappedBitMatrix::DecodedRows {
+    explicit DecodedRows(IndexType numOfRows) : rows(numOfRows, (CBitList*)0) {}
+
+    std::vector<CBitList*> rows;
+
+    boost::mutex mutex;
+};
+
+/**
+ * @brief The CMappedBitMatrix::MatrixIterator class is an iterator for CMappedBitMatrix.
+ */
+class CMappedBitMatrix::MatrixIterator :
+        public IBitMatrixIterator,
+        public std::iterator<std::input_iterator_tag, bool>
+{
+    const CMappedBitMatrix* m;
+    IndexType pos;
+
+public:
+    MatrixIterator() : m(0), pos(0) {}
+    MatrixIterator(const CMappedBitMatrix* x, IndexType p) : m(x), pos(p) {}
+    MatrixIterator(const MatrixIterator& it) : m(it.m), pos(it.pos) {}
+
+    IBitMatrixIterator& operator++()
+    {
+        ++pos;
+        return *this;
+    }
+    IBitMatrixIterator& operator++(int)
+    {
+        pos++;
+        return *this;
+    }
+    bool operator==(IBitMatrixIterator& rhs)
+    {
+        return pos == static_cast<CMappedBitMatrix::MatrixIterator*>(&rhs)->pos;
+    }
+    bool operator!=(IBitMatrixIterator& rhs)
+    {
+        return pos != static_cast<CMappedBitMatrix::MatrixIterator*>(&rhs)->pos;
+    }
+    bool operator*()
+    {
+        return m->bitAt(pos);
+    }
+};
+
+CMappedBitMatrix::CMappedBitMatrix(const char* data, unsigned long long length) :
+    m_row(0),
+    m_col(0),
+    m_bits(0),
+    m_numOfBytes(0),
+    m_rows(0),
+    m_beginIterator(0),
+    m_endIterator(0)
+{
+    if (length < 2 * sizeof(IndexType))
+        throw CException("soda::CMappedBitMatrix::CMappedBitMatrix()", "The chunk is too short!");
+
+    std::memcpy(&m_row, data, sizeof(IndexType));
+    std::memcpy(&m_col, data + sizeof(IndexType), sizeof(IndexType));
+    m_bits = data + 2 * sizeof(IndexType);
+    m_numOfBytes = io::CBitWriter::predictSize(m_row * m_col);
+
+    if (length < 2 * sizeof(IndexType) + m_numOfBytes)
+        throw CException("soda::CMappedBitMatrix::CMappedBitMatrix()", "The chunk is too short!");
+
+    m_rows = new DecodedRows(m_row);
+}
+
+CMappedBitMatrix::~CMappedBitMatrix()
+{
+    for (IndexType i = 0; i < m_rows->rows.size(); i++) {
+        delete m_rows->rows[i];
+    }
+    delete m_rows;
+    delete m_beginIterator;
+    delete m_endIterator;
+}
+
+IndexType CMappedBitMatrix::getNumOfRows() const
+{
+    return m_row;
+}
+
+IndexType CMappedBitMatrix::getNumOfCols() const
+{
+    return m_col;
+}
+
+WordType CMappedBitMatrix::extractWord(IndexType pos, IndexType bits) const
+{
+    const unsigned char* bytes = (const unsigned char*)m_bits + pos / 8;
+    IndexType shift = pos % 8;
+    IndexType needed = (shift + bits + 7) / 8;
+    WordType word = 0;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    if (pos / 8 + 8 <= m_numOfBytes) {
+        std::memcpy(&word, bytes, 8);
+    } else
+#endif
+    {
+        for (IndexType k = 0; k < needed && k < 8; k++) {
+            word |= WordType(bytes[k]) << (8 * k);
+        }
+    }
+
+    word >>= shift;
+    if (needed > 8) {
+        word |= WordType(bytes[8]) << (64 - shift);
+    }
+    if (bits < 64) {
+        word &= (WordType(1) << bits) - 1;
+    }
+    return word;
+}
+
+void CMappedBitMatrix::copyRowWords(IndexType row, WordType* words) const
+{
+    if (row >= m_row)
+        throw CException("soda::CMappedBitMatrix::copyRowWords()", "Index out of bound!");
+
+    IndexType pos = row * m_col;
+    for (IndexType w = 0; w * 64 < m_col; w++) {
+        IndexType bits = (m_col - w * 64 < 64) ? m_col - w * 64 : 64;
+        words[w] = extractWord(pos + w * 64, bits);
+    }
+}
+
+void CMappedBitMatrix::rowCounts(std::vector<IndexType> &v) const
+{
+    v.clear();
+    v.resize(m_row);
+    for (IndexType r = 0; r < m_row; r++) {
+        IndexType pos = r * m_col;
+        IndexType sum = 0;
+        for (IndexType c = 0; c < m_col; c += 64) {
+            sum += CBitOperations::popcount(extractWord(pos + c, (m_col - c < 64) ? m_col - c : 64));
+        }
+        v[r] = sum;
+    }
+}
+
+void CMappedBitMatrix::colCounts(std::vector<IndexType> &v) const
+{
+    v.clear();
+    v.resize(m_col);
+    for (IndexType r = 0; r < m_row; r++) {
+        IndexType pos = r * m_col;
+        for (IndexType c = 0; c < m_col; c += 64) {
+            WordType word = extractWord(pos + c, (m_col - c < 64) ? m_col - c : 64);
+            while (word) {
+                v[c + CBitOperations::lowestBit(word)]++;
+                word &= word - 1;
+            }
+        }
+    }
+}
+
+bool CMappedBitMatrix::get(IndexType row, IndexType col) const
+{
+    if (row >= m_row || col >= m_col)
+        throw CException("soda::CMappedBitMatrix", "Index out of bound!");
+    return bitAt(row * m_col + col);
+}
+
+void CMappedBitMatrix::set(IndexType, IndexType, bool)
+{
+    throw CException("soda::CMappedBitMatrix::set()", "The matrix is read-only!");
+}
+
+void CMappedBitMatrix::toggleValue(IndexType, IndexType)
+{
+    throw CException("soda::CMappedBitMatrix::toggleValue()", "The matrix is read-only!");
+}
+
+void CMappedBitMatrix::resize(IndexType, IndexType)
+{
+    throw CException("soda::CMappedBitMatrix::resize()", "The matrix is read-only!");
+}
+
+void CMappedBitMatrix::clear()
+{
+    throw CException("soda::CMappedBitMatrix::clear()", "The matrix is read-only!");
+}
+
+IBitList& CMappedBitMatrix::operator[](IndexType row) const
+{
+    boost::mutex::scoped_lock lock(m_rows->mutex);
+    CBitList*& list = m_rows->rows[row];
+    if (!list) {
+        list = new CBitList(m_col);
+        for (IndexType w = 0; w < list->getNumOfWords(); w++) {
+            list->setWord(w, extractWord(row * m_col + w * 64, (m_col - w * 64 < 64) ? m_col - w * 64 : 64));
+        }
+    }
+    return *list;
+}
+
+IBitList& CMappedBitMatrix::getRow(IndexType row) const
+{
+    if (row >= m_row)
+        throw CException("soda::CMappedBitMatrix", "Index out of bound!");
+
+    return (*this)[row];
+}
+
+IBitList& CMappedBitMatrix::getCol(IndexType col) const
+{
+    if (col >= m_col)
+        throw CException("soda::CMappedBitMatrix", "Index out of bound!");
+
+    CBitList* column = new CBitList(m_row);
+    for (IndexType r = 0; r < m_row; r++) {
+        if (bitAt(r * m_col + col)) {
+            column->set(r, true);
+        }
+    }
+    return *column;
+}
+
+IBitMatrixIterator& CMappedBitMatrix::begin()
+{
+    delete m_beginIterator;
+    m_beginIterator = new CMappedBitMatrix::MatrixIterator(this, 0);
+    return *m_beginIterator;
+}
+
+IBitMatrixIterator& CMappedBitMatrix::end()
+{
+    delete m_endIterator;
+    m_endIterator = new CMappedBitMatrix::MatrixIterator(this, m_row * m_col);
+    return *m_endIterator;
+}
+
+void CMappedBitMatrix::save(io::CBinaryIO* out, const io::CSoDAio::ChunkID chunk) const
+{
+    //write ChunkID
+    out->writeUInt4(chunk);
+    //write length
+    out->writeULongLong8(2 * sizeof(IndexType) + m_numOfBytes);
+    //Write rows count of the matrix
+    out->writeULongLong8(m_row);
+    //Write columns count of the matrix
+    out->writeULongLong8(m_col);
+    //Write the elements as they are stored in the file
+    if (m_numOfBytes > 0) {
+        out->writeData(m_bits, m_numOfBytes);
+    }
+}
+
+} // namespace soda
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "data/CMappedIDManager.h"
+#include "exception/CException.h"
+
+namespace soda {
+
+namespace {
+
+/**
+ * @brief Orders positions of the values by the strings they point to.
+ */
+struct ValueLess {
+    const std::vector<const char*>* values;
+
+    bool operator()(IndexType lhs, IndexType rhs) const
+    {
+        int cmp = std::strcmp((*values)[lhs], (*values)[rhs]);
+        return cmp < 0 || (cmp == 0 && lhs < rhs);
+    }
+};
+
+} // namespace
+
+CMappedIDManager::CMappedIDManager(const char* data, unsigned long long length) :
+    m_payload(data),
+    m_length(length),
+    m_ids(new IntVector()),
+    m_values(new std::vector<const char*>()),
+    m_byValue(0)
+{
+    if (length < sizeof(IndexType)) {
+        delete m_ids;
+        delete m_values;
+        throw CException("soda::CMappedIDManager::CMappedIDManager()", "The chunk is too short!");
+    }
+
+    IndexType size;
+    std::memcpy(&size, data, sizeof(IndexType));
+    m_ids->reserve(size);
+    m_values->reserve(size);
+
+    unsigned long long pos = sizeof(IndexType);
+    bool sorted = true;
+    for (IndexType i = 0; i < size; ++i) {
+        const char* end = (pos + sizeof(IndexType) <= length) ?
+            (const char*)std::memchr(data + pos + sizeof(IndexType), '\0', length - pos - sizeof(IndexType)) : 0;
+        if (!end) {
+            delete m_ids;
+            delete m_values;
+            throw CException("soda::CMappedIDManager::CMappedIDManager()", "The chunk is malformed!");
+        }
+
+        IndexType id;
+        std::memcpy(&id, data + pos, sizeof(IndexType));
+        if (!m_ids->empty() && id <= m_ids->back()) {
+            sorted = false;
+        }
+        m_ids->push_back(id);
+        m_values->push_back(data + pos + sizeof(IndexType));
+        pos = (end - data) + 1;
+    }
+
+    if (!sorted) {
+        // CIDManager writes the ids in increasing order, other writers may not.
+        std::vector<std::pair<IndexType, const char*> > pairs(size);
+        for (IndexType i = 0; i < size; ++i) {
+            pairs[i] = std::make_pair((*m_ids)[i], (*m_values)[i]);
+        }
+        std::stable_sort(pairs.begin(), pairs.end(),
+            [](const std::pair<IndexType, const char*>& lhs, const std::pair<IndexType, const char*>& rhs) {
+                return lhs.first < rhs.first;
+            });
+        for (IndexType i = 0; i < size; ++i) {
+            (*m_ids)[i] = pairs[i].first;
+            (*m_values)[i] = pairs[i].second;
+        }
+    }
+
+    // The value index is built here, so the const lookups do not modify the object
+    m_byValue = new IntVector(size);
+    for (IndexType i = 0; i < size; ++i) {
+        (*m_byValue)[i] = i;
+    }
+    ValueLess less = { m_values };
+    std::sort(m_byValue->begin(), m_byValue->end(), less);
+}
+
+CMappedIDManager::~CMappedIDManager()
+{
+    delete m_ids;
+    delete m_values;
+    delete m_byValue;
+}
+
+IndexType CMappedIDManager::findID(const IndexType id) const
+{
+    // Fast path for the usual dense ids.
+    if (id < m_ids->size() && (*m_ids)[id] == id) {
+        return id;
+    }
+
+    IntVector::const_iterator it = std::lower_bound(m_ids->begin(), m_ids->end(), id);
+    if (it != m_ids->end() && *it == id) {
+        return it - m_ids->begin();
+    }
+    return m_ids->size();
+}
+
+IndexType CMappedIDManager::findValue(const String& value) const
+{
+    const char* str = value.c_str();
+    IntVector::const_iterator it = std::lower_bound(m_byValue->begin(), m_byValue->end(), str,
+        [this](IndexType lhs, const char* rhs) {
+            return std::strcmp((*m_values)[lhs], rhs) < 0;
+        });
+    if (it != m_byValue->end() && value == (*m_values)[*it]) {
+        return *it;
+    }
+    return m_ids->size();
+}
+
+bool CMappedIDManager::containsValue(const String& value) const
+{
+    return findValue(value) < m_ids->size();
+}
+
+IndexType CMappedIDManager::getID(const String& value) const
+{
+    IndexType pos = findValue(value);
+    if (pos < m_ids->size()) {
+        return (*m_ids)[pos];
+    }
+    throw std::out_of_range("Value is not present in the Manager.");
+}
+
+String CMappedIDManager::getValue(const IndexType id) const
+{
+    IndexType pos = findID(id);
+    if (pos < m_ids->size()) {
+        return String((*m_values)[pos]);
+    }
+    throw std::out_of_range("Index is not present in the Manager.");
+}
+
+IntVector CMappedIDManager::getIDList() const
+{
+    return *m_ids;
+}
+
+const IntVector& CMappedIDManager::getIDs() const
+{
+    return *m_ids;
+}
+
+StringVector CMappedIDManager::getValueList() const
+{
+    return StringVector(m_values->begin(), m_values->end());
+}
+
+String CMappedIDManager::operator[](const IndexType id) const
+{
+    return getValue(id);
+}
+
+IndexType CMappedIDManager::operator[](const String& value) const
+{
+    return getID(value);
+}
+
+IndexType CMappedIDManager::getLastIndex() const
+{
+    if (m_ids->empty()) {
+        throw std::length_error("The manager is empty.");
+    }
+    return m_ids->back();
+}
+
+IndexType CMappedIDManager::size() const
+{
+    return m_ids->size();
+}
+
+void CMappedIDManager::add(const IndexType, const String&)
+{
+    throw CException("soda::CMappedIDManager::add()", "The manager is read-only!");
+}
+
+void CMappedIDManager::add(const String&)
+{
+    throw CException("soda::CMappedIDManager::add()", "The manager is read-only!");
+}
+
+void CMappedIDManager::remove(const IndexType)
+{
+    throw CException("soda::CMappedIDManager::remove()", "The manager is read-only!");
+}
+
+void CMappedIDManager::remove(const String&)
+{
+    throw CException("soda::CMappedIDManager::remove()", "The manager is read-only!");
+}
+
+void CMappedIDManager::clear()
+{
+    throw CException("soda::CMappedIDManager::clear()", "The manager is read-only!");
+}
+
+void CMappedIDManager::save(io::CBinaryIO *out, const io::CSoDAio::ChunkID chunk) const
+{
+    //write ChunkID
+    out->writeUInt4(chunk);
+    //write length
+    out->writeULongLong8(m_length);
+    //write the payload as it is stored in the file
+    out->writeData(m_payload, m_length);
+}
+
+void CMappedIDManager::load(io::CBinaryIO*)
+{
+    throw CException("soda::CMappedIDManager::load()", "The manager is read-only!");
+}
+
+} // namespace soda
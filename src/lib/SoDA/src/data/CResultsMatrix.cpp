@@ -20,15 +20,64 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <boost/lexical_cast.hpp>
 
 #include "data/CResultsMatrix.h"
 #include "data/CBitMatrix.h"
+#include "data/CDeltaBitMatrix.h"
 #include "data/CIDManager.h"
+#include "data/CMappedBitMatrix.h"
+#include "data/CMappedIDManager.h"
+#include "io/CMappedSoDAio.h"
 #include "exception/CException.h"
 
 namespace soda {
 
+namespace {
+
+/**
+ * @brief Loads the payload of a delta encoded chunk. An owned matrix is replaced by a
+ *        CDeltaBitMatrix, otherwise the decoded rows are copied into the matrix.
+ */
+void loadDeltas(IBitMatrix*& matrix, bool owned, const char* data, unsigned long long length)
+{
+    CDeltaBitMatrix* delta = new CDeltaBitMatrix();
+    try {
+        delta->loadDeltas(data, length);
+    } catch (...) {
+        delete delta;
+        throw;
+    }
+
+    if (owned) {
+        delete matrix;
+        matrix = delta;
+        return;
+    }
+
+    matrix->resize(delta->getNumOfRows(), delta->getNumOfCols());
+    std::vector<WordType> words(CBitOperations::numOfWords(delta->getNumOfCols()));
+    for (IndexType row = 0; row < delta->getNumOfRows(); row++) {
+        delta->copyRowWords(row, words.data());
+        matrix->setRowWords(row, words.data());
+    }
+    delete delta;
+}
+
+/**
+ * @brief Reads the payload of the actual chunk.
+ */
+void readChunk(io::CSoDAio* in, std::vector<char>& buffer)
+{
+    buffer.resize(in->getActualLength());
+    if (!buffer.empty()) {
+        in->readData(buffer.data(), buffer.size());
+    }
+}
+
+} // namespace
+
 CResultsMatrix::CResultsMatrix() :
     m_testcases(new CIDManager()),
     m_revisions(new CRevision<IndexType>()),
@@ -119,6 +168,16 @@ const IBitList& CResultsMatrix::getPassedBitList(const int revision) const
     return m_pass->getRow((*m_revisions)[revision]);
 }
 
+void CResultsMatrix::copyResults(const int revision, WordType* executed, WordType* passed) const
+{
+    if(!m_revisions->revisionExists(revision)) {
+        throw CException("CResultsMatrix::copyResults()", "Results matrix does not contain item!");
+    }
+    IndexType row = m_revisions->getRevision(revision);
+    m_exec->copyRowWords(row, executed);
+    m_pass->copyRowWords(row, passed);
+}
+
 CResultsMatrix::TestResultType CResultsMatrix::getResult(const int revision, const String& testcaseName) const
 {
     IndexType testcaseID = (*m_testcases)[testcaseName];
@@ -127,21 +186,21 @@ CResultsMatrix::TestResultType CResultsMatrix::getResult(const int revision, con
 
 CResultsMatrix::TestResultType CResultsMatrix::getResult(const int revision, const IndexType testcaseID) const
 {
-    return (TestResultType)
-          (((*m_exec)[(*m_revisions)[revision]][testcaseID] << 1) |
-           ((*m_exec)[(*m_revisions)[revision]][testcaseID] &
-            (*m_pass)[(*m_revisions)[revision]][testcaseID]));
+    IndexType row = (*m_revisions)[revision];
+    bool executed = m_exec->get(row, testcaseID);
+    return (TestResultType)((executed << 1) | (executed & m_pass->get(row, testcaseID)));
 }
 
 bool CResultsMatrix::isExecuted(const int revision, const String& testcaseName) const
 {
-    return (*m_exec)[(*m_revisions)[revision]][(*m_testcases)[testcaseName]];
+    return m_exec->get((*m_revisions)[revision], (*m_testcases)[testcaseName]);
 }
 
 bool CResultsMatrix::isPassed(const int revision, const String& testcaseName) const
 {
-    return (*m_exec)[(*m_revisions)[revision]][(*m_testcases)[testcaseName]] &&
-           (*m_pass)[(*m_revisions)[revision]][(*m_testcases)[testcaseName]];
+    IndexType row = (*m_revisions)[revision];
+    IndexType testcaseID = (*m_testcases)[testcaseName];
+    return m_exec->get(row, testcaseID) && m_pass->get(row, testcaseID);
 }
 
 void CResultsMatrix::setResult(const int revision, const String& testcaseName, const CResultsMatrix::TestResultType result)
@@ -162,6 +221,16 @@ void CResultsMatrix::setResult(const int revision, const IndexType testcaseID, c
     m_pass->set((*m_revisions)[revision], testcaseID, result == trtPassed);
 }
 
+void CResultsMatrix::setResults(const int revision, const WordType* executed, const WordType* passed)
+{
+    if(!m_revisions->revisionExists(revision)) {
+        throw CException("CResultsMatrix::setResults()", "Results matrix does not contain item!");
+    }
+    IndexType row = m_revisions->getRevision(revision);
+    m_exec->setRowWords(row, executed);
+    m_pass->setRowWords(row, passed);
+}
+
 void CResultsMatrix::addOrSetResult(const int revision, const String& testcaseName, const CResultsMatrix::TestResultType result)
 {
     if(!m_revisions->revisionExists(revision)) {
@@ -200,6 +269,24 @@ void CResultsMatrix::addTestcaseName(const String& testcaseName)
     }
 }
 
+void CResultsMatrix::compress()
+{
+    if(!m_createExecutionBitMatrix || !m_createPassedBitMatrix) {
+        throw CException("soda::CResultsMatrix::compress()", "Only the owned bit matrices can be replaced!");
+    }
+
+    if(!dynamic_cast<CDeltaBitMatrix*>(m_exec)) {
+        IBitMatrix* exec = new CDeltaBitMatrix(*m_exec);
+        delete m_exec;
+        m_exec = exec;
+    }
+    if(!dynamic_cast<CDeltaBitMatrix*>(m_pass)) {
+        IBitMatrix* pass = new CDeltaBitMatrix(*m_pass);
+        delete m_pass;
+        m_pass = pass;
+    }
+}
+
 void CResultsMatrix::save(const char * filename) const
 {
     io::CSoDAio *out = new io::CSoDAio(filename, io::CBinaryIO::omWrite);
@@ -218,8 +305,19 @@ void CResultsMatrix::save(io::CBinaryIO * out) const
 {
     m_revisions->save(out, io::CSoDAio::REVISIONS);
     m_testcases->save(out, io::CSoDAio::TCLIST);
-    m_exec->save(out, io::CSoDAio::EXECUTION);
-    m_pass->save(out, io::CSoDAio::PASSED);
+
+    const CDeltaBitMatrix* exec = dynamic_cast<const CDeltaBitMatrix*>(m_exec);
+    if(exec) {
+        exec->saveDeltas(out, io::CSoDAio::EXECUTION_DELTA);
+    } else {
+        m_exec->save(out, io::CSoDAio::EXECUTION);
+    }
+    const CDeltaBitMatrix* pass = dynamic_cast<const CDeltaBitMatrix*>(m_pass);
+    if(pass) {
+        pass->saveDeltas(out, io::CSoDAio::PASSED_DELTA);
+    } else {
+        m_pass->save(out, io::CSoDAio::PASSED);
+    }
 }
 
 void CResultsMatrix::load(io::CSoDAio* in)
@@ -228,6 +326,7 @@ void CResultsMatrix::load(io::CSoDAio* in)
     bool isPASS = false;
     bool isTC = false;
     bool isREV = false;
+    std::vector<char> buffer;
 
     while(in->nextChunkID()) {
         if(in->getChunkID() == io::CSoDAio::TCLIST) {
@@ -242,6 +341,14 @@ void CResultsMatrix::load(io::CSoDAio* in)
         } else if(in->getChunkID() == io::CSoDAio::PASSED) {
             m_pass->load(in);
             isPASS = true;
+        } else if(in->getChunkID() == io::CSoDAio::EXECUTION_DELTA) {
+            readChunk(in, buffer);
+            loadDeltas(m_exec, m_createExecutionBitMatrix, buffer.data(), buffer.size());
+            isEXEC = true;
+        } else if(in->getChunkID() == io::CSoDAio::PASSED_DELTA) {
+            readChunk(in, buffer);
+            loadDeltas(m_pass, m_createPassedBitMatrix, buffer.data(), buffer.size());
+            isPASS = true;
         }
     }
 
@@ -250,6 +357,88 @@ void CResultsMatrix::load(io::CSoDAio* in)
     }
 }
 
+void CResultsMatrix::load(io::CMappedSoDAio* in)
+{
+    if(!m_createTestcases || !m_createExecutionBitMatrix || !m_createPassedBitMatrix) {
+        throw CException("soda::CResultsMatrix::load()", "Only a standalone results matrix can be loaded from a mapped file!");
+    }
+
+    IIDManager* testcases = 0;
+    IBitMatrix* exec = 0;
+    IBitMatrix* pass = 0;
+    const char* revisions = 0;
+    unsigned long long revisionsLength = 0;
+
+    try {
+        while(in->nextChunkID()) {
+            if(in->getChunkID() == io::CSoDAio::TCLIST) {
+                delete testcases;
+                testcases = new CMappedIDManager(in->getChunkData(), in->getActualLength());
+            } else if(in->getChunkID() == io::CSoDAio::REVISIONS) {
+                revisions = in->getChunkData();
+                revisionsLength = in->getActualLength();
+            } else if(in->getChunkID() == io::CSoDAio::EXECUTION) {
+                delete exec;
+                exec = new CMappedBitMatrix(in->getChunkData(), in->getActualLength());
+            } else if(in->getChunkID() == io::CSoDAio::PASSED) {
+                delete pass;
+                pass = new CMappedBitMatrix(in->getChunkData(), in->getActualLength());
+            } else if(in->getChunkID() == io::CSoDAio::EXECUTION_DELTA) {
+                delete exec;
+                exec = 0;
+                loadDeltas(exec, true, in->getChunkData(), in->getActualLength());
+            } else if(in->getChunkID() == io::CSoDAio::PASSED_DELTA) {
+                delete pass;
+                pass = 0;
+                loadDeltas(pass, true, in->getChunkData(), in->getActualLength());
+            }
+        }
+    } catch (...) {
+        delete testcases;
+        delete exec;
+        delete pass;
+        throw;
+    }
+
+    RevNumType size = 0;
+    if(revisions) {
+        if(revisionsLength >= sizeof(RevNumType)) {
+            std::memcpy(&size, revisions, sizeof(RevNumType));
+        }
+        if(revisionsLength < sizeof(RevNumType) + size * (sizeof(RevNumType) + sizeof(IndexType))) {
+            revisions = 0;
+        }
+    }
+
+    if(!testcases || !exec || !pass || !revisions) {
+        delete testcases;
+        delete exec;
+        delete pass;
+        throw CException("soda::CResultsMatrix","There is no results matrix info in this file!");
+    }
+
+    delete m_testcases;
+    delete m_exec;
+    delete m_pass;
+    m_testcases = testcases;
+    m_exec = exec;
+    m_pass = pass;
+
+    // The revision list is small, it is copied as CRevision::load() does.
+    IntVector oldRevisions = m_revisions->getRevisionNumbers();
+    for (IndexType i = 0; i < oldRevisions.size(); ++i) {
+        m_revisions->removeRevision(oldRevisions[i]);
+    }
+    revisions += sizeof(RevNumType);
+    for (; size > 0; size--) {
+        RevNumType key;
+        IndexType value;
+        std::memcpy(&key, revisions, sizeof(RevNumType));
+        std::memcpy(&value, revisions + sizeof(RevNumType), sizeof(IndexType));
+        revisions += sizeof(RevNumType) + sizeof(IndexType);
+        m_revisions->addRevision(key, value);
+    }
+}
 
 void CResultsMatrix::save(const String& filename) const
 {
@@ -50,6 +50,12 @@ T& CRevision<T>::getRevision(const RevNumType rev)
     return m_data->at(rev);
 }
 
+template <typename T>
+const T& CRevision<T>::getRevision(const RevNumType rev) const
+{
+    return m_data->at(rev);
+}
+
 template <typename T>
 void CRevision<T>::addRevision(const RevNumType revNum, T& datastructure)
 {
@@ -90,7 +96,7 @@ template <typename T>
 void CRevision<T>::save(io::CBinaryIO *out, const io::CSoDAio::ChunkID chunk) const
 {
     out->writeInt4(chunk);
-    out->writeULongLong8(size() * (4 + sizeof(T)));
+    out->writeULongLong8(sizeof(RevNumType) + size() * (sizeof(RevNumType) + sizeof(T)));
 
     out->writeUInt4(size());
     for (typename std::map<RevNumType, T>::iterator it = m_data->begin(); it != m_data->end(); ++it) {
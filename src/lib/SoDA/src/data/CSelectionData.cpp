@@ -21,6 +21,9 @@
 
 #include "data/CSelectionData.h"
 #include "exception/CException.h"
+#include "util/CBitOperations.h"
+#include "util/CThreadPool.h"
+#include <algorithm>
 #include <iostream>
 
 namespace soda {
@@ -38,7 +41,13 @@ CSelectionData::CSelectionData() :
     m_changeset(new CChangeset(m_changesetCodeElements)),
     m_coverage(new CCoverageMatrix(m_coverageTestcases, m_coverageCodeElements)),
     m_bugs(new CBugset(m_bugCodeElements)),
-    m_results(new CResultsMatrix(m_resultsTestcases))
+    m_results(new CResultsMatrix(m_resultsTestcases)),
+
+    m_changesetToCoverageCodeElements(new IntVector()),
+    m_coverageToChangesetCodeElements(new IntVector()),
+    m_resultsToCoverageTestcases(new IntVector()),
+    m_coverageToResultsTestcases(new IntVector()),
+    m_sameTestcaseIds(false)
 {
 }
 
@@ -57,36 +66,47 @@ CSelectionData::~CSelectionData()
 
     delete m_globalCodeElements;
     delete m_globalTestcases;
+
+    delete m_changesetToCoverageCodeElements;
+    delete m_coverageToChangesetCodeElements;
+    delete m_resultsToCoverageTestcases;
+    delete m_coverageToResultsTestcases;
 }
 
 void CSelectionData::loadChangeset(const char* fname)
 {
     m_changeset->load(fname);
+    buildTranslationTables();
 }
 
 void CSelectionData::loadChangeset(const String &filename)
 {
     m_changeset->load(filename);
+    buildTranslationTables();
 }
 
 void CSelectionData::loadCoverage(const char* fname)
 {
     m_coverage->load(fname);
+    buildTranslationTables();
 }
 
 void CSelectionData::loadCoverage(const String &filename)
 {
     m_coverage->load(filename);
+    buildTranslationTables();
 }
 
 void CSelectionData::loadResults(const char* fname)
 {
     m_results->load(fname);
+    buildTranslationTables();
 }
 
 void CSelectionData::loadResults(const String &filename)
 {
     m_results->load(filename);
+    buildTranslationTables();
 }
 
 void CSelectionData::loadBugs(const char* fname)
@@ -101,42 +121,29 @@ void CSelectionData::loadBugs(const String &filename)
 
 void CSelectionData::globalize()
 {
-    for (IndexType i = 0; i < m_globalCodeElements->size(); i++) {
-        String cename = (*m_globalCodeElements)[i];
-        //m_bugs->addCodeElementName(cename);
-        m_changeset->addCodeElementName(cename);
-        m_coverage->addCodeElementName(cename);
-    }
-
-    for (IndexType i = 0; i < m_globalTestcases->size(); i++) {
-        String tcname = (*m_globalTestcases)[i];
-        m_results->addTestcaseName(tcname);
-        m_coverage->addTestcaseName(tcname);
-    }
+    // The mappers are shared with the containers, so the missing global ids are mapped directly
+    m_changesetCodeElements->addGlobalIds();
+    m_coverageCodeElements->addGlobalIds();
+    m_resultsTestcases->addGlobalIds();
+    m_coverageTestcases->addGlobalIds();
 
     m_changeset->refitSize();
     m_coverage->refitMatrixSize();
     m_results->refitMatrixSize();
+
+    buildTranslationTables();
 }
 
-void CSelectionData::filterToCoverage()
+void CSelectionData::filterToCoverage(unsigned int numOfThreads)
 {
     CIDMapper *l_changesetCodeElements = new CIDMapper(m_globalCodeElements);
     CIDMapper *l_resultsTestcases = new CIDMapper(m_globalTestcases);
+    l_changesetCodeElements->assign(*m_coverageCodeElements);
+    l_resultsTestcases->assign(*m_coverageTestcases);
 
     CChangeset *l_changeset = new CChangeset(l_changesetCodeElements);
     CResultsMatrix *l_results = new CResultsMatrix(l_resultsTestcases);
 
-    for (IndexType i = 0; i < m_coverageCodeElements->size(); i++) {
-        String fname = (*m_globalCodeElements)[i];
-        l_changeset->addCodeElementName(fname);
-    }
-
-    for (IndexType i = 0; i < m_coverageTestcases->size(); i++) {
-        String tcname = (*m_globalTestcases)[i];
-        l_results->addTestcaseName(tcname);
-    }
-
     const IntVector& revs = m_results->getRevisionNumbers();
     for (size_t r = 0; r < revs.size(); ++r) {
         l_results->addRevisionNumber(revs[r]);
@@ -146,34 +153,65 @@ void CSelectionData::filterToCoverage()
     l_changeset->refitSize();
     l_results->refitMatrixSize();
 
-    for (IndexType i = 0; i < m_coverageTestcases->size(); i++) {
-        String tcname = (*m_coverageTestcases)[i];
+    buildTranslationTables();
+    const IntVector& testcaseIds = *m_coverageToResultsTestcases;
+    const IntVector& codeElementIds = *m_changesetToCoverageCodeElements;
 
-        if (!m_resultsTestcases->containsValue(tcname)) {
-            std::cerr << "[WARNING] Not existing test case: " << tcname << std::endl;
-            continue;
+    for (IndexType i = 0; i < m_coverageTestcases->getIDs().size(); i++) {
+        IndexType tcid = m_coverageTestcases->getIDs()[i];
+        if (testcaseIds[tcid] == CIDMapper::NO_ID) {
+            std::cerr << "[WARNING] Not existing test case: " << (*m_coverageTestcases)[tcid] << std::endl;
         }
-        for (size_t r = 0; r < revs.size(); ++r) {
-            IndexType lid, tcid;
-            if ((lid = l_resultsTestcases->getID(tcname)) && ((tcid = m_resultsTestcases->getID(tcname)))) {
-                l_results->setResult(revs[r], lid, m_results->getResult(revs[r], tcid));
+    }
+
+    // The revisions are gathered independently, the missing code elements are reported afterwards
+    IndexType nofTestcases = l_results->getNumOfTestcases();
+    IndexType nofWords = CBitOperations::numOfWords(nofTestcases);
+    IndexType nofResultsWords = CBitOperations::numOfWords(m_results->getNumOfTestcases());
+    std::vector<IntVector> missingCodeElements(revs.size());
+
+    CThreadPool(numOfThreads).run(revs.size(), [&](IndexType r) {
+        std::vector<WordType> executed(nofResultsWords);
+        std::vector<WordType> passed(nofResultsWords);
+        IndexType row = m_results->getRevisions().getRevision(revs[r]);
+        m_results->getExecutionBitMatrix().copyRowWords(row, executed.data());
+        m_results->getPassedBitMatrix().copyRowWords(row, passed.data());
+
+        std::vector<WordType> l_executed(nofWords, 0);
+        std::vector<WordType> l_passed(nofWords, 0);
+        for (IndexType tcid = 0; tcid < nofTestcases && tcid < testcaseIds.size(); tcid++) {
+            IndexType tcidInResults = testcaseIds[tcid];
+            if (tcidInResults == CIDMapper::NO_ID) {
+                continue;
+            }
+            WordType bit = WordType(1) << (tcid % CBitOperations::BITS_PER_WORD);
+            if ((executed[tcidInResults / CBitOperations::BITS_PER_WORD] >> (tcidInResults % CBitOperations::BITS_PER_WORD)) & 1) {
+                l_executed[tcid / CBitOperations::BITS_PER_WORD] |= bit;
+            }
+            if ((passed[tcidInResults / CBitOperations::BITS_PER_WORD] >> (tcidInResults % CBitOperations::BITS_PER_WORD)) & 1) {
+                l_passed[tcid / CBitOperations::BITS_PER_WORD] |= bit;
             }
         }
-    }
+        l_results->setResults(revs[r], l_executed.data(), l_passed.data());
 
-    for (size_t r = 0; r < revs.size(); ++r) {
         if (m_changeset->exists(revs[r])) {
-            const StringVector& chng = m_changeset->getCodeElementNames(revs[r]);
-            for (size_t s = 0; s < chng.size(); ++s) {
-                if (!l_changesetCodeElements->containsValue(chng[s])) {
-                    std::cerr << "[WARNING] Not existing code element: " << chng[s] << std::endl;
+            IBitList& changes = l_changeset->at(revs[r]);
+            IntVector changed = m_changeset->getCodeElementIds(revs[r]);
+            for (IntVector::const_iterator it = changed.begin(); it != changed.end(); ++it) {
+                IndexType ceid = *it < codeElementIds.size() ? codeElementIds[*it] : CIDMapper::NO_ID;
+                if (ceid == CIDMapper::NO_ID || ceid >= changes.size()) {
+                    missingCodeElements[r].push_back(*it);
                     continue;
                 }
-                if (l_changesetCodeElements->getID(chng[s])) {
-                    l_changeset->setChange(revs[r], chng[s]);
-                }
+                changes.set(ceid, true);
             }
         }
+    });
+
+    for (size_t r = 0; r < revs.size(); ++r) {
+        for (IntVector::const_iterator it = missingCodeElements[r].begin(); it != missingCodeElements[r].end(); ++it) {
+            std::cerr << "[WARNING] Not existing code element: " << (*m_changesetCodeElements)[*it] << std::endl;
+        }
     }
 
     delete m_changeset;
@@ -184,6 +222,62 @@ void CSelectionData::filterToCoverage()
     m_changesetCodeElements = l_changesetCodeElements;
     delete m_resultsTestcases;
     m_resultsTestcases = l_resultsTestcases;
+
+    buildTranslationTables();
+}
+
+void CSelectionData::buildTranslationTables()
+{
+    m_coverageCodeElements->getTranslationTable(*m_changesetCodeElements, *m_changesetToCoverageCodeElements);
+    m_changesetCodeElements->getTranslationTable(*m_coverageCodeElements, *m_coverageToChangesetCodeElements);
+    m_coverageTestcases->getTranslationTable(*m_resultsTestcases, *m_resultsToCoverageTestcases);
+    m_resultsTestcases->getTranslationTable(*m_coverageTestcases, *m_coverageToResultsTestcases);
+
+    m_sameTestcaseIds = true;
+    for (IndexType tcid = 0; tcid < m_coverageToResultsTestcases->size() && m_sameTestcaseIds; tcid++) {
+        m_sameTestcaseIds = (*m_coverageToResultsTestcases)[tcid] == tcid;
+    }
+}
+
+void CSelectionData::getResultsInCoverageOrder(const int revision, CBitList& executed, CBitList& passed) const
+{
+    IndexType nofTestcases = m_coverage->getNumOfTestcases();
+
+    executed.resize(nofTestcases);
+    executed.setAll(false);
+    passed.resize(nofTestcases);
+    passed.setAll(false);
+
+    // The words are copied under the lock of the matrices, so compressed results can be read in parallel
+    IndexType nofResultsTestcases = m_results->getNumOfTestcases();
+    std::vector<WordType> executedWords(CBitOperations::numOfWords(nofResultsTestcases), 0);
+    std::vector<WordType> passedWords(executedWords.size(), 0);
+    m_results->copyResults(revision, executedWords.data(), passedWords.data());
+
+    if (m_sameTestcaseIds && m_coverageToResultsTestcases->size() >= nofTestcases) {
+        // The rows are copied word by word, the bits beyond the coverage test cases are masked
+        IndexType nofWords = std::min(executed.getNumOfWords(), (IndexType)executedWords.size());
+        for (IndexType w = 0; w < nofWords; w++) {
+            executed.setWord(w, executedWords[w]);
+            passed.setWord(w, executedWords[w] & passedWords[w]);
+        }
+        return;
+    }
+
+    for (IndexType tcid = 0; tcid < nofTestcases && tcid < m_coverageToResultsTestcases->size(); tcid++) {
+        IndexType tcidInResults = (*m_coverageToResultsTestcases)[tcid];
+        if (tcidInResults == CIDMapper::NO_ID || tcidInResults >= nofResultsTestcases) {
+            continue;
+        }
+        IndexType w = tcidInResults / CBitOperations::BITS_PER_WORD;
+        WordType mask = WordType(1) << (tcidInResults % CBitOperations::BITS_PER_WORD);
+        if (executedWords[w] & mask) {
+            executed.set(tcid, true);
+            if (passedWords[w] & mask) {
+                passed.set(tcid, true);
+            }
+        }
+    }
 }
 
 } /* namespace soda*/
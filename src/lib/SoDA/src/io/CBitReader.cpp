@@ -34,6 +34,63 @@ CBitReader::~CBitReader()
 {
 }
 
+void CBitReader::readWords(WordType* words, IndexType bits)
+{
+    IndexType numOfWords = (bits + 63) / 64;
+    for (IndexType i = 0; i < numOfWords; i++) {
+        words[i] = 0;
+    }
+    if (bits == 0) {
+        return;
+    }
+
+    // Bits remaining in the buffer.
+    IndexType available = 8 - m_shift;
+    if (bits <= available) {
+        words[0] = (((unsigned char)m_buffer) >> m_shift) & ((1 << bits) - 1);
+        m_shift += bits;
+        return;
+    }
+
+    IndexType remaining = bits - available;
+    IndexType numOfBytes = (remaining + 7) / 8;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    if (available == 0) {
+        // The memory layout of the words is the same as the file layout.
+        m_stream->readData(words, numOfBytes);
+        m_buffer = ((char*)words)[numOfBytes - 1];
+        m_shift = (bits % 8) ? (bits % 8) : 8;
+        if (bits % 64) {
+            words[numOfWords - 1] &= (WordType(1) << (bits % 64)) - 1;
+        }
+        return;
+    }
+#endif
+
+    m_bytes.resize(numOfBytes);
+    m_stream->readData(&m_bytes[0], numOfBytes);
+
+    words[0] = ((unsigned char)m_buffer) >> m_shift;
+    for (IndexType i = 0; i < numOfBytes; i++) {
+        IndexType pos = available + i * 8;
+        WordType value = (unsigned char)m_bytes[i];
+        IndexType index = pos / 64;
+        if (index < numOfWords) {
+            words[index] |= value << (pos % 64);
+        }
+        if (pos % 64 > 56 && index + 1 < numOfWords) {
+            words[index + 1] |= value >> (64 - pos % 64);
+        }
+    }
+    if (bits % 64) {
+        words[numOfWords - 1] &= (WordType(1) << (bits % 64)) - 1;
+    }
+
+    m_buffer = m_bytes[numOfBytes - 1];
+    m_shift = (remaining % 8) ? (remaining % 8) : 8;
+}
+
 } /* namespace io */
 
 } /* namespace soda */
@@ -34,6 +34,56 @@ CBitWriter::~CBitWriter()
 {
 }
 
+void CBitWriter::writeWords(const WordType* words, IndexType bits)
+{
+    if (bits == 0) {
+        return;
+    }
+
+    IndexType total = m_shift + bits;
+    IndexType fullBytes = total / 8;
+    unsigned char pending = (unsigned char)m_buffer;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    if (m_shift == 0) {
+        // The memory layout of the words is the same as the file layout.
+        if (fullBytes > 0) {
+            m_stream->writeData(words, fullBytes);
+        }
+        if (total % 8) {
+            m_buffer = (char)(((const unsigned char*)words)[fullBytes] & ((1 << (total % 8)) - 1));
+            m_shift = total % 8;
+        }
+        return;
+    }
+#endif
+
+    m_bytes.resize(fullBytes + 1);
+    IndexType numOfWords = (bits + 63) / 64;
+    for (IndexType i = 0; i <= fullBytes; i++) {
+        // Bit position of the byte in the words.
+        long long pos = (long long)(i * 8) - m_shift;
+        WordType value = 0;
+        if (pos < 0) {
+            value = (words[0] << (-pos)) | pending;
+        } else if ((IndexType)pos / 64 < numOfWords) {
+            IndexType index = pos / 64;
+            IndexType shift = pos % 64;
+            value = words[index] >> shift;
+            if (shift > 56 && index + 1 < numOfWords) {
+                value |= words[index + 1] << (64 - shift);
+            }
+        }
+        m_bytes[i] = (char)(value & 0xff);
+    }
+
+    if (fullBytes > 0) {
+        m_stream->writeData(&m_bytes[0], fullBytes);
+    }
+    m_shift = total % 8;
+    m_buffer = m_shift ? (char)(m_bytes[fullBytes] & ((1 << m_shift) - 1)) : 0;
+}
+
 } /* namespace io */
 
 } /* namespace soda */
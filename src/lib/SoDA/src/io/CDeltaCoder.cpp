@@ -0,0 +1,87 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "io/CDeltaCoder.h"
+
+namespace soda { namespace io {
+
+IndexType CDeltaCoder::predictSize(const IntVector &indices)
+{
+    IndexType size = 0;
+    IndexType previous = 0;
+    for (IndexType i = 0; i < indices.size(); i++) {
+        IndexType delta = indices[i] - previous;
+        previous = indices[i];
+        do {
+            size++;
+            delta >>= 7;
+        } while (delta != 0);
+    }
+    return size;
+}
+
+IndexType CDeltaCoder::encode(const IntVector &indices, std::vector<unsigned char> &buffer)
+{
+    if (buffer.size() < indices.size() * 10) {
+        buffer.resize(indices.size() * 10);
+    }
+
+    IndexType size = 0;
+    IndexType previous = 0;
+    for (IndexType i = 0; i < indices.size(); i++) {
+        IndexType delta = indices[i] - previous;
+        previous = indices[i];
+        while (delta >= 0x80) {
+            buffer[size++] = (unsigned char)(delta | 0x80);
+            delta >>= 7;
+        }
+        buffer[size++] = (unsigned char)delta;
+    }
+    return size;
+}
+
+bool CDeltaCoder::decode(const unsigned char *data, IndexType size, IndexType count, IntVector &indices)
+{
+    indices.resize(count);
+
+    IndexType pos = 0;
+    IndexType previous = 0;
+    for (IndexType i = 0; i < count; i++) {
+        IndexType delta = 0;
+        unsigned int shift = 0;
+        unsigned char byte;
+        do {
+            if (pos >= size || shift > 63) {
+                return false;
+            }
+            byte = data[pos++];
+            delta |= IndexType(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        previous += delta;
+        indices[i] = previous;
+    }
+    return true;
+}
+
+} /* namespace io */
+
+} /* namespace soda */
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "io/CMappedSoDAio.h"
+#include "exception/CIOException.h"
+
+namespace soda { namespace io {
+
+namespace {
+
+const unsigned int SoDA_MAGIC = 0x41446f53; // LSB: 'S', 'o', 'D', 'A'
+
+// Position of the chunk iterator before the first nextChunkID() call.
+const size_t BEFORE_FIRST = (size_t)-1;
+
+template <typename T>
+T readValue(const char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+CMappedSoDAio::CMappedSoDAio() :
+    m_mapping(0),
+    m_region(0),
+    m_base(0),
+    m_size(0),
+    m_chunks(new std::vector<ChunkInfo>()),
+    m_current(BEFORE_FIRST)
+{ }
+
+CMappedSoDAio::CMappedSoDAio(const char* filename) :
+    m_mapping(0),
+    m_region(0),
+    m_base(0),
+    m_size(0),
+    m_chunks(new std::vector<ChunkInfo>()),
+    m_current(BEFORE_FIRST)
+{
+    open(filename);
+}
+
+CMappedSoDAio::CMappedSoDAio(const String& filename) :
+    m_mapping(0),
+    m_region(0),
+    m_base(0),
+    m_size(0),
+    m_chunks(new std::vector<ChunkInfo>()),
+    m_current(BEFORE_FIRST)
+{
+    open(filename);
+}
+
+CMappedSoDAio::~CMappedSoDAio()
+{
+    close();
+    delete m_chunks;
+}
+
+void CMappedSoDAio::open(const char* filename)
+{
+    close();
+
+    try {
+        m_mapping = new boost::interprocess::file_mapping(filename, boost::interprocess::read_only);
+        m_region = new boost::interprocess::mapped_region(*m_mapping, boost::interprocess::read_only);
+    } catch (boost::interprocess::interprocess_exception& e) {
+        close();
+        throw CIOException("soda::io::CMappedSoDAio::open()", String("Failed to map file! ") + e.what());
+    }
+
+    m_base = static_cast<const char*>(m_region->get_address());
+    m_size = m_region->get_size();
+
+    if (m_size < sizeof(SoDA_MAGIC) || readValue<unsigned int>(m_base) != SoDA_MAGIC) {
+        close();
+        throw CIOException("soda::io::CMappedSoDAio::open()", "Failed to open file! This is not a standard SoDA library file!");
+    }
+
+    indexChunks();
+}
+
+void CMappedSoDAio::open(const String& filename)
+{
+    open(filename.c_str());
+}
+
+void CMappedSoDAio::close()
+{
+    delete m_region;
+    m_region = 0;
+    delete m_mapping;
+    m_mapping = 0;
+    m_base = 0;
+    m_size = 0;
+    m_chunks->clear();
+    m_current = BEFORE_FIRST;
+}
+
+bool CMappedSoDAio::isOpen() const
+{
+    return m_region != 0;
+}
+
+void CMappedSoDAio::indexChunks()
+{
+    const unsigned long long headerSize = sizeof(unsigned int) + sizeof(unsigned long long);
+    unsigned long long pos = sizeof(SoDA_MAGIC);
+
+    while (pos + headerSize <= m_size) {
+        ChunkInfo info;
+        info.id = (CSoDAio::ChunkID)readValue<unsigned int>(m_base + pos);
+        info.length = readValue<unsigned long long>(m_base + pos + sizeof(unsigned int));
+        info.offset = pos + headerSize;
+
+        if (info.id == CSoDAio::REVISIONS && info.offset + sizeof(unsigned int) <= m_size) {
+            info.length = CSoDAio::correctLength(info.id, info.length, readValue<unsigned int>(m_base + info.offset));
+        }
+
+        if (info.offset > m_size || info.length > m_size - info.offset) {
+            throw CIOException("soda::io::CMappedSoDAio::indexChunks()", "Unexpected end of file!");
+        }
+
+        m_chunks->push_back(info);
+        pos = info.offset + info.length;
+    }
+
+    m_current = BEFORE_FIRST;
+}
+
+const std::vector<CMappedSoDAio::ChunkInfo>& CMappedSoDAio::getChunks() const
+{
+    return *m_chunks;
+}
+
+bool CMappedSoDAio::nextChunkID()
+{
+    if (!isOpen())
+        throw CIOException("soda::io::CMappedSoDAio::nextChunkID()", "File is not open!");
+
+    if (m_current == BEFORE_FIRST) {
+        m_current = 0;
+    } else if (m_current < m_chunks->size()) {
+        ++m_current;
+    }
+    return m_current < m_chunks->size();
+}
+
+bool CMappedSoDAio::findChunkID(CSoDAio::ChunkID chunkID)
+{
+    if (!isOpen())
+        throw CIOException("soda::io::CMappedSoDAio::findChunkID()", "File is not open!");
+
+    for (m_current = 0; m_current < m_chunks->size(); ++m_current) {
+        if ((*m_chunks)[m_current].id == chunkID) {
+            return true;
+        }
+    }
+    return false;
+}
+
+CSoDAio::ChunkID CMappedSoDAio::getChunkID() const
+{
+    return (m_current < m_chunks->size()) ? (*m_chunks)[m_current].id : CSoDAio::UNKNOWN_TYPE;
+}
+
+unsigned long long CMappedSoDAio::getActualLength() const
+{
+    return (m_current < m_chunks->size()) ? (*m_chunks)[m_current].length : 0;
+}
+
+const char* CMappedSoDAio::getChunkData() const
+{
+    return (m_current < m_chunks->size()) ? m_base + (*m_chunks)[m_current].offset : 0;
+}
+
+} /* namespace io */
+
+} /* namespace soda */
@@ -28,6 +28,18 @@
 namespace soda { namespace io {
 
 const unsigned int CSoDAio::SoDA_MAGIC = 0x41446f53; // LSB: 'S', 'o', 'D', 'A'
+const unsigned int CSoDAio::DIRECTORY_MAGIC = 0x49446f53; // LSB: 'S', 'o', 'D', 'I'
+const unsigned int CSoDAio::DIRECTORY_VERSION = 1;
+
+/*
+ * The directory is the last chunk of the file:
+ *   version (4), number of entries (8), entries: id (4), offset (8), length (8),
+ *   offset of the directory chunk (8), DIRECTORY_MAGIC (4).
+ * The offsets point to the data of the chunks. Readers without directory support skip it as an unknown chunk.
+ */
+static const unsigned long long HEADER_SIZE = 12;
+static const unsigned long long ENTRY_SIZE = 20;
+static const unsigned long long TRAILER_SIZE = 12;
 
 void CSoDAio::checkOpened(io::CBinaryIO::eOpenMode openMode)
 {
@@ -37,27 +49,142 @@ void CSoDAio::checkOpened(io::CBinaryIO::eOpenMode openMode)
             CBinaryIO::close();
             throw CIOException("soda::io::CSoDAio::open()","Failed to open file! This is not a standard SoDA library file!");
         }
+        readDirectory();
     } else if(openMode == io::CBinaryIO::omWrite) {
         writeUInt4(SoDA_MAGIC);
     } else {
         CBinaryIO::close();
         throw CIOException("soda::io::CSoDAio::open()","Not supported eOpenMode! (Use one of these: omRead, omWrite, omAppend)");
     }
+    m_chunkID = CSoDAio::UNKNOWN_TYPE;
+    m_length = 0;
     m_lastpos = m_file->tellg();
 }
 
+void CSoDAio::readDirectory()
+{
+    m_file->seekg(0, std::ios::end);
+    m_fileSize = m_file->tellg();
+
+    if (m_fileSize >= sizeof(SoDA_MAGIC) + HEADER_SIZE + TRAILER_SIZE + 12) {
+        m_file->seekg(m_fileSize - TRAILER_SIZE, std::ios::beg);
+        unsigned long long dirOffset = readULongLong8();
+        unsigned int magic = readUInt4();
+
+        if (magic == DIRECTORY_MAGIC && dirOffset >= sizeof(SoDA_MAGIC) + HEADER_SIZE && dirOffset <= m_fileSize - 12 - TRAILER_SIZE) {
+            m_file->seekg(dirOffset - HEADER_SIZE, std::ios::beg);
+            ChunkID id = (ChunkID)readInt4();
+            unsigned long long length = readULongLong8();
+            unsigned int version = readUInt4();
+            unsigned long long count = readULongLong8();
+
+            if (id == DIRECTORY && version == DIRECTORY_VERSION && length == m_fileSize - dirOffset &&
+                    count == (length - 12 - TRAILER_SIZE) / ENTRY_SIZE && length == 12 + count * ENTRY_SIZE + TRAILER_SIZE) {
+                std::vector<DirectoryEntry>* directory = new std::vector<DirectoryEntry>(count);
+                for (unsigned long long i = 0; i < count; ++i) {
+                    DirectoryEntry& entry = (*directory)[i];
+                    entry.id = (ChunkID)readInt4();
+                    entry.offset = readULongLong8();
+                    entry.length = readULongLong8();
+                    unsigned long long limit = dirOffset - HEADER_SIZE;
+                    if (entry.offset > limit || entry.length > limit - entry.offset) {
+                        delete directory;
+                        directory = NULL;
+                        break;
+                    }
+                }
+                m_directory = directory;
+            }
+        }
+    }
+
+    m_file->clear();
+    m_file->seekg(sizeof(SoDA_MAGIC), std::ios::beg);
+}
+
+void CSoDAio::writeDirectory()
+{
+    std::vector<DirectoryEntry> entries;
+    unsigned long long size = 0;
+    {
+        std::ifstream in(m_filename.c_str(), std::ios::in | std::ios::binary);
+        if (!in) {
+            return;
+        }
+        in.seekg(0, std::ios::end);
+        size = in.tellg();
+
+        unsigned long long pos = sizeof(SoDA_MAGIC);
+        while (pos + HEADER_SIZE <= size) {
+            int id;
+            DirectoryEntry entry;
+            in.seekg(pos, std::ios::beg);
+            in.read((char*)&id, 4);
+            in.read((char*)&entry.length, 8);
+            entry.id = (ChunkID)id;
+            entry.offset = pos + HEADER_SIZE;
+            if (entry.id == REVISIONS && entry.offset + 4 <= size) {
+                unsigned int count;
+                in.read((char*)&count, 4);
+                entry.length = correctLength(entry.id, entry.length, count);
+            }
+            if (!in || entry.offset > size || entry.length > size - entry.offset) {
+                // The file is not a sequence of chunks, it is left as it is.
+                return;
+            }
+            if (entry.id != DIRECTORY) {
+                entries.push_back(entry);
+            }
+            pos = entry.offset + entry.length;
+        }
+        if (pos != size || entries.empty()) {
+            return;
+        }
+    }
+
+    std::ofstream out(m_filename.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+    int id = DIRECTORY;
+    unsigned long long count = entries.size();
+    unsigned long long length = 12 + count * ENTRY_SIZE + TRAILER_SIZE;
+    unsigned long long dirOffset = size + HEADER_SIZE;
+    out.write((char*)&id, 4);
+    out.write((char*)&length, 8);
+    out.write((char*)&DIRECTORY_VERSION, 4);
+    out.write((char*)&count, 8);
+    for (std::vector<DirectoryEntry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+        id = it->id;
+        out.write((char*)&id, 4);
+        out.write((char*)&it->offset, 8);
+        out.write((char*)&it->length, 8);
+    }
+    out.write((char*)&dirOffset, 8);
+    out.write((char*)&DIRECTORY_MAGIC, 4);
+    if (!out) {
+        throw CIOException("soda::io::CSoDAio::close()", "Failed to write the chunk directory!");
+    }
+}
+
 CSoDAio::CSoDAio() :
     m_chunkID(CSoDAio::UNKNOWN_TYPE),
     m_length(0),
-    m_lastpos(0)
+    m_lastpos(0),
+    m_filename(),
+    m_fileSize(0),
+    m_writeDirectory(true),
+    m_directory(NULL)
 { }
 
 CSoDAio::CSoDAio(const char* filename, io::CBinaryIO::eOpenMode openMode) :
     io::CBinaryIO(filename, openMode),
     m_chunkID(CSoDAio::UNKNOWN_TYPE),
     m_length(0),
-    m_lastpos(0)
+    m_lastpos(0),
+    m_filename(),
+    m_fileSize(0),
+    m_writeDirectory(true),
+    m_directory(NULL)
 {
+    m_filename = filename;
     checkOpened(openMode);
 }
 
@@ -65,21 +192,30 @@ CSoDAio::CSoDAio(const String& filename, io::CBinaryIO::eOpenMode openMode) :
     io::CBinaryIO(filename, openMode),
     m_chunkID(CSoDAio::UNKNOWN_TYPE),
     m_length(0),
-    m_lastpos(0)
+    m_lastpos(0),
+    m_filename(),
+    m_fileSize(0),
+    m_writeDirectory(true),
+    m_directory(NULL)
 {
+    m_filename = filename;
     checkOpened(openMode);
 }
 
 CSoDAio::~CSoDAio()
 {
+    try {
+        close();
+    } catch (CIOException&) {
+        // Destructors must not throw.
+    }
 }
 
 void CSoDAio::open(const char* filename, io::CBinaryIO::eOpenMode openMode)
 {
-    if(isOpen()) {
-        CBinaryIO::close();
-    }
+    close();
     CBinaryIO::open(filename, openMode);
+    m_filename = filename;
     checkOpened(openMode);
 }
 
@@ -91,8 +227,45 @@ void CSoDAio::open(const String& filename, io::CBinaryIO::eOpenMode openMode)
 void CSoDAio::close()
 {
     if(isOpen()) {
+        bool write = m_mode == omWrite && m_writeDirectory;
         CBinaryIO::close();
+        if (write) {
+            writeDirectory();
+        }
+    }
+    delete m_directory;
+    m_directory = NULL;
+    m_fileSize = 0;
+}
+
+void CSoDAio::setWriteDirectory(bool write)
+{
+    m_writeDirectory = write;
+}
+
+bool CSoDAio::hasDirectory() const
+{
+    return m_directory != NULL;
+}
+
+unsigned long long int CSoDAio::correctLength(ChunkID chunkID, unsigned long long int length, unsigned int count)
+{
+    if (chunkID == REVISIONS && length == count * (unsigned long long)(sizeof(RevNumType) + sizeof(IndexType))) {
+        return length + sizeof(RevNumType);
     }
+    return length;
+}
+
+void CSoDAio::skipChunk()
+{
+    unsigned long long length = m_length;
+    if (m_chunkID == REVISIONS && (unsigned long long)m_lastpos + sizeof(RevNumType) <= m_fileSize) {
+        length = correctLength(m_chunkID, m_length, readUInt4());
+    }
+    if ((unsigned long long)m_lastpos > m_fileSize || length > m_fileSize - (unsigned long long)m_lastpos) {
+        throw CIOException("soda::io::CSoDAio::nextChunkID()", "Unexpected end of file!");
+    }
+    m_file->seekg((unsigned long long)m_lastpos + length, std::ios::beg);
 }
 
 const unsigned long long int CSoDAio::getActualLength() const
@@ -108,12 +281,7 @@ const CSoDAio::ChunkID CSoDAio::getChunkID() const
 bool CSoDAio::nextChunkID()
 {
     if(m_file->tellg() == m_lastpos) {
-        for(unsigned long long int i = 0; i < m_length; ++i) {
-            readByte1();
-            if(eof()) {
-                throw CIOException("soda::io::CSoDAio::nextChunkID()", "Unexpected end of file!");
-            }
-        }
+        skipChunk();
     }
 
     /*
@@ -137,6 +305,21 @@ bool CSoDAio::findChunkID(ChunkID chunkID)
     if(m_mode != omRead)
         throw CIOException("soda::io::CSoDAio::findChunkID()","File open mode isn't 'omRead'! You can use findChunkID only in omRead mode!");
 
+    m_file->clear();
+
+    if (m_directory) {
+        for (std::vector<DirectoryEntry>::iterator it = m_directory->begin(); it != m_directory->end(); ++it) {
+            if (it->id == chunkID) {
+                m_chunkID = it->id;
+                m_length = it->length;
+                m_lastpos = it->offset;
+                m_file->seekg(it->offset, std::ios::beg);
+                return true;
+            }
+        }
+        return false;
+    }
+
     m_file->seekg(4, std::ios::beg); // SoDA_MAGIC on first 4 bytes
 
     while(nextChunkID()){
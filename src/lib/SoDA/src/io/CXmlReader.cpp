@@ -0,0 +1,423 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+
+#include "io/CXmlReader.h"
+#include "exception/CIOException.h"
+
+namespace soda { namespace io {
+
+namespace {
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool isNameEnd(char c)
+{
+    return isSpace(c) || c == '>' || c == '/' || c == '=';
+}
+
+inline bool startsWith(const char* pos, const char* end, const char* prefix)
+{
+    size_t length = std::strlen(prefix);
+    return (size_t)(end - pos) >= length && std::memcmp(pos, prefix, length) == 0;
+}
+
+/**
+ * @brief Appends the UTF-8 encoding of a character.
+ */
+void appendUtf8(String& value, unsigned long c)
+{
+    if (c < 0x80) {
+        value += (char)c;
+    } else if (c < 0x800) {
+        value += (char)(0xc0 | (c >> 6));
+        value += (char)(0x80 | (c & 0x3f));
+    } else if (c < 0x10000) {
+        value += (char)(0xe0 | (c >> 12));
+        value += (char)(0x80 | ((c >> 6) & 0x3f));
+        value += (char)(0x80 | (c & 0x3f));
+    } else {
+        value += (char)(0xf0 | (c >> 18));
+        value += (char)(0x80 | ((c >> 12) & 0x3f));
+        value += (char)(0x80 | ((c >> 6) & 0x3f));
+        value += (char)(0x80 | (c & 0x3f));
+    }
+}
+
+/**
+ * @brief Copies an attribute value and replaces the entity and character references.
+ */
+void decode(const char* begin, const char* end, String& value)
+{
+    value.clear();
+    while (begin < end) {
+        const char* amp = static_cast<const char*>(std::memchr(begin, '&', end - begin));
+        if (amp == NULL) {
+            value.append(begin, end);
+            return;
+        }
+        value.append(begin, amp);
+        const char* semicolon = static_cast<const char*>(std::memchr(amp, ';', end - amp));
+        if (semicolon == NULL) {
+            throw CIOException("soda::io::CXmlReader::getAttribute()", "Unterminated reference in attribute value.");
+        }
+        String entity(amp + 1, semicolon);
+        if (entity == "lt") {
+            value += '<';
+        } else if (entity == "gt") {
+            value += '>';
+        } else if (entity == "amp") {
+            value += '&';
+        } else if (entity == "quot") {
+            value += '"';
+        } else if (entity == "apos") {
+            value += '\'';
+        } else if (entity.length() > 1 && entity[0] == '#') {
+            char* last;
+            unsigned long c = (entity[1] == 'x') ? std::strtoul(entity.c_str() + 2, &last, 16) : std::strtoul(entity.c_str() + 1, &last, 10);
+            if (*last != '\0') {
+                throw CIOException("soda::io::CXmlReader::getAttribute()", "Invalid character reference: " + entity);
+            }
+            appendUtf8(value, c);
+        } else {
+            throw CIOException("soda::io::CXmlReader::getAttribute()", "Unknown entity: " + entity);
+        }
+        begin = semicolon + 1;
+    }
+}
+
+} // namespace
+
+CXmlReader::CXmlReader() :
+    m_mapping(0),
+    m_region(0),
+    m_pos(0),
+    m_end(0),
+    m_nodeType(ntNone),
+    m_depth(0),
+    m_openElements(new StringVector()),
+    m_emptyElement(false),
+    m_name(new String()),
+    m_attributes(new std::vector<Attribute>())
+{ }
+
+CXmlReader::CXmlReader(const String& filename) :
+    m_mapping(0),
+    m_region(0),
+    m_pos(0),
+    m_end(0),
+    m_nodeType(ntNone),
+    m_depth(0),
+    m_openElements(new StringVector()),
+    m_emptyElement(false),
+    m_name(new String()),
+    m_attributes(new std::vector<Attribute>())
+{
+    open(filename);
+}
+
+CXmlReader::~CXmlReader()
+{
+    close();
+    delete m_name;
+    delete m_attributes;
+    delete m_openElements;
+}
+
+void CXmlReader::open(const String& filename)
+{
+    close();
+
+    try {
+        m_mapping = new boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+        // An empty file can not be mapped, it is handled as an empty document.
+        if (boost::filesystem::file_size(filename) > 0) {
+            m_region = new boost::interprocess::mapped_region(*m_mapping, boost::interprocess::read_only);
+            m_pos = static_cast<const char*>(m_region->get_address());
+            m_end = m_pos + m_region->get_size();
+        }
+    } catch (std::exception& e) {
+        close();
+        throw CIOException("soda::io::CXmlReader::open()", String("Failed to map file! ") + e.what());
+    }
+}
+
+void CXmlReader::close()
+{
+    delete m_region;
+    m_region = 0;
+    delete m_mapping;
+    m_mapping = 0;
+    m_pos = 0;
+    m_end = 0;
+    m_nodeType = ntNone;
+    m_depth = 0;
+    m_openElements->clear();
+    m_emptyElement = false;
+    m_name->clear();
+    m_attributes->clear();
+}
+
+bool CXmlReader::isOpen() const
+{
+    return m_mapping != 0;
+}
+
+bool CXmlReader::next()
+{
+    m_attributes->clear();
+
+    if (m_emptyElement) {
+        m_emptyElement = false;
+        m_nodeType = ntEndElement;
+        return true;
+    }
+
+    while (m_pos < m_end) {
+        const char* tag = static_cast<const char*>(std::memchr(m_pos, '<', m_end - m_pos));
+        if (tag == NULL) {
+            // Trailing text.
+            m_pos = m_end;
+            break;
+        }
+        m_pos = tag + 1;
+
+        if (startsWith(m_pos, m_end, "!--")) {
+            const char* begin = m_pos + 3;
+            skipPast("-->");
+            m_name->assign(begin, m_pos - 3);
+            m_nodeType = ntComment;
+            m_depth = m_openElements->size();
+            return true;
+        } else if (startsWith(m_pos, m_end, "![CDATA[")) {
+            skipPast("]]>");
+        } else if (startsWith(m_pos, m_end, "?")) {
+            skipPast("?>");
+        } else if (startsWith(m_pos, m_end, "!")) {
+            // Document type declaration, the internal subset can contain '>' characters.
+            int brackets = 0;
+            while (m_pos < m_end && (*m_pos != '>' || brackets > 0)) {
+                if (*m_pos == '[') {
+                    ++brackets;
+                } else if (*m_pos == ']') {
+                    --brackets;
+                }
+                ++m_pos;
+            }
+            if (m_pos == m_end) {
+                throw CIOException("soda::io::CXmlReader::next()", "Unterminated declaration.");
+            }
+            ++m_pos;
+        } else {
+            readTag();
+            return true;
+        }
+    }
+
+    if (!m_openElements->empty()) {
+        throw CIOException("soda::io::CXmlReader::next()", "Unexpected end of document, unclosed element: " + m_openElements->back());
+    }
+    m_nodeType = ntNone;
+    m_name->clear();
+    return false;
+}
+
+void CXmlReader::readTag()
+{
+    bool endTag = (m_pos < m_end && *m_pos == '/');
+    if (endTag) {
+        ++m_pos;
+    }
+
+    const char* name = m_pos;
+    while (m_pos < m_end && !isNameEnd(*m_pos)) {
+        ++m_pos;
+    }
+    if (m_pos == name) {
+        throw CIOException("soda::io::CXmlReader::next()", "Missing element name.");
+    }
+    m_name->assign(name, m_pos);
+
+    while (true) {
+        while (m_pos < m_end && isSpace(*m_pos)) {
+            ++m_pos;
+        }
+        if (m_pos == m_end) {
+            throw CIOException("soda::io::CXmlReader::next()", "Unterminated tag: " + *m_name);
+        }
+        if (*m_pos == '>') {
+            ++m_pos;
+            break;
+        }
+        if (!endTag && *m_pos == '/' && m_pos + 1 < m_end && m_pos[1] == '>') {
+            m_pos += 2;
+            m_emptyElement = true;
+            break;
+        }
+        if (endTag) {
+            throw CIOException("soda::io::CXmlReader::next()", "Invalid end tag: " + *m_name);
+        }
+
+        Attribute attribute;
+        attribute.name = m_pos;
+        while (m_pos < m_end && !isNameEnd(*m_pos)) {
+            ++m_pos;
+        }
+        attribute.nameLength = m_pos - attribute.name;
+        while (m_pos < m_end && isSpace(*m_pos)) {
+            ++m_pos;
+        }
+        if (attribute.nameLength == 0 || m_pos == m_end || *m_pos != '=') {
+            throw CIOException("soda::io::CXmlReader::next()", "Invalid attribute in tag: " + *m_name);
+        }
+        ++m_pos;
+        while (m_pos < m_end && isSpace(*m_pos)) {
+            ++m_pos;
+        }
+        if (m_pos == m_end || (*m_pos != '"' && *m_pos != '\'')) {
+            throw CIOException("soda::io::CXmlReader::next()", "Unquoted attribute value in tag: " + *m_name);
+        }
+        char quote = *m_pos++;
+        const char* value = static_cast<const char*>(std::memchr(m_pos, quote, m_end - m_pos));
+        if (value == NULL) {
+            throw CIOException("soda::io::CXmlReader::next()", "Unterminated attribute value in tag: " + *m_name);
+        }
+        attribute.value = m_pos;
+        attribute.valueLength = value - m_pos;
+        m_attributes->push_back(attribute);
+        m_pos = value + 1;
+    }
+
+    if (endTag) {
+        if (m_openElements->empty()) {
+            throw CIOException("soda::io::CXmlReader::next()", "Unexpected end tag: " + *m_name);
+        }
+        if (m_openElements->back() != *m_name) {
+            throw CIOException("soda::io::CXmlReader::next()", "Mismatched end tag: " + *m_name + ", expected: " + m_openElements->back());
+        }
+        m_openElements->pop_back();
+        m_depth = m_openElements->size();
+        m_nodeType = ntEndElement;
+    } else {
+        m_depth = m_openElements->size();
+        if (!m_emptyElement) {
+            m_openElements->push_back(*m_name);
+        }
+        m_nodeType = ntStartElement;
+    }
+}
+
+void CXmlReader::skipPast(const char* terminator)
+{
+    size_t length = std::strlen(terminator);
+    while (m_pos < m_end) {
+        const char* candidate = static_cast<const char*>(std::memchr(m_pos, terminator[0], m_end - m_pos));
+        if (candidate == NULL) {
+            break;
+        }
+        if (startsWith(candidate, m_end, terminator)) {
+            m_pos = candidate + length;
+            return;
+        }
+        m_pos = candidate + 1;
+    }
+    throw CIOException("soda::io::CXmlReader::next()", String("Missing terminator: ") + terminator);
+}
+
+CXmlReader::eNodeType CXmlReader::getNodeType() const
+{
+    return m_nodeType;
+}
+
+IndexType CXmlReader::getDepth() const
+{
+    return m_depth;
+}
+
+const String& CXmlReader::getName() const
+{
+    return *m_name;
+}
+
+const String& CXmlReader::getComment() const
+{
+    return *m_name;
+}
+
+bool CXmlReader::isElement(const char* name) const
+{
+    return (m_nodeType == ntStartElement || m_nodeType == ntEndElement) && *m_name == name;
+}
+
+const CXmlReader::Attribute* CXmlReader::findAttribute(const char* name) const
+{
+    size_t length = std::strlen(name);
+    for (std::vector<Attribute>::const_iterator it = m_attributes->begin(); it != m_attributes->end(); ++it) {
+        if (it->nameLength == length && std::memcmp(it->name, name, length) == 0) {
+            return &(*it);
+        }
+    }
+    return NULL;
+}
+
+bool CXmlReader::getAttribute(const char* name, String& value) const
+{
+    const Attribute* attribute = findAttribute(name);
+    if (attribute == NULL) {
+        return false;
+    }
+    decode(attribute->value, attribute->value + attribute->valueLength, value);
+    return true;
+}
+
+String CXmlReader::getAttribute(const char* name) const
+{
+    String value;
+    if (!getAttribute(name, value)) {
+        throw CIOException("soda::io::CXmlReader::getAttribute()", "Missing attribute " + String(name) + " in element " + *m_name);
+    }
+    return value;
+}
+
+bool CXmlReader::hasAttributeValue(const char* name, const char* value) const
+{
+    const Attribute* attribute = findAttribute(name);
+    if (attribute == NULL) {
+        return false;
+    }
+    if (std::memchr(attribute->value, '&', attribute->valueLength) == NULL) {
+        return attribute->valueLength == std::strlen(value) && std::memcmp(attribute->value, value, attribute->valueLength) == 0;
+    }
+    String decoded;
+    decode(attribute->value, attribute->value + attribute->valueLength, decoded);
+    return decoded == value;
+}
+
+} /* namespace io */
+
+} /* namespace soda */
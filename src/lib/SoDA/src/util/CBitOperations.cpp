@@ -0,0 +1,375 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/CBitOperations.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(SODA_NO_SIMD)
+#define SODA_X86_KERNELS
+#include <immintrin.h>
+#if (__GNUC__ >= 8) || defined(__clang__)
+#define SODA_X86_VPOPCNT_KERNELS
+#endif
+#endif
+
+namespace soda {
+
+namespace {
+
+typedef IndexType (*CountKernel)(const WordType*, IndexType);
+typedef IndexType (*PairCountKernel)(const WordType*, const WordType*, IndexType);
+typedef void (*BinaryKernel)(WordType*, const WordType*, const WordType*, IndexType);
+
+/**
+ * @brief The set of kernels selected for the current CPU.
+ */
+struct BitKernels {
+    const char* name;
+    CountKernel count;
+    PairCountKernel countAnd;
+    PairCountKernel countXor;
+    BinaryKernel bitwiseAnd;
+    BinaryKernel bitwiseOr;
+    BinaryKernel bitwiseXor;
+    BinaryKernel bitwiseAndNot;
+};
+
+/*
+ * Generic implementations.
+ */
+
+IndexType countGeneric(const WordType* words, IndexType n)
+{
+    IndexType sum = 0;
+    for (IndexType i = 0; i < n; ++i) {
+        sum += CBitOperations::popcount(words[i]);
+    }
+    return sum;
+}
+
+IndexType countAndGeneric(const WordType* a, const WordType* b, IndexType n)
+{
+    IndexType sum = 0;
+    for (IndexType i = 0; i < n; ++i) {
+        sum += CBitOperations::popcount(a[i] & b[i]);
+    }
+    return sum;
+}
+
+IndexType countXorGeneric(const WordType* a, const WordType* b, IndexType n)
+{
+    IndexType sum = 0;
+    for (IndexType i = 0; i < n; ++i) {
+        sum += CBitOperations::popcount(a[i] ^ b[i]);
+    }
+    return sum;
+}
+
+void andGeneric(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    for (IndexType i = 0; i < n; ++i) {
+        dst[i] = a[i] & b[i];
+    }
+}
+
+void orGeneric(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    for (IndexType i = 0; i < n; ++i) {
+        dst[i] = a[i] | b[i];
+    }
+}
+
+void xorGeneric(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    for (IndexType i = 0; i < n; ++i) {
+        dst[i] = a[i] ^ b[i];
+    }
+}
+
+void andNotGeneric(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    for (IndexType i = 0; i < n; ++i) {
+        dst[i] = a[i] & ~b[i];
+    }
+}
+
+#ifdef SODA_X86_KERNELS
+
+/*
+ * AVX2 implementations. The population count uses the nibble lookup table method.
+ */
+
+__attribute__((target("avx2")))
+inline __m256i popcountAvx2(__m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low));
+    __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+    return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+inline IndexType horizontalSumAvx2(__m256i v)
+{
+    return (IndexType)_mm256_extract_epi64(v, 0) + (IndexType)_mm256_extract_epi64(v, 1) +
+           (IndexType)_mm256_extract_epi64(v, 2) + (IndexType)_mm256_extract_epi64(v, 3);
+}
+
+__attribute__((target("avx2,popcnt")))
+IndexType countAvx2(const WordType* words, IndexType n)
+{
+    IndexType i = 0;
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_epi64(acc, popcountAvx2(_mm256_loadu_si256((const __m256i*)(words + i))));
+    }
+    IndexType sum = horizontalSumAvx2(acc);
+    for (; i < n; ++i) {
+        sum += __builtin_popcountll(words[i]);
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,popcnt")))
+IndexType countAndAvx2(const WordType* a, const WordType* b, IndexType n)
+{
+    IndexType i = 0;
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                     _mm256_loadu_si256((const __m256i*)(b + i)));
+        acc = _mm256_add_epi64(acc, popcountAvx2(v));
+    }
+    IndexType sum = horizontalSumAvx2(acc);
+    for (; i < n; ++i) {
+        sum += __builtin_popcountll(a[i] & b[i]);
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,popcnt")))
+IndexType countXorAvx2(const WordType* a, const WordType* b, IndexType n)
+{
+    IndexType i = 0;
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)),
+                                     _mm256_loadu_si256((const __m256i*)(b + i)));
+        acc = _mm256_add_epi64(acc, popcountAvx2(v));
+    }
+    IndexType sum = horizontalSumAvx2(acc);
+    for (; i < n; ++i) {
+        sum += __builtin_popcountll(a[i] ^ b[i]);
+    }
+    return sum;
+}
+
+#define SODA_AVX2_BINARY_KERNEL(NAME, INTRINSIC, SCALAR) \
+__attribute__((target("avx2"))) \
+void NAME(WordType* dst, const WordType* a, const WordType* b, IndexType n) \
+{ \
+    IndexType i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i)); \
+        __m256i y = _mm256_loadu_si256((const __m256i*)(b + i)); \
+        _mm256_storeu_si256((__m256i*)(dst + i), INTRINSIC); \
+    } \
+    for (; i < n; ++i) { \
+        dst[i] = SCALAR; \
+    } \
+}
+
+SODA_AVX2_BINARY_KERNEL(andAvx2, _mm256_and_si256(x, y), a[i] & b[i])
+SODA_AVX2_BINARY_KERNEL(orAvx2, _mm256_or_si256(x, y), a[i] | b[i])
+SODA_AVX2_BINARY_KERNEL(xorAvx2, _mm256_xor_si256(x, y), a[i] ^ b[i])
+SODA_AVX2_BINARY_KERNEL(andNotAvx2, _mm256_andnot_si256(y, x), a[i] & ~b[i])
+
+/*
+ * AVX-512 implementations.
+ */
+
+#define SODA_AVX512_BINARY_KERNEL(NAME, INTRINSIC, SCALAR) \
+__attribute__((target("avx512f"))) \
+void NAME(WordType* dst, const WordType* a, const WordType* b, IndexType n) \
+{ \
+    IndexType i = 0; \
+    for (; i + 8 <= n; i += 8) { \
+        __m512i x = _mm512_loadu_si512((const void*)(a + i)); \
+        __m512i y = _mm512_loadu_si512((const void*)(b + i)); \
+        _mm512_storeu_si512((void*)(dst + i), INTRINSIC); \
+    } \
+    for (; i < n; ++i) { \
+        dst[i] = SCALAR; \
+    } \
+}
+
+SODA_AVX512_BINARY_KERNEL(andAvx512, _mm512_and_si512(x, y), a[i] & b[i])
+SODA_AVX512_BINARY_KERNEL(orAvx512, _mm512_or_si512(x, y), a[i] | b[i])
+SODA_AVX512_BINARY_KERNEL(xorAvx512, _mm512_xor_si512(x, y), a[i] ^ b[i])
+SODA_AVX512_BINARY_KERNEL(andNotAvx512, _mm512_andnot_si512(y, x), a[i] & ~b[i])
+
+#ifdef SODA_X86_VPOPCNT_KERNELS
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+IndexType countAvx512(const WordType* words, IndexType n)
+{
+    IndexType i = 0;
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*)(words + i))));
+    }
+    IndexType sum = _mm512_reduce_add_epi64(acc);
+    for (; i < n; ++i) {
+        sum += __builtin_popcountll(words[i]);
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+IndexType countAndAvx512(const WordType* a, const WordType* b, IndexType n)
+{
+    IndexType i = 0;
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_and_si512(_mm512_loadu_si512((const void*)(a + i)),
+                                     _mm512_loadu_si512((const void*)(b + i)));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    IndexType sum = _mm512_reduce_add_epi64(acc);
+    for (; i < n; ++i) {
+        sum += __builtin_popcountll(a[i] & b[i]);
+    }
+    return sum;
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+IndexType countXorAvx512(const WordType* a, const WordType* b, IndexType n)
+{
+    IndexType i = 0;
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_xor_si512(_mm512_loadu_si512((const void*)(a + i)),
+                                     _mm512_loadu_si512((const void*)(b + i)));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    IndexType sum = _mm512_reduce_add_epi64(acc);
+    for (; i < n; ++i) {
+        sum += __builtin_popcountll(a[i] ^ b[i]);
+    }
+    return sum;
+}
+
+#endif /* SODA_X86_VPOPCNT_KERNELS */
+
+#endif /* SODA_X86_KERNELS */
+
+BitKernels selectKernels()
+{
+    BitKernels kernels = { "generic", countGeneric, countAndGeneric, countXorGeneric, andGeneric, orGeneric, xorGeneric, andNotGeneric };
+
+#ifdef SODA_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        BitKernels avx2 = { "avx2", countAvx2, countAndAvx2, countXorAvx2, andAvx2, orAvx2, xorAvx2, andNotAvx2 };
+        kernels = avx2;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels.name = "avx512";
+        kernels.bitwiseAnd = andAvx512;
+        kernels.bitwiseOr = orAvx512;
+        kernels.bitwiseXor = xorAvx512;
+        kernels.bitwiseAndNot = andNotAvx512;
+#ifdef SODA_X86_VPOPCNT_KERNELS
+        if (__builtin_cpu_supports("avx512vpopcntdq")) {
+            kernels.count = countAvx512;
+            kernels.countAnd = countAndAvx512;
+            kernels.countXor = countXorAvx512;
+        }
+#endif
+    }
+#endif
+
+    return kernels;
+}
+
+const BitKernels& kernels()
+{
+    static const BitKernels selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+IndexType CBitOperations::count(const WordType* words, IndexType n)
+{
+    return kernels().count(words, n);
+}
+
+IndexType CBitOperations::countAnd(const WordType* a, const WordType* b, IndexType n)
+{
+    return kernels().countAnd(a, b, n);
+}
+
+IndexType CBitOperations::countXor(const WordType* a, const WordType* b, IndexType n)
+{
+    return kernels().countXor(a, b, n);
+}
+
+void CBitOperations::bitwiseAnd(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    kernels().bitwiseAnd(dst, a, b, n);
+}
+
+void CBitOperations::bitwiseOr(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    kernels().bitwiseOr(dst, a, b, n);
+}
+
+void CBitOperations::bitwiseXor(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    kernels().bitwiseXor(dst, a, b, n);
+}
+
+void CBitOperations::bitwiseAndNot(WordType* dst, const WordType* a, const WordType* b, IndexType n)
+{
+    kernels().bitwiseAndNot(dst, a, b, n);
+}
+
+void CBitOperations::transposeBlock(WordType* block)
+{
+    // The block is transposed by swapping the off-diagonal 32x32, 16x16, ... 1x1 sub-blocks.
+    WordType mask = 0x00000000ffffffffULL;
+    for (unsigned int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (unsigned int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            WordType t = ((block[k] >> j) ^ block[k | j]) & mask;
+            block[k] ^= t << j;
+            block[k | j] ^= t;
+        }
+    }
+}
+
+const char* CBitOperations::getKernelName()
+{
+    return kernels().name;
+}
+
+} // namespace soda
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "util/CCoverageSpectrum.h"
+#include "util/CBitOperations.h"
+
+namespace soda {
+
+CCoverageSpectrum::CCoverageSpectrum() :
+    m_ef(new IntVector()),
+    m_ep(new IntVector()),
+    m_nf(new IntVector()),
+    m_np(new IntVector()),
+    m_failed(0),
+    m_passed(0)
+{ }
+
+CCoverageSpectrum::~CCoverageSpectrum()
+{
+    delete m_ef;
+    delete m_ep;
+    delete m_nf;
+    delete m_np;
+}
+
+void CCoverageSpectrum::compute(CSelectionData& data, RevNumType revision, const IntVector& testcases, const IntVector& codeElements)
+{
+    CBitList executed, passed;
+    data.getResultsInCoverageOrder(revision, executed, passed);
+
+    IntVector executedTestcases;
+    CBitList failed;
+    executedTestcases.reserve(testcases.size());
+    for (IntVector::const_iterator it = testcases.begin(); it != testcases.end(); ++it) {
+        if (executed[*it]) {
+            executedTestcases.push_back(*it);
+            failed.push_back(!passed[*it]);
+        }
+    }
+
+    compute(data.getCoverage()->getBitMatrix(), executedTestcases, failed, codeElements);
+}
+
+void CCoverageSpectrum::compute(const IBitMatrix& coverage, const IntVector& testcases, const CBitList& failed, const IntVector& codeElements)
+{
+    const IndexType NO_COLUMN = (IndexType)-1;
+    IndexType nrOfTestcases = testcases.size();
+    IndexType nrOfWords = CBitOperations::numOfWords(nrOfTestcases);
+
+    // Masks of the failed and passed test cases.
+    std::vector<WordType> failedMask(failed.getWords(), failed.getWords() + nrOfWords);
+    std::vector<WordType> passedMask(nrOfWords);
+    for (IndexType w = 0; w < nrOfWords; ++w) {
+        passedMask[w] = ~failedMask[w];
+    }
+    if (nrOfWords > 0) {
+        passedMask[nrOfWords - 1] &= CBitOperations::lastWordMask(nrOfTestcases);
+    }
+    m_failed = CBitOperations::count(failedMask.data(), nrOfWords);
+    m_passed = nrOfTestcases - m_failed;
+
+    // Transposed coverage: one word-packed column of the test cases for each code element.
+    IntVector columnOf(coverage.getNumOfCols(), NO_COLUMN);
+    for (IndexType j = 0; j < codeElements.size(); ++j) {
+        columnOf[codeElements[j]] = j;
+    }
+    std::vector<WordType> columns(codeElements.size() * nrOfWords, 0);
+
+    for (IndexType k = 0; k < nrOfTestcases; ++k) {
+        IndexType row = testcases[k];
+        WordType bit = WordType(1) << (k % CBitOperations::BITS_PER_WORD);
+        IndexType word = k / CBitOperations::BITS_PER_WORD;
+
+        const WordType* rowWords = coverage.getRowWords(row);
+        if (rowWords == NULL) {
+            const CBitList* list = dynamic_cast<const CBitList*>(&coverage.getRow(row));
+            if (list != NULL) {
+                rowWords = list->getWords();
+            }
+        }
+
+        if (rowWords != NULL) {
+            IndexType nrOfRowWords = CBitOperations::numOfWords(coverage.getNumOfCols());
+            for (IndexType w = 0; w < nrOfRowWords; ++w) {
+                for (WordType x = rowWords[w]; x; x &= x - 1) {
+                    IndexType j = columnOf[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(x)];
+                    if (j != NO_COLUMN) {
+                        columns[j * nrOfWords + word] |= bit;
+                    }
+                }
+            }
+        } else {
+            for (IndexType j = 0; j < codeElements.size(); ++j) {
+                if (coverage.get(row, codeElements[j])) {
+                    columns[j * nrOfWords + word] |= bit;
+                }
+            }
+        }
+    }
+
+    m_ef->resize(codeElements.size());
+    m_ep->resize(codeElements.size());
+    m_nf->resize(codeElements.size());
+    m_np->resize(codeElements.size());
+    for (IndexType j = 0; j < codeElements.size(); ++j) {
+        const WordType* column = columns.data() + j * nrOfWords;
+        (*m_ef)[j] = CBitOperations::countAnd(column, failedMask.data(), nrOfWords);
+        (*m_ep)[j] = CBitOperations::countAnd(column, passedMask.data(), nrOfWords);
+        (*m_nf)[j] = m_failed - (*m_ef)[j];
+        (*m_np)[j] = m_passed - (*m_ep)[j];
+    }
+}
+
+const IntVector& CCoverageSpectrum::getEf() const
+{
+    return *m_ef;
+}
+
+const IntVector& CCoverageSpectrum::getEp() const
+{
+    return *m_ep;
+}
+
+const IntVector& CCoverageSpectrum::getNf() const
+{
+    return *m_nf;
+}
+
+const IntVector& CCoverageSpectrum::getNp() const
+{
+    return *m_np;
+}
+
+IndexType CCoverageSpectrum::getNumOfFailed() const
+{
+    return m_failed;
+}
+
+IndexType CCoverageSpectrum::getNumOfPassed() const
+{
+    return m_passed;
+}
+
+} // namespace soda
@@ -89,9 +89,10 @@ void CResultsDataManager::dumpExecution(const String& filepath, bool psize, char
         }
 
         for (IndexType rev = 0; rev < m.getNumOfRows(); ++rev) {
-            O << m[rev][0];
+            const IBitList& row = m[rev];
+            O << row[0];
             for(IndexType tcidx = 1; tcidx < m.getNumOfCols(); ++tcidx) {
-                O << csep << (m[rev][tcidx] ? '1' : '0');
+                O << csep << (row[tcidx] ? '1' : '0');
             }
             O << rsep;
         }
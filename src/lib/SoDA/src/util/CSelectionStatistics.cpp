@@ -21,6 +21,7 @@
 
 #include "boost/lexical_cast.hpp"
 #include "util/CSelectionStatistics.h"
+#include "util/CBitOperations.h"
 #include <sstream>
 #include <algorithm>
 #include <math.h>
@@ -135,9 +136,13 @@ void CSelectionStatistics::calcFailStatistics(rapidjson::Document &doc)
     IdxIdxMap data;
     IdxIdxMap revdata;
 
+    IndexType nofWords = CBitOperations::numOfWords(m_selectionData->getResults()->getNumOfTestcases());
+    std::vector<WordType> executed(nofWords, 0);
+    std::vector<WordType> passed(nofWords, 0);
     for (IndexType i = 0; i < nrOfRevisions; i++) {
         IndexType rev = revisions[i];
-        IndexType count = m_selectionData->getResults()->getExecutionBitList(rev).count() - m_selectionData->getResults()->getPassedBitList(rev).count();
+        m_selectionData->getResults()->copyResults(rev, executed.data(), passed.data());
+        IndexType count = CBitOperations::count(executed.data(), nofWords) - CBitOperations::count(passed.data(), nofWords);
         failed += count;
         revdata[revisions[i]] = count;
         data[count]++;
@@ -170,22 +175,30 @@ void CSelectionStatistics::calcCovResultsSummary(rapidjson::Document &doc)
     doc.AddMember("number_of_revisions", nOfRevisions, doc.GetAllocator());
     doc.AddMember("number_of_test_cases", nOfTestCases, doc.GetAllocator());
 
-    rapidjson::Value tcInfos(rapidjson::kObjectType);
-    for (IndexType tcid = 0; tcid < nOfTestCases; tcid++) {
-        IndexType tcidInResult = m_selectionData->translateTestcaseIdFromCoverageToResults(tcid);
-        IndexType execCnt = 0;
-        IndexType failedCnt = 0;
-        for (IndexType i = 0; i < nOfRevisions; i++) {
-            IndexType rev = revisions[i];
-            if (m_selectionData->getResults()->getExecutionBitList(rev).at(tcidInResult)) {
-                execCnt++;
-                sumExecCnt++;
-                if (!m_selectionData->getResults()->getPassedBitList(rev).at(tcidInResult)) {
-                    failedCnt++;
-                    sumFailedCnt++;
-                }
+    // The results of each revision are counted in the order of the coverage test cases
+    IntVector execCnts(nOfTestCases, 0);
+    IntVector failedCnts(nOfTestCases, 0);
+    CBitList executed, passed;
+    for (IndexType i = 0; i < nOfRevisions; i++) {
+        m_selectionData->getResultsInCoverageOrder(revisions[i], executed, passed);
+        const WordType* executedWords = executed.getWords();
+        const WordType* passedWords = passed.getWords();
+        for (IndexType w = 0; w < executed.getNumOfWords(); w++) {
+            for (WordType x = executedWords[w]; x; x &= x - 1) {
+                execCnts[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(x)]++;
+            }
+            for (WordType x = executedWords[w] & ~passedWords[w]; x; x &= x - 1) {
+                failedCnts[w * CBitOperations::BITS_PER_WORD + CBitOperations::lowestBit(x)]++;
             }
         }
+        sumExecCnt += executed.count();
+        sumFailedCnt += executed.count() - passed.count();
+    }
+
+    rapidjson::Value tcInfos(rapidjson::kObjectType);
+    for (IndexType tcid = 0; tcid < nOfTestCases; tcid++) {
+        IndexType execCnt = execCnts[tcid];
+        IndexType failedCnt = failedCnts[tcid];
         execData[execCnt]++;
         rapidjson::Value tcInfo(rapidjson::kObjectType);
         tcInfo.AddMember("executed", execCnt, doc.GetAllocator());
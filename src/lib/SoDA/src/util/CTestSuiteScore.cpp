@@ -49,12 +49,13 @@ double CTestSuiteScore::fdScore(CSelectionData &data, CClusterDefinition &cluste
     IntVector testCaseIds = cluster.getTestCases();
     IndexType nOfTestcases = testCaseIds.size();
 
+    CBitList failed, passed;
+    data.getResultsInCoverageOrder(revision, failed, passed);
+    failed.bitwiseAndNot(passed);
+
     double nrOfFailedAndCovered = 0.0;
     for (IndexType i = 0; i < nOfTestcases; i++) {
-        IndexType tcid = testCaseIds[i];
-        IndexType tcidInResults = data.translateTestcaseIdFromCoverageToResults(tcid);
-        if (data.getResults()->getExecutionBitList(revision).at(tcidInResults) &&
-                !data.getResults()->getPassedBitList(revision).at(tcidInResults)) {
+        if (failed[testCaseIds[i]]) {
             nrOfFailedAndCovered++;
         }
     }
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <exception>
+#include <boost/thread.hpp>
+
+#include "util/CThreadPool.h"
+
+namespace soda {
+
+/**
+ * @brief The state shared by the caller of run() and the worker threads.
+ */
+struct CThreadPool::SharedState {
+    boost::mutex mutex;
+    boost::condition_variable workAvailable;
+    boost::condition_variable workDone;
+    boost::thread_group threads;
+    const boost::function<void (IndexType)> *task;
+    IndexType next;
+    IndexType numOfTasks;
+    unsigned int generation;
+    unsigned int numOfActiveWorkers;
+    bool running;
+    bool stop;
+    std::exception_ptr exception;
+
+    /**
+     * @brief Runs the remaining tasks of the current run, the lock is held between the tasks.
+     */
+    void runTasks(boost::mutex::scoped_lock &lock);
+};
+
+CThreadPool::CThreadPool(unsigned int numOfThreads) :
+    m_numOfThreads(numOfThreads),
+    m_state(new SharedState())
+{
+    if (m_numOfThreads == 0) {
+        m_numOfThreads = std::max(1u, boost::thread::hardware_concurrency());
+    }
+    m_state->task = NULL;
+    m_state->next = 0;
+    m_state->numOfTasks = 0;
+    m_state->generation = 0;
+    m_state->numOfActiveWorkers = 0;
+    m_state->running = false;
+    m_state->stop = false;
+}
+
+CThreadPool::~CThreadPool()
+{
+    {
+        boost::mutex::scoped_lock lock(m_state->mutex);
+        m_state->stop = true;
+    }
+    m_state->workAvailable.notify_all();
+    m_state->threads.join_all();
+    delete m_state;
+}
+
+unsigned int CThreadPool::getNumOfThreads() const
+{
+    return m_numOfThreads;
+}
+
+void CThreadPool::run(IndexType numOfTasks, const boost::function<void (IndexType)> &task)
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+    if (m_numOfThreads == 1 || numOfTasks <= 1 || m_state->running) {
+        lock.unlock();
+        for (IndexType i = 0; i < numOfTasks; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    if (m_state->threads.size() == 0) {
+        for (unsigned int i = 1; i < m_numOfThreads; ++i) {
+            m_state->threads.create_thread(boost::bind(&CThreadPool::work, this));
+        }
+    }
+
+    m_state->running = true;
+    m_state->task = &task;
+    m_state->next = 0;
+    m_state->numOfTasks = numOfTasks;
+    m_state->exception = std::exception_ptr();
+    ++m_state->generation;
+    m_state->workAvailable.notify_all();
+
+    m_state->runTasks(lock);
+    while (m_state->numOfActiveWorkers > 0) {
+        m_state->workDone.wait(lock);
+    }
+
+    std::exception_ptr exception = m_state->exception;
+    m_state->exception = std::exception_ptr();
+    m_state->task = NULL;
+    m_state->running = false;
+    lock.unlock();
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+void CThreadPool::work()
+{
+    boost::mutex::scoped_lock lock(m_state->mutex);
+    unsigned int generation = 0;
+    while (true) {
+        while (!m_state->stop && m_state->generation == generation) {
+            m_state->workAvailable.wait(lock);
+        }
+        if (m_state->stop) {
+            return;
+        }
+        generation = m_state->generation;
+
+        ++m_state->numOfActiveWorkers;
+        m_state->runTasks(lock);
+        if (--m_state->numOfActiveWorkers == 0) {
+            m_state->workDone.notify_all();
+        }
+    }
+}
+
+void CThreadPool::SharedState::runTasks(boost::mutex::scoped_lock &lock)
+{
+    while (running && next < numOfTasks && !exception) {
+        IndexType index = next++;
+        const boost::function<void (IndexType)> &currentTask = *task;
+        lock.unlock();
+        try {
+            currentTask(index);
+        } catch (...) {
+            lock.lock();
+            if (!exception) {
+                exception = std::current_exception();
+            }
+            continue;
+        }
+        lock.lock();
+    }
+}
+
+} // namespace soda
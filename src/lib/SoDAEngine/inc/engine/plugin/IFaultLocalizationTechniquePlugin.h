@@ -27,6 +27,7 @@
 #include <vector>
 
 #include "data/CClusterDefinition.h"
+#include "data/CFLMetricTable.h"
 #include "data/CSelectionData.h"
 #include "data/SoDALibDefs.h"
 #include "rapidjson/document.h"
@@ -83,6 +84,12 @@ public:
      */
     virtual void init(CSelectionData *data, ClusterMap *clusters, IndexType revision, IntVector failedCodeElements) = 0;
 
+    /**
+     * @brief Sets the number of threads used to process the clusters in parallel.
+     * @param numOfThreads Number of threads, 0 means the number of hardware threads.
+     */
+    virtual void setNumOfThreads(unsigned int numOfThreads) = 0;
+
     /**
      * @brief Returns the distributiuon of fault lcoalization technique values.
      * @return
@@ -95,6 +102,13 @@ public:
      */
     virtual void calculate(rapidjson::Document &res) = 0;
 
+    /**
+     * @brief Calculates the metric values for each code element in the clusters.
+     *        The values of the dependencies are read from the columns of the tables.
+     * @param tables The metric tables of the clusters, the new columns are added to them.
+     */
+    virtual void calculate(FLMetricTables &tables) = 0;
+
     /**
      * @brief Returns the fl score of all the elements.
      * @return
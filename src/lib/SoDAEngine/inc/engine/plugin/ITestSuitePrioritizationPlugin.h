@@ -56,6 +56,12 @@ public:
      */
     virtual void init(CSelectionData *, CKernel *) = 0;
 
+    /**
+     * @brief Sets the number of threads used by the prioritization. The plugins which do not run in parallel ignore it.
+     * @param numOfThreads Number of threads, 0 means the number of hardware threads.
+     */
+    virtual void setNumOfThreads(unsigned int) {}
+
     /**
      * @brief Sets the cinitial state of the algorithm.
      * @param ordered List of already prioritized tests. The algorithm will continue the priorotozation from this point.
@@ -20,22 +20,35 @@
  */
 
 #include <iostream>
-#include <fstream>
-#include <ctype.h>
 
-#include "boost/property_tree/ptree.hpp"
-#include "boost/property_tree/xml_parser.hpp"
-#include "boost/foreach.hpp"
-#include "boost/regex.hpp"
 #include "exception/CException.h"
+#include "io/CXmlReader.h"
+#include "util/CThreadPool.h"
 #include "EmmaJavaCoverageReaderPlugin.h"
 
-namespace pt = boost::property_tree;
-
 namespace soda {
 
+namespace {
+
+/**
+ * @brief The elements of the EMMA report which define code elements.
+ */
+enum ElementKind { OTHER, PACKAGE_ELEMENT, SRCFILE_ELEMENT, CLASS_ELEMENT, METHOD_ELEMENT };
+
+/**
+ * @brief An open element of the report.
+ */
+struct OpenElement {
+    ElementKind kind;
+    // True if the first coverage child of the method has already been read.
+    bool counted;
+};
+
+} // namespace
+
 EmmaJavaCoverageReaderPlugin::EmmaJavaCoverageReaderPlugin() :
-    m_coverage(NULL)
+    m_coverage(NULL),
+    m_numOfThreads(1)
 {}
 
 EmmaJavaCoverageReaderPlugin::~EmmaJavaCoverageReaderPlugin()
@@ -65,9 +78,17 @@ CCoverageMatrix* EmmaJavaCoverageReaderPlugin::read(const variables_map &vm)
         m_granularity = METHOD;
     }
 
+    m_numOfThreads = vm.count("jobs") ? vm["jobs"].as<unsigned int>() : 1;
+
     std::cerr << "Granularity: " << m_granularity << std::endl << std::endl;
     m_coverage = new CCoverageMatrix();
-    readFromDirectoryStructure(vm["path"].as<String>());
+    try {
+        readFromDirectoryStructure(vm["path"].as<String>());
+    } catch (...) {
+        delete m_coverage;
+        m_coverage = NULL;
+        throw;
+    }
     return m_coverage;
 }
 
@@ -87,9 +108,37 @@ void EmmaJavaCoverageReaderPlugin::readFromDirectoryStructure(const char * dirna
     }
 
     size_t cutsize = coverage_path.generic_string().length() + ((*(coverage_path.generic_string().rbegin()) == '/') ? 0 : 1);
-    readFromDirectory1stPass(coverage_path, cutsize);
-    m_coverage->refitMatrixSize();
-    readFromDirectory(coverage_path, cutsize);
+    std::vector<fs::path> files;
+    StringVector testcaseNames;
+    collectFiles(coverage_path, cutsize, files, testcaseNames);
+
+    // Each thread reads a contiguous range of the files into its own builder, so merging
+    // the builders in order gives the same identifiers as reading the files one by one.
+    CThreadPool pool(m_numOfThreads);
+    IndexType numOfChunks = std::min<IndexType>(pool.getNumOfThreads(), files.size());
+    std::vector<CCoverageMatrixBuilder*> builders;
+    for (IndexType i = 0; i < numOfChunks; ++i) {
+        builders.push_back(new CCoverageMatrixBuilder());
+    }
+    CCoverageMatrixBuilder builder;
+    try {
+        pool.run(numOfChunks, [this, &files, &testcaseNames, &builders, numOfChunks](IndexType chunk) {
+            IndexType end = (chunk + 1) * files.size() / numOfChunks;
+            for (IndexType i = chunk * files.size() / numOfChunks; i < end; ++i) {
+                readFile(files[i], testcaseNames[i], *builders[chunk]);
+            }
+        });
+        builder.merge(builders, m_numOfThreads);
+    } catch (...) {
+        for (IndexType i = 0; i < builders.size(); ++i) {
+            delete builders[i];
+        }
+        throw;
+    }
+    for (IndexType i = 0; i < builders.size(); ++i) {
+        delete builders[i];
+    }
+    builder.build(*m_coverage);
 }
 
 void EmmaJavaCoverageReaderPlugin::readFromDirectoryStructure(const std::string& dirname)
@@ -97,246 +146,82 @@ void EmmaJavaCoverageReaderPlugin::readFromDirectoryStructure(const std::string&
     readFromDirectoryStructure(dirname.c_str());
 }
 
-void EmmaJavaCoverageReaderPlugin::readFromDirectory1stPass(fs::path p, size_t cut)
+void EmmaJavaCoverageReaderPlugin::collectFiles(const fs::path &p, size_t cut, std::vector<fs::path> &files, StringVector &testcaseNames)
 {
-    static int info_tcnt = 0; //INFO
-    static int info_tmax = 0;
-    int info_cnt = 0; //INFO
-    int info_max;
-
-    std::cout << "Directory: " << p << " 1st pass" << std::endl;
-    std::cout.flush();
+    std::cout << "Directory: " << p << std::endl;
 
     std::vector<fs::path> pathVector;
     std::copy(fs::directory_iterator(p), fs::directory_iterator(), back_inserter(pathVector));
     std::sort(pathVector.begin(), pathVector.end());
-    info_tmax += info_max = pathVector.size();
-
-    bool readXML = true;
 
     for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); it++) {
         if (is_directory(*it)) { // recurse into subdirs
             if (basename(*it) != "") {
-                readFromDirectory1stPass(*it, cut);
-            } else {
-                info_tmax--;
-                info_max--;
+                collectFiles(*it, cut, files, testcaseNames);
             }
         } else {
-            std::cout << info_cnt++ << "/" << info_max << ' ' << info_tcnt++ << "/" << info_tmax << '\r';
-            std::cout.flush();
-
             std::string tcname = it->generic_string().substr(cut);
             cutExtension(tcname);
-            m_coverage->addTestcaseName(tcname);
-
-            // The EMMA xml report contains all code elements, we do not need to read all files in the 1st pass.
-            if (!readXML) {
-                //continue;
-            }
-
-            std::ifstream in(it->string().c_str());
-            std::string line;
-
-            boost::regex packageStartExpr(".*<package .+>.*");
-            boost::regex packageEndExpr(".*</package>.*");
-            while (std::getline(in, line)) {
-                // Skip first few lines
-                if (!boost::regex_match(line, packageStartExpr)) {
-                    continue;
-                }
-                std::stringstream xmlString;
-                xmlString << line << std::endl;
-                while (std::getline(in, line)) {
-                    xmlString << line << std::endl;
-                    if (boost::regex_match(line, packageEndExpr)) {
-                        break;
-                    }
-                }
-
-                // Process XML
-                pt::ptree xml;
-                pt::read_xml(xmlString, xml);
-
-                String packageName = xml.get<String>("package.<xmlattr>.name");
-
-                if (m_granularity == PACKAGE) {
-                    m_coverage->addCodeElementName(packageName);
-                    continue;
-                }
-
-                BOOST_FOREACH(ptree::value_type &srcFile, xml.get_child("package")) {
-                    if (srcFile.first == "srcfile") {
-                        String srcFileName = srcFile.second.get<String>("<xmlattr>.name");
-                        if (m_granularity == SRC) {
-                            std::stringstream codeElement;
-                            codeElement << packageName << "." << srcFileName;
-
-                            m_coverage->addCodeElementName(codeElement.str());
-                            continue;
-                        }
-
-                        BOOST_FOREACH(ptree::value_type &classElement, srcFile.second.get_child("")) {
-                            if (classElement.first == "class") {
-                                String className = classElement.second.get<String>("<xmlattr>.name");
-                                if (m_granularity == CLASS) {
-                                    std::stringstream codeElement;
-                                    codeElement << packageName << "." << className;
-
-                                    m_coverage->addCodeElementName(codeElement.str());
-                                    continue;
-                                }
-
-
-                                BOOST_FOREACH(ptree::value_type &method, classElement.second.get_child("")) {
-                                    if (method.first == "method") {
-                                        String methodName = method.second.get<String>("<xmlattr>.name");
-                                        if (m_granularity == METHOD) {
-                                            std::stringstream codeElement;
-                                            codeElement << packageName << "." << className << "." << methodName;
-
-                                            m_coverage->addCodeElementName(codeElement.str());
-                                            continue;
-                                        }
-                                    }
-
-                                }
-                            }
-
-                        }
-                    }
-
-                }
-            }
-            in.close();
-            readXML = false;
+            files.push_back(*it);
+            testcaseNames.push_back(tcname);
         }
     }
 }
 
-void EmmaJavaCoverageReaderPlugin::readFromDirectory(fs::path p, size_t cut)
+void EmmaJavaCoverageReaderPlugin::readFile(const fs::path &p, const String &testcaseName, CCoverageMatrixBuilder &builder)
 {
-    static int info_tcnt = 0; //INFO
-    static int info_tmax = 0;
-    int info_cnt = 0; //INFO
-    int info_max;
+    io::CXmlReader xml(p.string());
 
-    std::cout << "Directory: " << p << std::endl;
-    std::cout.flush();
+    IndexType tcidx = builder.addTestcaseName(testcaseName);
+    IndexType ceidx = 0;
+    String packageName;
+    String className;
+    std::vector<OpenElement> elements;
 
-    std::vector<fs::path> pathVector;
-    std::copy(fs::directory_iterator(p), fs::directory_iterator(), back_inserter(pathVector));
-    std::sort(pathVector.begin(), pathVector.end());
-    info_tmax += info_max = pathVector.size();
+    while (xml.next()) {
+        if (xml.getNodeType() != io::CXmlReader::ntStartElement) {
+            continue;
+        }
 
-    for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); it++) {
-        if (is_directory(*it)) { // recurse into subdirs
-            if (basename(*it) != "") {
-                readFromDirectory(*it, cut);
-            } else {
-                info_tmax--;
-                info_max--;
+        IndexType depth = xml.getDepth();
+        elements.resize(depth + 1);
+        OpenElement &element = elements[depth];
+        element.kind = OTHER;
+        element.counted = false;
+        ElementKind parentKind = (depth > 0) ? elements[depth - 1].kind : OTHER;
+
+        if (xml.isElement("package")) {
+            element.kind = PACKAGE_ELEMENT;
+            packageName = xml.getAttribute("name");
+            if (m_granularity == PACKAGE) {
+                ceidx = builder.addCodeElementName(packageName);
             }
-        } else {
-            std::cout << info_cnt++ << "/" << info_max << ' ' << info_tcnt++ << "/" << info_tmax << '\r';
-            std::cout.flush();
-
-            std::string tcname = it->generic_string().substr(cut);
-            cutExtension(tcname);
-            m_coverage->addTestcaseName(tcname);
-
-            std::ifstream in(it->string().c_str());
-            std::string line;
-
-            boost::regex packageStartExpr(".*<package .+>.*");
-            boost::regex packageEndExpr(".*</package>.*");
-            while (std::getline(in, line)) {
-                // Skip first few lines
-                if (!boost::regex_match(line, packageStartExpr)) {
-                    continue;
-                }
-                std::stringstream xmlString;
-                xmlString << line << std::endl;
-                while (std::getline(in, line)) {
-                    xmlString << line << std::endl;
-                    if (boost::regex_match(line, packageEndExpr)) {
-                        break;
-                    }
-                }
-
-                // Process XML
-                pt::ptree xml;
-                pt::read_xml(xmlString, xml);
-
-                String packageName = xml.get<String>("package.<xmlattr>.name");
-
-                std::stringstream codeElement;
-                codeElement << packageName;
-                bool covered = false;
-                BOOST_FOREACH(ptree::value_type &srcFile, xml.get_child("package")) {
-                    if (srcFile.first == "srcfile") {
-                        String srcFileName = srcFile.second.get<String>("<xmlattr>.name");
-                        if (m_granularity == SRC) {
-                            codeElement.str(String());
-                            codeElement.clear();
-                            codeElement << packageName << "." << srcFileName;
-                        }
-
-                        BOOST_FOREACH(ptree::value_type &classElement, srcFile.second.get_child("")) {
-                            if (classElement.first == "class") {
-                                String className = classElement.second.get<String>("<xmlattr>.name");
-                                if (m_granularity == CLASS) {
-                                    codeElement.str(String());
-                                    codeElement.clear();
-                                    codeElement << packageName << "." << className;
-                                }
-
-                                BOOST_FOREACH(ptree::value_type &method, classElement.second.get_child("")) {
-                                    if (method.first == "method") {
-                                        String methodName = method.second.get<String>("<xmlattr>.name");
-
-                                        if (m_granularity == METHOD) {
-                                            codeElement.str(String());
-                                            codeElement.clear();
-                                            codeElement << packageName << "." << className << "." << methodName;
-                                        }
-
-                                        BOOST_FOREACH(ptree::value_type &coverage, method.second.get_child("coverage")) {
-                                            if (coverage.second.get<String>("type") == "method, %") {
-                                                String value = coverage.second.get<String>("value");
-                                                if (value == "100% (1/1)") {
-                                                    m_coverage->setRelation(tcname, codeElement.str(), true);
-                                                    covered = true;
-                                                }
-                                                break;
-                                            }
-                                        }
-                                        if (m_granularity < METHOD && covered) {
-                                            break;
-                                        }
-                                    }
-                                }
-                                if (m_granularity < CLASS && covered) {
-                                    break;
-                                } else {
-                                    covered = false;
-                                }
-                            }
-                        }
-                        if (m_granularity < SRC && covered) {
-                            break;
-                        } else {
-                            covered = false;
-                        }
-                    }
-                }
+        } else if (parentKind == PACKAGE_ELEMENT && xml.isElement("srcfile")) {
+            element.kind = SRCFILE_ELEMENT;
+            if (m_granularity == SRC) {
+                ceidx = builder.addCodeElementName(packageName + "." + xml.getAttribute("name"));
+            }
+        } else if (parentKind == SRCFILE_ELEMENT && xml.isElement("class")) {
+            element.kind = CLASS_ELEMENT;
+            className = xml.getAttribute("name");
+            if (m_granularity == CLASS) {
+                ceidx = builder.addCodeElementName(packageName + "." + className);
+            }
+        } else if (parentKind == CLASS_ELEMENT && xml.isElement("method")) {
+            element.kind = METHOD_ELEMENT;
+            if (m_granularity == METHOD) {
+                ceidx = builder.addCodeElementName(packageName + "." + className + "." + xml.getAttribute("name"));
+            }
+        } else if (parentKind == METHOD_ELEMENT && xml.isElement("coverage") && !elements[depth - 1].counted) {
+            // Only the first coverage of the method is checked, it is the method coverage.
+            elements[depth - 1].counted = true;
+            if (xml.hasAttributeValue("type", "method, %") && xml.hasAttributeValue("value", "100% (1/1)")) {
+                builder.addOrSetRelation(tcidx, ceidx, true);
             }
-            in.close();
         }
     }
 }
 
-
 extern "C" MSDLL_EXPORT void registerPlugin(CKernel &kernel)
 {
     kernel.getCoverageReaderPluginManager().addPlugin(new EmmaJavaCoverageReaderPlugin());
@@ -29,6 +29,7 @@
 #include "boost/regex.hpp"
 #include "boost/filesystem.hpp"
 #include "engine/CKernel.h"
+#include "data/CCoverageMatrixBuilder.h"
 
 namespace fs = boost::filesystem;
 
@@ -63,25 +64,19 @@ private:
     void readFromDirectoryStructure(const std::string&);
 
     /**
-     * @brief Reads One Test per File format code element names and test case names
-     *        from the specified directory.
-     *        Recursively searches the files in the given path p
+     * @brief Collects the XML files from the specified directory recursively in sorted order.
      *        File name format: <Dirname>/<Basename>.<Extension>
      *        substring beginning at the cut position of <Dirname>/<Basename> is used as the test case name
-     *        File format is: <CodeElementName>,<SourceFilePath>
-     *        <CodeElementName> is used as the codeElement name
      */
-    void readFromDirectory1stPass(fs::path, size_t);
+    void collectFiles(const fs::path &p, size_t cut, std::vector<fs::path> &files, StringVector &testcaseNames);
 
     /**
-     * @brief Reads One Test per File format coverage data from the specified directory.
-     *        Recursively searches the files in the given path p
-     *        File name format: <Dirname>/<Basename>.<Extension>
-     *        substring beginning at the cut position of <Dirname>/<Basename> is used as the test case name
-     *        File format is: <CodeElementName>,<SourceFilePath>
-     *        <CodeElementName> is used as the codeElement name
+     * @brief Reads an EMMA XML report with a streaming parser.
+     * @param p  Path of the report.
+     * @param testcaseName  The name of the test case.
+     * @param builder  Collects the code element names and relations of the report.
      */
-    void readFromDirectory(fs::path, size_t);
+    void readFile(const fs::path &p, const String &testcaseName, CCoverageMatrixBuilder &builder);
 
     /**
      * @brief Stores coverage data.
@@ -90,6 +85,11 @@ private:
 
     enum Granularity {PACKAGE = 1, SRC, CLASS, METHOD};
     Granularity m_granularity;
+
+    /**
+     * @brief Number of threads reading the files, 0 means the number of hardware threads.
+     */
+    unsigned int m_numOfThreads;
 };
 
 }
@@ -20,21 +20,124 @@
  */
 
 #include <iostream>
-#include <fstream>
+#include <sstream>
+#include <cstring>
 #include <ctype.h>
 
 #include "boost/tokenizer.hpp"
-#include "boost/lexical_cast.hpp"
-#include "boost/algorithm/string.hpp"
+#include "boost/interprocess/file_mapping.hpp"
+#include "boost/interprocess/mapped_region.hpp"
 #include "exception/CException.h"
+#include "util/CThreadPool.h"
 #include "GcovCoverageReaderPlugin.h"
 
 
 namespace soda {
 
+namespace {
+
+/**
+ * @brief A colon separated field of a gcov line without the surrounding
+ *        white spaces. Points into the mapped file.
+ */
+struct Field {
+    const char *begin;
+    const char *end;
+
+    bool equals(char c) const
+    {
+        return end - begin == 1 && *begin == c;
+    }
+
+    bool startsWith(const char *prefix) const
+    {
+        size_t length = strlen(prefix);
+        return (size_t)(end - begin) >= length && memcmp(begin, prefix, length) == 0;
+    }
+
+    bool endsWith(const char *suffix) const
+    {
+        size_t length = strlen(suffix);
+        return (size_t)(end - begin) >= length && memcmp(end - length, suffix, length) == 0;
+    }
+
+    bool toInt(int &value) const
+    {
+        const char *p = begin;
+        bool negative = false;
+        if (p != end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        if (p == end) {
+            return false;
+        }
+        long long result = 0;
+        for (; p != end; ++p) {
+            if (*p < '0' || *p > '9' || result > 0x7fffffff) {
+                return false;
+            }
+            result = result * 10 + (*p - '0');
+        }
+        value = (int)(negative ? -result : result);
+        return true;
+    }
+};
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief The fields of a gcov line: execution count, line number and the
+ *        source code. Empty fields are skipped like boost::char_separator does.
+ */
+struct Line {
+    static const int MAX_FIELDS = 4;
+
+    /* The first four fields. */
+    Field fields[MAX_FIELDS];
+    /* The last field. */
+    Field last;
+    size_t numOfFields;
+
+    /**
+     * @brief Splits the line between begin and end.
+     */
+    void split(const char *begin, const char *end)
+    {
+        numOfFields = 0;
+        const char *p = begin;
+        while (p < end) {
+            const char *separator = static_cast<const char*>(memchr(p, ':', end - p));
+            if (separator == NULL) {
+                separator = end;
+            }
+            if (separator != p) {
+                Field field = { p, separator };
+                while (field.begin < field.end && isSpace(*field.begin)) {
+                    ++field.begin;
+                }
+                while (field.end > field.begin && isSpace(*(field.end - 1))) {
+                    --field.end;
+                }
+                if (numOfFields < MAX_FIELDS) {
+                    fields[numOfFields] = field;
+                }
+                last = field;
+                ++numOfFields;
+            }
+            p = separator + 1;
+        }
+    }
+};
+
+} // namespace
+
 GcovCoverageReaderPlugin::GcovCoverageReaderPlugin() :
     m_coverage(NULL),
-    m_codeElementNameReading(true)
+    m_numOfThreads(1)
 {}
 
 GcovCoverageReaderPlugin::~GcovCoverageReaderPlugin()
@@ -62,9 +165,16 @@ CCoverageMatrix* GcovCoverageReaderPlugin::read(const variables_map &vm)
     for (it = tokens.begin(); it != tokens.end(); ++it) {
         m_fileFilter.push_back(boost::regex(*it));
     }
+    m_numOfThreads = vm.count("jobs") ? vm["jobs"].as<unsigned int>() : 1;
 
     m_coverage = new CCoverageMatrix();
-    readFromDirectoryStructure(vm["path"].as<String>());
+    try {
+        readFromDirectoryStructure(vm["path"].as<String>());
+    } catch (...) {
+        delete m_coverage;
+        m_coverage = NULL;
+        throw;
+    }
     return m_coverage;
 }
 
@@ -80,131 +190,158 @@ void GcovCoverageReaderPlugin::readFromDirectoryStructure(const char * dirname)
         throw CException("GcovCoverageReaderPlugin::readFromDirectoryStructure()", "Specified path does not exists or is not a directory.");
     }
 
-    readTestcaseNames(coverage_path);
     std::vector<fs::path> pathVector;
     std::copy(fs::directory_iterator(coverage_path), fs::directory_iterator(), back_inserter(pathVector));
     std::sort(pathVector.begin(), pathVector.end());
-    m_codeElementNameReading = true;
+    std::vector<fs::path> testcasePaths;
     for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); ++it) {
         if (is_directory((*it))) {
-            m_currentTestcase = (*it).leaf().string();
-            std::cout << "[INFO] Reading coverage data from directory (1st pass): " << *it << std::endl;
-            readCoverage((*it));
+            testcasePaths.push_back(*it);
+        }
+    }
+
+    // Every test case is read into its own table by the threads.
+    std::vector<TestcaseCoverage> testcases(testcasePaths.size());
+    CThreadPool pool(m_numOfThreads);
+    pool.run(testcasePaths.size(), [this, &testcasePaths, &testcases](IndexType i) {
+        testcases[i].name = testcasePaths[i].leaf().string();
+        readCoverage(testcasePaths[i], testcases[i]);
+    });
+
+    // Merge the tables in the order of the test cases, so the code elements
+    // get the same identifiers and the progress is printed in the same order as in a sequential read.
+    std::unordered_map<String, IndexType> sourcePathIds;
+    std::unordered_map<u_int64_t, IndexType> codeElementIds;
+    std::vector<std::vector<IndexType> > globalIds(testcases.size());
+    for (IndexType t = 0; t < testcases.size(); ++t) {
+        TestcaseCoverage &testcase = testcases[t];
+        std::cout << "[INFO] Reading coverage data from directory: " << testcasePaths[t] << std::endl;
+        m_coverage->addTestcaseName(testcase.name);
+
+        std::vector<IndexType> pathIds(testcase.sourcePaths.size());
+        for (IndexType i = 0; i < testcase.sourcePaths.size(); ++i) {
+            pathIds[i] = sourcePathIds.insert(std::make_pair(testcase.sourcePaths[i], sourcePathIds.size())).first->second;
+        }
+
+        globalIds[t].resize(testcase.codeElements.size());
+        for (IndexType i = 0; i < testcase.codeElements.size(); ++i) {
+            u_int64_t local = testcase.codeElements[i];
+            u_int64_t key = (u_int64_t(pathIds[local >> 32]) << 32) | (local & 0xffffffff);
+            std::unordered_map<u_int64_t, IndexType>::iterator it = codeElementIds.find(key);
+            if (it == codeElementIds.end()) {
+                std::ostringstream codeElementName;
+                codeElementName << testcase.sourcePaths[local >> 32] << ":" << (int)(local & 0xffffffff);
+                m_coverage->addCodeElementName(codeElementName.str());
+                it = codeElementIds.insert(std::make_pair(key, m_coverage->getCodeElements().getID(codeElementName.str()))).first;
+            }
+            globalIds[t][i] = it->second;
         }
     }
     m_coverage->refitMatrixSize();
-    m_codeElementNameReading = false;
-    for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); ++it) {
-        if (is_directory((*it))) {
-            m_currentTestcase = (*it).leaf().string();
-            std::cout << "[INFO] Reading coverage data from directory: " << *it << std::endl;
-            readCoverage((*it));
+    for (IndexType t = 0; t < testcases.size(); ++t) {
+        IndexType tcidx = m_coverage->getTestcases().getID(testcases[t].name);
+        for (IndexType i = 0; i < globalIds[t].size(); ++i) {
+            if (testcases[t].covered[i]) {
+                m_coverage->setRelation(tcidx, globalIds[t][i], true);
+            }
         }
     }
 }
 
-void GcovCoverageReaderPlugin::readTestcaseNames(fs::path p)
+void GcovCoverageReaderPlugin::readCoverage(const fs::path &p, TestcaseCoverage &testcase)
 {
     std::vector<fs::path> pathVector;
     std::copy(fs::directory_iterator(p), fs::directory_iterator(), back_inserter(pathVector));
     std::sort(pathVector.begin(), pathVector.end());
+
     for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); ++it) {
         if (is_directory((*it))) {
-            m_coverage->addTestcaseName((*it).leaf().string());
+            readCoverage((*it), testcase);
+        } else if (is_regular_file((*it)) && (*it).extension() == ".gcov") {
+            readCoverageDataFromFile((*it), testcase);
         }
     }
 }
 
-void GcovCoverageReaderPlugin::readCoverage(fs::path p)
+void GcovCoverageReaderPlugin::readCoverageDataFromFile(const fs::path &p, TestcaseCoverage &testcase)
 {
-    int info_cnt = 0; //INFO
-    int info_max;
-
-    std::vector<fs::path> pathVector;
-    std::copy(fs::directory_iterator(p), fs::directory_iterator(), back_inserter(pathVector));
-    std::sort(pathVector.begin(), pathVector.end());
-    info_max = pathVector.size();
-
-    for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); ++it) {
-        if (is_directory((*it)))
-            readCoverage((*it));
-        else if (is_regular_file((*it)) && (*it).extension() == ".gcov")
-            std::cout << info_cnt++ << "/" << info_max << '\r';
-            std::cout.flush();
-
-            readCoverageDataFromFile((*it));
+    if (fs::file_size(p) == 0) {
+        return;
     }
-}
+    boost::interprocess::file_mapping file(p.string().c_str(), boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(file, boost::interprocess::read_only);
+    const char *data = static_cast<const char*>(region.get_address());
+    const char *end = data + region.get_size();
 
-void GcovCoverageReaderPlugin::readCoverageDataFromFile(fs::path p)
-{
-    std::ifstream in(p.string().c_str());
-    std::string line;
-    std::string sourcePath;
+    IndexType sourcePathId = 0;
     bool firstLine = true;
     bool skip = false;
-    boost::char_separator<char> sep(":");
-
-    while (std::getline(in, line)) {
-        StringVector rowData;
-        boost::tokenizer<boost::char_separator<char> > tokens(line, sep);
-        boost::tokenizer<boost::char_separator<char> >::iterator it;
-        for (it = tokens.begin(); it != tokens.end(); ++it) {
-            std::string tmp = *it;
-            boost::algorithm::trim(tmp);
-            rowData.push_back(tmp);
+    Line line;
+
+    for (const char *begin = data; begin < end; ) {
+        const char *lineEnd = static_cast<const char*>(memchr(begin, '\n', end - begin));
+        if (lineEnd == NULL) {
+            lineEnd = end;
         }
+        line.split(begin, lineEnd);
+        begin = lineEnd + 1;
 
         // read source path from first line
         if (firstLine) {
+            if (line.numOfFields < 4) {
+                return;
+            }
+            String path(line.fields[3].begin, line.fields[3].end);
             for (std::vector<boost::regex>::iterator it = m_fileFilter.begin(); it != m_fileFilter.end(); ++it) {
-                if (boost::regex_search(rowData[3], *it)) {
-                    in.close();
+                if (boost::regex_search(path, *it)) {
                     return;
                 }
             }
-            sourcePath = boost::regex_replace(rowData[3], m_codeElementNameFilter, "");
+            String sourcePath = boost::regex_replace(path, m_codeElementNameFilter, "");
+            std::unordered_map<String, IndexType>::iterator it = testcase.sourcePathIds.find(sourcePath);
+            if (it == testcase.sourcePathIds.end()) {
+                it = testcase.sourcePathIds.insert(std::make_pair(sourcePath, testcase.sourcePaths.size())).first;
+                testcase.sourcePaths.push_back(sourcePath);
+            }
+            sourcePathId = it->second;
             firstLine = false;
         }
 
-        int lineNumber = boost::lexical_cast<int>(rowData[1]); // executed line number
+        int lineNumber = 0; // executed line number
+        if (line.numOfFields < 2 || !line.fields[1].toInt(lineNumber)) {
+            continue;
+        }
 
         // skip gcov file messages
         if (lineNumber == 0)
             continue;
         // skip empty lines
-        if (rowData.size() < 3)
+        if (line.numOfFields < 3)
             continue;
 
-        StringVector codeTokens;
-        for (StringVector::iterator it = rowData.begin() + 2; it != rowData.end(); ++it) {
-            codeTokens.push_back(*it);
-        }
-        String code = boost::algorithm::join(codeTokens, ":");
-        boost::algorithm::trim(code);
-        boost::regex reg("((^(\\{)$)|(^(\\})$)|(^//)|(^#))"); // regex for {, }, # and // chars
-        boost::regex openComment("^(\\/\\*)"); // regex for /*
-        boost::regex closeComment("(\\*\\/)$"); // regex for */
-        if (boost::regex_search(code, reg)) // skips lines starting with //, #, {, }
+        // The code is the fields from the third one joined by colons.
+        const Field &first = line.fields[2];
+        if ((line.numOfFields == 3 && (first.equals('{') || first.equals('}'))) ||
+                first.startsWith("//") || first.startsWith("#")) // skips lines starting with //, #, {, }
             continue;
-        if (!skip && boost::regex_search(code, openComment)) // skips multi line comments
+        if (!skip && first.startsWith("/*")) // skips multi line comments
             skip = true;
         if (skip) {
-            if (boost::regex_search(code, closeComment))
+            if (line.last.endsWith("*/"))
                 skip = false;
             continue;
         }
 
-        std::stringstream codeElementName;
-        codeElementName << sourcePath << ":" << lineNumber;
-
-        if (m_codeElementNameReading) {
-            m_coverage->addCodeElementName(codeElementName.str());
-        } else {
-            m_coverage->setRelation(m_currentTestcase, codeElementName.str(), isdigit(rowData[0][0]) != 0);
+        u_int64_t key = (u_int64_t(sourcePathId) << 32) | (unsigned int)lineNumber;
+        std::unordered_map<u_int64_t, IndexType>::iterator it = testcase.codeElementIds.find(key);
+        if (it == testcase.codeElementIds.end()) {
+            it = testcase.codeElementIds.insert(std::make_pair(key, testcase.codeElements.size())).first;
+            testcase.codeElements.push_back(key);
+            testcase.covered.push_back(false);
         }
+        const Field &count = line.fields[0];
+        testcase.covered[it->second] = count.begin != count.end && isdigit(*count.begin);
     }
-    in.close();
 }
 
 extern "C" MSDLL_EXPORT void registerPlugin(CKernel &kernel)
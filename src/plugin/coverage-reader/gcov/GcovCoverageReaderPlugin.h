@@ -26,6 +26,8 @@
 #define BOOST_FILESYSTEM_VERSION 3
 #endif
 
+#include <unordered_map>
+
 #include "boost/regex.hpp"
 #include "boost/filesystem.hpp"
 #include "engine/CKernel.h"
@@ -51,12 +53,26 @@ public:
     CCoverageMatrix* read(const variables_map &vm);
 
 private:
+    /**
+     * @brief The code elements of a test case in the order of their first
+     *        occurrence. The code elements are identified by the index of the
+     *        source path in the upper 32 bits and the line number in the lower 32 bits.
+     */
+    struct TestcaseCoverage {
+        String name;
+        StringVector sourcePaths;
+        std::unordered_map<String, IndexType> sourcePathIds;
+        std::vector<u_int64_t> codeElements;
+        std::vector<bool> covered;
+        std::unordered_map<u_int64_t, IndexType> codeElementIds;
+    };
+
     /**
      * @brief Reads gcov coverage data from the specified path.
      *        First subdirectories of the specified path contains the test cases.
      *        Recursively searches the files and the directories in the given path.
      *        Gcov files should be separated by test cases and the directory names
-     *        are used as test case names.
+     *        are used as test case names. The test cases are read in parallel.
      * @throw Exception at invalid directory path.
      */
     void readFromDirectoryStructure(const char *);
@@ -67,32 +83,22 @@ private:
     void readFromDirectoryStructure(const std::string&);
 
     /**
-     * @brief Reads test case names from the directories. Directory name is a test case name.
-     */
-    void readTestcaseNames(fs::path);
-
-    /**
-     * @brief Reads coverage data from directories.
+     * @brief Reads coverage data from a directory of a test case recursively.
      */
-    void readCoverage(fs::path);
+    void readCoverage(const fs::path &, TestcaseCoverage &);
 
     /**
      * @brief Reads gcov coverage data from gcov files.
      *        Code element names are created from the file path and the line number of the source file which
      *        were executed in the current test case.
      */
-    void readCoverageDataFromFile(fs::path);
+    void readCoverageDataFromFile(const fs::path &, TestcaseCoverage &);
 
     /**
      * @brief Stores coverage data.
      */
     CCoverageMatrix *m_coverage;
 
-    /**
-     * @brief Current test case name.
-     */
-    String m_currentTestcase;
-
     /**
      * @brief Regular expression for cut parts from the code element names.
      */
@@ -104,9 +110,9 @@ private:
     std::vector<boost::regex> m_fileFilter;
 
     /**
-     * @brief Indicates whether the reader should add code element names or set relations.
+     * @brief Number of threads reading the test cases, 0 means the number of hardware threads.
      */
-    bool m_codeElementNameReading;
+    unsigned int m_numOfThreads;
 };
 
 }
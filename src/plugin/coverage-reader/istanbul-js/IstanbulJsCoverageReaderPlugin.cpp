@@ -38,7 +38,8 @@ namespace pt = boost::property_tree;
 namespace soda {
 
 IstanbulJsCoverageReaderPlugin::IstanbulJsCoverageReaderPlugin() :
-    m_coverage(NULL)
+    m_coverage(NULL),
+    m_builder(NULL)
 {}
 
 IstanbulJsCoverageReaderPlugin::~IstanbulJsCoverageReaderPlugin()
@@ -71,7 +72,11 @@ CCoverageMatrix* IstanbulJsCoverageReaderPlugin::read(const variables_map &vm)
 
     std::cerr << "Granularity: " << m_granularity << std::endl << std::endl;
     m_coverage = new CCoverageMatrix();
+    m_builder = new CCoverageMatrixBuilder();
     readFromDirectoryStructure(vm["path"].as<String>());
+    m_builder->build(*m_coverage);
+    delete m_builder;
+    m_builder = NULL;
     return m_coverage;
 }
 
@@ -99,7 +104,7 @@ void IstanbulJsCoverageReaderPlugin::readFromDirectoryStructure(const std::strin
     readFromDirectoryStructure(dirname.c_str());
 }
 
-static void readFunctionCoverage(std::string &tcname, rapidjson::Document &json, CCoverageMatrix *cmx, boost::regex& path_filter) {
+static void readFunctionCoverage(std::string &tcname, rapidjson::Document &json, CCoverageMatrixBuilder *cmx, boost::regex& path_filter) {
     for (rapidjson::Value::ConstMemberIterator itr = json.MemberBegin(); itr != json.MemberEnd(); ++itr) {
         String srcname = itr->name.GetString();
         srcname = boost::regex_replace(srcname, path_filter, "");
@@ -162,7 +167,7 @@ void IstanbulJsCoverageReaderPlugin::readFromDirectory(fs::path p, size_t cut)
             String tcname = basename(*it);
             boost::algorithm::trim(tcname);
             switch (m_granularity) {
-                case METHOD: readFunctionCoverage(tcname, json, m_coverage, m_codeElementNameFilter); break;
+                case METHOD: readFunctionCoverage(tcname, json, m_builder, m_codeElementNameFilter); break;
                 default: break;
             }
         }
@@ -29,6 +29,7 @@
 #include "boost/regex.hpp"
 #include "boost/filesystem.hpp"
 #include "engine/CKernel.h"
+#include "data/CCoverageMatrixBuilder.h"
 
 namespace fs = boost::filesystem;
 
@@ -81,6 +82,11 @@ private:
      */
     CCoverageMatrix *m_coverage;
 
+    /**
+     * @brief Collects the relations while the files are read.
+     */
+    CCoverageMatrixBuilder *m_builder;
+
     enum Granularity {METHOD, BRANCH, STATEMENT};
     Granularity m_granularity;
 };
@@ -20,23 +20,37 @@
  */
 
 #include <iostream>
-#include <fstream>
-#include <ctype.h>
 
 #include "boost/algorithm/string.hpp"
-#include "boost/property_tree/ptree.hpp"
-#include "boost/property_tree/xml_parser.hpp"
-#include "boost/foreach.hpp"
-#include "boost/regex.hpp"
 #include "exception/CException.h"
+#include "io/CXmlReader.h"
+#include "util/CThreadPool.h"
 #include "JacocoJavaCoverageReaderPlugin.h"
 
-namespace pt = boost::property_tree;
-
 namespace soda {
 
+namespace {
+
+/**
+ * @brief The elements of the Jacoco report which contain counters.
+ */
+enum ElementKind { OTHER, REPORT, PACKAGE_ELEMENT, CLASS_ELEMENT, METHOD_ELEMENT, SOURCEFILE_ELEMENT };
+
+/**
+ * @brief An open element of the report.
+ */
+struct OpenElement {
+    ElementKind kind;
+    // True if the METHOD counter of the element has already been read.
+    bool counted;
+};
+
+} // namespace
+
 JacocoJavaCoverageReaderPlugin::JacocoJavaCoverageReaderPlugin() :
-    m_coverage(NULL)
+    m_coverage(NULL),
+    m_builder(NULL),
+    m_numOfThreads(1)
 {}
 
 JacocoJavaCoverageReaderPlugin::~JacocoJavaCoverageReaderPlugin()
@@ -66,18 +80,24 @@ CCoverageMatrix* JacocoJavaCoverageReaderPlugin::read(const variables_map &vm)
         m_granularity = METHOD;
     }
 
+    m_numOfThreads = vm.count("jobs") ? vm["jobs"].as<unsigned int>() : 1;
+
     std::cerr << "Granularity: " << m_granularity << std::endl << std::endl;
     m_coverage = new CCoverageMatrix();
-    readFromDirectoryStructure(vm["path"].as<String>());
-    return m_coverage;
-}
-
-static void cutExtension(std::string& str)
-{
-    size_t b = str.find_last_of('.');
-    if (b != std::string::npos) {
-        str.erase(b);
+    m_builder = new CCoverageMatrixBuilder();
+    try {
+        readFromDirectoryStructure(vm["path"].as<String>());
+        m_builder->build(*m_coverage);
+    } catch (...) {
+        delete m_builder;
+        m_builder = NULL;
+        delete m_coverage;
+        m_coverage = NULL;
+        throw;
     }
+    delete m_builder;
+    m_builder = NULL;
+    return m_coverage;
 }
 
 void JacocoJavaCoverageReaderPlugin::readFromDirectoryStructure(const char * dirname)
@@ -87,10 +107,34 @@ void JacocoJavaCoverageReaderPlugin::readFromDirectoryStructure(const char * dir
         throw CException("JacocoJavaCoverageReaderPlugin::readFromDirectoryStructure()", "Specified path does not exists or is not a directory.");
     }
 
-    size_t cutsize = coverage_path.generic_string().length() + ((*(coverage_path.generic_string().rbegin()) == '/') ? 0 : 1);
-    //readFromDirectory1stPass(coverage_path, cutsize);
-    //m_coverage->refitMatrixSize();
-    readFromDirectory(coverage_path, cutsize);
+    std::vector<fs::path> files;
+    collectFiles(coverage_path, files);
+
+    // Each thread reads a contiguous range of the files into its own builder, so merging
+    // the builders in order gives the same identifiers as reading the files one by one.
+    CThreadPool pool(m_numOfThreads);
+    IndexType numOfChunks = std::min<IndexType>(pool.getNumOfThreads(), files.size());
+    std::vector<CCoverageMatrixBuilder*> builders;
+    for (IndexType i = 0; i < numOfChunks; ++i) {
+        builders.push_back(new CCoverageMatrixBuilder());
+    }
+    try {
+        pool.run(numOfChunks, [this, &files, &builders, numOfChunks](IndexType chunk) {
+            IndexType end = (chunk + 1) * files.size() / numOfChunks;
+            for (IndexType i = chunk * files.size() / numOfChunks; i < end; ++i) {
+                readFile(files[i], *builders[chunk]);
+            }
+        });
+        m_builder->merge(builders, m_numOfThreads);
+    } catch (...) {
+        for (IndexType i = 0; i < builders.size(); ++i) {
+            delete builders[i];
+        }
+        throw;
+    }
+    for (IndexType i = 0; i < builders.size(); ++i) {
+        delete builders[i];
+    }
 }
 
 void JacocoJavaCoverageReaderPlugin::readFromDirectoryStructure(const std::string& dirname)
@@ -98,175 +142,112 @@ void JacocoJavaCoverageReaderPlugin::readFromDirectoryStructure(const std::strin
     readFromDirectoryStructure(dirname.c_str());
 }
 
-void JacocoJavaCoverageReaderPlugin::readFromDirectory1stPass(fs::path p, size_t cut)
+void JacocoJavaCoverageReaderPlugin::collectFiles(const fs::path &p, std::vector<fs::path> &files)
 {
-    static int info_tcnt = 0; //INFO
-    static int info_tmax = 0;
-    int info_cnt = 0; //INFO
-    int info_max;
-
-    std::cout << "Directory: " << p << " 1st pass" << std::endl;
-    std::cout.flush();
+    std::cout << "Directory: " << p << std::endl;
 
     std::vector<fs::path> pathVector;
     std::copy(fs::directory_iterator(p), fs::directory_iterator(), back_inserter(pathVector));
     std::sort(pathVector.begin(), pathVector.end());
-    info_tmax += info_max = pathVector.size();
 
     for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); it++) {
         if (is_directory(*it)) { // recurse into subdirs
             if (basename(*it) != "") {
-                readFromDirectory1stPass(*it, cut);
-            } else {
-                info_tmax--;
-                info_max--;
+                collectFiles(*it, files);
             }
         } else {
-            std::cout << info_cnt++ << "/" << info_max << ' ' << info_tcnt++ << "/" << info_tmax << '\r';
-            std::cout.flush();
-
-            std::ifstream in(it->string().c_str());
-
-            // Process XML
-            pt::ptree xml;
-            pt::read_xml(in, xml);
-
-            String tcname = xml.get<String>("<xmlcomment>");
-            boost::algorithm::trim(tcname);
-            m_coverage->addTestcaseName(tcname);
-
-            BOOST_FOREACH(ptree::value_type &packageNode, xml.get_child("report")) {
-                if (packageNode.first == "package") {
-                    String packageName = packageNode.second.get<String>("<xmlattr>.name");
-
-                    if (m_granularity == PACKAGE) {
-                        m_coverage->addCodeElementName(packageName);
-                        continue;
-                    }
-                    BOOST_FOREACH(ptree::value_type &node, packageNode.second.get_child("")) {
-                        if ((m_granularity == CLASS || m_granularity == METHOD) && node.first == "class") {
-                            String className = node.second.get<String>("<xmlattr>.name");
-
-                            if (m_granularity == CLASS) {
-                                m_coverage->addCodeElementName(className);
-                                continue;
-                            }
-                            BOOST_FOREACH(ptree::value_type &methodNode, node.second.get_child("")) {
-                                if (methodNode.first == "method") {
-                                    std::stringstream codeElement;
-                                    codeElement << className << "/" << methodNode.second.get<String>("<xmlattr>.name") << methodNode.second.get<String>("<xmlattr>.desc");
-                                    String methodName = boost::replace_all_copy(codeElement.str(), ";", ",");
-                                    m_coverage->addCodeElementName(methodName);
-                                    continue;
-                                }
-                            }
-
-                        } else if (m_granularity == SRC && node.first == "sourcefile") {
-                            String srcName = node.second.get<String>("<xmlattr>.name");
-                            std::stringstream codeElement;
-                            codeElement << packageName << "/" << srcName;
-                            m_coverage->addCodeElementName(codeElement.str());
-                            continue;
-                        }
-
-                    }
-                }
-            }
-            in.close();
+            files.push_back(*it);
         }
     }
 }
 
-void JacocoJavaCoverageReaderPlugin::readFromDirectory(fs::path p, size_t cut)
+void JacocoJavaCoverageReaderPlugin::readFile(const fs::path &p, CCoverageMatrixBuilder &builder)
 {
-    static int info_tcnt = 0; //INFO
-    static int info_tmax = 0;
-    int info_cnt = 0; //INFO
-    int info_max;
-
-    std::cout << "Directory: " << p << std::endl;
-    std::cout.flush();
-
-    std::vector<fs::path> pathVector;
-    std::copy(fs::directory_iterator(p), fs::directory_iterator(), back_inserter(pathVector));
-    std::sort(pathVector.begin(), pathVector.end());
-    info_tmax += info_max = pathVector.size();
-
-    for (std::vector<fs::path>::iterator it = pathVector.begin(); it != pathVector.end(); it++) {
-        if (is_directory(*it)) { // recurse into subdirs
-            if (basename(*it) != "") {
-                readFromDirectory(*it, cut);
-            } else {
-                info_tmax--;
-                info_max--;
+    io::CXmlReader xml(p.string());
+
+    String tcname;
+    bool hasTestcaseName = false;
+    bool hasReport = false;
+    String packageName;
+    String className;
+    String methodName;
+    String value;
+    std::vector<OpenElement> elements;
+    // The test case name is at the end of the report, so the relations are stored until it is read.
+    std::vector<std::pair<IndexType, bool> > relations;
+
+    while (xml.next()) {
+        if (xml.getNodeType() == io::CXmlReader::ntComment) {
+            if (xml.getDepth() == 0 && !hasTestcaseName) {
+                tcname = boost::algorithm::trim_copy(xml.getComment());
+                hasTestcaseName = true;
             }
-        } else {
-            std::cout << info_cnt++ << "/" << info_max << ' ' << info_tcnt++ << "/" << info_tmax << '\r';
-            std::cout.flush();
-
-            std::ifstream in(it->string().c_str());
-
-            // Process XML
-            pt::ptree xml;
-            pt::read_xml(in, xml);
-
-            String tcname = xml.get<String>("<xmlcomment>");
-            boost::algorithm::trim(tcname);
-
-            BOOST_FOREACH(ptree::value_type &packageNode, xml.get_child("report")) {
-                if (packageNode.first == "package") {
-                    String packageName = packageNode.second.get<String>("<xmlattr>.name");
-
-                    BOOST_FOREACH(ptree::value_type &node, packageNode.second.get_child("")) {
-                        if (m_granularity == PACKAGE && node.first == "counter" && node.second.get<String>("<xmlattr>.type") == "METHOD") {
-                            m_coverage->addOrSetRelation(tcname, packageName, (node.second.get<String>("<xmlattr>.covered") != "0"));
-                            break;
-                        }
-
-                        if ((m_granularity == CLASS || m_granularity == METHOD) && node.first == "class") {
-                            String className = node.second.get<String>("<xmlattr>.name");
-
-                            BOOST_FOREACH(ptree::value_type &methodNode, node.second.get_child("")) {
-                                if (m_granularity == CLASS && methodNode.first == "counter" && methodNode.second.get<String>("<xmlattr>.type") == "METHOD") {
-                                    m_coverage->addOrSetRelation(tcname, className, (methodNode.second.get<String>("<xmlattr>.covered") != "0"));
-                                    break;
-                                }
-
-                                if (m_granularity == METHOD && methodNode.first == "method") {
-                                    std::stringstream codeElement;
-                                    codeElement << className << "/" << methodNode.second.get<String>("<xmlattr>.name") << methodNode.second.get<String>("<xmlattr>.desc");
-                                    String methodName = boost::replace_all_copy(codeElement.str(), ";", ",");
-
-                                    BOOST_FOREACH(ptree::value_type &counterNode, methodNode.second.get_child("")) {
-                                        if (counterNode.first == "counter" && counterNode.second.get<String>("<xmlattr>.type") == "METHOD") {
-                                            m_coverage->addOrSetRelation(tcname, methodName, (counterNode.second.get<String>("<xmlattr>.covered") != "0"));
-                                            break;
-                                        }
-                                    }
-                                }
-                            }
-
-                        } else if (m_granularity == SRC && node.first == "sourcefile") {
-                            String srcName = node.second.get<String>("<xmlattr>.name");
-                            std::stringstream codeElement;
-                            codeElement << packageName << "/" << srcName;
+            continue;
+        }
+        if (xml.getNodeType() != io::CXmlReader::ntStartElement) {
+            continue;
+        }
 
-                            BOOST_FOREACH(ptree::value_type &counterNode, node.second.get_child("")) {
-                                if (counterNode.first == "counter" && counterNode.second.get<String>("<xmlattr>.type") == "METHOD") {
-                                    m_coverage->addOrSetRelation(tcname, codeElement.str(), (counterNode.second.get<String>("<xmlattr>.covered") != "0"));
-                                    break;
-                                }
-                            }
-                        }
+        IndexType depth = xml.getDepth();
+        elements.resize(depth + 1);
+        OpenElement &element = elements[depth];
+        element.kind = OTHER;
+        element.counted = false;
+        if (depth == 0) {
+            if (xml.isElement("report")) {
+                element.kind = REPORT;
+                hasReport = true;
+            }
+            continue;
+        }
 
-                    }
-                }
+        OpenElement &parent = elements[depth - 1];
+        if (parent.kind == REPORT && xml.isElement("package")) {
+            element.kind = PACKAGE_ELEMENT;
+            packageName = xml.getAttribute("name");
+        } else if (parent.kind == PACKAGE_ELEMENT && xml.isElement("class")) {
+            element.kind = CLASS_ELEMENT;
+            className = xml.getAttribute("name");
+        } else if (parent.kind == PACKAGE_ELEMENT && xml.isElement("sourcefile")) {
+            element.kind = SOURCEFILE_ELEMENT;
+            className = packageName + "/" + xml.getAttribute("name");
+        } else if (parent.kind == CLASS_ELEMENT && xml.isElement("method")) {
+            element.kind = METHOD_ELEMENT;
+            methodName = className + "/" + xml.getAttribute("name") + xml.getAttribute("desc");
+            boost::replace_all(methodName, ";", ",");
+        } else if (xml.isElement("counter") && !parent.counted && xml.hasAttributeValue("type", "METHOD")) {
+            const String *codeElement = NULL;
+            if (m_granularity == PACKAGE && parent.kind == PACKAGE_ELEMENT) {
+                codeElement = &packageName;
+            } else if (m_granularity == CLASS && parent.kind == CLASS_ELEMENT) {
+                codeElement = &className;
+            } else if (m_granularity == METHOD && parent.kind == METHOD_ELEMENT) {
+                codeElement = &methodName;
+            } else if (m_granularity == SRC && parent.kind == SOURCEFILE_ELEMENT) {
+                codeElement = &className;
+            }
+            if (codeElement != NULL) {
+                value = xml.getAttribute("covered");
+                relations.push_back(std::make_pair(builder.addCodeElementName(*codeElement), value != "0"));
+                parent.counted = true;
             }
-            in.close();
         }
     }
-}
 
+    if (!hasReport) {
+        throw CException("JacocoJavaCoverageReaderPlugin::readFile()", "Missing report element in " + p.string());
+    }
+    if (!hasTestcaseName) {
+        throw CException("JacocoJavaCoverageReaderPlugin::readFile()", "Missing test case name in " + p.string());
+    }
+    if (relations.empty()) {
+        return;
+    }
+    IndexType tcidx = builder.addTestcaseName(tcname);
+    for (std::vector<std::pair<IndexType, bool> >::iterator it = relations.begin(); it != relations.end(); ++it) {
+        builder.addOrSetRelation(tcidx, it->first, it->second);
+    }
+}
 
 extern "C" MSDLL_EXPORT void registerPlugin(CKernel &kernel)
 {
@@ -29,6 +29,7 @@
 #include "boost/regex.hpp"
 #include "boost/filesystem.hpp"
 #include "engine/CKernel.h"
+#include "data/CCoverageMatrixBuilder.h"
 
 namespace fs = boost::filesystem;
 
@@ -63,33 +64,36 @@ private:
     void readFromDirectoryStructure(const std::string&);
 
     /**
-     * @brief Reads One Test per File format code element names and test case names
-     *        from the specified directory.
-     *        Recursively searches the files in the given path p
-     *        File name format: <Dirname>/<Basename>.<Extension>
-     *        substring beginning at the cut position of <Dirname>/<Basename> is used as the test case name
-     *        File format is: <CodeElementName>,<SourceFilePath>
-     *        <CodeElementName> is used as the codeElement name
+     * @brief Collects the XML files from the specified directory recursively in sorted order.
      */
-    void readFromDirectory1stPass(fs::path, size_t);
+    void collectFiles(const fs::path &p, std::vector<fs::path> &files);
 
     /**
-     * @brief Reads One Test per File format coverage data from the specified directory.
-     *        Recursively searches the files in the given path p
-     *        File name format: <Dirname>/<Basename>.<Extension>
-     *        substring beginning at the cut position of <Dirname>/<Basename> is used as the test case name
-     *        File format is: <CodeElementName>,<SourceFilePath>
-     *        <CodeElementName> is used as the codeElement name
+     * @brief Reads a Jacoco XML report with a streaming parser. The name of the test case
+     *        is the first comment after the root element.
+     * @param p  Path of the report.
+     * @param builder  Collects the relations of the report.
+     * @throw Exception if the report has no root element or test case name.
      */
-    void readFromDirectory(fs::path, size_t);
+    void readFile(const fs::path &p, CCoverageMatrixBuilder &builder);
 
     /**
      * @brief Stores coverage data.
      */
     CCoverageMatrix *m_coverage;
 
+    /**
+     * @brief Collects the relations while the files are read.
+     */
+    CCoverageMatrixBuilder *m_builder;
+
     enum Granularity {PACKAGE = 1, SRC, CLASS, METHOD};
     Granularity m_granularity;
+
+    /**
+     * @brief Number of threads reading the files, 0 means the number of hardware threads.
+     */
+    unsigned int m_numOfThreads;
 };
 
 }
@@ -36,7 +36,7 @@ namespace pt = boost::property_tree;
 namespace soda {
 
 NodeJsCoverageReaderPlugin::NodeJsCoverageReaderPlugin() :
-    m_coverage(NULL), m_granularity(CHAIN)
+    m_coverage(NULL), m_builder(NULL), m_granularity(CHAIN)
 {}
 
 NodeJsCoverageReaderPlugin::~NodeJsCoverageReaderPlugin()
@@ -68,9 +68,13 @@ CCoverageMatrix* NodeJsCoverageReaderPlugin::read(const variables_map &vm)
     }
 
     m_coverage = new CCoverageMatrix();
+    m_builder = new CCoverageMatrixBuilder();
 
     readFromDirectoryStructure(vm["path"].as<String>());
 
+    m_builder->build(*m_coverage);
+    delete m_builder;
+    m_builder = NULL;
     return m_coverage;
 }
 
@@ -141,8 +145,7 @@ void NodeJsCoverageReaderPlugin::readFromDirectory(fs::path path)
             String tcname = fs::basename(*it);
             boost::algorithm::trim(tcname);
 
-            m_coverage->addTestcaseName(tcname);
-            m_coverage->refitMatrixSize();
+            m_builder->addTestcaseName(tcname);
 
             switch (m_granularity) {
                 case CHAIN: readChainCoverage(tcname, json); break;
@@ -180,7 +183,7 @@ void NodeJsCoverageReaderPlugin::readChainCoverage(const std::string& tcname, co
 
         auto chain_as_string = boost::algorithm::join(code_elements, "---");
 
-        m_coverage->addOrSetRelation(tcname, chain_as_string);
+        m_builder->addOrSetRelation(tcname, chain_as_string);
     }
 }
 
@@ -197,11 +200,9 @@ void NodeJsCoverageReaderPlugin::readFunctionCoverage(const std::string& tcname,
 
         id_to_codeElement_mapping[id] = pos;
 
-        m_coverage->addCodeElementName(pos);
+        m_builder->addCodeElementName(pos);
     }
 
-    m_coverage->refitMatrixSize();
-
     auto chains = json.FindMember("call_chains");
 
     std::set<String> covered_codeElements;
@@ -215,7 +216,7 @@ void NodeJsCoverageReaderPlugin::readFunctionCoverage(const std::string& tcname,
     }
 
     for (auto& codeElement : covered_codeElements) {
-        m_coverage->setRelation(tcname, codeElement);
+        m_builder->addOrSetRelation(tcname, codeElement);
     }
 }
 
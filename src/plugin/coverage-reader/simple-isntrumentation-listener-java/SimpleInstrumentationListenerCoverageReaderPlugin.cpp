@@ -27,6 +27,7 @@
 #include "boost/regex.hpp"
 #include "boost/lexical_cast.hpp"
 #include "exception/CException.h"
+#include "data/CCoverageMatrixBuilder.h"
 #include "SimpleInstrumentationListenerCoverageReaderPlugin.h"
 
 namespace pt = boost::property_tree;
@@ -64,7 +65,8 @@ CCoverageMatrix* SimpleInstrumentationListenerJavaCoverageReaderPlugin::read(con
 
 void SimpleInstrumentationListenerJavaCoverageReaderPlugin::readFromFile(String const &file)
 {
-    CCoverageMatrix *mutationM = new CCoverageMatrix();
+    CCoverageMatrixBuilder coverageBuilder;
+    CCoverageMatrixBuilder mutationBuilder;
     fs::path coverage_path(file);
     if (!(exists(coverage_path) && is_regular_file(coverage_path))) {
         throw CException("SimpleInstrumentationListenerJavaCoverageReaderPlugin::readFromDirectoryStructure()", "Specified path does not exists or is not a file.");
@@ -82,10 +84,10 @@ void SimpleInstrumentationListenerJavaCoverageReaderPlugin::readFromFile(String
         data.push_back(line.substr(0, line.find(":{")));
         data.push_back(line.substr(line.find(":{") + 1));
         if (data[1].find("mutation") != String::npos) {
-            mutationM->addOrSetRelation(data[0], data[1], true);
+            mutationBuilder.addOrSetRelation(data[0], data[1], true);
         }
         else {
-            coverage->addOrSetRelation(data[0], data[1], true);
+            coverageBuilder.addOrSetRelation(data[0], data[1], true);
         }
     }
     in.close();
@@ -94,20 +96,20 @@ void SimpleInstrumentationListenerJavaCoverageReaderPlugin::readFromFile(String
         std::ifstream codeElementsList(codeElements);
         while (std::getline(codeElementsList, line)) {
             if (line.find("mutation") != String::npos) {
-                mutationM->addCodeElementName(line);
+                mutationBuilder.addCodeElementName(line);
             }
             else {
-                coverage->addCodeElementName(line);
+                coverageBuilder.addCodeElementName(line);
             }
-            coverage->refitMatrixSize();
-            mutationM->refitMatrixSize();
         }
     }
 
-    if (mutationM->getTestcases().size()) {
+    coverageBuilder.build(*coverage);
+    if (mutationBuilder.getTestcases().size()) {
+        CCoverageMatrix *mutationM = mutationBuilder.build();
         mutationM->save(outputPath);
+        delete mutationM;
     }
-    delete mutationM;
 }
 
 extern "C" MSDLL_EXPORT void registerPlugin(CKernel &kernel)
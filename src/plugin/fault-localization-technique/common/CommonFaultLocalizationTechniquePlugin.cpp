@@ -20,6 +20,8 @@
  */
 
 #include "CommonFaultLocalizationTechniquePlugin.h"
+#include "util/CCoverageSpectrum.h"
+#include "util/CThreadPool.h"
 
 namespace soda {
 
@@ -27,7 +29,8 @@ CommonFaultLocalizationTechniquePlugin::CommonFaultLocalizationTechniquePlugin()
     m_data(NULL),
     clusterList(NULL),
     m_flScore(NULL),
-    m_revision(0)
+    m_revision(0),
+    m_numOfThreads(1)
 {
 }
 
@@ -57,6 +60,11 @@ void CommonFaultLocalizationTechniquePlugin::init(CSelectionData *data, ClusterM
     m_revision = revision;
 }
 
+void CommonFaultLocalizationTechniquePlugin::setNumOfThreads(unsigned int numOfThreads)
+{
+    m_numOfThreads = numOfThreads;
+}
+
 CommonFaultLocalizationTechniquePlugin::FLDistribution& CommonFaultLocalizationTechniquePlugin::getDistribution()
 {
     return distribution;
@@ -69,79 +77,71 @@ CommonFaultLocalizationTechniquePlugin::FLScore& CommonFaultLocalizationTechniqu
 
 void CommonFaultLocalizationTechniquePlugin::calculate(rapidjson::Document &res)
 {
-    CCoverageMatrix *coverageMatrix = m_data->getCoverage();
-
-    ClusterMap::iterator it;
-    for (it = clusterList->begin(); it != clusterList->end(); it++) {
-        std::map<IndexType, IndexType> tcMap;
-        IntVector testCaseIds = it->second.getTestCases();
-        IntVector codeElementIds = it->second.getCodeElements();
+    FLMetricTables tables;
+    calculate(tables);
 
+    FLMetricTables::iterator it;
+    for (it = tables.begin(); it != tables.end(); it++) {
         // group for cluster data
         if (!res.HasMember(it->first.c_str())) {
             res.AddMember(rapidjson::Value(it->first.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
         }
+        it->second.toJson(res[it->first.c_str()], res.GetAllocator(), it->second.getColumnNames());
+    }
+}
 
-        for (IndexType i = 0; i < testCaseIds.size(); i++) {
-            tcMap[testCaseIds[i]] = m_data->translateTestcaseIdFromCoverageToResults(testCaseIds[i]);
+void CommonFaultLocalizationTechniquePlugin::calculate(FLMetricTables &tables)
+{
+    // The tables are created before the clusters are processed in parallel.
+    std::vector<CClusterDefinition*> clusters;
+    std::vector<CFLMetricTable*> clusterTables;
+    ClusterMap::iterator it;
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        CFLMetricTable &table = tables[it->first];
+        if (table.getCodeElements() != it->second.getCodeElements()) {
+            table.setCodeElements(it->second.getCodeElements());
         }
+        table.addUIntColumn("ef");
+        table.addUIntColumn("ep");
+        table.addUIntColumn("nf");
+        table.addUIntColumn("np");
+        table.addDoubleColumn("ef/(ef+ep)");
+        table.addDoubleColumn("nf/(nf+np)");
+
+        clusters.push_back(&it->second);
+        clusterTables.push_back(&table);
+    }
 
-        for (IndexType i = 0; i < codeElementIds.size(); i++) {
-            IndexType cid = codeElementIds[i];
-            String ceIdStr = std::to_string(cid);
-
-            // holds the metric values for one code element
-            if (!res[it->first.c_str()].HasMember(ceIdStr.c_str())) {
-                res[it->first.c_str()].AddMember(rapidjson::Value(ceIdStr.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
-            }
-            rapidjson::Value &ceMetrics = res[it->first.c_str()][ceIdStr.c_str()];
-
-            IndexType failedCovered = 0;
-            IndexType passedCovered = 0;
-            IndexType failedNotCovered = 0;
-            IndexType passedNotCovered = 0;
-            for (IndexType j = 0; j < testCaseIds.size(); j++) {
-                IndexType tcid = testCaseIds[j];
-                IndexType tcidInResults = tcMap[tcid];
-
-                if (m_data->getResults()->getExecutionBitList(m_revision).at(tcidInResults)) {
-                    bool isPassed = m_data->getResults()->getPassedBitList(m_revision).at(tcidInResults);
-                    bool isCovered = coverageMatrix->getBitMatrix().get(tcid, cid);
-                    if (isCovered) {
-                        if (isPassed) {
-                            passedCovered++;
-                        }
-                        else {
-                            failedCovered++;
-                        }
-                    }
-                    else {
-                        if (isPassed) {
-                            passedNotCovered++;
-                        }
-                        else {
-                            failedNotCovered++;
-                        }
-                    }
-                }
-            }
-
-            double efperefep = 0;
-            if ((failedCovered + passedCovered) > 0) {
-                efperefep = (double)failedCovered / (failedCovered + passedCovered);
-            }
-            double nfpernfnp = 0;
-            if ((failedNotCovered + passedNotCovered) > 0) {
-                nfpernfnp = (double)failedNotCovered / (failedNotCovered + passedNotCovered);
-            }
-
-            // ef; ep; nf; np; ef/(ef+ep); nf/(nf+np);
-            ceMetrics.AddMember("ef", failedCovered, res.GetAllocator());
-            ceMetrics.AddMember("ep", passedCovered, res.GetAllocator());
-            ceMetrics.AddMember("nf", failedNotCovered, res.GetAllocator());
-            ceMetrics.AddMember("np", passedNotCovered, res.GetAllocator());
-            ceMetrics.AddMember("ef/(ef+ep)", efperefep, res.GetAllocator());
-            ceMetrics.AddMember("nf/(nf+np)", nfpernfnp, res.GetAllocator());
+    CThreadPool(m_numOfThreads).run(clusters.size(), [&](IndexType i) {
+        calculateCluster(*clusters[i], *clusterTables[i]);
+    });
+}
+
+void CommonFaultLocalizationTechniquePlugin::calculateCluster(CClusterDefinition &cluster, CFLMetricTable &table)
+{
+    CCoverageSpectrum spectrum;
+    spectrum.compute(*m_data, m_revision, cluster.getTestCases(), cluster.getCodeElements());
+
+    // ef; ep; nf; np; ef/(ef+ep); nf/(nf+np);
+    IntVector &ef = table.addUIntColumn("ef");
+    IntVector &ep = table.addUIntColumn("ep");
+    IntVector &nf = table.addUIntColumn("nf");
+    IntVector &np = table.addUIntColumn("np");
+    std::vector<double> &efperefep = table.addDoubleColumn("ef/(ef+ep)");
+    std::vector<double> &nfpernfnp = table.addDoubleColumn("nf/(nf+np)");
+    ef = spectrum.getEf();
+    ep = spectrum.getEp();
+    nf = spectrum.getNf();
+    np = spectrum.getNp();
+
+    for (IndexType i = 0; i < table.getNumOfRows(); i++) {
+        efperefep[i] = 0;
+        if ((ef[i] + ep[i]) > 0) {
+            efperefep[i] = (double)ef[i] / (ef[i] + ep[i]);
+        }
+        nfpernfnp[i] = 0;
+        if ((nf[i] + np[i]) > 0) {
+            nfpernfnp[i] = (double)nf[i] / (nf[i] + np[i]);
         }
     }
 }
@@ -57,6 +57,12 @@ public:
      */
     void init(CSelectionData *data, ClusterMap *clusters, IndexType revision, IntVector failedCodeElements);
 
+    /**
+     * @brief Sets the number of threads used to process the clusters in parallel.
+     * @param numOfThreads Number of threads, 0 means the number of hardware threads.
+     */
+    void setNumOfThreads(unsigned int numOfThreads);
+
     /**
      * @brief Calculates the score values for each code element in clusters.
      * @param cluster The cluster to use during the calculation.
@@ -64,6 +70,12 @@ public:
      */
     void calculate(rapidjson::Document &res);
 
+    /**
+     * @brief Calculates the score values for each code element in clusters.
+     * @param tables The metric tables of the clusters.
+     */
+    void calculate(FLMetricTables &tables);
+
     /**
      * @brief Returns the distributiuon of fault lcoalization technique values.
      * @return
@@ -77,11 +89,17 @@ public:
     FLScore& getFlScore();
 
 private:
+    /**
+     * @brief Calculates the common values of one cluster.
+     */
+    void calculateCluster(CClusterDefinition &cluster, CFLMetricTable &table);
+
     FLDistribution distribution;
     CSelectionData *m_data;
     ClusterMap *clusterList;
     IndexType       m_revision;
     FLScore *m_flScore;
+    unsigned int m_numOfThreads;
 };
 
 } /* namespace soda */
@@ -20,6 +20,7 @@
  */
 #include "DStarFaultLocalizationTechniquePlugin.h"
 #include "util/CTestSuiteScore.h"
+#include "util/CThreadPool.h"
 
 namespace soda {
 
@@ -28,7 +29,8 @@ DStarFaultLocalizationTechniquePlugin::DStarFaultLocalizationTechniquePlugin() :
     m_flScore(new FLScore()),
     m_data(NULL),
     clusterList(NULL),
-    m_revision(0)
+    m_revision(0),
+    m_numOfThreads(1)
 {
 }
 
@@ -60,6 +62,11 @@ void DStarFaultLocalizationTechniquePlugin::init(CSelectionData *data, ClusterMa
     m_failedCodeElements = failedCodeElements;
 }
 
+void DStarFaultLocalizationTechniquePlugin::setNumOfThreads(unsigned int numOfThreads)
+{
+    m_numOfThreads = numOfThreads;
+}
+
 DStarFaultLocalizationTechniquePlugin::FLDistribution& DStarFaultLocalizationTechniquePlugin::getDistribution()
 {
     return *m_distribution;
@@ -72,55 +79,83 @@ DStarFaultLocalizationTechniquePlugin::FLScore& DStarFaultLocalizationTechniqueP
 
 void DStarFaultLocalizationTechniquePlugin::calculate(rapidjson::Document &res)
 {
-    CCoverageMatrix *coverageMatrix = m_data->getCoverage();
+    FLMetricTables tables;
 
-    std::map<String, CClusterDefinition>::iterator it;
+    ClusterMap::iterator it;
     for (it = clusterList->begin(); it != clusterList->end(); it++) {
-
-        m_distribution->clear();
-
-        IntVector codeElementIds = it->second.getCodeElements();
-
         // group for cluster data
         if (!res.HasMember(it->first.c_str())) {
             res.AddMember(rapidjson::Value(it->first.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
         }
+        tables[it->first].loadUIntColumns(res[it->first.c_str()], { "ef", "ep", "nf", "np" });
+    }
 
-        for (IndexType i = 0; i < codeElementIds.size(); i++) {
-            IndexType cid = codeElementIds[i];
-            String ceIdStr = std::to_string(cid);
-
-            // holds the metric values for one code element
-            if (!res[it->first.c_str()].HasMember(ceIdStr.c_str())) {
-                res[it->first.c_str()].AddMember(rapidjson::Value(ceIdStr.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
-            }
-            rapidjson::Value &ceMetrics = res[it->first.c_str()][ceIdStr.c_str()];
-
-            IndexType failedCovered = ceMetrics["ef"].GetUint64();
-            IndexType passedCovered = ceMetrics["ep"].GetUint64();
-            IndexType failedNotCovered = ceMetrics["nf"].GetUint64();
+    calculate(tables);
 
-            double dstar = 0;
-            IndexType nrOfFailedTestcases = failedCovered + failedNotCovered;
-            IndexType denominator = passedCovered + (nrOfFailedTestcases - failedCovered);
-            if (denominator > 0) {
-                dstar = std::pow((double)failedCovered, 2) / denominator;
-            }
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        tables[it->first].toJson(res[it->first.c_str()], res.GetAllocator(), { "dstar" });
+    }
+}
 
-            ceMetrics.AddMember("dstar", dstar, res.GetAllocator());
+void DStarFaultLocalizationTechniquePlugin::calculate(FLMetricTables &tables)
+{
+    // The tables and the result buffers are created before the clusters are processed in parallel.
+    std::vector<ClusterMap::iterator> clusters;
+    std::vector<CFLMetricTable*> clusterTables;
+    ClusterMap::iterator it;
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        CFLMetricTable &table = tables[it->first];
+        table.addDoubleColumn("dstar");
 
-            (*m_distribution)[dstar]++;
+        clusters.push_back(it);
+        clusterTables.push_back(&table);
+    }
+    std::vector<FLDistribution> distributions(clusters.size());
+    std::vector<std::map<IndexType, double> > flScores(clusters.size());
+
+    CThreadPool(m_numOfThreads).run(clusters.size(), [&](IndexType i) {
+        calculateCluster(clusters[i]->second, *clusterTables[i], distributions[i], flScores[i]);
+    });
+
+    // The results are merged in the order of the clusters, the distribution of the last one is kept.
+    for (IndexType i = 0; i < clusters.size(); i++) {
+        std::map<IndexType, double> &clusterScores = (*m_flScore)[clusters[i]->first];
+        for (std::map<IndexType, double>::iterator scoreIt = flScores[i].begin(); scoreIt != flScores[i].end(); scoreIt++) {
+            clusterScores[scoreIt->first] = scoreIt->second;
         }
+    }
+    if (!clusters.empty()) {
+        m_distribution->swap(distributions.back());
+    }
+}
 
-        for (IndexType i = 0; i < m_failedCodeElements.size(); i++) {
-            IndexType cid = m_failedCodeElements[i];
-            String ceIdStr = std::to_string(cid);
-            double DStar = res[it->first.c_str()][ceIdStr.c_str()]["dstar"].GetDouble();
+void DStarFaultLocalizationTechniquePlugin::calculateCluster(CClusterDefinition &cluster, CFLMetricTable &table, FLDistribution &distribution, std::map<IndexType, double> &flScore)
+{
+    const IntVector &ef = table.getUIntColumn("ef");
+    const IntVector &ep = table.getUIntColumn("ep");
+    const IntVector &nf = table.getUIntColumn("nf");
+    std::vector<double> &values = table.addDoubleColumn("dstar");
+
+    for (IndexType i = 0; i < table.getNumOfRows(); i++) {
+        double dstar = 0;
+        IndexType nrOfFailedTestcases = ef[i] + nf[i];
+        IndexType denominator = ep[i] + (nrOfFailedTestcases - ef[i]);
+        if (denominator > 0) {
+            dstar = std::pow((double)ef[i], 2) / denominator;
+        }
 
-            (*m_flScore)[it->first][cid] = CTestSuiteScore::flScore(it->second, DStar, *m_distribution);
+        values[i] = dstar;
+        distribution[dstar]++;
+    }
 
+    for (IndexType i = 0; i < m_failedCodeElements.size(); i++) {
+        IndexType cid = m_failedCodeElements[i];
+        IndexType row = table.getRow(cid);
+        if (row == CFLMetricTable::NO_ROW) {
+            continue;
         }
 
+        flScore[cid] = CTestSuiteScore::flScore(cluster, values[row], distribution);
     }
 }
 
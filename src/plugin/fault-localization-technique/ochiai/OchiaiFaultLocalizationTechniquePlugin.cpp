@@ -23,6 +23,7 @@
 
 #include "OchiaiFaultLocalizationTechniquePlugin.h"
 #include "util/CTestSuiteScore.h"
+#include "util/CThreadPool.h"
 
 namespace soda {
 
@@ -31,7 +32,8 @@ OchiaiFaultLocalizationTechniquePlugin::OchiaiFaultLocalizationTechniquePlugin()
     m_flScore(new FLScore()),
     m_data(NULL),
     clusterList(NULL),
-    m_revision(0)
+    m_revision(0),
+    m_numOfThreads(1)
 {
 }
 
@@ -63,6 +65,11 @@ void OchiaiFaultLocalizationTechniquePlugin::init(CSelectionData *data, ClusterM
     m_failedCodeElements = failedCodeElements;
 }
 
+void OchiaiFaultLocalizationTechniquePlugin::setNumOfThreads(unsigned int numOfThreads)
+{
+    m_numOfThreads = numOfThreads;
+}
+
 OchiaiFaultLocalizationTechniquePlugin::FLDistribution& OchiaiFaultLocalizationTechniquePlugin::getDistribution()
 {
     return *m_distribution;
@@ -75,56 +82,86 @@ OchiaiFaultLocalizationTechniquePlugin::FLScore& OchiaiFaultLocalizationTechniqu
 
 void OchiaiFaultLocalizationTechniquePlugin::calculate(rapidjson::Document &res)
 {
-    CCoverageMatrix *coverageMatrix = m_data->getCoverage();
+    FLMetricTables tables;
 
     ClusterMap::iterator it;
     for (it = clusterList->begin(); it != clusterList->end(); it++) {
-        m_distribution->clear();
-
-        IntVector codeElementIds = (*it).second.getCodeElements();
-
         // group for cluster data
         if (!res.HasMember(it->first.c_str())) {
             res.AddMember(rapidjson::Value(it->first.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
         }
+        tables[it->first].loadUIntColumns(res[it->first.c_str()], { "ef", "ep", "nf", "np" });
+    }
 
-        for (IndexType i = 0; i < codeElementIds.size(); i++) {
-            IndexType cid = codeElementIds[i];
-            String ceIdStr = std::to_string(cid);
+    calculate(tables);
 
-            // holds the metric values for one code element
-            if (!res[it->first.c_str()].HasMember(ceIdStr.c_str())) {
-                res[it->first.c_str()].AddMember(rapidjson::Value(ceIdStr.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
-            }
-            rapidjson::Value &ceMetrics = res[it->first.c_str()][ceIdStr.c_str()];
-
-            IndexType failedCovered = ceMetrics["ef"].GetUint64();
-            IndexType passedCovered = ceMetrics["ep"].GetUint64();
-            IndexType failedNotCovered = ceMetrics["nf"].GetUint64();
-            IndexType passedNotCovered = ceMetrics["np"].GetUint64();
-
-            double ochiai = 0;
-            IndexType nrOfFailedTestcases = failedCovered + failedNotCovered;
-            IndexType covered = failedCovered + passedCovered;
-            if (nrOfFailedTestcases > 0 && covered > 0) {
-                double denominator = std::sqrt(nrOfFailedTestcases * covered);
-                if (denominator > 0) {
-                    ochiai = (double)failedCovered / denominator;
-                }
-            }
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        tables[it->first].toJson(res[it->first.c_str()], res.GetAllocator(), { "ochiai" });
+    }
+}
+
+void OchiaiFaultLocalizationTechniquePlugin::calculate(FLMetricTables &tables)
+{
+    // The tables and the result buffers are created before the clusters are processed in parallel.
+    std::vector<ClusterMap::iterator> clusters;
+    std::vector<CFLMetricTable*> clusterTables;
+    ClusterMap::iterator it;
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        CFLMetricTable &table = tables[it->first];
+        table.addDoubleColumn("ochiai");
 
-            ceMetrics.AddMember("ochiai", ochiai, res.GetAllocator());
-            (*m_distribution)[ochiai]++;
+        clusters.push_back(it);
+        clusterTables.push_back(&table);
+    }
+    std::vector<FLDistribution> distributions(clusters.size());
+    std::vector<std::map<IndexType, double> > flScores(clusters.size());
+
+    CThreadPool(m_numOfThreads).run(clusters.size(), [&](IndexType i) {
+        calculateCluster(clusters[i]->second, *clusterTables[i], distributions[i], flScores[i]);
+    });
+
+    // The results are merged in the order of the clusters, the distribution of the last one is kept.
+    for (IndexType i = 0; i < clusters.size(); i++) {
+        std::map<IndexType, double> &clusterScores = (*m_flScore)[clusters[i]->first];
+        for (std::map<IndexType, double>::iterator scoreIt = flScores[i].begin(); scoreIt != flScores[i].end(); scoreIt++) {
+            clusterScores[scoreIt->first] = scoreIt->second;
         }
+    }
+    if (!clusters.empty()) {
+        m_distribution->swap(distributions.back());
+    }
+}
 
-        for (IndexType i = 0; i < m_failedCodeElements.size(); i++) {
-            IndexType cid = m_failedCodeElements[i];
-            String ceIdStr = std::to_string(cid);
-            double ochiai = res[it->first.c_str()][ceIdStr.c_str()]["ochiai"].GetDouble();
+void OchiaiFaultLocalizationTechniquePlugin::calculateCluster(CClusterDefinition &cluster, CFLMetricTable &table, FLDistribution &distribution, std::map<IndexType, double> &flScore)
+{
+    const IntVector &ef = table.getUIntColumn("ef");
+    const IntVector &ep = table.getUIntColumn("ep");
+    const IntVector &nf = table.getUIntColumn("nf");
+    std::vector<double> &values = table.addDoubleColumn("ochiai");
+
+    for (IndexType i = 0; i < table.getNumOfRows(); i++) {
+        double ochiai = 0;
+        IndexType nrOfFailedTestcases = ef[i] + nf[i];
+        IndexType covered = ef[i] + ep[i];
+        if (nrOfFailedTestcases > 0 && covered > 0) {
+            double denominator = std::sqrt(nrOfFailedTestcases * covered);
+            if (denominator > 0) {
+                ochiai = (double)ef[i] / denominator;
+            }
+        }
 
-            (*m_flScore)[it->first][cid] = CTestSuiteScore::flScore(it->second, ochiai, *m_distribution);
+        values[i] = ochiai;
+        distribution[ochiai]++;
+    }
 
+    for (IndexType i = 0; i < m_failedCodeElements.size(); i++) {
+        IndexType cid = m_failedCodeElements[i];
+        IndexType row = table.getRow(cid);
+        if (row == CFLMetricTable::NO_ROW) {
+            continue;
         }
+
+        flScore[cid] = CTestSuiteScore::flScore(cluster, values[row], distribution);
     }
 }
 
@@ -20,6 +20,7 @@
  */
 #include "TarantulaFaultLocalizationTechniquePlugin.h"
 #include "util/CTestSuiteScore.h"
+#include "util/CThreadPool.h"
 
 namespace soda {
 
@@ -28,7 +29,8 @@ TarantulaFaultLocalizationTechniquePlugin::TarantulaFaultLocalizationTechniquePl
     m_flScore(new FLScore()),
     m_data(NULL),
     clusterList(NULL),
-    m_revision(0)
+    m_revision(0),
+    m_numOfThreads(1)
 {
 }
 
@@ -60,6 +62,11 @@ void TarantulaFaultLocalizationTechniquePlugin::init(CSelectionData *data, Clust
     m_failedCodeElements = failedCodeElements;
 }
 
+void TarantulaFaultLocalizationTechniquePlugin::setNumOfThreads(unsigned int numOfThreads)
+{
+    m_numOfThreads = numOfThreads;
+}
+
 TarantulaFaultLocalizationTechniquePlugin::FLDistribution& TarantulaFaultLocalizationTechniquePlugin::getDistribution()
 {
     return *m_distribution;
@@ -72,59 +79,87 @@ TarantulaFaultLocalizationTechniquePlugin::FLScore& TarantulaFaultLocalizationTe
 
 void TarantulaFaultLocalizationTechniquePlugin::calculate(rapidjson::Document &res)
 {
-    CCoverageMatrix *coverageMatrix = m_data->getCoverage();
+    FLMetricTables tables;
 
-    std::map<String, CClusterDefinition>::iterator it;
+    ClusterMap::iterator it;
     for (it = clusterList->begin(); it != clusterList->end(); it++) {
-
-        m_distribution->clear();
-
-        IntVector codeElementIds = it->second.getCodeElements();
-
         // group for cluster data
         if (!res.HasMember(it->first.c_str())) {
             res.AddMember(rapidjson::Value(it->first.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
         }
+        tables[it->first].loadUIntColumns(res[it->first.c_str()], { "ef", "ep", "nf", "np" });
+    }
 
-        for (IndexType i = 0; i < codeElementIds.size(); i++) {
-            IndexType cid = codeElementIds[i];
-            String ceIdStr = std::to_string(cid);
+    calculate(tables);
 
-            // holds the metric values for one code element
-            if (!res[it->first.c_str()].HasMember(ceIdStr.c_str())) {
-                res[it->first.c_str()].AddMember(rapidjson::Value(ceIdStr.c_str(), res.GetAllocator()), rapidjson::Value(rapidjson::kObjectType), res.GetAllocator());
-            }
-            rapidjson::Value &ceMetrics = res[it->first.c_str()][ceIdStr.c_str()];
-
-            IndexType failedCovered = ceMetrics["ef"].GetUint64();
-            IndexType passedCovered = ceMetrics["ep"].GetUint64();
-            IndexType failedNotCovered = ceMetrics["nf"].GetUint64();
-            IndexType passedNotCovered = ceMetrics["np"].GetUint64();
-
-            double tarantula = 0;
-            IndexType nrOfFailedTestcases = failedCovered + failedNotCovered;
-            IndexType nrOfPassedTestcases = passedCovered + passedNotCovered;
-            if (nrOfFailedTestcases > 0 && nrOfPassedTestcases > 0) {
-                double denominator = (((double)failedCovered / nrOfFailedTestcases) + ((double)passedCovered / nrOfPassedTestcases));
-                if (denominator > 0) {
-                    tarantula = ((double)failedCovered / nrOfFailedTestcases) / denominator;
-                }
-            }
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        tables[it->first].toJson(res[it->first.c_str()], res.GetAllocator(), { "tarantula" });
+    }
+}
 
-            ceMetrics.AddMember("tarantula", tarantula, res.GetAllocator());
+void TarantulaFaultLocalizationTechniquePlugin::calculate(FLMetricTables &tables)
+{
+    // The tables and the result buffers are created before the clusters are processed in parallel.
+    std::vector<ClusterMap::iterator> clusters;
+    std::vector<CFLMetricTable*> clusterTables;
+    ClusterMap::iterator it;
+    for (it = clusterList->begin(); it != clusterList->end(); it++) {
+        CFLMetricTable &table = tables[it->first];
+        table.addDoubleColumn("tarantula");
 
-            (*m_distribution)[tarantula]++;
+        clusters.push_back(it);
+        clusterTables.push_back(&table);
+    }
+    std::vector<FLDistribution> distributions(clusters.size());
+    std::vector<std::map<IndexType, double> > flScores(clusters.size());
+
+    CThreadPool(m_numOfThreads).run(clusters.size(), [&](IndexType i) {
+        calculateCluster(clusters[i]->second, *clusterTables[i], distributions[i], flScores[i]);
+    });
+
+    // The results are merged in the order of the clusters, the distribution of the last one is kept.
+    for (IndexType i = 0; i < clusters.size(); i++) {
+        std::map<IndexType, double> &clusterScores = (*m_flScore)[clusters[i]->first];
+        for (std::map<IndexType, double>::iterator scoreIt = flScores[i].begin(); scoreIt != flScores[i].end(); scoreIt++) {
+            clusterScores[scoreIt->first] = scoreIt->second;
         }
+    }
+    if (!clusters.empty()) {
+        m_distribution->swap(distributions.back());
+    }
+}
 
-        for (IndexType i = 0; i < m_failedCodeElements.size(); i++) {
-            IndexType cid = m_failedCodeElements[i];
-            String ceIdStr = std::to_string(cid);
-            double tarantula = res[it->first.c_str()][ceIdStr.c_str()]["tarantula"].GetDouble();
+void TarantulaFaultLocalizationTechniquePlugin::calculateCluster(CClusterDefinition &cluster, CFLMetricTable &table, FLDistribution &distribution, std::map<IndexType, double> &flScore)
+{
+    const IntVector &ef = table.getUIntColumn("ef");
+    const IntVector &ep = table.getUIntColumn("ep");
+    const IntVector &nf = table.getUIntColumn("nf");
+    const IntVector &np = table.getUIntColumn("np");
+    std::vector<double> &values = table.addDoubleColumn("tarantula");
+
+    for (IndexType i = 0; i < table.getNumOfRows(); i++) {
+        double tarantula = 0;
+        IndexType nrOfFailedTestcases = ef[i] + nf[i];
+        IndexType nrOfPassedTestcases = ep[i] + np[i];
+        if (nrOfFailedTestcases > 0 && nrOfPassedTestcases > 0) {
+            double denominator = (((double)ef[i] / nrOfFailedTestcases) + ((double)ep[i] / nrOfPassedTestcases));
+            if (denominator > 0) {
+                tarantula = ((double)ef[i] / nrOfFailedTestcases) / denominator;
+            }
+        }
 
-            (*m_flScore)[it->first][cid] = CTestSuiteScore::flScore(it->second, tarantula, *m_distribution);
+        values[i] = tarantula;
+        distribution[tarantula]++;
+    }
 
+    for (IndexType i = 0; i < m_failedCodeElements.size(); i++) {
+        IndexType cid = m_failedCodeElements[i];
+        IndexType row = table.getRow(cid);
+        if (row == CFLMetricTable::NO_ROW) {
+            continue;
         }
 
+        flScore[cid] = CTestSuiteScore::flScore(cluster, values[row], distribution);
     }
 }
 
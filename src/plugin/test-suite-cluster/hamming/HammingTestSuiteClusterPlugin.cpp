@@ -22,17 +22,35 @@
 
 #include "HammingTestSuiteClusterPlugin.h"
 #include "data/CBitMatrix.h"
+#include "util/CBitOperations.h"
+#include "util/CThreadPool.h"
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
 
 namespace soda {
 
-HammingTestSuiteClusterPlugin::HammingTestSuiteClusterPlugin()
+namespace {
+
+/**
+ * @brief Minimal number of rows compared to the cluster seed by one task.
+ */
+const IndexType MIN_ROWS_PER_TASK = 1024;
+
+/**
+ * @brief Number of words compared between two checks of the Hamming tolerance.
+ */
+const IndexType DISTANCE_BLOCK_WORDS = 16;
+
+} // namespace
+
+HammingTestSuiteClusterPlugin::HammingTestSuiteClusterPlugin() :
+    m_pool(new CThreadPool(1))
 {
 }
 
 HammingTestSuiteClusterPlugin::~HammingTestSuiteClusterPlugin()
 {
+    delete m_pool;
 }
 
 std::string HammingTestSuiteClusterPlugin::getName()
@@ -58,6 +76,8 @@ void HammingTestSuiteClusterPlugin::init(rapidjson::Document &doc)
     _0cluster_limit = doc["0cluster(%)"].GetInt();
     testClusterDump = doc["test_clusters_dump"].GetString();
     codeElementsClusterDump = doc["codeelement_clusters_dump"].GetString();
+    delete m_pool;
+    m_pool = new CThreadPool(doc.HasMember("threads") ? doc["threads"].GetUint() : 1);
 }
 
 void HammingTestSuiteClusterPlugin::execute(CSelectionData &data, std::map<std::string, CClusterDefinition>& clusterList)
@@ -185,6 +205,12 @@ void HammingTestSuiteClusterPlugin::ep_np_ef_nf(CSelectionData &data){
             testCaseIds.push_back(it_cov->second);
 
 
+        // the results of the revision are copied once, the rows of compressed matrices are not kept
+        IndexType nofWords = CBitOperations::numOfWords(data.getResults()->getNumOfTestcases());
+        std::vector<WordType> executed(nofWords, 0);
+        std::vector<WordType> passed(nofWords, 0);
+        data.getResults()->copyResults(*rev_it, executed.data(), passed.data());
+
         // calculate
         for (IndexType i = 0; i < codeElementIds.size(); i++) {
 
@@ -196,9 +222,11 @@ void HammingTestSuiteClusterPlugin::ep_np_ef_nf(CSelectionData &data){
                 IndexType tcid = testCaseIds[j];
                 IndexType tcidInResults = tcMap[tcid];
 
-                if ( data.getResults()->getExecutionBitList(*rev_it).at(tcidInResults)) {
+                IndexType w = tcidInResults / CBitOperations::BITS_PER_WORD;
+                WordType mask = WordType(1) << (tcidInResults % CBitOperations::BITS_PER_WORD);
+                if (executed[w] & mask) {
 
-                    bool isPassed = data.getResults()->getPassedBitList(*rev_it).at(tcidInResults);
+                    bool isPassed = (passed[w] & mask) != 0;
                     bool isCovered = data.getCoverage()->getBitMatrix().get(tcid, cid);
 
                     if (isCovered) {
@@ -268,11 +296,19 @@ std::vector<int> HammingTestSuiteClusterPlugin::clustering(CCoverageMatrix* data
     std::cout<<"\tHamm tol.: "<<tolerance<<std::endl;
     std::cout<<"\t0cluster tol.: "<<_0cluster_tolerance <<std::endl;
 
+    // packed rows and their number of 1 bits
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = data->getBitMatrix().getPackedRows(buffer);
+    IndexType numOfWords = CBitOperations::numOfWords(size2);
+    std::vector<int> elements(size1);
+    for(int index = 0 ; index < size1 ; index++ )
+        elements[index] = int(CBitOperations::count(rows[index], numOfWords));
+
     for(int index_1 = 0 ; index_1 < size1 ; index_1++ ){
 
         //if(index_1%1000==0) std::cout<<index_1<<". ("<<size1<<")"<<std::endl;
 
-        int element_1 = data->getBitMatrix().getRow(IndexType(index_1)).count();
+        int element_1 = elements[index_1];
 
         // 0cluster
         if( element_1 > _0cluster_tolerance ){
@@ -283,14 +319,19 @@ std::vector<int> HammingTestSuiteClusterPlugin::clustering(CCoverageMatrix* data
 
             actual_index++;
             clusterindex_vector[index_1] = actual_index;
-            for(int index_2 = index_1 ; index_2 < size1 ; index_2++ ){
 
-                int element_2 = data->getBitMatrix().getRow(IndexType(index_2)).count();
+            // The rows are compared to the seed independently, so the candidates are split between the threads.
+            IndexType first = index_1 + 1;
+            IndexType numOfCandidates = size1 - first;
+            IndexType numOfTasks = std::max<IndexType>(1, std::min<IndexType>(m_pool->getNumOfThreads(), numOfCandidates / MIN_ROWS_PER_TASK));
+            m_pool->run(numOfTasks, [&](IndexType task) {
+                for(int index_2 = first + task * numOfCandidates / numOfTasks ; index_2 < int(first + (task + 1) * numOfCandidates / numOfTasks) ; index_2++ ){
 
-                if( index_1 != index_2 && clusterindex_vector[index_2] == -1 && abs(element_1-element_2) < tolerance )
-                    if( hamming_distance(data, index_1, index_2, tolerance, size2) )  clusterindex_vector[index_2] = actual_index;
+                    if( clusterindex_vector[index_2] == -1 && abs(element_1-elements[index_2]) < tolerance )
+                        if( hamming_distance(rows[index_1], rows[index_2], tolerance, numOfWords) )  clusterindex_vector[index_2] = actual_index;
 
-            }
+                }
+            });
         }
     }
 
@@ -300,21 +341,22 @@ std::vector<int> HammingTestSuiteClusterPlugin::clustering(CCoverageMatrix* data
 
 
 
-// Hamming distance calculate
-bool HammingTestSuiteClusterPlugin::hamming_distance(CCoverageMatrix* data, int index1, int index2, int tolerance, int size){
-    int distance = 0;
-    for(int a = 0 ; a < size ; a++)
-        distance += ( data->getBitMatrix().get(IndexType(index1),IndexType(a)) ^ data->getBitMatrix().get(IndexType(index2),IndexType(a)) );
+// Hamming distance calculate, stops as soon as the tolerance is reached
+bool HammingTestSuiteClusterPlugin::hamming_distance(const WordType* row1, const WordType* row2, int tolerance, IndexType numOfWords){
+    if( tolerance <= 0 ) return false;
 
+    IndexType distance = 0;
+    for(IndexType a = 0 ; a < numOfWords ; a += DISTANCE_BLOCK_WORDS){
+        distance += CBitOperations::countXor(row1 + a, row2 + a, std::min(DISTANCE_BLOCK_WORDS, numOfWords - a));
+        if( distance >= IndexType(tolerance) ) return false;
+    }
 
-    if( distance < tolerance )return true;
-
-    return false;
+    return true;
 }
 
 
 
-// original matrix transpose
+// original matrix transpose, done in 64x64 bit blocks
 void HammingTestSuiteClusterPlugin::matrixTranspose(CSelectionData &data, CCoverageMatrix* coverageMatrix, CBitMatrix* bitMatrix, int numTC, int numCE){
 
     for(int i = 0 ; i < numCE ; i++)
@@ -325,9 +367,7 @@ void HammingTestSuiteClusterPlugin::matrixTranspose(CSelectionData &data, CCover
 
     coverageMatrix->refitMatrixSize();
 
-    for(int i = 0 ; i < numCE ; i++)
-        for(int j = 0 ; j < numTC ; j++)
-            bitMatrix->set(i,j, data.getCoverage()->getBitMatrix().get(IndexType(j),IndexType(i)));
+    bitMatrix->transpose(data.getCoverage()->getBitMatrix(), *m_pool);
 
 }
 
@@ -372,8 +412,10 @@ void HammingTestSuiteClusterPlugin::matrixDensity(CCoverageMatrix* matrix){
 
     int size = matrix->getNumOfTestcases();
     int count = 0;
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = matrix->getBitMatrix().getPackedRows(buffer);
     for(int i = 0 ; i < size ; i++)
-        count += matrix->getBitMatrix().getRow(IndexType(i)).count();
+        count += CBitOperations::count(rows[i], CBitOperations::numOfWords(matrix->getNumOfCodeElements()));
 
     std::cout<<"Matrix density: "<<float(count)/float((size*matrix->getNumOfCodeElements()))<<std::endl<<std::endl;
 }
@@ -27,6 +27,7 @@
 
 namespace soda {
 
+class CThreadPool;
 
 class HammingTestSuiteClusterPlugin : public ITestSuiteClusterPlugin
 {
@@ -47,7 +48,7 @@ public:
 
     std::vector<int> clustering(CCoverageMatrix* data, int hammingTolerance, int nullTolerance);
 
-    bool hamming_distance(CCoverageMatrix* data, int index1, int index2, int tolerance, int size);
+    bool hamming_distance(const WordType* row1, const WordType* row2, int tolerance, IndexType numOfWords);
 
     void matrixTranspose(CSelectionData &data, CCoverageMatrix* newMatrix, CBitMatrix* bitMatrix, int numTC, int numCE);
 
@@ -70,6 +71,7 @@ private:
     std::vector<int> cols_cluster_index;
     std::string testClusterDump;
     std::string codeElementsClusterDump;
+    CThreadPool* m_pool;    // threads of the clustering and the transposition, 1 by default
 
 };
 
@@ -23,17 +23,55 @@
 #include "Ochiai_Dice_JaccardTestSuiteClusterPlugin.h"
 #include "cluster.hpp"
 #include "data/CBitMatrix.h"
+#include "util/CBitOperations.h"
+#include "util/CThreadPool.h"
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string.hpp>
 
 namespace soda {
 
-Ochiai_Dice_JaccardTestSuiteClusterPlugin::Ochiai_Dice_JaccardTestSuiteClusterPlugin()
+namespace {
+
+/**
+ * @brief Number of rows in a block of the similarity matrix computation.
+ */
+const IndexType SIMILARITY_BLOCK_SIZE = 64;
+
+/**
+ * @brief Minimal number of rows processed by one task of the top-k similarity computation.
+ */
+const IndexType MIN_ROWS_PER_TASK = 64;
+
+/**
+ * @brief Maximal number of iterations of k-means and k-medoids.
+ */
+const unsigned int MAX_ITERATIONS = 1000;
+
+/**
+ * @brief Orders the similarities decreasingly, equal similarities by the index.
+ */
+bool moreSimilar(const Clustering::SparseCoord &coord1, const Clustering::SparseCoord &coord2)
+{
+    if (coord1.second == coord2.second) {
+        return coord1.first < coord2.first;
+    }
+    return coord1.second > coord2.second;
+}
+
+} // namespace
+
+Ochiai_Dice_JaccardTestSuiteClusterPlugin::Ochiai_Dice_JaccardTestSuiteClusterPlugin() :
+    m_topK(0),
+    m_kMedoids(false),
+    m_jaccardDistance(false),
+    m_seed(0),
+    m_pool(new CThreadPool(1))
 {
 }
 
 Ochiai_Dice_JaccardTestSuiteClusterPlugin::~Ochiai_Dice_JaccardTestSuiteClusterPlugin()
 {
+    delete m_pool;
 }
 
 std::string Ochiai_Dice_JaccardTestSuiteClusterPlugin::getName()
@@ -59,6 +97,12 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::init(rapidjson::Document &doc)
     _0cluster_limit = doc["0cluster(%)"].GetInt();
     testClusterDump = doc["test_clusters_dump"].GetString();
     codeElementsClusterDump = doc["codeelement_clusters_dump"].GetString();
+    m_topK = doc.HasMember("top-k") ? doc["top-k"].GetInt() : 0;
+    m_kMedoids = doc.HasMember("method") && std::string(doc["method"].GetString()) == "k-medoids";
+    m_jaccardDistance = doc.HasMember("distance") && std::string(doc["distance"].GetString()) == "jaccard";
+    m_seed = doc.HasMember("seed") ? doc["seed"].GetUint() : 0;
+    delete m_pool;
+    m_pool = new CThreadPool(doc.HasMember("threads") ? doc["threads"].GetUint() : 1);
 }
 
 
@@ -75,9 +119,10 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::execute(CSelectionData &data, st
     std::cout<<"Matrix size: "<<numTC<<" X "<<numCE<<std::endl;
 
 
-    // TestCase X TestCase matrix calc.
+    // TestCase X TestCase matrix calc., k-medoids works on the rows directly
     //std::cout<<"... on rows..."<<std::endl;
-    clusters(data.getCoverage(), algorithm_index , false);
+    if( !m_kMedoids )
+        clusters(data.getCoverage(), algorithm_index , false);
 
 
     // matrix transpose
@@ -89,7 +134,8 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::execute(CSelectionData &data, st
 
     // CodeElements X CodeElements matrix calc.
     //std::cout<<"... on cols..."<<std::endl;
-    clusters(coverageTransposeMatrix, algorithm_index , true);
+    if( !m_kMedoids )
+        clusters(coverageTransposeMatrix, algorithm_index , true);
 
 
     // matrix density = | 1 points | / (matrix size)
@@ -101,14 +147,23 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::execute(CSelectionData &data, st
     histogram(coverageTransposeMatrix, true);
 
 
-    // k-means alg. on (row) x (row) matrix
-    //std::cout<<std::endl<<"k-means running on row..."<<std::endl;
-    kMeans(data.getCoverage(),false);
+    if( m_kMedoids ){
 
+        // k-medoids alg. on the rows and on the cols
+        kMedoids(data.getCoverage(),false);
+        kMedoids(coverageTransposeMatrix,true);
 
-    // k-means alg. on (cols) x (cols) matrix
-    //std::cout<<"... and on cols"<<std::endl;
-    kMeans(coverageTransposeMatrix,true);
+    } else {
+
+        // k-means alg. on (row) x (row) matrix
+        //std::cout<<std::endl<<"k-means running on row..."<<std::endl;
+        kMeans(data.getCoverage(),false);
+
+
+        // k-means alg. on (cols) x (cols) matrix
+        //std::cout<<"... and on cols"<<std::endl;
+        kMeans(coverageTransposeMatrix,true);
+    }
 
 
 
@@ -201,6 +256,12 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::ep_np_ef_nf(CSelectionData &data
             testCaseIds.push_back(it_cov->second);
 
 
+        // the results of the revision are copied once, the rows of compressed matrices are not kept
+        IndexType nofWords = CBitOperations::numOfWords(data.getResults()->getNumOfTestcases());
+        std::vector<WordType> executed(nofWords, 0);
+        std::vector<WordType> passed(nofWords, 0);
+        data.getResults()->copyResults(*rev_it, executed.data(), passed.data());
+
         // calculate
         for (IndexType i = 0; i < codeElementIds.size(); i++) {
 
@@ -212,9 +273,11 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::ep_np_ef_nf(CSelectionData &data
                 IndexType tcid = testCaseIds[j];
                 IndexType tcidInResults = tcMap[tcid];
 
-                if ( data.getResults()->getExecutionBitList(*rev_it).at(tcidInResults)) {
+                IndexType w = tcidInResults / CBitOperations::BITS_PER_WORD;
+                WordType mask = WordType(1) << (tcidInResults % CBitOperations::BITS_PER_WORD);
+                if (executed[w] & mask) {
 
-                    bool isPassed = data.getResults()->getPassedBitList(*rev_it).at(tcidInResults);
+                    bool isPassed = (passed[w] & mask) != 0;
                     bool isCovered = data.getCoverage()->getBitMatrix().get(tcid, cid);
 
                     if (isCovered) {
@@ -262,58 +325,69 @@ float Ochiai_Dice_JaccardTestSuiteClusterPlugin::results_vs_limit( float results
 void Ochiai_Dice_JaccardTestSuiteClusterPlugin::kMeans(CCoverageMatrix *matrix, bool dimension){
 
     Clustering::ClusterId num_clusters = cluster_number;
-    Clustering::PointId num_points;
-    Clustering::Dimensions num_dimensions;
+    Clustering::PointId num_points = matrix->getNumOfTestcases();
+    Clustering::Dimensions num_dimensions = matrix->getNumOfTestcases();
+
+    std::vector<ClusterId>& labelVector = dimension ? ColsIndexVector : RowIndexVector;
+
+    if( m_topK > 0 ){
+
+        Clustering::PointsSpace ps(num_points, num_dimensions, dimension ? sparseColsVectors : sparseRowVectors );
+        Clustering::Clusters clusters(num_clusters, ps, *m_pool);
+
+        clusters.k_means(MAX_ITERATIONS);
+
+        labelVector = clusters.points_to_clusters__;
 
-    if( !dimension ){
-        num_points = floatRowVectors[0].size();
-        num_dimensions = floatRowVectors[0].size();
     } else {
-        num_points = floatColsVectors[0].size();
-        num_dimensions = floatColsVectors[0].size();
+
+        Clustering::PointsSpace ps(num_points, num_dimensions, dimension ? floatColsVectors : floatRowVectors );
+        Clustering::Clusters clusters(num_clusters, ps, *m_pool);
+
+        clusters.k_means(MAX_ITERATIONS);
+
+        labelVector = clusters.points_to_clusters__;
     }
 
-    int size = matrix->getBitMatrix().getNumOfCols();
-    int position = 0;
+    nullCluster(matrix, labelVector);
+}
 
-    if( !dimension ){
 
-        Clustering::PointsSpace ps(num_points, num_dimensions, floatRowVectors );
-        Clustering::Clusters clusters(num_clusters, ps);
 
-        clusters.k_means();
+// k-medoids on the binary rows with Hamming or Jaccard distance
+void Ochiai_Dice_JaccardTestSuiteClusterPlugin::kMedoids(CCoverageMatrix *matrix, bool dimension){
 
-        RowIndexVector = clusters.points_to_clusters__;
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = matrix->getBitMatrix().getPackedRows(buffer);
 
-        for (std::vector<ClusterId>::iterator it = RowIndexVector.begin() ; it != RowIndexVector.end(); ++it){
-            if( matrix->getBitMatrix().getRow(IndexType(position)).count() > (size*_0cluster_limit/100) ){
-                *it = ClusterId(0); // add to 0cluster
-            } else {
-                *it = (*it)+1;
-            }
-            position++;
-        }
+    Clustering::BinaryPointsSpace ps(rows, CBitOperations::numOfWords(matrix->getBitMatrix().getNumOfCols()), m_jaccardDistance);
+    Clustering::Medoids medoids(cluster_number, ps, *m_pool);
 
-    } else {
+    medoids.k_medoids(m_seed, MAX_ITERATIONS);
 
-        Clustering::PointsSpace ps(num_points, num_dimensions, floatColsVectors );
-        Clustering::Clusters clusters(num_clusters, ps);
+    std::vector<ClusterId>& labelVector = dimension ? ColsIndexVector : RowIndexVector;
+    labelVector = medoids.points_to_clusters__;
 
-        clusters.k_means();
+    nullCluster(matrix, labelVector);
+}
 
-        ColsIndexVector = clusters.points_to_clusters__;
 
-        for (std::vector<ClusterId>::iterator it = ColsIndexVector.begin() ; it != ColsIndexVector.end(); ++it){
-            if( matrix->getBitMatrix().getRow(IndexType(position)).count() > (size*_0cluster_limit/100) ){
-                *it = ClusterId(0); // add to 0cluster
-            } else {
-                *it = (*it)+1;
-            }
-            position++;
-        }
-    }
 
+// the rows covering more than 0cluster(%) go to the 0cluster, the cluster ids of the others are shifted
+void Ochiai_Dice_JaccardTestSuiteClusterPlugin::nullCluster(CCoverageMatrix* matrix, std::vector<ClusterId>& labelVector){
 
+    int size = matrix->getBitMatrix().getNumOfCols();
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = matrix->getBitMatrix().getPackedRows(buffer);
+    IndexType numOfWords = CBitOperations::numOfWords(size);
+
+    for (IndexType position = 0 ; position < labelVector.size() ; position++){
+        if( CBitOperations::count(rows[position], numOfWords) > IndexType(size*_0cluster_limit/100) ){
+            labelVector[position] = ClusterId(0); // add to 0cluster
+        } else {
+            labelVector[position] = labelVector[position]+1;
+        }
+    }
 }
 
 
@@ -345,9 +419,7 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::matrixTranspose(CSelectionData &
 
     coverageMatrix->refitMatrixSize();
 
-    for(int i = 0 ; i < numCE ; i++)
-        for(int j = 0 ; j < numTC ; j++)
-            bitMatrix->set(i,j, data.getCoverage()->getBitMatrix().get(IndexType(j),IndexType(i)));
+    bitMatrix->transpose(data.getCoverage()->getBitMatrix(), *m_pool);
 
 }
 
@@ -384,83 +456,97 @@ void Ochiai_Dice_JaccardTestSuiteClusterPlugin::clusters(CCoverageMatrix* matrix
     int numTC = int(matrix->getNumOfTestcases());
     int numCE = int(matrix->getNumOfCodeElements());
 
-    if( !dimension ){
-        floatRowVectors.resize(numTC, std::vector<float>(numTC));
-    } else {
-        floatColsVectors.resize(numTC, std::vector<float>(numTC));
+    if( algorithm_index < 0 || algorithm_index > 2 ){
+        std::cout<<"Error"<<std::endl;
     }
 
-    for(int index_1 = 0 ; index_1 < numTC ; index_1++){
-        int element_1 = int( matrix->getBitMatrix().getRow(IndexType(index_1)).count() );
-
-        for(int index_2 = 0 ; index_2 < numTC ; index_2++ )
-            set_results(matrix, index_1, index_2, element_1, numCE, algorithm_index, dimension);
+    // packed rows and their number of 1 bits
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = matrix->getBitMatrix().getPackedRows(buffer);
+    IndexType numOfWords = CBitOperations::numOfWords(numCE);
+    std::vector<int> elements(numTC);
+    for(int index = 0 ; index < numTC ; index++ )
+        elements[index] = int(CBitOperations::count(rows[index], numOfWords));
+
+    if( m_topK > 0 ){
+
+        // only the top-k similarities of each row are kept, the rows are computed independently
+        std::vector<Clustering::SparsePoint>& sparseVectors = dimension ? sparseColsVectors : sparseRowVectors;
+        sparseVectors.assign(numTC, Clustering::SparsePoint());
+
+        IndexType k = std::min<IndexType>(m_topK, numTC);
+        IndexType numOfTasks = std::max<IndexType>(1, std::min<IndexType>(m_pool->getNumOfThreads(), numTC / MIN_ROWS_PER_TASK));
+        m_pool->run(numOfTasks, [&](IndexType task) {
+            Clustering::SparsePoint row(numTC);
+            for(int index_1 = task * numTC / numOfTasks ; index_1 < int((task + 1) * numTC / numOfTasks) ; index_1++ ){
+                for(int index_2 = 0 ; index_2 < numTC ; index_2++ ){
+                    int intersection = int(CBitOperations::countAnd(rows[index_1], rows[index_2], numOfWords));
+                    row[index_2] = Clustering::SparseCoord(index_2, results_vs_limit(similarity(intersection, elements[index_1], elements[index_2], algorithm_index), float(limit)));
+                }
 
-    }
+                std::nth_element(row.begin(), row.begin() + (k - 1), row.end(), moreSimilar);
 
-}
+                Clustering::SparsePoint& point = sparseVectors[index_1];
+                for(IndexType i = 0 ; i < k ; i++ )
+                    if( row[i].second != 0.0 ) point.push_back(row[i]);
+                std::sort(point.begin(), point.end());
+            }
+        });
 
-void Ochiai_Dice_JaccardTestSuiteClusterPlugin::set_results(CCoverageMatrix* matrix, int index_1, int index_2, int element_1, int numCE,  int algorithm_index, bool dimension){
+        return;
+    }
 
-    int element_2 = int(matrix->getBitMatrix().getRow(IndexType(index_2)).count());
+    std::vector< std::vector<float> >& vectors = dimension ? floatColsVectors : floatRowVectors;
+    vectors.assign(numTC, std::vector<float>(numTC));
+
+    // the matrix is symmetric, so a block of rows is compared to itself and to the following blocks only
+    IndexType numOfBlocks = (numTC + SIMILARITY_BLOCK_SIZE - 1) / SIMILARITY_BLOCK_SIZE;
+    m_pool->run(numOfBlocks, [&](IndexType block_1) {
+        int end_1 = int(std::min<IndexType>(numTC, (block_1 + 1) * SIMILARITY_BLOCK_SIZE));
+        for(IndexType block_2 = block_1 ; block_2 < numOfBlocks ; block_2++ ){
+            int end_2 = int(std::min<IndexType>(numTC, (block_2 + 1) * SIMILARITY_BLOCK_SIZE));
+            for(int index_1 = block_1 * SIMILARITY_BLOCK_SIZE ; index_1 < end_1 ; index_1++ ){
+                for(int index_2 = std::max<int>(index_1, block_2 * SIMILARITY_BLOCK_SIZE) ; index_2 < end_2 ; index_2++ ){
+                    int intersection = int(CBitOperations::countAnd(rows[index_1], rows[index_2], numOfWords));
+                    float results = results_vs_limit(similarity(intersection, elements[index_1], elements[index_2], algorithm_index), float(limit));
+                    vectors[index_1][index_2] = results;
+                    vectors[index_2][index_1] = results;
+                }
+            }
+        }
+    });
 
-    float* v_pointer;
+}
 
-    if( !dimension ){
-        v_pointer = floatRowVectors[index_1].data();
-    } else {
-        v_pointer = floatColsVectors[index_1].data();
-    }
+float Ochiai_Dice_JaccardTestSuiteClusterPlugin::similarity(int intersection, int element_1, int element_2, int algorithm_index){
 
     float results=0.0;
 
     if(algorithm_index==0){   // ochiai calc.
-        if( element_1*element_2 != 0 )
-            results = intersections(matrix, index_1, index_2, numCE) / (std::sqrt( element_1*element_2));
+        if( element_1 != 0 && element_2 != 0 )
+            results = intersection / (std::sqrt( double(element_1)*element_2));
 
     } else if(algorithm_index==1){    // dice calc.
         if( element_1+element_2 != 0 )
-            results = 2*intersections(matrix, index_1, index_2, numCE) / float(element_1+element_2);
+            results = 2*intersection / float(element_1+element_2);
 
     } else if(algorithm_index==2){    // jaccard calc.
-        int unions = unionsCalc(matrix, index_1, index_2, numCE);
+        int unions = element_1 + element_2 - intersection;
         if( unions != 0 )
-            results = intersections(matrix, index_1, index_2, numCE) / float(unions);
-
-    } else {
-        std::cout<<"Error"<<std::endl;
-        return;
+            results = intersection / float(unions);
     }
 
-    *(v_pointer+index_2) = results_vs_limit(results,float(limit)) ;
-
-}
-
-
-
-int Ochiai_Dice_JaccardTestSuiteClusterPlugin::intersections(CCoverageMatrix* matrix, int index_1, int index_2, int size){
-    int intersections = 0;
-    for(int a = 0 ; a < size ; a++)
-        intersections += int( matrix->getBitMatrix().get(IndexType(index_1),IndexType(a)) && matrix->getBitMatrix().get(IndexType(index_2),IndexType(a)) );
-
-    return intersections;
-}
-
-
-int Ochiai_Dice_JaccardTestSuiteClusterPlugin::unionsCalc(CCoverageMatrix* matrix, int index_1, int index_2, int size){
-    int unions = 0;
-    for(int a = 0 ; a < size ; a++)
-        unions += int( matrix->getBitMatrix().get(IndexType(index_1),IndexType(a)) || matrix->getBitMatrix().get(IndexType(index_2),IndexType(a)) );
-
-    return unions;
+    return results;
 }
 
 void Ochiai_Dice_JaccardTestSuiteClusterPlugin::matrixDensity(CCoverageMatrix* matrix){
 
     int size = matrix->getNumOfTestcases();
     int count = 0;
+    std::vector<WordType> buffer;
+    std::vector<const WordType*> rows = matrix->getBitMatrix().getPackedRows(buffer);
     for(int i = 0 ; i < size ; i++){
-        count += matrix->getBitMatrix().getRow(IndexType(i)).count();
+        count += CBitOperations::count(rows[i], CBitOperations::numOfWords(matrix->getNumOfCodeElements()));
     }
     std::cout<<"Matrix density: "<<float(count)/float((size*matrix->getNumOfCodeElements()))<<std::endl<<std::endl;
 }
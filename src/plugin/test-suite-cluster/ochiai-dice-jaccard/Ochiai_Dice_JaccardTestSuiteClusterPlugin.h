@@ -52,16 +52,16 @@ public:
 
     void clusters(CCoverageMatrix* matrix, int algorithm_index, bool dimension);
 
-    void set_results(CCoverageMatrix* matrix, int index_1, int index_2, int count_1, int element, int algorithm_index, bool dimension);
-
-    int intersections(CCoverageMatrix* matrix, int index_1, int index_2, int size);
-
-    int unionsCalc(CCoverageMatrix* matrix, int index_1, int index_2, int size);
+    float similarity(int intersection, int element_1, int element_2, int algorithm_index);
 
     float results_vs_limit( float results, float limit );
 
     void kMeans(CCoverageMatrix* matrix, bool dimension);
 
+    void kMedoids(CCoverageMatrix* matrix, bool dimension);
+
+    void nullCluster(CCoverageMatrix* matrix, std::vector<ClusterId>& labelVector);
+
     void setClusterList(int numTC, int numCE, std::map<std::string, CClusterDefinition>& clusterList);
 
     void matrixTranspose(CSelectionData &matrix, CCoverageMatrix* newMatrix, CBitMatrix* bitMatrix, int numTC, int numCE);
@@ -81,6 +81,10 @@ public:
     std::vector< std::vector<float> > floatRowVectors;
     std::vector< std::vector<float> > floatColsVectors;
 
+    // the top-k most similar elements of each row, used instead of the dense vectors if top-k is set
+    std::vector<Clustering::SparsePoint> sparseRowVectors;
+    std::vector<Clustering::SparsePoint> sparseColsVectors;
+
     std::vector<ClusterId> RowIndexVector;
     std::vector<ClusterId>  ColsIndexVector;
 
@@ -93,6 +97,11 @@ public:
     int _0cluster_limit;
     std::string testClusterDump;
     std::string codeElementsClusterDump;
+    int m_topK;                     // number of kept similarities per row, 0 means all
+    bool m_kMedoids;                // k-medoids on the binary rows instead of k-means on the similarities
+    bool m_jaccardDistance;         // Jaccard distance instead of Hamming distance for k-medoids
+    unsigned int m_seed;            // seed of the k-medoids initialization
+    CThreadPool* m_pool;            // threads of the similarities and the clustering, 1 by default
 
 };
 
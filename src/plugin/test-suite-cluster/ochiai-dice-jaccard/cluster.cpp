@@ -6,11 +6,34 @@
 
 
 
+#include <random>
+
 #include "cluster.hpp"
-#include "Ochiai_Dice_JaccardTestSuiteClusterPlugin.h"
+#include "util/CBitOperations.h"
+#include "util/CThreadPool.h"
+
+using soda::IndexType;
+using soda::CBitOperations;
+using soda::CThreadPool;
 
 namespace Clustering{
 
+  namespace {
+
+    //
+    // Minimal number of points processed by one task
+    //
+    const PointId MIN_POINTS_PER_TASK = 256;
+
+    //
+    // Number of tasks the points are split into
+    //
+    IndexType num_tasks(const CThreadPool & pool, PointId num_points){
+      return std::max<IndexType>(1, std::min<IndexType>(pool.getNumOfThreads(), num_points / MIN_POINTS_PER_TASK));
+    }
+
+  }
+
   //
   // Dump a point
   //
@@ -38,6 +61,37 @@ namespace Clustering{
     return total;  // no need to take sqrt, which is monotonic
   }
 
+  //
+  // distance between a centroid and a row of the similarity matrix
+  //
+  Distance distance(const Point& centroid, const DensePoint& p)
+  {
+    Distance total = 0.0;
+    Distance diff;
+
+    for(Dimensions i=0; i<centroid.size(); ++i){
+      diff = centroid[i] - Coord(p[i]);
+      total += (diff * diff);
+    }
+    return total;
+  }
+
+  //
+  // distance between a centroid and a sparse point:
+  // |c - p|^2 = |c|^2 + sum of ((c[i] - p[i])^2 - c[i]^2) over the non-zero coordinates of p
+  //
+  Distance distance(const Point& centroid, Distance centroid_norm, const SparsePoint& p)
+  {
+    Distance total = centroid_norm;
+    Distance diff;
+
+    BOOST_FOREACH(const SparsePoint::value_type& coord, p){
+      diff = centroid[coord.first] - Coord(coord.second);
+      total += (diff * diff) - centroid[coord.first] * centroid[coord.first];
+    }
+    return total;
+  }
+
   //
   // Dump collection of Points
   //
@@ -89,19 +143,31 @@ namespace Clustering{
   }
 
   //
-  // Init collection of points
-  //  
-  void PointsSpace::init_points( std::vector< std::vector<float> > floatVectors ) {
-
-      for(int a=0 ; a<floatVectors[0].size();a++){
-        Point p;
-        for (std::vector<float>::iterator it = floatVectors[a].begin() ; it != floatVectors[a].end(); ++it)
-            p.push_back( double(*it) );
+  // Add the coordinates of the point to sum
+  //
+  void PointsSpace::add_point(Point & sum, PointId pid) const {
 
-        points__.push_back(p);
+    if (sparse_points__ != NULL) {
+      BOOST_FOREACH(const SparsePoint::value_type& coord, (*sparse_points__)[pid]){
+        sum[coord.first] += coord.second;
+      }
+    } else {
+      const DensePoint& p = (*dense_points__)[pid];
+      for (Dimensions i=0; i<num_dimensions__; i++)
+        sum[i] += p[i];
     }
+  }
+
+  //
+  // Distance of the point from the centroid
+  //
+  Distance PointsSpace::distance(const Point & centroid, Distance centroid_norm, PointId pid) const {
 
-  }  
+    if (sparse_points__ != NULL)
+      return Clustering::distance(centroid, centroid_norm, (*sparse_points__)[pid]);
+
+    return Clustering::distance(centroid, (*dense_points__)[pid]);
+  }
 
   //
   // Zero centroids
@@ -120,72 +186,58 @@ namespace Clustering{
   //
   void Clusters::compute_centroids() {
 
-    
-    Dimensions i;
-    ClusterId cid = 0;
-    PointId num_points_in_cluster;
-    // For each centroid
-    BOOST_FOREACH(Centroids::value_type& centroid, centroids__){
+    // The centroids are independent, so they are computed in parallel
+    pool__.run(num_clusters__, [&](IndexType cid) {
 
-      num_points_in_cluster = 0;
+      Point& centroid = centroids__[cid];
+      PointId num_points_in_cluster = 0;
 
       // For earch PointId in this set
-      BOOST_FOREACH(SetPoints::value_type pid, 
-		    clusters_to_points__[cid]){
-	
-	Point p = ps__.getPoint(pid);
-	//std::cout << "(" << p << ")";
-	for (i=0; i<num_dimensions__; i++)
-	  centroid[i] += p[i];	
+      BOOST_FOREACH(SetPoints::value_type pid, clusters_to_points__[cid]){
+	ps__.add_point(centroid, pid);
 	num_points_in_cluster++;
       }
       //
       // if no point in the clusters, this goes to inf (correct!)
       //
-      for (i=0; i<num_dimensions__; i++)
-	centroid[i] /= num_points_in_cluster;	
-      cid++;
-    }
+      for (Dimensions i=0; i<num_dimensions__; i++)
+	centroid[i] /= num_points_in_cluster;
+
+      if (ps__.isSparse()){
+	Distance norm = 0.0;
+	BOOST_FOREACH(Point::value_type d, centroid){
+	  norm += d * d;
+	}
+	centroid_norms__[cid] = norm;
+      }
+    });
   }
 
   //
   // Initial partition points among available clusters
   //
   void Clusters::initial_partition_points(){
-    
+
     ClusterId cid;
-    
+
     for (PointId pid = 0; pid < ps__.getNumPoints(); pid++){
-      
+
       cid = pid % num_clusters__;
 
       points_to_clusters__[pid] = cid;
       clusters_to_points__[cid].insert(pid);
     }
-    
-
-    /**************************
-    std::cout << "Points_to_clusters " << std::endl;
-    std::cout << points_to_clusters__;
-    std::cout << "Clusters_to_points " << std::endl;
-    std::cout << clusters_to_points__;
-    ***************************/
-
-
   };
 
   //
   // k-means
   //
-  void Clusters::k_means(void){
-    
-    bool move;
+  void Clusters::k_means(unsigned int max_iterations){
+
     bool some_point_is_moving = true;
     unsigned int num_iterations = 0;
-    PointId pid;
-    ClusterId cid, to_cluster;
-    Distance d, min;
-    
+    PointsToClusters to_cluster(num_points__);
+    IndexType tasks = num_tasks(pool__, num_points__);
 
     //
     // Initial partition of points
@@ -195,81 +247,207 @@ namespace Clustering{
     //
     // Until not converge
     //
-    while (some_point_is_moving){
-
-     /*******************************
-      std::cout << std::endl << "*** Num Iterations "
-        << num_iterations  << std::endl << std::endl ;;
-     ********************************/
+    while (some_point_is_moving && (max_iterations == 0 || num_iterations < max_iterations)){
 
       some_point_is_moving = false;
 
       compute_centroids();
-      //      std::cout << "Centroids" << std::endl << centroids__;      
 
       //
-      // for each point
+      // for each point find the first closest centroid, the centroids do not change
+      // while the points are processed, so the points are split between the threads
+      //
+      pool__.run(tasks, [&](IndexType task) {
+	for (PointId pid = PointId(task * num_points__ / tasks); pid < PointId((task + 1) * num_points__ / tasks); pid++){
+
+	  // distance from current cluster
+	  ClusterId from_cluster = points_to_clusters__[pid];
+	  Distance min = ps__.distance(centroids__[from_cluster], centroid_norms__[from_cluster], pid);
+
+	  to_cluster[pid] = from_cluster;
+	  for (ClusterId cid = 0; cid < num_clusters__; cid++){
+	    Distance d = ps__.distance(centroids__[cid], centroid_norms__[cid], pid);
+	    if (d < min){
+	      min = d;
+	      to_cluster[pid] = cid;
+	    }
+	  }
+	}
+      });
+
+      //
+      // move towards a closer centroid
       //
-      for (pid=0; pid<num_points__; pid++){
-	
-	// distance from current cluster
-	min = 
-	  Clustering::distance(centroids__[points_to_clusters__[pid]], 
-			       ps__.getPoint(pid));
-
-    /***********************
-    std::cout << "pid[" << pid << "] in cluster="
-		  << points_to_clusters__[pid] 
-          << " with distance=" << min << std::endl;
-    ************************/
-
-	//
-	// foreach centroid
-	//
-	cid = 0; 
-	move = false;
-	BOOST_FOREACH(Centroids::value_type c, centroids__){
-	  
-
-	  d = Clustering::distance(c, ps__.getPoint(pid));
+      for (PointId pid=0; pid<num_points__; pid++){
+	if (to_cluster[pid] != points_to_clusters__[pid]){
+	  clusters_to_points__[points_to_clusters__[pid]].erase(pid);
+	  points_to_clusters__[pid] = to_cluster[pid];
+	  clusters_to_points__[to_cluster[pid]].insert(pid);
+	  some_point_is_moving = true;
+	}
+      }
+
+      num_iterations++;
+    } // end while (some_point_is_moving)
+  }
+
+  //
+  // Binary points
+  //
+  BinaryPointsSpace::BinaryPointsSpace(const std::vector<const soda::WordType*> & rows, IndexType num_words, bool jaccard)
+    : rows__(rows), num_words__(num_words), jaccard__(jaccard), counts__(rows.size()) {
+
+    for (PointId pid = 0; pid < rows__.size(); pid++)
+      counts__[pid] = CBitOperations::count(rows__[pid], num_words__);
+  }
+
+  //
+  // Hamming or Jaccard distance of two points
+  //
+  Distance BinaryPointsSpace::distance(PointId x, PointId y) const {
+
+    if (!jaccard__)
+      return Distance(CBitOperations::countXor(rows__[x], rows__[y], num_words__));
+
+    IndexType intersection = CBitOperations::countAnd(rows__[x], rows__[y], num_words__);
+    IndexType unions = counts__[x] + counts__[y] - intersection;
+    if (unions == 0)
+      return 0.0;
+
+    return 1.0 - Distance(intersection) / Distance(unions);
+  }
+
+  //
+  // k-means++ seeding: the first medoid is chosen uniformly, the next ones with
+  // probability proportional to the squared distance from the closest medoid
+  //
+  void Medoids::init_medoids(unsigned int seed){
+
+    medoids__.clear();
+    if (num_points__ == 0)
+      return;
+
+    std::mt19937 generator(seed);
+    IndexType tasks = num_tasks(pool__, num_points__);
+    std::vector<Distance> closest(num_points__);
+    std::vector<bool> is_medoid(num_points__, false);
+
+    PointId next = PointId(generator() % num_points__);
+    while (true){
+      medoids__.push_back(next);
+      is_medoid[next] = true;
+      if (medoids__.size() == std::min<PointId>(num_clusters__, num_points__))
+	break;
+
+      bool first = medoids__.size() == 1;
+      pool__.run(tasks, [&](IndexType task) {
+	for (PointId pid = PointId(task * num_points__ / tasks); pid < PointId((task + 1) * num_points__ / tasks); pid++){
+	  Distance d = ps__.distance(pid, next);
+	  if (first || d < closest[pid])
+	    closest[pid] = d;
+	}
+      });
+
+      Distance total = 0.0;
+      for (PointId pid = 0; pid < num_points__; pid++)
+	total += closest[pid] * closest[pid];
+
+      // every point equals to a medoid: the first point that is not a medoid is chosen
+      next = 0;
+      while (is_medoid[next])
+	next++;
+
+      if (total > 0.0){
+	// the generator gives 32 bit values, so the result is the same on each platform
+	Distance r = Distance(generator()) / 4294967296.0 * total;
+	Distance sum = 0.0;
+	for (PointId pid = 0; pid < num_points__; pid++){
+	  if (closest[pid] > 0.0){
+	    next = pid;
+	    sum += closest[pid] * closest[pid];
+	    if (r < sum)
+	      break;
+	  }
+	}
+      }
+    }
+  }
+
+  //
+  // Assign each point to the closest medoid, ties go to the lower cluster id
+  //
+  void Medoids::assign_points(){
+
+    IndexType tasks = num_tasks(pool__, num_points__);
+    pool__.run(tasks, [&](IndexType task) {
+      for (PointId pid = PointId(task * num_points__ / tasks); pid < PointId((task + 1) * num_points__ / tasks); pid++){
+	ClusterId to_cluster = 0;
+	Distance min = ps__.distance(pid, medoids__[0]);
+	for (ClusterId cid = 1; cid < medoids__.size(); cid++){
+	  Distance d = ps__.distance(pid, medoids__[cid]);
 	  if (d < min){
 	    min = d;
-	    move = true;
 	    to_cluster = cid;
-
-	    // remove from current cluster
-	    clusters_to_points__[points_to_clusters__[pid]].erase(pid);
-
-	    some_point_is_moving = true;
-        /********************************************
-        std::cout << "\tcluster=" << cid
-              << " closer, dist=" << d << std::endl;
-              ********************************************************/
 	  }
-	  cid++;
 	}
-	
-	//
-	// move towards a closer centroid 
-	//
-	if (move){
-	  
-	  // insert
-	  points_to_clusters__[pid] = to_cluster;
-	  clusters_to_points__[to_cluster].insert(pid);
-      //std::cout << "\t\tmove to cluster=" << to_cluster << std::endl;
+	points_to_clusters__[pid] = to_cluster;
+      }
+    });
+  }
+
+  //
+  // Select the member with the least total distance in each cluster
+  //
+  bool Medoids::update_medoids(){
+
+    std::vector<std::vector<PointId> > members(medoids__.size());
+    for (PointId pid = 0; pid < num_points__; pid++)
+      members[points_to_clusters__[pid]].push_back(pid);
+
+    // total distance of each point from the other members of its cluster
+    std::vector<Distance> cost(num_points__, 0.0);
+    IndexType tasks = num_tasks(pool__, num_points__);
+    pool__.run(tasks, [&](IndexType task) {
+      for (PointId pid = PointId(task * num_points__ / tasks); pid < PointId((task + 1) * num_points__ / tasks); pid++){
+	BOOST_FOREACH(PointId other, members[points_to_clusters__[pid]]){
+	  cost[pid] += ps__.distance(pid, other);
 	}
-      }      
+      }
+    });
 
-      num_iterations++;
-    } // end while (some_point_is_moving)
+    bool changed = false;
+    for (ClusterId cid = 0; cid < medoids__.size(); cid++){
+
+      // the current medoid is kept on ties, so the total cost decreases at each change
+      Distance min = 0.0;
+      BOOST_FOREACH(PointId other, members[cid]){
+	min += ps__.distance(medoids__[cid], other);
+      }
 
-    //std::cout << std::endl << "Final clusters" << std::endl;
-    //std::cout << clusters_to_points__;
+      BOOST_FOREACH(PointId pid, members[cid]){
+	if (cost[pid] < min){
+	  min = cost[pid];
+	  medoids__[cid] = pid;
+	  changed = true;
+	}
+      }
+    }
 
+    return changed;
+  }
+
+  //
+  // k-medoids
+  //
+  void Medoids::k_medoids(unsigned int seed, unsigned int max_iterations){
 
+    init_medoids(seed);
+    if (medoids__.empty())
+      return;
 
+    assign_points();
+    for (unsigned int num_iterations = 0; num_iterations < max_iterations && update_medoids(); num_iterations++)
+      assign_points();
   }
 
-  
 };
@@ -9,12 +9,14 @@
 
 #include <set>
 #include <vector>
+#include <utility>
 #include <iostream>
 
 #include <boost/unordered_map.hpp>
 #include <boost/foreach.hpp>
 
-#include "Ochiai_Dice_JaccardTestSuiteClusterPlugin.h"
+#include "data/SoDALibDefs.h"
+#include "util/CThreadPool.h"
 
 namespace Clustering{
 
@@ -27,12 +29,16 @@ namespace Clustering{
   typedef std::vector<Coord> Point;    // a point (a centroid)
   typedef std::vector<Point> Points;   // collection of points
 
+  typedef std::vector<float> DensePoint;          // a row of the similarity matrix
+  typedef std::pair<PointId, float> SparseCoord;  // (dimension, value) of a non-zero coordinate
+  typedef std::vector<SparseCoord> SparsePoint;   // the non-zero coordinates ordered by dimension
+
   typedef std::set<PointId> SetPoints; // set of points
-  
+
   // ClusterId -> (PointId, PointId, PointId, .... )
   typedef std::vector<SetPoints> ClustersToPoints;
   // PointId -> ClusterId
-  typedef std::vector<ClusterId> PointsToClusters; 
+  typedef std::vector<ClusterId> PointsToClusters;
   // coll of centroids
   typedef std::vector<Point> Centroids;
 
@@ -46,6 +52,16 @@ namespace Clustering{
   //
   Distance distance(const Point & x, const Point & y);
 
+  //
+  // distance between a centroid and a row of the similarity matrix
+  //
+  Distance distance(const Point & centroid, const DensePoint & p);
+
+  //
+  // distance between a centroid and a sparse point, centroid_norm is the squared length of the centroid
+  //
+  Distance distance(const Point & centroid, Distance centroid_norm, const SparsePoint & p);
+
   //
   // Dump collection of Points
   //
@@ -55,12 +71,12 @@ namespace Clustering{
   // Dump a Set of points
   //
   std::ostream& operator << (std::ostream& os, SetPoints & sp);
-    
+
   //
   // Dump centroids
   //
   std::ostream& operator << (std::ostream& os, Centroids & cp);
-  
+
 
   //
   // Dump ClustersToPoints
@@ -74,62 +90,58 @@ namespace Clustering{
 
 
   //
-  // This class stores all the points available in the model
+  // This class stores all the points available in the model,
+  // the points are referenced, not copied
   //
   class PointsSpace{
 
-    //
-    // Dump collection of points
-    //
-    friend std::ostream& operator << (std::ostream& os, PointsSpace & ps){
-
-      PointId i = 0;
-      BOOST_FOREACH(Points::value_type p, ps.points__){
-    /***************
-     os << "point["<<i++<<"]=" << p << std::endl;
-     *******************/
-      }
-
-      return os;
-    };
-
   public:
 
-    PointsSpace(PointId num_points, Dimensions num_dimensions, std::vector< std::vector<float> > floatVectors )
-      : num_points__(num_points), num_dimensions__(num_dimensions), floatVectors__(floatVectors)
-    { init_points(floatVectors);};
+    PointsSpace(PointId num_points, Dimensions num_dimensions, const std::vector<DensePoint> & points)
+      : num_points__(num_points), num_dimensions__(num_dimensions), dense_points__(&points), sparse_points__(NULL)
+    {};
+
+    PointsSpace(PointId num_points, Dimensions num_dimensions, const std::vector<SparsePoint> & points)
+      : num_points__(num_points), num_dimensions__(num_dimensions), dense_points__(NULL), sparse_points__(&points)
+    {};
 
     inline const PointId getNumPoints() const {return num_points__;}
     inline const PointId getNumDimensions() const {return num_dimensions__;}
-    inline const Point& getPoint(PointId pid) const { return points__[pid];}
- 
+    inline bool isSparse() const {return sparse_points__ != NULL;}
+
     //
-    // Init collection of points
+    // Add the coordinates of the point to sum
     //
-    void init_points(std::vector< std::vector<float> > floatVectors__);
+    void add_point(Point & sum, PointId pid) const;
 
-  private:  
+    //
+    // Distance of the point from the centroid
+    //
+    Distance distance(const Point & centroid, Distance centroid_norm, PointId pid) const;
+
+  private:
     PointId num_points__;
     Dimensions num_dimensions__;
-    Points points__;
-    std::vector< std::vector<float> > floatVectors__;
-
+    const std::vector<DensePoint>* dense_points__;
+    const std::vector<SparsePoint>* sparse_points__;
 
   };
 
-  // 
+  //
   //  This class represents a cluster
-  // 
+  //
   class Clusters {
 
   private:
-   
+
     ClusterId num_clusters__;    // number of clusters
     PointsSpace& ps__;           // the point space
     Dimensions num_dimensions__; // the dimensions of vectors
     PointId num_points__;        // total number of points
+    soda::CThreadPool& pool__;   // the threads of the clustering run
     ClustersToPoints clusters_to_points__;
     Centroids centroids__;
+    std::vector<Distance> centroid_norms__; // squared length of the centroids, used for sparse points
 
   public:
     PointsToClusters points_to_clusters__;
@@ -138,74 +150,106 @@ namespace Clustering{
     //
     // Zero centroids
     //
-    void zero_centroids();     
+    void zero_centroids();
 
     //
     // Zero centroids
     //
-    void compute_centroids();     
-    
+    void compute_centroids();
+
     //
     // Initial partition points among available clusters
     //
     void initial_partition_points();
 
   public:
-   
-    //
-    // Dump ClustersToPoints
-    //
-    friend std::ostream& operator << (std::ostream& os, Clusters & cl){
-      
-      ClusterId cid = 0;
-      BOOST_FOREACH(ClustersToPoints::value_type set, cl.clusters_to_points__){
-    //os << "Cluster["<<cid<<"]=(";
-	BOOST_FOREACH(SetPoints::value_type pid, set){
-	  Point p = cl.ps__.getPoint(pid);
-      //os << "(" << p << ")";
-	}
-    //os << ")" << std::endl;
-	cid++;
-      }
-      return os;
-    }
-    
-
-    Clusters(ClusterId num_clusters, PointsSpace & ps) 
-      : num_clusters__(num_clusters), ps__(ps), 
+
+    Clusters(ClusterId num_clusters, PointsSpace & ps, soda::CThreadPool & pool)
+      : num_clusters__(num_clusters), ps__(ps),
 	num_dimensions__(ps.getNumDimensions()),
 	num_points__(ps.getNumPoints()),
+	pool__(pool),
+	clusters_to_points__(num_clusters),
+	centroids__(num_clusters, Point(num_dimensions__, 0.0)),
+	centroid_norms__(num_clusters, 0.0),
 	points_to_clusters__(num_points__, 0){
+    };
 
-      ClusterId i = 0;
-      Dimensions dim;
-      for (; i < num_clusters; i++){
-	Point point;   // each centroid is a point
-	for (dim=0; dim<num_dimensions__; dim++) 
-	  point.push_back(0.0);
-	SetPoints set_of_points;
-
-	// init centroids
-	centroids__.push_back(point);  
-
-	// init clusterId -> set of points
-	clusters_to_points__.push_back(set_of_points);
-	// init point <- cluster
-      }
-      /*
-      std::cout << "Centroids" 
-		<<std::endl<< centroids__;
-      std::cout << "PointsToClusters" 
-        <<std::endl<< points_to_clusters__;
-      std::cout << "ClustersToPoints" 
-        <<std::endl<< clusters_to_points__;*/
+    //
+    // k-means, stops after max_iterations iterations if it is not 0
+    //
+    void k_means (unsigned int max_iterations = 0);
+  };
+
+
+  //
+  // This class stores binary points, the packed rows of a bit matrix
+  //
+  class BinaryPointsSpace{
 
+  public:
+
+    BinaryPointsSpace(const std::vector<const soda::WordType*> & rows, soda::IndexType num_words, bool jaccard);
+
+    inline const PointId getNumPoints() const {return PointId(rows__.size());}
+
+    //
+    // Hamming distance or Jaccard distance (1 - |x & y| / |x | y|) of two points
+    //
+    Distance distance(PointId x, PointId y) const;
+
+  private:
+    const std::vector<const soda::WordType*>& rows__;
+    soda::IndexType num_words__;
+    bool jaccard__;
+    std::vector<soda::IndexType> counts__;
+
+  };
+
+  //
+  //  This class represents clusters around medoids
+  //
+  class Medoids {
+
+  private:
+
+    ClusterId num_clusters__;    // number of clusters
+    const BinaryPointsSpace& ps__;
+    PointId num_points__;        // total number of points
+    soda::CThreadPool& pool__;   // the threads of the clustering run
+    std::vector<PointId> medoids__;
+
+    //
+    // k-means++ seeding of the medoids
+    //
+    void init_medoids(unsigned int seed);
+
+    //
+    // Assign each point to the closest medoid
+    //
+    void assign_points();
+
+    //
+    // Select the member with the least total distance in each cluster, returns false if no medoid changed
+    //
+    bool update_medoids();
+
+  public:
+    PointsToClusters points_to_clusters__;
+
+    Medoids(ClusterId num_clusters, const BinaryPointsSpace & ps, soda::CThreadPool & pool)
+      : num_clusters__(num_clusters), ps__(ps),
+	num_points__(ps.getNumPoints()),
+	pool__(pool),
+	points_to_clusters__(num_points__, 0){
     };
-    
+
+    inline const std::vector<PointId>& getMedoids() const {return medoids__;}
+
     //
-    // k-means
+    // k-medoids, the same seed gives the same clusters
     //
-    void k_means (void);
+    void k_medoids(unsigned int seed, unsigned int max_iterations);
   };
 
 };
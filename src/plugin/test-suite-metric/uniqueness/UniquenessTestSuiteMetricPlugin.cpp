@@ -50,8 +50,9 @@ void UniquenessTestSuiteMetricPlugin::calculate(rapidjson::Document &results)
 
     std::cout << std::endl;
 
+    const IBitList& executed = m_data->getResults()->getExecutionBitList(m_revision);
     for (IndexType i = 0; i < nrOfTestcases; i++) {
-        tcMap[i] = m_data->getResults()->getExecutionBitList(m_revision).at(i);
+        tcMap[i] = executed.at(i);
     }
 
 
@@ -37,14 +37,18 @@ AdditionalGeneralIgnorePrioritizationPlugin::AdditionalGeneralIgnorePrioritizati
         m_nofElementsReady(0),
         m_elementsReady(NULL),
         m_priorityQueue(new std::vector<qelement>()),
-        m_notCoveredCEIDs(new std::list<IndexType>())
+        m_notCoveredCEs(new std::vector<WordType>()),
+        m_rows(new std::vector<WordType>()),
+        m_nofWords(0),
+        m_coverageVersion(0)
 {}
 
 AdditionalGeneralIgnorePrioritizationPlugin::~AdditionalGeneralIgnorePrioritizationPlugin()
 {
     delete m_priorityQueue;
     delete m_elementsReady;
-    delete m_notCoveredCEIDs;
+    delete m_notCoveredCEs;
+    delete m_rows;
     m_elementsReady = NULL;
     m_nofElementsReady = 0;
 }
@@ -72,28 +76,46 @@ void AdditionalGeneralIgnorePrioritizationPlugin::setState(IntVector &ordered)
     m_elementsReady = new IntVector(ordered);
     m_priorityQueue->clear();
     m_nofElementsReady = ordered.size();
-    m_notCoveredCEIDs->clear();
-
+    m_coverageVersion = 0;
 
     IndexType nofTestcases = m_data->getCoverage()->getNumOfTestcases();
     IndexType nofCodeElements = m_data->getCoverage()->getNumOfCodeElements();
     const IBitMatrix& coverageBitMatrix = m_data->getCoverage()->getBitMatrix();
 
-    // Initialize the not covered code element list
-    for (IndexType ceid = 0; ceid < nofCodeElements; ceid++) {
-        m_notCoveredCEIDs->push_back(ceid);
+    // Copy the rows if the matrix is not word-packed
+    m_nofWords = CBitOperations::numOfWords(nofCodeElements);
+    m_rows->clear();
+    if (nofTestcases > 0 && coverageBitMatrix.getRowWords(0) == NULL) {
+        m_rows->resize(nofTestcases * m_nofWords);
+        for (IndexType tcid = 0; tcid < nofTestcases; tcid++) {
+            coverageBitMatrix.copyRowWords(tcid, m_rows->data() + tcid * m_nofWords);
+        }
+    }
+
+    // Initialize the not covered code elements
+    m_notCoveredCEs->assign(m_nofWords, ~WordType(0));
+    if (m_nofWords > 0) {
+        m_notCoveredCEs->back() &= CBitOperations::lastWordMask(nofCodeElements);
     }
 
     // Fill the priority queue with the remaining tests
+    std::vector<bool> isReady(nofTestcases, false);
+    for (IntVector::iterator it = ordered.begin(); it != ordered.end(); it++) {
+        if (*it < nofTestcases) {
+            isReady[*it] = true;
+        }
+    }
     for (IndexType tcid = 0; tcid < nofTestcases; tcid++) {
-        if (std::find(m_elementsReady->begin(), m_elementsReady->end(), tcid) != m_elementsReady->end()) {
+        if (isReady[tcid]) {
             continue;
         }
         qelement d;
         d.testcaseId    = tcid;
-        d.priorityValue = coverageBitMatrix.getRow(tcid).count();
+        d.priorityValue = CBitOperations::count(getRowWords(tcid), m_nofWords);
+        d.version       = m_coverageVersion;
         m_priorityQueue->push_back(d);
     }
+    std::make_heap(m_priorityQueue->begin(), m_priorityQueue->end());
 
     // Update the prioritization values based on the received test list
     for (IntVector::iterator it = ordered.begin(); it != ordered.end(); it++) {
@@ -138,7 +160,18 @@ IndexType AdditionalGeneralIgnorePrioritizationPlugin::next()
     if (m_priorityQueue->empty()) {
         throw std::out_of_range("There are not any testcases left.");
     }
-    sort(m_priorityQueue->begin(), m_priorityQueue->end());
+
+    // Recompute the outdated value at the top until the top is up to date. The values of the
+    // other tests are upper bounds of their current values, so the top is the best test.
+    while (m_priorityQueue->front().version != m_coverageVersion) {
+        std::pop_heap(m_priorityQueue->begin(), m_priorityQueue->end());
+        qelement& top = m_priorityQueue->back();
+        top.priorityValue = CBitOperations::countAnd(getRowWords(top.testcaseId), m_notCoveredCEs->data(), m_nofWords);
+        top.version = m_coverageVersion;
+        std::push_heap(m_priorityQueue->begin(), m_priorityQueue->end());
+    }
+
+    std::pop_heap(m_priorityQueue->begin(), m_priorityQueue->end());
     qelement nxt = m_priorityQueue->back();
     m_priorityQueue->pop_back();
     m_elementsReady->push_back(nxt.testcaseId);
@@ -153,20 +186,23 @@ IndexType AdditionalGeneralIgnorePrioritizationPlugin::next()
 
 void AdditionalGeneralIgnorePrioritizationPlugin::updateData(IndexType tcid)
 {
-    const IBitMatrix& coverageBitMatrix = m_data->getCoverage()->getBitMatrix();
-    for (std::list<IndexType>::iterator ceit = m_notCoveredCEIDs->begin(); ceit != m_notCoveredCEIDs->end();) {
-        if (coverageBitMatrix[tcid][*ceit]) {
-            register IndexType ceid = *ceit;
-            m_notCoveredCEIDs->erase(ceit++);
-            for (std::vector<qelement>::iterator qi = m_priorityQueue->begin(); qi != m_priorityQueue->end(); ++qi) {
-                if (coverageBitMatrix[qi->testcaseId][ceid]) {
-                    qi->priorityValue--;
-                }
-            }
-        } else {
-            ++ceit;
-        }
+    if (tcid >= m_data->getCoverage()->getNumOfTestcases()) {
+        return;
+    }
+    const WordType* row = getRowWords(tcid);
+    if (CBitOperations::countAnd(row, m_notCoveredCEs->data(), m_nofWords) == 0) {
+        return;
+    }
+    CBitOperations::bitwiseAndNot(m_notCoveredCEs->data(), m_notCoveredCEs->data(), row, m_nofWords);
+    m_coverageVersion++;
+}
+
+const WordType* AdditionalGeneralIgnorePrioritizationPlugin::getRowWords(IndexType tcid) const
+{
+    if (!m_rows->empty()) {
+        return m_rows->data() + tcid * m_nofWords;
     }
+    return m_data->getCoverage()->getBitMatrix().getRowWords(tcid);
 }
 
 extern "C" MSDLL_EXPORT void registerPlugin(CKernel &kernel)
@@ -24,6 +24,7 @@
 
 #include "data/CSelectionData.h"
 #include "engine/CKernel.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
@@ -35,7 +36,10 @@ class AdditionalGeneralIgnorePrioritizationPlugin : public ITestSuitePrioritizat
 private:
     typedef struct {
         IndexType testcaseId;
+        // Number of the not yet covered code elements covered by the test when it was last computed.
         IndexType priorityValue;
+        // Value of m_coverageVersion when the priority value was computed.
+        IndexType version;
     } qelement;
     friend bool operator<(qelement d1, qelement d2);
 
@@ -94,6 +98,12 @@ private:
      * @param tcid The id of the test
      */
     void updateData(IndexType tcid);
+
+    /**
+     * @brief Returns the packed coverage row of the given test.
+     * @param tcid The id of the test
+     */
+    const WordType* getRowWords(IndexType tcid) const;
 private:
 
     /**
@@ -112,14 +122,31 @@ private:
     IntVector* m_elementsReady;
 
     /**
-     * @brief Priority queue.
+     * @brief Priority queue, a max-heap of the remaining tests. The priority values are
+     *        recomputed lazily: the additional coverage of a test can only decrease, so
+     *        a value is updated only when its test gets to the top of the heap.
      */
     std::vector<qelement>* m_priorityQueue;
 
     /**
-     * @brief List of not covered code element ids.
+     * @brief Bits of the not covered code elements.
+     */
+    std::vector<WordType>* m_notCoveredCEs;
+
+    /**
+     * @brief Packed copy of the coverage rows if the coverage matrix does not store them.
+     */
+    std::vector<WordType>* m_rows;
+
+    /**
+     * @brief Number of words of a coverage row.
+     */
+    IndexType m_nofWords;
+
+    /**
+     * @brief Incremented whenever code elements become covered.
      */
-    std::list<IndexType>* m_notCoveredCEIDs;
+    IndexType m_coverageVersion;
 };
 
 } /* namespace soda */
@@ -39,7 +39,8 @@ PartitionMetricPrioritizationPlugin::PartitionMetricPrioritizationPlugin():
         m_elementsReady(NULL),
         m_elementsRemaining(NULL),
         m_priorityQueue(new std::vector<qelement>()),
-        m_currentCluster(new CClusterDefinition())
+        m_currentCluster(new CClusterDefinition()),
+        m_numOfThreads(1)
 {}
 
 PartitionMetricPrioritizationPlugin::~PartitionMetricPrioritizationPlugin()
@@ -62,6 +63,11 @@ String PartitionMetricPrioritizationPlugin::getDescription()
     return "Prioritize the tests based on the best partition metric value";
 }
 
+void PartitionMetricPrioritizationPlugin::setNumOfThreads(unsigned int numOfThreads)
+{
+    m_numOfThreads = numOfThreads;
+}
+
 void PartitionMetricPrioritizationPlugin::init(CSelectionData *data, CKernel *kernel)
 {
     m_data = data;
@@ -155,7 +161,7 @@ double PartitionMetricPrioritizationPlugin::partitionMetric(IndexType tcid)
     m_currentCluster->addTestCase(tcid);
 
     CPartitionAlgorithm algorithm;
-    algorithm.compute(*m_data, *m_currentCluster);
+    algorithm.compute(*m_data, *m_currentCluster, m_numOfThreads);
 
     CPartitionAlgorithm::PartitionInfo &partitionInfo = algorithm.getPartitionInfo();
     CPartitionAlgorithm::PartitionData &partitions = algorithm.getPartitions();
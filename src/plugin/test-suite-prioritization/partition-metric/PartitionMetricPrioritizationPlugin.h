@@ -65,6 +65,12 @@ public:
      */
     void init(CSelectionData *, CKernel *);
 
+    /**
+     * @brief Sets the number of threads computing the partitions, the default is 1.
+     * @param numOfThreads Number of threads, 0 means the number of hardware threads.
+     */
+    void setNumOfThreads(unsigned int numOfThreads);
+
     /**
      * @brief Gets the first n prioritized testcases.
      * @param selected The result vector.
@@ -121,6 +127,11 @@ private:
      * @brief Vector of remaining elements.
      */
     IntVector* m_elementsRemaining;
+
+    /**
+     * @brief Number of threads computing the partitions.
+     */
+    unsigned int m_numOfThreads;
 };
 
 } /* namespace soda */
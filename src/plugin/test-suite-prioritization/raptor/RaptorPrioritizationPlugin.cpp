@@ -23,6 +23,7 @@
 #include <chrono>
 #include <stdexcept>
 #include "RaptorPrioritizationPlugin.h"
+#include "util/CBitOperations.h"
 
 namespace soda {
 
@@ -40,16 +41,23 @@ RaptorPrioritizationPlugin::RaptorPrioritizationPlugin():
         m_nofElementsReady(0),
         m_elementsReady(NULL),
         m_elementsRemaining(NULL),
-        m_currentCluster(new CClusterDefinition()),
+        m_partition(new CPartitionRefinement()),
+        m_rows(new std::vector<WordType>()),
+        m_nofWords(0),
         m_currentAmbiguity(0.0),
         m_priorityQueue(new std::vector<qelement>()),
-        m_recursionLevel(0)
+        m_recursionLevel(0),
+        m_pool(new CThreadPool(1))
 {}
 
 RaptorPrioritizationPlugin::~RaptorPrioritizationPlugin()
 {
     delete m_priorityQueue;
     delete m_elementsReady;
+    delete m_elementsRemaining;
+    delete m_partition;
+    delete m_rows;
+    delete m_pool;
     m_elementsReady = NULL;
     m_nofElementsReady = 0;
 }
@@ -64,10 +72,28 @@ String RaptorPrioritizationPlugin::getDescription()
     return "RAPTOR algorithm by Gonzalez-Sanchez, Abreu, Gross and Gemund.";
 }
 
+void RaptorPrioritizationPlugin::setNumOfThreads(unsigned int numOfThreads)
+{
+    delete m_pool;
+    m_pool = new CThreadPool(numOfThreads);
+}
+
 void RaptorPrioritizationPlugin::init(CSelectionData *data, CKernel *kernel)
 {
     m_data = data;
-    m_currentCluster->addCodeElements(m_data->getCodeElements()->getIDList());
+
+    // Copy the rows if the matrix is not word-packed
+    IndexType nofTestcases = m_data->getCoverage()->getNumOfTestcases();
+    const IBitMatrix& coverageBitMatrix = m_data->getCoverage()->getBitMatrix();
+    m_nofWords = CBitOperations::numOfWords(m_data->getCoverage()->getNumOfCodeElements());
+    m_rows->clear();
+    if (nofTestcases > 0 && coverageBitMatrix.getRowWords(0) == NULL) {
+        m_rows->resize(nofTestcases * m_nofWords);
+        for (IndexType tcid = 0; tcid < nofTestcases; tcid++) {
+            coverageBitMatrix.copyRowWords(tcid, m_rows->data() + tcid * m_nofWords);
+        }
+    }
+
     IntVector initial;
     setState(initial);
 }
@@ -84,20 +110,29 @@ void RaptorPrioritizationPlugin::setState(IntVector &ordered)
     m_elementsReady = new IntVector(ordered);
     m_elementsRemaining = new IntVector();
     IndexType nofTestcases = m_data->getCoverage()->getNumOfTestcases();
+    std::vector<bool> isReady(nofTestcases, false);
+    for (IntVector::iterator it = ordered.begin(); it != ordered.end(); it++) {
+        if (*it < nofTestcases) {
+            isReady[*it] = true;
+        }
+    }
     for(IndexType tcid = 0; tcid < nofTestcases; tcid++) {
-        if (std::find(m_elementsReady->begin(), m_elementsReady->end(), tcid) == m_elementsReady->end()) {
+        if (!isReady[tcid]) {
             m_elementsRemaining->push_back(tcid);
         }
     }
 
-    m_currentCluster->clearTestCases();
-    m_currentCluster->addTestCases(ordered);
+    m_partition->reset(m_data->getCoverage()->getNumOfCodeElements());
+    for (IntVector::iterator it = ordered.begin(); it != ordered.end(); it++) {
+        if (*it < nofTestcases) {
+            m_partition->refine(getRowWords(*it));
+        }
+    }
 
     m_nofElementsReady = ordered.size();
     m_priorityQueue->clear();
 
-    IndexType nofCodeElements = m_data->getCoverage()->getNumOfCodeElements();
-    m_currentAmbiguity = (double) (nofCodeElements - 1) / 2.0;
+    m_currentAmbiguity = ambiguity(m_partition->getNumOfPairs());
     m_recursionLevel = 0;
 }
 
@@ -139,15 +174,14 @@ IndexType RaptorPrioritizationPlugin::next()
     qelement d = m_priorityQueue->back();
     if (d.ambiguityReduction > 0) {
         m_priorityQueue->pop_back();
-        m_currentCluster->addTestCase(d.testcaseId);
+        m_partition->refine(getRowWords(d.testcaseId));
         m_currentAmbiguity = d.diagnosticAmbiguity;
         tcid = d.testcaseId;
         m_recursionLevel = 0;
     } else if (m_recursionLevel == 0) {
         // Reset the internal state and prioritize again
-        m_currentCluster->clearTestCases();
-        IndexType nofCodeElements = m_data->getCoverage()->getNumOfCodeElements();
-        m_currentAmbiguity = (double) (nofCodeElements - 1) / 2.0;
+        m_partition->reset(m_data->getCoverage()->getNumOfCodeElements());
+        m_currentAmbiguity = ambiguity(m_partition->getNumOfPairs());
         // Call recursively
         // std::cerr << "[RAPTOR] Recursive call" << std::endl;
         m_recursionLevel++;
@@ -164,66 +198,53 @@ IndexType RaptorPrioritizationPlugin::next()
         m_elementsReady->push_back(tcid);
         m_nofElementsReady++;
     }
-    CClusterDefinition globalCluster;
-    globalCluster.addCodeElements(m_data->getCoverage()->getCodeElements().getIDList());
-    globalCluster.addTestCases(*m_elementsReady);
 
     return tcid;
 }
 
 void RaptorPrioritizationPlugin::prioritize()
 {
-    m_priorityQueue->clear();
-
-    for (IndexType i = 0; i < m_elementsRemaining->size(); i++) {
-        double extended = diagnosticAmbiguity(m_elementsRemaining->at(i));
-
-        qelement d;
-        d.testcaseId = m_elementsRemaining->at(i);
-        d.ambiguityReduction = m_currentAmbiguity - extended;
-        d.diagnosticAmbiguity = extended;
-        m_priorityQueue->push_back(d);
-    }
+    IndexType nofCandidates = m_elementsRemaining->size();
+    m_priorityQueue->resize(nofCandidates);
+
+    // The candidates are evaluated on the same partition in contiguous chunks.
+    IndexType nofChunks = std::min<IndexType>(m_pool->getNumOfThreads(), nofCandidates);
+    m_pool->run(nofChunks, [&](IndexType chunk) {
+        IntVector counts;
+        for (IndexType i = chunk * nofCandidates / nofChunks; i < (chunk + 1) * nofCandidates / nofChunks; i++) {
+            double extended = diagnosticAmbiguity(m_elementsRemaining->at(i), counts);
+
+            qelement &d = (*m_priorityQueue)[i];
+            d.testcaseId = m_elementsRemaining->at(i);
+            d.ambiguityReduction = m_currentAmbiguity - extended;
+            d.diagnosticAmbiguity = extended;
+        }
+    });
 
     sort(m_priorityQueue->begin(), m_priorityQueue->end());
 }
 
-double RaptorPrioritizationPlugin::diagnosticAmbiguity(IndexType tcid)
+double RaptorPrioritizationPlugin::diagnosticAmbiguity(IndexType tcid, IntVector &counts)
 {
-    m_currentCluster->addTestCase(tcid);
-    CPartitionAlgorithm algorithm;
-    algorithm.compute(*m_data, *m_currentCluster);
-    m_currentCluster->removeTestCase(tcid);
-    return ambiguity(algorithm);
+    return ambiguity(m_partition->getNumOfPairsIfRefined(getRowWords(tcid), counts));
 }
 
-double RaptorPrioritizationPlugin::ambiguity(CPartitionAlgorithm &partition)
+double RaptorPrioritizationPlugin::ambiguity(IndexType nofPairs)
 {
+    // The sum of size / |C| * (size - 1) / 2 over the partitions.
     IndexType nofCodeElements = m_data->getCoverage()->getNumOfCodeElements();
-    double ambiguity = 0.0;
-    CPartitionAlgorithm::PartitionData &partitionData = partition.getPartitions();
-    for (CPartitionAlgorithm::PartitionData::iterator partIt = partitionData.begin(); partIt != partitionData.end(); partIt++) {
-        IndexType size = partIt->second.size();
-        //std::cerr << "[Raptor] " << "Size partition(" << partIt->first << "): " << size << std::endl;
-        ambiguity += ((double)size / nofCodeElements) * (((double)size - 1.0) / 2.0);
+    if (nofCodeElements == 0) {
+        return 0.0;
     }
-    return ambiguity;
-
+    return (double)nofPairs / nofCodeElements;
 }
 
-double RaptorPrioritizationPlugin::raptorMetric(CClusterDefinition &cluster)
+const WordType* RaptorPrioritizationPlugin::getRowWords(IndexType tcid) const
 {
-    CPartitionAlgorithm partition;
-    partition.compute(*m_data, cluster);
-    IndexType nofCodeElements = m_data->getCoverage()->getNumOfCodeElements();
-    double ambiguity = 0.0;
-    CPartitionAlgorithm::PartitionData &partitionData = partition.getPartitions();
-    for (CPartitionAlgorithm::PartitionData::iterator partIt = partitionData.begin(); partIt != partitionData.end(); partIt++) {
-        IndexType size = partIt->second.size();
-        //std::cerr << "[Raptor] " << "Size partition(" << partIt->first << "): " << size << std::endl;
-        ambiguity += ((double)size / nofCodeElements) * (((double)size - 1.0) / 2.0);
+    if (!m_rows->empty()) {
+        return m_rows->data() + tcid * m_nofWords;
     }
-    return ambiguity;
+    return m_data->getCoverage()->getBitMatrix().getRowWords(tcid);
 }
 
 extern "C" MSDLL_EXPORT void registerPlugin(CKernel &kernel)
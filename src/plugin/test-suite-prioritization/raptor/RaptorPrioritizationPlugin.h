@@ -22,10 +22,10 @@
 #ifndef RAPTORPRIORITIZATIONPLUGIN_H
 #define RAPTORPRIORITIZATIONPLUGIN_H
 
-#include "algorithm/CPartitionAlgorithm.h"
+#include "algorithm/CPartitionRefinement.h"
 #include "data/CSelectionData.h"
-#include "data/CClusterDefinition.h"
 #include "engine/CKernel.h"
+#include "util/CThreadPool.h"
 
 namespace soda {
 
@@ -68,6 +68,12 @@ public:
      */
     void init(CSelectionData *, CKernel *);
 
+    /**
+     * @brief Sets the number of threads evaluating the candidate tests, the default is 1.
+     * @param numOfThreads Number of threads, 0 means the number of hardware threads.
+     */
+    void setNumOfThreads(unsigned int numOfThreads);
+
     /**
      * @brief Gets the first n prioritized testcases.
      * @param selected The result vector.
@@ -98,11 +104,23 @@ private:
      */
     void prioritize();
 
-    double diagnosticAmbiguity(IndexType tcid);
+    /**
+     * @brief Returns the diagnostic ambiguity of the current partition extended by the given test.
+     * @param tcid The id of the test
+     * @param counts Buffer of the partition.
+     */
+    double diagnosticAmbiguity(IndexType tcid, IntVector &counts);
 
-    double ambiguity(CPartitionAlgorithm &partition);
+    /**
+     * @brief Returns the diagnostic ambiguity from the number of code element pairs in the same partition.
+     */
+    double ambiguity(IndexType nofPairs);
 
-    double raptorMetric(CClusterDefinition &cluster);
+    /**
+     * @brief Returns the packed coverage row of the given test.
+     * @param tcid The id of the test
+     */
+    const WordType* getRowWords(IndexType tcid) const;
 private:
 
     /**
@@ -126,9 +144,19 @@ private:
     IntVector* m_elementsRemaining;
 
     /**
-     * @brief Stores the selected test cases
+     * @brief Partition of the code elements by the selected test cases.
      */
-    CClusterDefinition* m_currentCluster;
+    CPartitionRefinement* m_partition;
+
+    /**
+     * @brief Packed copy of the coverage rows if the coverage matrix does not store them.
+     */
+    std::vector<WordType>* m_rows;
+
+    /**
+     * @brief Number of words of a coverage row.
+     */
+    IndexType m_nofWords;
 
     double m_currentAmbiguity;
 
@@ -139,6 +167,11 @@ private:
 
     IndexType m_recursionLevel;
 
+    /**
+     * @brief The threads evaluating the candidate tests, used by every step of the prioritization.
+     */
+    CThreadPool* m_pool;
+
 };
 
 } /* namespace soda */
@@ -60,3 +60,59 @@ TEST(CBitReader, BasicOperators)
     EXPECT_EQ(true, reader.readBit());
     EXPECT_NO_THROW(delete io);
 }
+
+TEST(CBitWriter, WriteWords)
+{
+    soda::WordType words[3] = { 0x8000000000000001ULL, 0x123456789abcdef0ULL, 0x5ULL };
+
+    // Write the same bits with writeWords and writeBit at every byte offset.
+    for (int offset = 0; offset < 8; ++offset) {
+        CBinaryIO *io = new CBinaryIO("sample/bitio_words.saved", CBinaryIO::omWrite);
+        CBitWriter writer(io);
+        for (int i = 0; i < offset; ++i)
+            writer.writeBit(i % 2);
+        EXPECT_NO_THROW(writer.writeWords(words, 131));
+        EXPECT_NO_THROW(writer.writeWords(words, 5));
+        writer.flush();
+        delete io;
+
+        io = new CBinaryIO("sample/bitio_words.saved", CBinaryIO::omRead);
+        CBitReader reader(io);
+        for (int i = 0; i < offset; ++i)
+            EXPECT_EQ((bool)(i % 2), reader.readBit());
+        for (int i = 0; i < 131; ++i)
+            EXPECT_EQ((bool)((words[i / 64] >> (i % 64)) & 1), reader.readBit());
+        for (int i = 0; i < 5; ++i)
+            EXPECT_EQ((bool)((words[0] >> i) & 1), reader.readBit());
+        delete io;
+    }
+}
+
+TEST(CBitReader, ReadWords)
+{
+    soda::WordType words[3] = { 0xfedcba9876543210ULL, 0x0f0f0f0f0f0f0f0fULL, 0x3ULL };
+
+    for (int offset = 0; offset < 8; ++offset) {
+        CBinaryIO *io = new CBinaryIO("sample/bitio_words.saved", CBinaryIO::omWrite);
+        CBitWriter writer(io);
+        for (int i = 0; i < offset; ++i)
+            writer.writeBit(true);
+        for (int i = 0; i < 130; ++i)
+            writer.writeBit((words[i / 64] >> (i % 64)) & 1);
+        writer.writeBit(true);
+        writer.flush();
+        delete io;
+
+        io = new CBinaryIO("sample/bitio_words.saved", CBinaryIO::omRead);
+        CBitReader reader(io);
+        for (int i = 0; i < offset; ++i)
+            EXPECT_TRUE(reader.readBit());
+        soda::WordType result[3] = { 0, 0, ~0ULL };
+        EXPECT_NO_THROW(reader.readWords(result, 130));
+        EXPECT_EQ(words[0], result[0]);
+        EXPECT_EQ(words[1], result[1]);
+        EXPECT_EQ(words[2], result[2]);
+        EXPECT_TRUE(reader.readBit());
+        delete io;
+    }
+}
@@ -207,3 +207,82 @@ TEST(CBitList, Resize_Count)
     EXPECT_EQ(104u, bitList.size());
     EXPECT_EQ(100u, bitList.count());
 }
+
+TEST(CBitList, EraseAcrossWords)
+{
+    IndexType n = 200;
+    CBitList bitList(n);
+    for (IndexType i = 0; i < n; i += 3) {
+        bitList.set(i, true);
+    }
+
+    EXPECT_NO_THROW(bitList.erase(10));
+    EXPECT_EQ(n - 1, bitList.size());
+    for (IndexType i = 0; i < n - 1; ++i) {
+        IndexType old = (i < 10) ? i : i + 1;
+        EXPECT_EQ(old % 3 == 0, bitList.at(i));
+    }
+
+    IndexType expected = 0;
+    for (IndexType i = 0; i < bitList.size(); ++i) {
+        if (bitList[i])
+            expected++;
+    }
+    EXPECT_EQ(expected, bitList.count());
+}
+
+TEST(CBitList, WordAccess)
+{
+    CBitList bitList(100);
+    EXPECT_EQ(2u, bitList.getNumOfWords());
+
+    EXPECT_NO_THROW(bitList.setWord(0, 0xffULL));
+    EXPECT_NO_THROW(bitList.setWord(1, ~WordType(0)));
+    EXPECT_ANY_THROW(bitList.setWord(2, 0));
+    EXPECT_ANY_THROW(bitList.getWord(2));
+
+    // The bits beyond the size of the list are dropped.
+    EXPECT_EQ((WordType(1) << 36) - 1, bitList.getWord(1));
+    EXPECT_EQ(8u + 36u, bitList.count());
+    EXPECT_TRUE(bitList.at(7));
+    EXPECT_FALSE(bitList.at(8));
+    EXPECT_TRUE(bitList.back());
+
+    bitList.set(3, false);
+    EXPECT_EQ(0xf7ULL, bitList.getWords()[0]);
+    EXPECT_EQ(43u, bitList.count());
+
+    bitList.setAll(true);
+    EXPECT_EQ(100u, bitList.count());
+    EXPECT_EQ((WordType(1) << 36) - 1, bitList.getWord(1));
+}
+
+TEST(CBitList, BitwiseOperations)
+{
+    IndexType n = 1000;
+    CBitList a(n);
+    CBitList b(n);
+    for (IndexType i = 0; i < n; ++i) {
+        a.set(i, i % 2 == 0);
+        b.set(i, i % 3 == 0);
+    }
+
+    CBitList result(n);
+    result.bitwiseOr(a);
+    result.bitwiseAnd(b);
+    for (IndexType i = 0; i < n; ++i) {
+        EXPECT_EQ(i % 6 == 0, result[i]);
+    }
+    EXPECT_EQ(167u, result.count());
+
+    result.bitwiseXor(a);
+    for (IndexType i = 0; i < n; ++i) {
+        EXPECT_EQ(i % 2 == 0 && i % 3 != 0, result[i]);
+    }
+
+    result.bitwiseAndNot(a);
+    EXPECT_EQ(0u, result.count());
+
+    CBitList other(n + 1);
+    EXPECT_ANY_THROW(result.bitwiseAnd(other));
+}
@@ -23,6 +23,7 @@
 #include "data/CBitMatrix.h"
 #include "interface/IBitList.h"
 #include "interface/IIterators.h"
+#include "util/CThreadPool.h"
 #include "gtest/gtest.h"
 
 using namespace soda;
@@ -250,3 +251,157 @@ TEST(CBitMatrix, SaveAndLoad)
     bitMatrix2.resize(100, 50);
     EXPECT_TRUE(bitMatrix != bitMatrix2);
 }
+
+TEST(CBitMatrix, ResizeAcrossWords)
+{
+    IndexType n = 10;
+    IndexType m = 130;
+
+    CBitMatrix bitMatrix(n, m);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            bitMatrix.set(i, j, (i + j) % 5 == 0);
+        }
+    }
+    EXPECT_EQ(3u, bitMatrix.getNumOfWordsPerRow());
+
+    bitMatrix.resize(2 * n, 70);
+    EXPECT_EQ(2u, bitMatrix.getNumOfWordsPerRow());
+    for (IndexType i = 0; i < 2 * n; ++i) {
+        IndexType count = 0;
+        for (IndexType j = 0; j < 70; ++j) {
+            bool expected = i < n && (i + j) % 5 == 0;
+            EXPECT_EQ(expected, bitMatrix.get(i, j));
+            if (expected)
+                count++;
+        }
+        EXPECT_EQ(count, bitMatrix.getRow(i).count());
+    }
+
+    // Shrinking inside the last word clears the dropped bits.
+    bitMatrix.resize(2 * n, 65);
+    bitMatrix.resize(2 * n, 70);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 65; j < 70; ++j) {
+            EXPECT_FALSE(bitMatrix.get(i, j));
+        }
+    }
+}
+
+TEST(CBitMatrix, RowWords)
+{
+    IndexType n = 4;
+    IndexType m = 100;
+
+    CBitMatrix bitMatrix(n, m);
+    WordType words[2] = { 0x5ULL, ~WordType(0) };
+
+    EXPECT_NO_THROW(bitMatrix.setRowWords(2, words));
+    EXPECT_ANY_THROW(bitMatrix.setRowWords(n, words));
+    EXPECT_TRUE(bitMatrix.get(2, 0));
+    EXPECT_FALSE(bitMatrix.get(2, 1));
+    EXPECT_TRUE(bitMatrix.get(2, 2));
+    EXPECT_TRUE(bitMatrix.get(2, 99));
+    EXPECT_EQ(2u + 36u, bitMatrix.getRow(2).count());
+    EXPECT_EQ((WordType(1) << 36) - 1, bitMatrix.getRowWords(2)[1]);
+
+    WordType copied[2] = { 0, 0 };
+    const IBitMatrix& matrix = bitMatrix;
+    matrix.copyRowWords(2, copied);
+    EXPECT_EQ(0x5ULL, copied[0]);
+    EXPECT_EQ((WordType(1) << 36) - 1, copied[1]);
+
+    EXPECT_NO_THROW(bitMatrix.setWord(1, 0, 0x3ULL));
+    EXPECT_EQ(0x3ULL, bitMatrix.getWord(1, 0));
+    EXPECT_ANY_THROW(bitMatrix.getWord(1, 2));
+    EXPECT_ANY_THROW(bitMatrix.getWord(n, 0));
+
+    IntVector v;
+    bitMatrix.colCounts(v);
+    EXPECT_EQ(2u, v[0]);
+    EXPECT_EQ(1u, v[1]);
+    EXPECT_EQ(1u, v[2]);
+    EXPECT_EQ(0u, v[3]);
+    EXPECT_EQ(1u, v[99]);
+
+    // Rows are views of the matrix and can not change their size.
+    EXPECT_ANY_THROW(bitMatrix.getRow(0).push_back(true));
+    EXPECT_ANY_THROW(bitMatrix.getRow(0).resize(m + 1));
+}
+
+TEST(CBitMatrix, SaveAndLoadUnalignedRows)
+{
+    IndexType n = 37;
+    IndexType m = 93;
+
+    CBitMatrix bitMatrix(n, m);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            bitMatrix.set(i, j, (i * 7 + j * 3) % 11 == 0);
+        }
+    }
+
+    io::CSoDAio *io = new io::CSoDAio("sample/bitMatrixTest.saved", io::CBinaryIO::omWrite);
+    EXPECT_NO_THROW(bitMatrix.save(io));
+    delete io;
+
+    // The rows are stored continuously without padding.
+    io::CBinaryIO *bin = new io::CBinaryIO("sample/bitMatrixTest.saved", io::CBinaryIO::omRead);
+    bin->readUInt4();
+    EXPECT_EQ((unsigned)io::CSoDAio::BITMATRIX, bin->readUInt4());
+    EXPECT_EQ(2 * sizeof(IndexType) + io::CBitWriter::predictSize(n * m), bin->readULongLong8());
+    EXPECT_EQ(n, bin->readULongLong8());
+    EXPECT_EQ(m, bin->readULongLong8());
+    io::CBitReader reader(bin);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            EXPECT_EQ(bitMatrix.get(i, j), reader.readBit());
+        }
+    }
+    delete bin;
+
+    CBitMatrix bitMatrix2;
+    io = new io::CSoDAio("sample/bitMatrixTest.saved", io::CBinaryIO::omRead);
+    EXPECT_TRUE(io->findChunkID(io::CSoDAio::BITMATRIX));
+    EXPECT_NO_THROW(bitMatrix2.load(io));
+    delete io;
+
+    EXPECT_TRUE(bitMatrix == bitMatrix2);
+    std::vector<IndexType> counts;
+    std::vector<IndexType> counts2;
+    bitMatrix.rowCounts(counts);
+    bitMatrix2.rowCounts(counts2);
+    EXPECT_TRUE(counts == counts2);
+}
+
+TEST(CBitMatrix, Transpose)
+{
+    IndexType n = 130;
+    IndexType m = 75;
+
+    CBitMatrix bitMatrix(n, m);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            bitMatrix.set(i, j, (i * 7 + j * 3) % 11 == 0);
+        }
+    }
+
+    CThreadPool pool(4);
+    CBitMatrix transposed(3, 3);
+    transposed.set(2, 2, true);
+    transposed.transpose(bitMatrix, pool);
+    ASSERT_EQ(m, transposed.getNumOfRows());
+    ASSERT_EQ(n, transposed.getNumOfCols());
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            EXPECT_EQ(bitMatrix.get(i, j), transposed.get(j, i)) << i << " " << j;
+        }
+    }
+
+    std::vector<IndexType> rowCounts;
+    std::vector<IndexType> colCounts;
+    transposed.rowCounts(rowCounts);
+    bitMatrix.colCounts(colCounts);
+    EXPECT_TRUE(rowCounts == colCounts);
+    EXPECT_ANY_THROW(transposed.transpose(transposed, pool));
+}
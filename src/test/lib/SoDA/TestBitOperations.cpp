@@ -0,0 +1,99 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "util/CBitOperations.h"
+#include "gtest/gtest.h"
+
+using namespace soda;
+
+TEST(CBitOperations, WordHelpers)
+{
+    EXPECT_EQ(0u, CBitOperations::numOfWords(0));
+    EXPECT_EQ(1u, CBitOperations::numOfWords(64));
+    EXPECT_EQ(2u, CBitOperations::numOfWords(65));
+    EXPECT_EQ(~WordType(0), CBitOperations::lastWordMask(128));
+    EXPECT_EQ(0x7ULL, CBitOperations::lastWordMask(67));
+    EXPECT_EQ(64u, CBitOperations::popcount(~WordType(0)));
+    EXPECT_EQ(5u, CBitOperations::lowestBit(0x60ULL));
+}
+
+TEST(CBitOperations, Kernels)
+{
+    // Odd length to exercise both the vector and the scalar part of the kernels.
+    IndexType n = 37;
+    std::vector<WordType> a(n);
+    std::vector<WordType> b(n);
+    std::vector<WordType> dst(n);
+    for (IndexType i = 0; i < n; ++i) {
+        a[i] = (i + 1) * 0x9e3779b97f4a7c15ULL;
+        b[i] = (i + 7) * 0xc2b2ae3d27d4eb4fULL;
+    }
+
+    IndexType count = 0;
+    IndexType countAnd = 0;
+    IndexType countXor = 0;
+    for (IndexType i = 0; i < n; ++i) {
+        count += CBitOperations::popcount(a[i]);
+        countAnd += CBitOperations::popcount(a[i] & b[i]);
+        countXor += CBitOperations::popcount(a[i] ^ b[i]);
+    }
+    EXPECT_EQ(count, CBitOperations::count(a.data(), n));
+    EXPECT_EQ(countAnd, CBitOperations::countAnd(a.data(), b.data(), n));
+    EXPECT_EQ(countXor, CBitOperations::countXor(a.data(), b.data(), n));
+
+    CBitOperations::bitwiseAnd(dst.data(), a.data(), b.data(), n);
+    for (IndexType i = 0; i < n; ++i)
+        EXPECT_EQ(a[i] & b[i], dst[i]);
+
+    CBitOperations::bitwiseOr(dst.data(), a.data(), b.data(), n);
+    for (IndexType i = 0; i < n; ++i)
+        EXPECT_EQ(a[i] | b[i], dst[i]);
+
+    CBitOperations::bitwiseXor(dst.data(), a.data(), b.data(), n);
+    for (IndexType i = 0; i < n; ++i)
+        EXPECT_EQ(a[i] ^ b[i], dst[i]);
+
+    CBitOperations::bitwiseAndNot(dst.data(), a.data(), b.data(), n);
+    for (IndexType i = 0; i < n; ++i)
+        EXPECT_EQ(a[i] & ~b[i], dst[i]);
+
+    std::string name = CBitOperations::getKernelName();
+    EXPECT_TRUE(name == "avx512" || name == "avx2" || name == "generic");
+}
+
+TEST(CBitOperations, TransposeBlock)
+{
+    WordType block[64];
+    for (IndexType r = 0; r < 64; ++r) {
+        block[r] = (r * 0x9e3779b97f4a7c15ULL) ^ (r << 7);
+    }
+    WordType transposed[64];
+    std::copy(block, block + 64, transposed);
+    CBitOperations::transposeBlock(transposed);
+
+    for (IndexType r = 0; r < 64; ++r) {
+        for (IndexType c = 0; c < 64; ++c) {
+            EXPECT_EQ((block[r] >> c) & 1, (transposed[c] >> r) & 1);
+        }
+    }
+}
@@ -157,11 +157,52 @@ TEST_F(CChangesetTest, SaveAndLoad)
     }
 }
 
+TEST_F(CChangesetTest, SaveAndLoadChanges)
+{
+    changeset->addRevision(intVector);
+    changeset->addCodeElement(strVector);
+    for (unsigned int i = 1; i <= revCount; ++i) {
+        for (unsigned int j = 0; j < prCount; j += i) {
+            changeset->setChange(i, strVector[j], true);
+        }
+    }
+
+    // The byte per code element chunk is written by default, the delta encoded chunk on request.
+    for (int delta = 0; delta < 2; ++delta) {
+        EXPECT_EQ(delta == 1, changeset->getDeltaEncoding());
+        EXPECT_NO_THROW(changeset->save("sample/changesetTest.saved"));
+
+        io::CSoDAio *io = new io::CSoDAio("sample/changesetTest.saved", io::CBinaryIO::omRead);
+        EXPECT_EQ(delta == 1, io->findChunkID(io::CSoDAio::CHANGESET_DELTA));
+        EXPECT_EQ(delta == 0, io->findChunkID(io::CSoDAio::CHANGESET));
+        delete io;
+
+        CChangeset loaded;
+        EXPECT_NO_THROW(loaded.load("sample/changesetTest.saved"));
+        EXPECT_EQ(delta == 1, loaded.getDeltaEncoding());
+        EXPECT_EQ(intVector, loaded.getRevisions());
+        for (unsigned int i = 1; i <= revCount; ++i) {
+            EXPECT_EQ(changeset->getCodeElementNames(i), loaded.getCodeElementNames(i));
+        }
+        changeset->setDeltaEncoding(true);
+    }
+}
+
 TEST_F(CChangesetTest, BackwardCompatibility)
 {
     EXPECT_NO_THROW(changeset->load("sample/ChangesetSampleBit"));
     EXPECT_EQ(30u, (changeset->getCodeElements()).size());
     EXPECT_EQ(6u, (changeset->getRevisions()).size());
+
+    // the old byte per code element chunk is saved in the delta encoded format
+    changeset->setDeltaEncoding(true);
+    EXPECT_NO_THROW(changeset->save("sample/changesetTest.saved"));
+    CChangeset loaded;
+    EXPECT_NO_THROW(loaded.load("sample/changesetTest.saved"));
+    IntVector revisions = changeset->getRevisions();
+    for (IntVector::iterator it = revisions.begin(); it != revisions.end(); ++it) {
+        EXPECT_EQ(changeset->getCodeElementNames(*it), loaded.getCodeElementNames(*it));
+    }
 }
 
 TEST_F(CChangesetTest, AddOrSetChange)
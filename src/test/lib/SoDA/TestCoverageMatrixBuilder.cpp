@@ -0,0 +1,117 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include "gtest/gtest.h"
+#include "data/CCoverageMatrixBuilder.h"
+#include "exception/CException.h"
+
+using namespace soda;
+
+TEST(CCoverageMatrixBuilder, AddOrSetRelation)
+{
+    CCoverageMatrixBuilder builder;
+    CCoverageMatrix expected;
+    char tc[50], ce[50];
+
+    for (unsigned int i = 0; i < 2000; ++i) {
+        sprintf(tc, "test %d", i % 37);
+        sprintf(ce, "element %d", (i * 7) % 101);
+        bool covered = (i % 5) != 0;
+        builder.addOrSetRelation(tc, ce, covered);
+        expected.addOrSetRelation(tc, ce, covered);
+    }
+
+    CCoverageMatrix* coverage = builder.build();
+    ASSERT_EQ(expected.getNumOfTestcases(), coverage->getNumOfTestcases());
+    ASSERT_EQ(expected.getNumOfCodeElements(), coverage->getNumOfCodeElements());
+    EXPECT_EQ(expected.getTestcases().getValueList(), coverage->getTestcases().getValueList());
+    EXPECT_EQ(expected.getCodeElements().getValueList(), coverage->getCodeElements().getValueList());
+    for (IndexType i = 0; i < expected.getNumOfTestcases(); ++i) {
+        for (IndexType j = 0; j < expected.getNumOfCodeElements(); ++j) {
+            EXPECT_EQ(expected.getBitMatrix().get(i, j), coverage->getBitMatrix().get(i, j));
+        }
+    }
+    delete coverage;
+}
+
+TEST(CCoverageMatrixBuilder, LastRelationWins)
+{
+    CCoverageMatrixBuilder builder;
+    IndexType tc = builder.addTestcaseName("tc");
+    IndexType ce = builder.addCodeElementName("ce");
+    builder.addCodeElementName("other");
+
+    for (unsigned int i = 0; i < 1000; ++i) {
+        builder.addOrSetRelation(tc, ce, i % 2 == 0);
+    }
+    builder.addOrSetRelation(tc, ce, true);
+    EXPECT_LT(builder.getNumOfRelations(), 200u);
+    EXPECT_THROW(builder.addOrSetRelation(tc, 2, true), CException);
+
+    CCoverageMatrix coverage;
+    coverage.addOrSetRelation("existing", "other");
+    builder.build(coverage);
+    EXPECT_EQ(2u, coverage.getNumOfTestcases());
+    EXPECT_EQ(2u, coverage.getNumOfCodeElements());
+    EXPECT_TRUE(coverage.getRelation("tc", "ce"));
+    EXPECT_FALSE(coverage.getRelation("tc", "other"));
+    EXPECT_TRUE(coverage.getRelation("existing", "other"));
+}
+
+TEST(CCoverageMatrixBuilder, ParallelMerge)
+{
+    std::vector<CCoverageMatrixBuilder*> builders;
+    CCoverageMatrixBuilder sequential;
+    char tc[50], ce[50];
+
+    for (unsigned int b = 0; b < 4; ++b) {
+        builders.push_back(new CCoverageMatrixBuilder());
+        for (unsigned int i = 0; i < 500; ++i) {
+            sprintf(tc, "test %d", (i + b) % 23);
+            sprintf(ce, "element %d", (i * 3 + b) % 41);
+            builders[b]->addOrSetRelation(tc, ce, (i + b) % 3 != 0);
+            sequential.addOrSetRelation(tc, ce, (i + b) % 3 != 0);
+        }
+    }
+
+    CCoverageMatrixBuilder merged;
+    merged.merge(builders, 3);
+
+    CCoverageMatrix* expected = sequential.build();
+    CCoverageMatrix* coverage = merged.build();
+    ASSERT_EQ(expected->getNumOfTestcases(), coverage->getNumOfTestcases());
+    ASSERT_EQ(expected->getNumOfCodeElements(), coverage->getNumOfCodeElements());
+    for (IndexType i = 0; i < expected->getNumOfTestcases(); ++i) {
+        for (IndexType j = 0; j < expected->getNumOfCodeElements(); ++j) {
+            String testcase = expected->getTestcases().getValue(i);
+            String codeElement = expected->getCodeElements().getValue(j);
+            EXPECT_EQ(expected->getRelation(testcase, codeElement), coverage->getRelation(testcase, codeElement));
+        }
+    }
+    EXPECT_THROW(merged.merge(std::vector<CCoverageMatrixBuilder*>(1, &merged)), CException);
+
+    delete expected;
+    delete coverage;
+    for (unsigned int b = 0; b < builders.size(); ++b) {
+        delete builders[b];
+    }
+}
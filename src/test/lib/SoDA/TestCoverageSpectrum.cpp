@@ -0,0 +1,83 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "data/CBitMatrix.h"
+#include "util/CCoverageSpectrum.h"
+
+using namespace soda;
+
+TEST(CCoverageSpectrum, Compute)
+{
+    CBitMatrix coverage(150, 200);
+    for (IndexType i = 0; i < 150; ++i) {
+        for (IndexType j = 0; j < 200; ++j) {
+            coverage.set(i, j, ((i * 31 + j * 17) % 7) < 3);
+        }
+    }
+
+    IntVector testcases;
+    CBitList failed;
+    for (IndexType i = 0; i < 150; i += 2) {
+        testcases.push_back(i);
+        failed.push_back(i % 6 == 0);
+    }
+    IntVector codeElements;
+    for (IndexType j = 0; j < 200; j += 3) {
+        codeElements.push_back(199 - j);
+    }
+
+    CCoverageSpectrum spectrum;
+    spectrum.compute(coverage, testcases, failed, codeElements);
+    EXPECT_EQ(25u, spectrum.getNumOfFailed());
+    EXPECT_EQ(50u, spectrum.getNumOfPassed());
+    ASSERT_EQ(codeElements.size(), spectrum.getEf().size());
+
+    for (IndexType j = 0; j < codeElements.size(); ++j) {
+        IndexType ef = 0, ep = 0, nf = 0, np = 0;
+        for (IndexType i = 0; i < testcases.size(); ++i) {
+            bool covered = coverage.get(testcases[i], codeElements[j]);
+            if (failed.at(i)) {
+                covered ? ef++ : nf++;
+            } else {
+                covered ? ep++ : np++;
+            }
+        }
+        EXPECT_EQ(ef, spectrum.getEf()[j]);
+        EXPECT_EQ(ep, spectrum.getEp()[j]);
+        EXPECT_EQ(nf, spectrum.getNf()[j]);
+        EXPECT_EQ(np, spectrum.getNp()[j]);
+    }
+}
+
+TEST(CCoverageSpectrum, NoTestcases)
+{
+    CBitMatrix coverage(3, 4);
+    coverage.setAll(true);
+    IntVector codeElements(1, 2);
+
+    CCoverageSpectrum spectrum;
+    spectrum.compute(coverage, IntVector(), CBitList(), codeElements);
+    EXPECT_EQ(0u, spectrum.getNumOfFailed());
+    EXPECT_EQ(0u, spectrum.getNumOfPassed());
+    EXPECT_EQ(0u, spectrum.getEf()[0]);
+    EXPECT_EQ(0u, spectrum.getNp()[0]);
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <set>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+
+#include "gtest/gtest.h"
+#include "io/CSoDAio.h"
+#include "io/CMappedSoDAio.h"
+#include "data/CBitMatrix.h"
+#include "data/CDeltaBitMatrix.h"
+#include "exception/CException.h"
+#include "util/CThreadPool.h"
+
+using namespace soda;
+
+namespace {
+
+/**
+ * @brief Fills the matrix with rows which differ from the previous row in a few columns.
+ */
+void fillHistory(IBitMatrix& matrix)
+{
+    for (IndexType i = 0; i < matrix.getNumOfRows(); ++i) {
+        for (IndexType j = 0; j < matrix.getNumOfCols(); ++j) {
+            bool previous = i > 0 && matrix.get(i - 1, j);
+            matrix.set(i, j, (i * 7 + j * 13) % 29 == 0 ? !previous : previous);
+        }
+    }
+}
+
+void expectSame(const IBitMatrix& expected, const IBitMatrix& actual)
+{
+    ASSERT_EQ(expected.getNumOfRows(), actual.getNumOfRows());
+    ASSERT_EQ(expected.getNumOfCols(), actual.getNumOfCols());
+    for (IndexType i = 0; i < expected.getNumOfRows(); ++i) {
+        for (IndexType j = 0; j < expected.getNumOfCols(); ++j) {
+            ASSERT_EQ(expected.get(i, j), actual.get(i, j)) << i << " " << j;
+        }
+    }
+}
+
+} // namespace
+
+TEST(CDeltaBitMatrix, EncodeMatrix)
+{
+    CBitMatrix bitMatrix(150, 201);
+    fillHistory(bitMatrix);
+
+    CDeltaBitMatrix delta(bitMatrix);
+    expectSame(bitMatrix, delta);
+    EXPECT_TRUE(bitMatrix == delta);
+    EXPECT_LT(delta.getNumOfChanges(), bitMatrix.getNumOfRows() * bitMatrix.getNumOfCols() / 20);
+
+    std::vector<IndexType> expected, actual;
+    bitMatrix.rowCounts(expected);
+    delta.rowCounts(actual);
+    EXPECT_EQ(expected, actual);
+    bitMatrix.colCounts(expected);
+    delta.colCounts(actual);
+    EXPECT_EQ(expected, actual);
+
+    IBitList& column = delta.getCol(5);
+    for (IndexType i = 0; i < bitMatrix.getNumOfRows(); ++i) {
+        EXPECT_EQ(bitMatrix.get(i, 5), column[i]);
+    }
+    delete &column;
+
+    EXPECT_ANY_THROW(delta.get(150, 0));
+    EXPECT_ANY_THROW(delta.get(0, 201));
+    EXPECT_ANY_THROW(delta.getRow(150));
+}
+
+TEST(CDeltaBitMatrix, SetAndResize)
+{
+    CBitMatrix bitMatrix(130, 70);
+    CDeltaBitMatrix delta(130, 70);
+    fillHistory(bitMatrix);
+    fillHistory(delta);
+    expectSame(bitMatrix, delta);
+
+    // Modify rows at and around the full rows, reading other rows in between
+    IndexType rows[] = { 0, 64, 63, 65, 129, 1, 128 };
+    for (IndexType k = 0; k < 7; ++k) {
+        for (IndexType j = 0; j < 70; j += 3) {
+            bitMatrix.toggleValue(rows[k], j);
+            delta.toggleValue(rows[k], j);
+        }
+        EXPECT_TRUE(bitMatrix.getRow((rows[k] + 50) % 130) == delta.getRow((rows[k] + 50) % 130));
+    }
+    expectSame(bitMatrix, delta);
+
+    std::vector<WordType> words(2, 0x5555555555555555ULL);
+    bitMatrix.setRowWords(100, words.data());
+    delta.setRowWords(100, words.data());
+    expectSame(bitMatrix, delta);
+
+    bitMatrix.resize(200, 90);
+    delta.resize(200, 90);
+    expectSame(bitMatrix, delta);
+    bitMatrix.resize(66, 40);
+    delta.resize(66, 40);
+    expectSame(bitMatrix, delta);
+
+    delta.setAll(true);
+    EXPECT_EQ(40u, delta[65].count());
+    EXPECT_EQ(40u, delta.getNumOfChanges());
+    delta.clear();
+    EXPECT_EQ(0u, delta.getNumOfRows());
+}
+
+TEST(CDeltaBitMatrix, PackedRows)
+{
+    CBitMatrix bitMatrix(70, 130);
+    fillHistory(bitMatrix);
+    CDeltaBitMatrix delta(bitMatrix);
+
+    // The rows of the word-packed matrix are not copied.
+    std::vector<WordType> bitBuffer, deltaBuffer;
+    std::vector<const WordType*> bitRows = bitMatrix.getPackedRows(bitBuffer);
+    std::vector<const WordType*> deltaRows = delta.getPackedRows(deltaBuffer);
+    EXPECT_TRUE(bitBuffer.empty());
+    EXPECT_EQ(70u * 3, deltaBuffer.size());
+    ASSERT_EQ(70u, bitRows.size());
+    ASSERT_EQ(70u, deltaRows.size());
+    for (IndexType i = 0; i < 70; ++i) {
+        EXPECT_EQ(bitMatrix.getRowWords(i), bitRows[i]);
+        EXPECT_TRUE(std::equal(bitRows[i], bitRows[i] + 3, deltaRows[i])) << i;
+    }
+}
+
+TEST(CDeltaBitMatrix, ParallelRows)
+{
+    CBitMatrix bitMatrix(100, 150);
+    fillHistory(bitMatrix);
+    CDeltaBitMatrix delta(bitMatrix);
+
+    // The returned row stays valid while the thread accesses fewer other rows than the cache holds
+    IBitList& first = delta.getRow(3);
+    for (IndexType i = 10; i < 17; ++i) {
+        delta.getRow(i);
+    }
+    EXPECT_TRUE(bitMatrix.getRow(3) == first);
+    delta.set(3, 7, !bitMatrix.get(3, 7));
+    EXPECT_EQ(!bitMatrix.get(3, 7), first[7]);
+    delta.set(3, 7, bitMatrix.get(3, 7));
+
+    // Every row is decoded and copied by several threads at the same time
+    std::vector<int> sameRows(4 * 100, 0);
+    std::vector<int> sameWords(sameRows.size(), 0);
+    CThreadPool(4).run(sameRows.size(), [&](IndexType i) {
+        sameRows[i] = bitMatrix.getRow(i % 100) == delta.getRow(i % 100);
+        std::vector<WordType> words(3);
+        delta.copyRowWords(i % 100, words.data());
+        sameWords[i] = std::equal(words.begin(), words.end(), bitMatrix.getRowWords(i % 100));
+    });
+    for (IndexType i = 0; i < sameRows.size(); ++i) {
+        EXPECT_TRUE(sameRows[i]) << i;
+        EXPECT_TRUE(sameWords[i]) << i;
+    }
+}
+
+TEST(CDeltaBitMatrix, BoundedRows)
+{
+    CBitMatrix bitMatrix(200, 150);
+    fillHistory(bitMatrix);
+    CDeltaBitMatrix delta(bitMatrix);
+
+    // A full pass over the rows reuses the 8 decoded rows of the thread
+    std::set<const IBitList*> rows;
+    for (IndexType k = 0; k < 2; ++k) {
+        for (IndexType i = 0; i < 200; ++i) {
+            IBitList& row = delta[i];
+            EXPECT_TRUE(bitMatrix.getRow(i) == row) << i;
+            rows.insert(&row);
+        }
+    }
+    EXPECT_EQ(8u, rows.size());
+
+    // The other threads get their own rows
+    boost::mutex mutex;
+    CThreadPool(4).run(4 * 200, [&](IndexType i) {
+        const IBitList* row = &delta.getRow(i % 200);
+        boost::mutex::scoped_lock lock(mutex);
+        rows.insert(row);
+    });
+    EXPECT_GE(4u * 8, rows.size());
+
+    // The modifications of a returned row are written into the matrix
+    IBitList& row = delta[150];
+    row.set(9, !bitMatrix.get(150, 9));
+    row.toggleValue(10);
+    bitMatrix.toggleValue(150, 9);
+    bitMatrix.toggleValue(150, 10);
+    for (IndexType i = 0; i < 200; ++i) {
+        delta.getRow(i);
+    }
+    expectSame(bitMatrix, delta);
+    delta[199].setAll(true);
+    EXPECT_EQ(150u, delta.getRow(199).count());
+    std::vector<IndexType> counts;
+    delta.rowCounts(counts);
+    EXPECT_EQ(150u, counts[199]);
+}
+
+TEST(CDeltaBitMatrix, SaveAndLoad)
+{
+    CBitMatrix bitMatrix(100, 333);
+    fillHistory(bitMatrix);
+    CDeltaBitMatrix delta(bitMatrix);
+
+    io::CSoDAio *out = new io::CSoDAio("sample/deltaBitMatrix.saved", io::CBinaryIO::omWrite);
+    delta.saveDeltas(out, io::CSoDAio::EXECUTION_DELTA);
+    delta.save(out, io::CSoDAio::EXECUTION);
+    delete out;
+
+    io::CMappedSoDAio in("sample/deltaBitMatrix.saved");
+    ASSERT_TRUE(in.findChunkID(io::CSoDAio::EXECUTION_DELTA));
+    CDeltaBitMatrix loaded;
+    loaded.loadDeltas(in.getChunkData(), in.getActualLength());
+    expectSame(bitMatrix, loaded);
+    EXPECT_THROW(loaded.loadDeltas(in.getChunkData(), in.getActualLength() - 1), CException);
+    EXPECT_THROW(loaded.loadDeltas(in.getChunkData(), 8), CException);
+
+    io::CSoDAio *io = new io::CSoDAio("sample/deltaBitMatrix.saved", io::CBinaryIO::omRead);
+    ASSERT_TRUE(io->findChunkID(io::CSoDAio::EXECUTION));
+    CBitMatrix dense;
+    dense.load(io);
+    delete io;
+    expectSame(bitMatrix, dense);
+
+    io = new io::CSoDAio("sample/deltaBitMatrix.saved", io::CBinaryIO::omRead);
+    ASSERT_TRUE(io->findChunkID(io::CSoDAio::EXECUTION));
+    CDeltaBitMatrix reencoded;
+    reencoded.load(io);
+    delete io;
+    expectSame(bitMatrix, reencoded);
+    EXPECT_EQ(delta.getNumOfChanges(), reencoded.getNumOfChanges());
+}
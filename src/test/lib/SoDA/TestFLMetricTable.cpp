@@ -0,0 +1,107 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include "gtest/gtest.h"
+#include "data/CFLMetricTable.h"
+#include "exception/CException.h"
+
+using namespace soda;
+
+TEST(CFLMetricTable, Columns)
+{
+    CFLMetricTable table;
+    IntVector codeElements = { 7, 2, 5 };
+    table.setCodeElements(codeElements);
+
+    EXPECT_EQ(3u, table.getNumOfRows());
+    EXPECT_EQ(0u, table.getRow(7));
+    EXPECT_EQ(2u, table.getRow(5));
+    EXPECT_EQ(CFLMetricTable::NO_ROW, table.getRow(3));
+    EXPECT_EQ(CFLMetricTable::NO_ROW, table.getRow(100));
+
+    IntVector &ef = table.addUIntColumn("ef");
+    std::vector<double> &ochiai = table.addDoubleColumn("ochiai");
+    ef[1] = 4;
+    ochiai[2] = 0.5;
+
+    EXPECT_TRUE(table.hasColumn("ef"));
+    EXPECT_FALSE(table.hasColumn("ep"));
+    EXPECT_EQ(StringVector({ "ef", "ochiai" }), table.getColumnNames());
+    EXPECT_EQ(IntVector({ 0, 4, 0 }), table.getUIntColumn("ef"));
+    EXPECT_DOUBLE_EQ(0.5, table.getDoubleColumn("ochiai")[2]);
+    EXPECT_EQ(&ef, &table.addUIntColumn("ef"));
+    EXPECT_THROW(table.getDoubleColumn("ef"), CException);
+    EXPECT_THROW(table.getUIntColumn("ep"), CException);
+    EXPECT_THROW(table.addDoubleColumn("ef"), CException);
+}
+
+TEST(CFLMetricTable, Serialization)
+{
+    CFLMetricTable table;
+    table.setCodeElements({ 3, 1 });
+    IntVector &ef = table.addUIntColumn("ef");
+    std::vector<double> &value = table.addDoubleColumn("ef/(ef+ep)");
+    ef[0] = 2;
+    ef[1] = 1;
+    value[0] = 0.25;
+
+    std::stringstream csv;
+    table.writeCsvHeader(csv, ";");
+    table.writeCsvRow(csv, 0, ";");
+    EXPECT_EQ("ef;ef/(ef+ep);2;0.25;", csv.str());
+
+    std::map<String, CFLMetricTable> tables;
+    tables["full"] = table;
+    std::stringstream json;
+    CFLMetricTable::writeJson(json, tables);
+    EXPECT_EQ("{\n"
+              "    \"full\": {\n"
+              "        \"3\": {\n"
+              "            \"ef\": 2,\n"
+              "            \"ef/(ef+ep)\": 0.25\n"
+              "        },\n"
+              "        \"1\": {\n"
+              "            \"ef\": 1,\n"
+              "            \"ef/(ef+ep)\": 0.0\n"
+              "        }\n"
+              "    }\n"
+              "}", json.str());
+
+    std::map<String, CFLMetricTable> escaped;
+    escaped["C:\\src\\\"a\".cpp"] = CFLMetricTable();
+    std::stringstream escapedJson;
+    CFLMetricTable::writeJson(escapedJson, escaped);
+    EXPECT_EQ("{\n    \"C:\\\\src\\\\\\\"a\\\".cpp\": {}\n}", escapedJson.str());
+
+    rapidjson::Document doc;
+    doc.SetObject();
+    table.toJson(doc, doc.GetAllocator(), table.getColumnNames());
+    EXPECT_EQ(2u, doc.MemberCount());
+    EXPECT_EQ(2u, doc["3"]["ef"].GetUint64());
+    EXPECT_DOUBLE_EQ(0.25, doc["3"]["ef/(ef+ep)"].GetDouble());
+
+    CFLMetricTable loaded;
+    loaded.loadUIntColumns(doc, { "ef" });
+    EXPECT_EQ(table.getCodeElements(), loaded.getCodeElements());
+    EXPECT_EQ(table.getUIntColumn("ef"), loaded.getUIntColumn("ef"));
+    EXPECT_THROW(loaded.loadUIntColumns(doc, { "ep" }), CException);
+}
@@ -199,3 +199,57 @@ TEST_F(CIDManagerTest, Clear)
     EXPECT_EQ(0u, idManager->getIDList().size());
     EXPECT_EQ(0u, idManager->getValueList().size());
 }
+
+TEST_F(CIDManagerTest, ManyValues)
+{
+    unsigned int n = 10000;
+    char str[50];
+
+    for (unsigned int i = 0; i < n; ++i) {
+        sprintf(str, "value %d", i);
+        idManager->add(str);
+    }
+    EXPECT_EQ(n, idManager->size());
+    EXPECT_EQ(n, idManager->getIDs().size());
+    EXPECT_EQ(n - 1, idManager->getLastIndex());
+
+    for (unsigned int i = 0; i < n; i += 2) {
+        sprintf(str, "value %d", i);
+        idManager->remove(String(str));
+    }
+    EXPECT_EQ(n / 2, idManager->size());
+
+    const IntVector& ids = idManager->getIDs();
+    for (unsigned int i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(2 * i + 1, ids[i]);
+        sprintf(str, "value %d", 2 * i + 1);
+        EXPECT_EQ(str, idManager->getValue(ids[i]));
+        EXPECT_EQ(ids[i], idManager->getID(str));
+    }
+    EXPECT_FALSE(idManager->containsValue("value 0"));
+    EXPECT_THROW(idManager->getValue(0), std::out_of_range);
+
+    idManager->add(0, "value 0");
+    EXPECT_EQ(0u, idManager->getIDs()[0]);
+    EXPECT_EQ(0u, idManager->getID("value 0"));
+}
+
+TEST_F(CIDManagerTest, DuplicatedValues)
+{
+    StringVector values;
+    values.push_back("a");
+    values.push_back("b");
+    values.push_back("a");
+    CIDManager manager(values);
+
+    EXPECT_EQ(3u, manager.size());
+    EXPECT_EQ(0u, manager.getID("a"));
+    EXPECT_EQ("a", manager.getValue(2));
+
+    idManager->add(1, "x");
+    idManager->add(1, "y");
+    idManager->add(2, "x");
+    EXPECT_EQ(1u, idManager->size());
+    EXPECT_EQ("x", idManager->getValue(1));
+    EXPECT_FALSE(idManager->containsValue("y"));
+}
@@ -186,6 +186,63 @@ TEST_F(CIDMapperTest, translateFromAnotherId)
     delete differentidMgr;
 }
 
+TEST_F(CIDMapperTest, getTranslationTable)
+{
+    CIDMapper* anotherMapper = new CIDMapper(idManager);
+
+    idMapper->add(0, "Zero");
+    idMapper->add(1, "Alpha");
+    idMapper->add(2, "Beta");
+    anotherMapper->add(0, "Zero");
+    anotherMapper->add(1, "Beta");
+    anotherMapper->add(2, "Alpha");
+    anotherMapper->add(4, "Fourth");
+
+    IntVector table;
+    EXPECT_NO_THROW(idMapper->getTranslationTable(*anotherMapper, table));
+    EXPECT_EQ(5u, table.size());
+    EXPECT_EQ(0u, table[0]);
+    EXPECT_EQ(2u, table[1]);
+    EXPECT_EQ(1u, table[2]);
+    EXPECT_EQ(CIDMapper::NO_ID, table[3]);
+    EXPECT_EQ(CIDMapper::NO_ID, table[4]);
+    delete anotherMapper;
+
+    CIDManager *differentidMgr = new CIDManager();
+    anotherMapper = new CIDMapper(differentidMgr);
+    EXPECT_THROW(idMapper->getTranslationTable(*anotherMapper, table), CException);
+    delete anotherMapper;
+    delete differentidMgr;
+}
+
+TEST_F(CIDMapperTest, addGlobalIdsAndAssign)
+{
+    CIDMapper* anotherMapper = new CIDMapper(idManager);
+
+    idMapper->add(0, "Zero");
+    idMapper->add(2, "Alpha");
+    anotherMapper->add(0, "Beta");
+    anotherMapper->add(1, "Alpha");
+    anotherMapper->add(2, "Gamma");
+
+    EXPECT_NO_THROW(idMapper->addGlobalIds());
+    EXPECT_EQ(4u, idMapper->size());
+    EXPECT_EQ(2u, idMapper->getID("Alpha"));
+    EXPECT_EQ(3u, idMapper->getID("Beta"));
+    EXPECT_EQ(4u, idMapper->getID("Gamma"));
+    EXPECT_THROW(idMapper->getValue(1), std::out_of_range);
+
+    EXPECT_NO_THROW(anotherMapper->assign(*idMapper));
+    EXPECT_EQ(idMapper->getIDList(), anotherMapper->getIDList());
+    EXPECT_EQ(idMapper->getValueList(), anotherMapper->getValueList());
+
+    CIDManager *differentidMgr = new CIDManager();
+    CIDMapper differentMapper(differentidMgr);
+    EXPECT_THROW(differentMapper.assign(*idMapper), CException);
+    delete anotherMapper;
+    delete differentidMgr;
+}
+
 TEST_F(CIDMapperTest, GetIDThrowsException)
 {
     EXPECT_THROW(idMapper->getID("this element does not exists"), std::out_of_range);
@@ -213,3 +270,24 @@ TEST_F(CIDMapperTest, ContainsValue)
     EXPECT_TRUE(idMapper->containsValue("codeElement1"));
     EXPECT_FALSE(idMapper->containsValue("codeElement2"));
 }
+
+TEST_F(CIDMapperTest, GetIDs)
+{
+    idManager->add("Global");
+    idMapper->add(3, "Third");
+    idMapper->add(1, "First");
+    idMapper->add(2, "Second");
+
+    const IntVector& ids = idMapper->getIDs();
+    ASSERT_EQ(3u, ids.size());
+    EXPECT_EQ(1u, ids[0]);
+    EXPECT_EQ(2u, ids[1]);
+    EXPECT_EQ(3u, ids[2]);
+    EXPECT_EQ(1u, idMapper->getID("First"));
+    EXPECT_EQ(1u, idManager->getID("Third"));
+
+    idMapper->remove("Second");
+    EXPECT_EQ(2u, idMapper->getIDs().size());
+    EXPECT_THROW(idMapper->getValue(2), std::out_of_range);
+    EXPECT_TRUE(idManager->containsValue("Second"));
+}
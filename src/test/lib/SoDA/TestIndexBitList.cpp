@@ -20,6 +20,7 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "data/CBitList.h"
 #include "data/CIndexBitList.h"
 #include "interface/IIterators.h"
 #include "gtest/gtest.h"
@@ -210,3 +211,135 @@ TEST(CIndexBitList, SaveAndLoad)
         EXPECT_TRUE(indexBitList2.at(i));
     }
 }
+
+TEST(CIndexBitList, GetAndSetIndices)
+{
+    CIndexBitList indexBitList(100);
+    indexBitList.set(70, true);
+    indexBitList.set(3, true);
+    indexBitList.set(42, true);
+
+    IntVector indices;
+    indexBitList.getIndices(indices);
+    EXPECT_EQ(IntVector({ 3, 42, 70 }), indices);
+
+    EXPECT_NO_THROW(indexBitList.setIndices(IntVector({ 0, 5, 99 })));
+    EXPECT_EQ(3u, indexBitList.count());
+    EXPECT_TRUE(indexBitList.at(0));
+    EXPECT_TRUE(indexBitList.at(99));
+    EXPECT_FALSE(indexBitList.at(70));
+
+    EXPECT_THROW(indexBitList.setIndices(IntVector({ 5, 5 })), CException);
+    EXPECT_THROW(indexBitList.setIndices(IntVector({ 100 })), CException);
+}
+
+TEST(CIndexBitList, LargeContainers)
+{
+    IndexType n = 200000;
+    CIndexBitList indexBitList(n);
+
+    // Every third position, so the first containers become bitmaps
+    for (IndexType i = 0; i < n; i += 3) {
+        indexBitList.set(i, true);
+    }
+    EXPECT_EQ((n + 2) / 3, indexBitList.count());
+    for (IndexType i = 0; i < n; ++i) {
+        EXPECT_EQ(i % 3 == 0, indexBitList[i]);
+    }
+
+    // Clear most of them, so the containers become arrays again
+    for (IndexType i = 0; i < n; i += 3) {
+        if (i % 30 != 0) {
+            indexBitList.set(i, false);
+        }
+    }
+    EXPECT_EQ((n + 29) / 30, indexBitList.count());
+
+    IntVector indices;
+    indexBitList.getIndices(indices);
+    ASSERT_EQ(indexBitList.count(), indices.size());
+    for (IndexType i = 0; i < indices.size(); ++i) {
+        EXPECT_EQ(i * 30, indices[i]);
+    }
+
+    indexBitList.setAll(true);
+    EXPECT_EQ(n, indexBitList.count());
+    EXPECT_TRUE(indexBitList.back());
+    indexBitList.resize(70000);
+    EXPECT_EQ(70000u, indexBitList.count());
+    indexBitList.setAll(false);
+    EXPECT_EQ(0u, indexBitList.count());
+    EXPECT_FALSE(indexBitList.at(65536));
+}
+
+TEST(CIndexBitList, EraseAndPopFront)
+{
+    CIndexBitList indexBitList(70000);
+    indexBitList.set(1, true);
+    indexBitList.set(10, true);
+    indexBitList.set(65536, true);
+
+    indexBitList.erase(5);
+    EXPECT_EQ(69999u, indexBitList.size());
+    EXPECT_TRUE(indexBitList.at(1));
+    EXPECT_TRUE(indexBitList.at(9));
+    EXPECT_TRUE(indexBitList.at(65535));
+    EXPECT_FALSE(indexBitList.at(65536));
+
+    indexBitList.pop_front();
+    EXPECT_TRUE(indexBitList.front());
+    EXPECT_EQ(3u, indexBitList.count());
+
+    indexBitList.erase(0);
+    EXPECT_EQ(2u, indexBitList.count());
+    EXPECT_TRUE(indexBitList.at(7));
+}
+
+TEST(CIndexBitList, WordOperations)
+{
+    IndexType n = 140000;
+    CIndexBitList indexBitList(n);
+    CBitList bitList(n);
+    for (IndexType i = 0; i < n; i += 2) {
+        indexBitList.set(i, true);
+    }
+    indexBitList.set(131073, true);
+    for (IndexType i = 0; i < n; i += 5) {
+        bitList.set(i, true);
+    }
+
+    // Expected values are computed bit by bit
+    IndexType expectedAnd = 0;
+    IndexType expectedOr = 0;
+    IndexType expectedAndNot = 0;
+    for (IndexType i = 0; i < n; ++i) {
+        expectedAnd += indexBitList[i] && bitList[i];
+        expectedOr += indexBitList[i] || bitList[i];
+        expectedAndNot += bitList[i] && !indexBitList[i];
+    }
+
+    EXPECT_EQ(expectedAnd, indexBitList.countAnd(bitList.getWords(), bitList.getNumOfWords()));
+
+    CBitList andList(n);
+    andList.setAll(true);
+    andList.bitwiseAnd(indexBitList);
+    EXPECT_EQ(indexBitList.count(), andList.count());
+    andList.bitwiseAnd(bitList);
+    EXPECT_EQ(expectedAnd, andList.count());
+
+    CBitList orList(n);
+    orList.bitwiseOr(bitList);
+    orList.bitwiseOr(indexBitList);
+    EXPECT_EQ(expectedOr, orList.count());
+
+    CBitList andNotList(n);
+    andNotList.bitwiseOr(bitList);
+    andNotList.bitwiseAndNot(indexBitList);
+    EXPECT_EQ(expectedAndNot, andNotList.count());
+    for (IndexType i = 0; i < n; ++i) {
+        EXPECT_EQ(bitList[i] && !indexBitList[i], andNotList[i]);
+    }
+
+    CBitList shorter(n - 1);
+    EXPECT_THROW(shorter.bitwiseAnd(indexBitList), CException);
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "io/CMappedSoDAio.h"
+#include "data/CBitMatrix.h"
+#include "data/CMappedBitMatrix.h"
+#include "data/CMappedIDManager.h"
+#include "data/CIDManager.h"
+#include "interface/IIterators.h"
+#include "util/CThreadPool.h"
+
+using namespace soda;
+
+TEST(CMappedBitMatrix, ReadOnlyView)
+{
+    IndexType n = 23;
+    IndexType m = 133;
+
+    CBitMatrix bitMatrix(n, m);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            bitMatrix.set(i, j, (i * 5 + j * 3) % 7 == 0);
+        }
+    }
+
+    io::CSoDAio *out = new io::CSoDAio("sample/mappedBitMatrix.saved", io::CBinaryIO::omWrite);
+    bitMatrix.save(out);
+    delete out;
+
+    io::CMappedSoDAio in("sample/mappedBitMatrix.saved");
+    ASSERT_TRUE(in.findChunkID(io::CSoDAio::BITMATRIX));
+    CMappedBitMatrix mapped(in.getChunkData(), in.getActualLength());
+    EXPECT_ANY_THROW(CMappedBitMatrix(in.getChunkData(), 8));
+
+    EXPECT_EQ(n, mapped.getNumOfRows());
+    EXPECT_EQ(m, mapped.getNumOfCols());
+    EXPECT_TRUE(bitMatrix == mapped);
+    EXPECT_ANY_THROW(mapped.get(n, 0));
+    EXPECT_ANY_THROW(mapped.get(0, m));
+    EXPECT_ANY_THROW(mapped.set(0, 0, true));
+    EXPECT_ANY_THROW(mapped.resize(1, 1));
+
+    IntVector counts;
+    IntVector mappedCounts;
+    bitMatrix.rowCounts(counts);
+    mapped.rowCounts(mappedCounts);
+    EXPECT_TRUE(counts == mappedCounts);
+    bitMatrix.colCounts(counts);
+    mapped.colCounts(mappedCounts);
+    EXPECT_TRUE(counts == mappedCounts);
+
+    std::vector<WordType> words(3);
+    mapped.copyRowWords(5, words.data());
+    for (IndexType w = 0; w < words.size(); ++w) {
+        EXPECT_EQ(bitMatrix.getWord(5, w), words[w]);
+    }
+
+    IBitList& column = mapped.getCol(3);
+    for (IndexType i = 0; i < n; ++i) {
+        EXPECT_EQ(bitMatrix.get(i, 3), column[i]);
+    }
+    delete &column;
+
+    IndexType count = 0;
+    for (IBitMatrixIterator& it = mapped.begin(); it != mapped.end(); ++it) {
+        if (*it)
+            count++;
+    }
+    IndexType expected = 0;
+    for (IndexType i = 0; i < n; ++i) {
+        expected += bitMatrix.getRow(i).count();
+    }
+    EXPECT_EQ(expected, count);
+
+    // Saving copies the mapped bits.
+    out = new io::CSoDAio("sample/mappedBitMatrix2.saved", io::CBinaryIO::omWrite);
+    mapped.save(out);
+    delete out;
+    CBitMatrix reloaded;
+    io::CSoDAio *reader = new io::CSoDAio("sample/mappedBitMatrix2.saved", io::CBinaryIO::omRead);
+    EXPECT_TRUE(reader->findChunkID(io::CSoDAio::BITMATRIX));
+    reloaded.load(reader);
+    delete reader;
+    EXPECT_TRUE(bitMatrix == reloaded);
+}
+
+TEST(CMappedBitMatrix, ParallelRows)
+{
+    IndexType n = 200;
+    IndexType m = 77;
+
+    CBitMatrix bitMatrix(n, m);
+    for (IndexType i = 0; i < n; ++i) {
+        for (IndexType j = 0; j < m; ++j) {
+            bitMatrix.set(i, j, (i + j * 3) % 5 == 0);
+        }
+    }
+
+    io::CSoDAio *out = new io::CSoDAio("sample/mappedBitMatrix3.saved", io::CBinaryIO::omWrite);
+    bitMatrix.save(out);
+    delete out;
+
+    io::CMappedSoDAio in("sample/mappedBitMatrix3.saved");
+    ASSERT_TRUE(in.findChunkID(io::CSoDAio::BITMATRIX));
+    CMappedBitMatrix mapped(in.getChunkData(), in.getActualLength());
+
+    // Every row is decoded by several threads at the same time
+    std::vector<IBitList*> rows(4 * n);
+    CThreadPool(4).run(rows.size(), [&](IndexType i) {
+        rows[i] = &mapped.getRow(i % n);
+    });
+    for (IndexType i = 0; i < rows.size(); ++i) {
+        EXPECT_EQ(rows[i % n], rows[i]);
+        EXPECT_TRUE(bitMatrix.getRow(i % n) == *rows[i]);
+    }
+}
+
+TEST(CMappedIDManager, ReadOnlyView)
+{
+    CIDManager manager;
+    manager.add(0, "first");
+    manager.add(2, "second");
+    manager.add(5, "third");
+
+    io::CSoDAio *out = new io::CSoDAio("sample/mappedIDManager.saved", io::CBinaryIO::omWrite);
+    manager.save(out, io::CSoDAio::TCLIST);
+    delete out;
+
+    io::CMappedSoDAio in("sample/mappedIDManager.saved");
+    ASSERT_TRUE(in.findChunkID(io::CSoDAio::TCLIST));
+    CMappedIDManager mapped(in.getChunkData(), in.getActualLength());
+
+    EXPECT_EQ(3u, mapped.size());
+    EXPECT_EQ(5u, mapped.getLastIndex());
+    EXPECT_TRUE(manager.getIDList() == mapped.getIDList());
+    EXPECT_TRUE(manager.getValueList() == mapped.getValueList());
+    EXPECT_EQ("second", mapped.getValue(2));
+    EXPECT_EQ("third", mapped[5]);
+    EXPECT_EQ(0u, mapped.getID("first"));
+    EXPECT_EQ(5u, mapped["third"]);
+    EXPECT_TRUE(mapped.containsValue("second"));
+    EXPECT_FALSE(mapped.containsValue("fourth"));
+    EXPECT_THROW(mapped.getValue(1), std::out_of_range);
+    EXPECT_THROW(mapped.getID("fourth"), std::out_of_range);
+    EXPECT_ANY_THROW(mapped.add("fourth"));
+    EXPECT_ANY_THROW(mapped.remove(0));
+    EXPECT_ANY_THROW(CMappedIDManager(in.getChunkData(), in.getActualLength() - 1));
+}
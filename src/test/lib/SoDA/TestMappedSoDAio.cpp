@@ -0,0 +1,117 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "io/CMappedSoDAio.h"
+#include "data/CCoverageMatrix.h"
+#include "data/CResultsMatrix.h"
+#include "data/CIDManager.h"
+#include "exception/CException.h"
+
+using namespace soda;
+
+TEST(CMappedSoDAio, OpenAndIndex)
+{
+    io::CMappedSoDAio in;
+    EXPECT_FALSE(in.isOpen());
+    EXPECT_ANY_THROW(in.findChunkID(io::CSoDAio::TCLIST));
+    EXPECT_ANY_THROW(in.open("sample/bitio.saved"));
+    EXPECT_ANY_THROW(in.open("sample/notExisting.saved"));
+
+    EXPECT_NO_THROW(in.open("sample/ResultsMatrixSampleBit"));
+    EXPECT_TRUE(in.isOpen());
+    EXPECT_EQ(4u, in.getChunks().size());
+
+    // The TCLIST chunk follows the REVISIONS chunk which has a short length field.
+    EXPECT_TRUE(in.findChunkID(io::CSoDAio::TCLIST));
+    EXPECT_EQ(io::CSoDAio::TCLIST, in.getChunkID());
+    EXPECT_TRUE(in.findChunkID(io::CSoDAio::PASSED));
+    EXPECT_FALSE(in.findChunkID(io::CSoDAio::COVERAGE));
+
+    int chunks = 0;
+    in.close();
+    EXPECT_NO_THROW(in.open(String("sample/ResultsMatrixSampleBit")));
+    while (in.nextChunkID()) {
+        EXPECT_TRUE(in.getChunkData() != 0);
+        chunks++;
+    }
+    EXPECT_EQ(4, chunks);
+    EXPECT_FALSE(in.nextChunkID());
+}
+
+TEST(CMappedSoDAio, CoverageMatrix)
+{
+    CCoverageMatrix coverage;
+    coverage.load("sample/CoverageMatrixSampleBit");
+
+    io::CMappedSoDAio in("sample/CoverageMatrixSampleBit");
+    CCoverageMatrix mapped;
+    EXPECT_NO_THROW(mapped.load(&in));
+
+    EXPECT_EQ(coverage.getNumOfTestcases(), mapped.getNumOfTestcases());
+    EXPECT_EQ(coverage.getNumOfCodeElements(), mapped.getNumOfCodeElements());
+    EXPECT_TRUE(coverage.getBitMatrix() == mapped.getBitMatrix());
+    EXPECT_TRUE(coverage.getTestcases().getValueList() == mapped.getTestcases().getValueList());
+    EXPECT_TRUE(coverage.getCodeElements().getIDList() == mapped.getCodeElements().getIDList());
+
+    String tc = coverage.getTestcases().getValue(0);
+    EXPECT_TRUE(coverage.getCodeElements(tc) == mapped.getCodeElements(tc));
+    EXPECT_ANY_THROW(mapped.addOrSetRelation("newTestcase", "newCodeElement"));
+
+    // The mapped data is written back unchanged.
+    mapped.save("sample/coverageMatrixMapped.saved");
+    CCoverageMatrix reloaded;
+    reloaded.load("sample/coverageMatrixMapped.saved");
+    EXPECT_TRUE(coverage.getBitMatrix() == reloaded.getBitMatrix());
+    EXPECT_TRUE(coverage.getCodeElements().getValueList() == reloaded.getCodeElements().getValueList());
+
+    io::CMappedSoDAio results("sample/ResultsMatrixSampleBit");
+    CCoverageMatrix wrong;
+    EXPECT_ANY_THROW(wrong.load(&results));
+}
+
+TEST(CMappedSoDAio, ResultsMatrix)
+{
+    CResultsMatrix results;
+    results.load("sample/ResultsMatrixSampleBit");
+
+    io::CMappedSoDAio in("sample/ResultsMatrixSampleBit");
+    CResultsMatrix mapped;
+    EXPECT_NO_THROW(mapped.load(&in));
+
+    EXPECT_EQ(2u, mapped.getNumOfRevisions());
+    EXPECT_EQ(28u, mapped.getNumOfTestcases());
+    EXPECT_TRUE(results.getRevisionNumbers() == mapped.getRevisionNumbers());
+    EXPECT_TRUE(results.getExecutionBitMatrix() == mapped.getExecutionBitMatrix());
+    EXPECT_TRUE(results.getPassedBitMatrix() == mapped.getPassedBitMatrix());
+
+    IntVector revisions = results.getRevisionNumbers();
+    StringVector testcases = results.getTestcases().getValueList();
+    for (IndexType r = 0; r < revisions.size(); ++r) {
+        for (IndexType t = 0; t < testcases.size(); ++t) {
+            EXPECT_EQ(results.getResult(revisions[r], testcases[t]), mapped.getResult(revisions[r], testcases[t]));
+        }
+    }
+
+    CIDManager sharedTestcases;
+    CResultsMatrix shared(&sharedTestcases);
+    EXPECT_ANY_THROW(shared.load(&in));
+}
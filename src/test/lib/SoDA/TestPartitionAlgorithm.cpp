@@ -0,0 +1,99 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "algorithm/CPartitionAlgorithm.h"
+
+using namespace soda;
+
+class CPartitionAlgorithmTest : public testing::Test
+{
+protected:
+    CSelectionData data;
+    CClusterDefinition cluster;
+
+    virtual void SetUp()
+    {
+        CCoverageMatrix *coverage = data.getCoverage();
+        for (IndexType i = 0; i < 3; i++) {
+            coverage->addTestcaseName("tc" + std::to_string(i));
+        }
+        for (IndexType i = 0; i < 100; i++) {
+            coverage->addCodeElementName("ce" + std::to_string(i));
+        }
+        coverage->refitMatrixSize();
+
+        // ce0, ce1: {tc0}, ce2: {}, ce3: {tc1, tc2}, ce4: {tc2}, ce5 and ce99: {tc0, tc1}
+        coverage->setRelation(0, 0, true);
+        coverage->setRelation(0, 1, true);
+        coverage->setRelation(1, 3, true);
+        coverage->setRelation(2, 3, true);
+        coverage->setRelation(2, 4, true);
+        coverage->setRelation(0, 5, true);
+        coverage->setRelation(1, 5, true);
+        coverage->setRelation(0, 99, true);
+        coverage->setRelation(1, 99, true);
+
+        cluster.addTestCases({ 0, 1, 2 });
+        cluster.addCodeElements({ 0, 1, 2, 3, 4, 5, 99 });
+    }
+};
+
+TEST_F(CPartitionAlgorithmTest, Compute)
+{
+    CPartitionAlgorithm algorithm;
+    algorithm.compute(data, cluster);
+
+    CPartitionAlgorithm::PartitionData &partitions = algorithm.getPartitions();
+    EXPECT_EQ(7u, algorithm.getPartitionInfo().size());
+    ASSERT_EQ(5u, partitions.size());
+
+    // Ordered by the sum of the covering test indices, ce4 and ce5 have the same sum.
+    EXPECT_EQ(std::set<IndexType>({ 3 }), partitions[1]);
+    EXPECT_EQ(std::set<IndexType>({ 5, 99 }), partitions[2]);
+    EXPECT_EQ(std::set<IndexType>({ 4 }), partitions[3]);
+    EXPECT_EQ(std::set<IndexType>({ 0, 1 }), partitions[4]);
+    EXPECT_EQ(std::set<IndexType>({ 2 }), partitions[5]);
+
+    for (CPartitionAlgorithm::PartitionInfo::iterator it = algorithm.getPartitionInfo().begin(); it != algorithm.getPartitionInfo().end(); it++) {
+        EXPECT_EQ(1u, partitions[it->partitionId].count(it->cid));
+    }
+}
+
+TEST_F(CPartitionAlgorithmTest, ComputeTestSubset)
+{
+    CClusterDefinition subset;
+    subset.addTestCases({ 1, 2 });
+    subset.addCodeElements(cluster.getCodeElements());
+
+    CPartitionAlgorithm algorithm;
+    for (unsigned int threads = 1; threads <= 4; threads += 3) {
+        algorithm.compute(data, subset, threads);
+
+        CPartitionAlgorithm::PartitionData &partitions = algorithm.getPartitions();
+        EXPECT_EQ(7u, algorithm.getPartitionInfo().size());
+        ASSERT_EQ(4u, partitions.size());
+        EXPECT_EQ(std::set<IndexType>({ 3 }), partitions[1]);
+        EXPECT_EQ(std::set<IndexType>({ 4 }), partitions[2]);
+        EXPECT_EQ(std::set<IndexType>({ 5, 99 }), partitions[3]);
+        EXPECT_EQ(std::set<IndexType>({ 0, 1, 2 }), partitions[4]);
+    }
+}
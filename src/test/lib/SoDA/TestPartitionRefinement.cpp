@@ -0,0 +1,78 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "algorithm/CPartitionRefinement.h"
+
+using namespace soda;
+
+TEST(CPartitionRefinement, Reset)
+{
+    CPartitionRefinement empty;
+    EXPECT_EQ(0u, empty.getNumOfCodeElements());
+    EXPECT_EQ(0u, empty.getNumOfBlocks());
+    EXPECT_EQ(0u, empty.getNumOfPairs());
+
+    CPartitionRefinement partition(5);
+    EXPECT_EQ(5u, partition.getNumOfCodeElements());
+    EXPECT_EQ(1u, partition.getNumOfBlocks());
+    EXPECT_EQ(5u, partition.getBlockSize(0));
+    EXPECT_EQ(10u, partition.getNumOfPairs());
+
+    WordType row = 0x3;
+    partition.refine(&row);
+    partition.reset(70);
+    EXPECT_EQ(70u, partition.getNumOfCodeElements());
+    EXPECT_EQ(1u, partition.getNumOfBlocks());
+    EXPECT_EQ(70u * 69u / 2, partition.getNumOfPairs());
+}
+
+TEST(CPartitionRefinement, Refine)
+{
+    CPartitionRefinement partition(70);
+    IntVector counts;
+
+    // Covers the code elements 0, 1, 64 and 65.
+    WordType first[2] = { 0x3, 0x3 };
+    EXPECT_EQ(6u + 66u * 65u / 2, partition.getNumOfPairsIfRefined(first, counts));
+    EXPECT_EQ(1u, partition.getNumOfBlocks());
+    partition.refine(first);
+    EXPECT_EQ(2u, partition.getNumOfBlocks());
+    EXPECT_EQ(6u + 66u * 65u / 2, partition.getNumOfPairs());
+    EXPECT_EQ(partition.getBlockId(0), partition.getBlockId(65));
+    EXPECT_NE(partition.getBlockId(0), partition.getBlockId(2));
+    EXPECT_EQ(4u, partition.getBlockSize(partition.getBlockId(64)));
+
+    // Covers the code elements 1 and 2, both blocks are split.
+    WordType second[2] = { 0x6, 0x0 };
+    EXPECT_EQ(3u + 65u * 64u / 2, partition.getNumOfPairsIfRefined(second, counts));
+    partition.refine(second);
+    EXPECT_EQ(4u, partition.getNumOfBlocks());
+    EXPECT_EQ(3u + 65u * 64u / 2, partition.getNumOfPairs());
+    EXPECT_EQ(1u, partition.getBlockSize(partition.getBlockId(1)));
+    EXPECT_EQ(1u, partition.getBlockSize(partition.getBlockId(2)));
+    EXPECT_EQ(partition.getBlockId(0), partition.getBlockId(64));
+
+    // Refining by the same row does not change the partition.
+    EXPECT_EQ(partition.getNumOfPairs(), partition.getNumOfPairsIfRefined(second, counts));
+    partition.refine(second);
+    EXPECT_EQ(4u, partition.getNumOfBlocks());
+}
@@ -24,6 +24,7 @@
 #include "data/CIDManager.h"
 #include "data/CBitMatrix.h"
 #include "data/CRevision.h"
+#include "io/CMappedSoDAio.h"
 #include "exception/CException.h"
 
 using namespace soda;
@@ -117,6 +118,18 @@ TEST_F(CResultsMatrixTest, BasicOperations)
     EXPECT_EQ(CResultsMatrix::trtNotExecuted, resMatrix->getResult(4, 0));
 }
 
+TEST_F(CResultsMatrixTest, CopyResults)
+{
+    WordType executed = 0, passed = 0;
+    EXPECT_NO_THROW(resMatrix->copyResults(1, &executed, &passed));
+    EXPECT_EQ(6u, executed);
+    EXPECT_EQ(2u, passed);
+    EXPECT_NO_THROW(resMatrix->copyResults(2, &executed, &passed));
+    EXPECT_EQ(3u, executed);
+    EXPECT_EQ(1u, passed);
+    EXPECT_THROW(resMatrix->copyResults(3, &executed, &passed), CException);
+}
+
 TEST(CResultsMatrix, Resize)
 {
     CResultsMatrix resMatrix;
@@ -144,3 +157,41 @@ TEST(CResultsMatrix, SaveAndLoad)
     delete resMatrix;
     delete loadedResMatrix;
 }
+
+TEST(CResultsMatrix, CompressAndLoad)
+{
+    CResultsMatrix resMatrix;
+    EXPECT_NO_THROW(resMatrix.load(String("sample/ResultsMatrixSampleBit")));
+    CResultsMatrix compressed;
+    EXPECT_NO_THROW(compressed.load(String("sample/ResultsMatrixSampleBit")));
+    EXPECT_NO_THROW(compressed.compress());
+    EXPECT_NO_THROW(compressed.addOrSetResult(100, "testcase1", CResultsMatrix::trtFailed));
+    EXPECT_NO_THROW(resMatrix.addOrSetResult(100, "testcase1", CResultsMatrix::trtFailed));
+    EXPECT_NO_THROW(compressed.save(String("sample/resultsMatrixDelta.saved")));
+
+    io::CSoDAio *io = new io::CSoDAio("sample/resultsMatrixDelta.saved", io::CBinaryIO::omRead);
+    EXPECT_TRUE(io->findChunkID(io::CSoDAio::EXECUTION_DELTA));
+    delete io;
+
+    CResultsMatrix loaded;
+    EXPECT_NO_THROW(loaded.load(String("sample/resultsMatrixDelta.saved")));
+    EXPECT_TRUE(resMatrix.getExecutionBitMatrix() == loaded.getExecutionBitMatrix());
+    EXPECT_TRUE(resMatrix.getPassedBitMatrix() == loaded.getPassedBitMatrix());
+    EXPECT_EQ(CResultsMatrix::trtFailed, loaded.getResult(100, "testcase1"));
+
+    io::CMappedSoDAio mappedFile("sample/resultsMatrixDelta.saved");
+    CResultsMatrix mapped;
+    EXPECT_NO_THROW(mapped.load(&mappedFile));
+    EXPECT_TRUE(resMatrix.getExecutionBitMatrix() == mapped.getExecutionBitMatrix());
+    EXPECT_TRUE(resMatrix.getPassedBitMatrix() == mapped.getPassedBitMatrix());
+
+    // The rows are copied into the bit matrices of the caller
+    CIDManager testcases;
+    CRevision<IndexType> revisions;
+    CBitMatrix exec, pass;
+    CResultsMatrix external(&testcases, &revisions, &exec, &pass);
+    EXPECT_NO_THROW(external.load(String("sample/resultsMatrixDelta.saved")));
+    EXPECT_TRUE(resMatrix.getExecutionBitMatrix() == exec);
+    EXPECT_TRUE(resMatrix.getPassedBitMatrix() == pass);
+    EXPECT_THROW(external.compress(), CException);
+}
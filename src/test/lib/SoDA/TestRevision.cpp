@@ -43,6 +43,10 @@ TEST(CRevision, BasicOperations)
         EXPECT_EQ(ids[i], keys[i]);
     }
 
+    const CRevision<String>& constRevisions = stringRevisions;
+    EXPECT_EQ("X", constRevisions.getRevision(10u));
+    EXPECT_THROW(constRevisions.getRevision(2u), std::out_of_range);
+
     for (int i = 0; i < 7; i++) {
         EXPECT_EQ(stringRevisions[keys[i]], vals[i]);
         stringRevisions.removeRevision(keys[i]);
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "data/CSelectionData.h"
 #include "exception/CException.h"
+#include "util/CThreadPool.h"
 
 using namespace soda;
 
@@ -97,3 +98,100 @@ TEST_F(CSelectionDataTest, globalize)
     EXPECT_EQ(numberOfTestcases, data->getCoverage()->getTestcases().size());
     EXPECT_EQ(numberOfTestcases, data->getResults()->getNumOfTestcases());
 }
+
+TEST_F(CSelectionDataTest, resultsInCoverageOrder)
+{
+    EXPECT_NO_THROW(data->loadCoverage("sample/CoverageMatrixSampleBit"));
+    EXPECT_NO_THROW(data->loadResults("sample/ResultsMatrixSampleBit"));
+
+    IntVector revisions = data->getResults()->getRevisionNumbers();
+    for (IndexType i = 0; i < revisions.size(); i++) {
+        CBitList executed, passed;
+        data->getResultsInCoverageOrder(revisions[i], executed, passed);
+        EXPECT_EQ(data->getCoverage()->getNumOfTestcases(), executed.size());
+        EXPECT_EQ(data->getCoverage()->getNumOfTestcases(), passed.size());
+        for (IndexType tcid = 0; tcid < executed.size(); tcid++) {
+            String name = data->getCoverage()->getTestcases().getValue(tcid);
+            bool isExecuted = data->getResults()->getTestcases().containsValue(name) &&
+                    data->getResults()->isExecuted(revisions[i], name);
+            EXPECT_EQ(isExecuted, executed[tcid]);
+            EXPECT_EQ(isExecuted && data->getResults()->isPassed(revisions[i], name), passed[tcid]);
+        }
+    }
+}
+
+TEST_F(CSelectionDataTest, resultsInCoverageOrderParallel)
+{
+    EXPECT_NO_THROW(data->loadCoverage("sample/CoverageMatrixSampleBit"));
+    EXPECT_NO_THROW(data->loadResults("sample/ResultsMatrixSampleBit"));
+    EXPECT_NO_THROW(data->getResults()->compress());
+
+    // The results are read by several threads at the same time without changing the data
+    const CSelectionData& constData = *data;
+    IntVector revisions = data->getResults()->getRevisionNumbers();
+    std::vector<CBitList> executed(8 * revisions.size()), passed(8 * revisions.size());
+    CThreadPool(4).run(executed.size(), [&](IndexType i) {
+        constData.getResultsInCoverageOrder(revisions[i % revisions.size()], executed[i], passed[i]);
+    });
+    for (IndexType i = 0; i < executed.size(); i++) {
+        CBitList expectedExecuted, expectedPassed;
+        constData.getResultsInCoverageOrder(revisions[i % revisions.size()], expectedExecuted, expectedPassed);
+        EXPECT_TRUE(expectedExecuted == executed[i]);
+        EXPECT_TRUE(expectedPassed == passed[i]);
+    }
+}
+
+TEST_F(CSelectionDataTest, translationsAfterFilter)
+{
+    EXPECT_NO_THROW(data->loadChangeset("sample/SelectionDataChangeset"));
+    EXPECT_NO_THROW(data->loadCoverage("sample/SelectionDataCoverage"));
+    EXPECT_NO_THROW(data->loadResults("sample/SelectionDataResults"));
+    EXPECT_NO_THROW(data->filterToCoverage());
+
+    for(IndexType i=0; i<data->getCoverage()->getTestcases().size(); i++) {
+        EXPECT_EQ(data->getCoverage()->getTestcases().getValue(i),
+                  data->getResults()->getTestcases().getValue(data->translateTestcaseIdFromCoverageToResults(i)));
+    }
+    for(IndexType i=0; i<data->getChangeset()->getCodeElements().size(); i++) {
+        EXPECT_EQ(data->getChangeset()->getCodeElements().getValue(i),
+                  data->getCoverage()->getCodeElements().getValue(data->translateCodeElementIdFromChangesetToCoverage(i)));
+    }
+}
+
+TEST_F(CSelectionDataTest, filterToCoverage)
+{
+    EXPECT_NO_THROW(data->loadChangeset("sample/SelectionDataChangeset"));
+    EXPECT_NO_THROW(data->loadCoverage("sample/SelectionDataCoverage"));
+    EXPECT_NO_THROW(data->loadResults("sample/SelectionDataResults"));
+
+    IntVector revisions = data->getResults()->getRevisionNumbers();
+    StringVector testcases = data->getCoverage()->getTestcases().getValueList();
+    std::vector<std::vector<CResultsMatrix::TestResultType> > results(revisions.size());
+    std::vector<StringVector> changes(revisions.size());
+    for (IndexType i = 0; i < revisions.size(); i++) {
+        for (IndexType j = 0; j < testcases.size(); j++) {
+            results[i].push_back(data->getResults()->getTestcases().containsValue(testcases[j]) ?
+                    data->getResults()->getResult(revisions[i], testcases[j]) : CResultsMatrix::trtNotExecuted);
+        }
+        if (data->getChangeset()->exists(revisions[i])) {
+            StringVector names = data->getChangeset()->getCodeElementNames(revisions[i]);
+            for (IndexType j = 0; j < names.size(); j++) {
+                if (data->getCoverage()->getCodeElements().containsValue(names[j])) {
+                    changes[i].push_back(names[j]);
+                }
+            }
+        }
+    }
+
+    EXPECT_NO_THROW(data->filterToCoverage(2));
+
+    EXPECT_EQ(testcases, data->getResults()->getTestcases().getValueList());
+    EXPECT_EQ(data->getCoverage()->getCodeElements().getValueList(), data->getChangeset()->getCodeElements().getValueList());
+    EXPECT_EQ(revisions, data->getResults()->getRevisionNumbers());
+    for (IndexType i = 0; i < revisions.size(); i++) {
+        for (IndexType j = 0; j < testcases.size(); j++) {
+            EXPECT_EQ(results[i][j], data->getResults()->getResult(revisions[i], testcases[j]));
+        }
+        EXPECT_EQ(changes[i], data->getChangeset()->getCodeElementNames(revisions[i]));
+    }
+}
@@ -19,6 +19,8 @@
  *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+
 #include "gtest/gtest.h"
 #include "io/CSoDAio.h"
 #include "exception/CIOException.h"
@@ -63,3 +65,85 @@ TEST(CSoDAio, GetActualLength)
     EXPECT_EQ(182u, io->getActualLength());
     delete io;
 }
+
+TEST(CSoDAio, Directory)
+{
+    EXPECT_EQ(40u, CSoDAio::correctLength(CSoDAio::REVISIONS, 36, 3));
+    EXPECT_EQ(40u, CSoDAio::correctLength(CSoDAio::REVISIONS, 40, 3));
+    EXPECT_EQ(36u, CSoDAio::correctLength(CSoDAio::TCLIST, 36, 3));
+
+    CSoDAio *io = new CSoDAio(String("sample/ioDirectoryTest"), CBinaryIO::omWrite);
+    io->writeUInt4(CSoDAio::TCLIST);
+    io->writeULongLong8(3);
+    io->writeData("abc", 3);
+    io->writeUInt4(CSoDAio::PRLIST);
+    io->writeULongLong8(8);
+    io->writeULongLong8(42);
+    io->close();
+
+    EXPECT_NO_THROW(io->open("sample/ioDirectoryTest", CBinaryIO::omRead));
+    EXPECT_TRUE(io->hasDirectory());
+    EXPECT_TRUE(io->findChunkID(CSoDAio::PRLIST));
+    EXPECT_EQ(8u, io->getActualLength());
+    EXPECT_EQ(42u, io->readULongLong8());
+    EXPECT_TRUE(io->findChunkID(CSoDAio::TCLIST));
+    EXPECT_EQ(3u, io->getActualLength());
+    EXPECT_FALSE(io->findChunkID(CSoDAio::COVERAGE));
+
+    // The directory is visible as a regular chunk for the readers iterating over the chunks.
+    EXPECT_TRUE(io->findChunkID(CSoDAio::TCLIST));
+    EXPECT_TRUE(io->nextChunkID());
+    EXPECT_EQ(CSoDAio::PRLIST, io->getChunkID());
+    EXPECT_TRUE(io->nextChunkID());
+    EXPECT_EQ(CSoDAio::DIRECTORY, io->getChunkID());
+    EXPECT_FALSE(io->nextChunkID());
+    delete io;
+}
+
+TEST(CSoDAio, WithoutDirectory)
+{
+    CSoDAio *io = new CSoDAio(String("sample/ioDirectoryTest"), CBinaryIO::omWrite);
+    io->setWriteDirectory(false);
+    io->writeUInt4(CSoDAio::TCLIST);
+    io->writeULongLong8(3);
+    io->writeData("abc", 3);
+    io->close();
+
+    io->open("sample/ioDirectoryTest", CBinaryIO::omRead);
+    EXPECT_FALSE(io->hasDirectory());
+    EXPECT_TRUE(io->findChunkID(CSoDAio::TCLIST));
+    EXPECT_FALSE(io->findChunkID(CSoDAio::DIRECTORY));
+    delete io;
+
+    io = new CSoDAio(String("sample/CoverageMatrixSampleBit"), CBinaryIO::omRead);
+    EXPECT_FALSE(io->hasDirectory());
+    EXPECT_TRUE(io->findChunkID(CSoDAio::COVERAGE));
+    EXPECT_TRUE(io->findChunkID(CSoDAio::TCLIST));
+    EXPECT_EQ(182u, io->getActualLength());
+    delete io;
+}
+
+TEST(CSoDAio, CorruptedDirectory)
+{
+    CSoDAio *io = new CSoDAio(String("sample/ioDirectoryTest"), CBinaryIO::omWrite);
+    io->writeUInt4(CSoDAio::TCLIST);
+    io->writeULongLong8(3);
+    io->writeData("abc", 3);
+    io->close();
+
+    // The offset + length of the only entry wraps around to a small value.
+    {
+        std::fstream file("sample/ioDirectoryTest", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-28, std::ios::end);
+        unsigned long long offset = 0xFFFFFFFFFFFFFFF8ULL;
+        unsigned long long length = 16;
+        file.write((char*)&offset, 8);
+        file.write((char*)&length, 8);
+    }
+
+    io->open("sample/ioDirectoryTest", CBinaryIO::omRead);
+    EXPECT_FALSE(io->hasDirectory());
+    EXPECT_TRUE(io->findChunkID(CSoDAio::TCLIST));
+    EXPECT_EQ(3u, io->getActualLength());
+    delete io;
+}
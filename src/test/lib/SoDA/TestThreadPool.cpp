@@ -0,0 +1,95 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include "util/CThreadPool.h"
+#include "exception/CException.h"
+
+using namespace soda;
+
+TEST(CThreadPool, Run)
+{
+    EXPECT_EQ(3u, CThreadPool(3).getNumOfThreads());
+    EXPECT_LE(1u, CThreadPool().getNumOfThreads());
+
+    for (unsigned int threads = 1; threads <= 4; ++threads) {
+        IntVector values(1000, 0);
+        CThreadPool(threads).run(values.size(), [&](IndexType i) {
+            values[i] = i * i;
+        });
+        for (IndexType i = 0; i < values.size(); ++i) {
+            EXPECT_EQ(i * i, values[i]);
+        }
+    }
+}
+
+TEST(CThreadPool, Exception)
+{
+    for (unsigned int threads = 1; threads <= 4; threads += 3) {
+        EXPECT_THROW(CThreadPool(threads).run(100, [](IndexType i) {
+            if (i == 42) {
+                throw CException("TestThreadPool", "Task failed");
+            }
+        }), CException);
+    }
+}
+
+TEST(CThreadPool, Reuse)
+{
+    CThreadPool pool(4);
+    for (IndexType run = 0; run < 200; ++run) {
+        IntVector values(run % 7, 0);
+        pool.run(values.size(), [&](IndexType i) {
+            values[i] = run + i;
+        });
+        for (IndexType i = 0; i < values.size(); ++i) {
+            EXPECT_EQ(run + i, values[i]);
+        }
+    }
+
+    EXPECT_THROW(pool.run(10, [](IndexType i) {
+        if (i == 3) {
+            throw CException("TestThreadPool", "Task failed");
+        }
+    }), CException);
+
+    IntVector values(10, 0);
+    pool.run(values.size(), [&](IndexType i) {
+        values[i] = 1;
+    });
+    EXPECT_EQ(IntVector(10, 1), values);
+}
+
+TEST(CThreadPool, Nested)
+{
+    CThreadPool pool(3);
+    std::vector<IntVector> values(5, IntVector(5, 0));
+    pool.run(values.size(), [&](IndexType i) {
+        pool.run(values[i].size(), [&](IndexType j) {
+            values[i][j] = i * j;
+        });
+    });
+    for (IndexType i = 0; i < values.size(); ++i) {
+        for (IndexType j = 0; j < values[i].size(); ++j) {
+            EXPECT_EQ(i * j, values[i][j]);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+
+#include "gtest/gtest.h"
+#include "io/CXmlReader.h"
+#include "exception/CIOException.h"
+
+using namespace soda;
+using namespace soda::io;
+
+static void writeFile(const char* path, const char* content)
+{
+    std::ofstream out(path);
+    out << content;
+}
+
+TEST(CXmlReader, Elements)
+{
+    writeFile("sample/xmlReaderTest.xml",
+              "<?xml version=\"1.0\" encoding=\"UTF-8\"?><!DOCTYPE report [<!ELEMENT report ANY>]>\n"
+              "<report name=\"r\">\n"
+              "  <package name='a/b'><method name=\"&lt;init&gt;\" desc=\"(I)V\"/>text<![CDATA[<x>]]></package>\n"
+              "</report><!-- test name -->\n");
+
+    CXmlReader xml(String("sample/xmlReaderTest.xml"));
+    EXPECT_TRUE(xml.isOpen());
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_EQ(CXmlReader::ntStartElement, xml.getNodeType());
+    EXPECT_TRUE(xml.isElement("report"));
+    EXPECT_EQ(0u, xml.getDepth());
+    EXPECT_EQ("r", xml.getAttribute("name"));
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_TRUE(xml.isElement("package"));
+    EXPECT_EQ(1u, xml.getDepth());
+    EXPECT_TRUE(xml.hasAttributeValue("name", "a/b"));
+    EXPECT_FALSE(xml.hasAttributeValue("name", "a"));
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_EQ(CXmlReader::ntStartElement, xml.getNodeType());
+    EXPECT_TRUE(xml.isElement("method"));
+    EXPECT_EQ(2u, xml.getDepth());
+    EXPECT_EQ("<init>", xml.getAttribute("name"));
+    EXPECT_TRUE(xml.hasAttributeValue("name", "<init>"));
+    String value;
+    EXPECT_FALSE(xml.getAttribute("line", value));
+    EXPECT_THROW(xml.getAttribute("line"), CIOException);
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_EQ(CXmlReader::ntEndElement, xml.getNodeType());
+    EXPECT_TRUE(xml.isElement("method"));
+    EXPECT_EQ(2u, xml.getDepth());
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_EQ(CXmlReader::ntEndElement, xml.getNodeType());
+    EXPECT_TRUE(xml.isElement("package"));
+    EXPECT_EQ(1u, xml.getDepth());
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_TRUE(xml.isElement("report"));
+    EXPECT_EQ(0u, xml.getDepth());
+
+    EXPECT_TRUE(xml.next());
+    EXPECT_EQ(CXmlReader::ntComment, xml.getNodeType());
+    EXPECT_EQ(" test name ", xml.getComment());
+    EXPECT_EQ(0u, xml.getDepth());
+
+    EXPECT_FALSE(xml.next());
+    EXPECT_EQ(CXmlReader::ntNone, xml.getNodeType());
+}
+
+TEST(CXmlReader, Errors)
+{
+    CXmlReader xml;
+    EXPECT_FALSE(xml.isOpen());
+    EXPECT_THROW(xml.open("sample/notExisting.xml"), CIOException);
+
+    writeFile("sample/xmlReaderTest.xml", "");
+    EXPECT_NO_THROW(xml.open("sample/xmlReaderTest.xml"));
+    EXPECT_FALSE(xml.next());
+
+    writeFile("sample/xmlReaderTest.xml", "<report><package name=\"a></report>");
+    xml.open("sample/xmlReaderTest.xml");
+    EXPECT_TRUE(xml.next());
+    EXPECT_THROW(xml.next(), CIOException);
+
+    writeFile("sample/xmlReaderTest.xml", "<report><package>");
+    xml.open("sample/xmlReaderTest.xml");
+    EXPECT_TRUE(xml.next());
+    EXPECT_TRUE(xml.next());
+    EXPECT_THROW(xml.next(), CIOException);
+    writeFile("sample/xmlReaderTest.xml", "<report><package></report></package>");
+    xml.open("sample/xmlReaderTest.xml");
+    EXPECT_TRUE(xml.next());
+    EXPECT_TRUE(xml.next());
+    EXPECT_THROW(xml.next(), CIOException);
+
+    writeFile("sample/xmlReaderTest.xml", "<report><package><class/></package></report>");
+    xml.open("sample/xmlReaderTest.xml");
+    for (int i = 0; i < 6; ++i) {
+        EXPECT_TRUE(xml.next());
+    }
+    EXPECT_TRUE(xml.isElement("report"));
+    EXPECT_EQ(CXmlReader::ntEndElement, xml.getNodeType());
+    EXPECT_FALSE(xml.next());
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+#include "boost/filesystem.hpp"
+#include "gtest/gtest.h"
+#include "CAddressResolver.h"
+#include "CElfSymbolizer.h"
+
+using namespace soda;
+
+namespace {
+
+/**
+ * @brief Compiles the fixture with the given DWARF version and compares every
+ *        function address resolved by the symbolizer with addr2line.
+ */
+void compareWithAddr2line(const String &dwarfVersion)
+{
+    String dir = boost::filesystem::absolute("sample/ElfSymbolizerSampleDir").string();
+    String binary = dir + "/fixture" + dwarfVersion;
+    // The sources are compiled with relative paths, so the include directory is relative to the compilation directory.
+    String compile = "cd " + dir + " && c++ -g -gdwarf-" + dwarfVersion + " -O0 -o " + binary +
+            " main.cpp sub/helper.cpp > /dev/null 2>&1";
+    if (std::system(compile.c_str()) != 0 || std::system("addr2line --version > /dev/null 2>&1") != 0) {
+        std::cerr << "[WARNING] The compiler or addr2line is not available, the test is skipped." << std::endl;
+        return;
+    }
+
+    CElfSymbolizer symbolizer;
+    ASSERT_TRUE(symbolizer.load(binary));
+
+    std::vector<int> addresses;
+    FILE *pf = popen(("nm --defined-only " + binary).c_str(), "r");
+    ASSERT_TRUE(pf != NULL);
+    char buf[1024];
+    while (fgets(buf, sizeof(buf), pf) != NULL) {
+        std::istringstream line(buf);
+        String address, type;
+        line >> address >> type;
+        if (type == "T" || type == "t" || type == "W") {
+            addresses.push_back((int)std::strtoul(address.c_str(), NULL, 16));
+        }
+    }
+    pclose(pf);
+    ASSERT_FALSE(addresses.empty());
+
+    StringVector expected = CAddressResolver::resolve(binary, addresses);
+    ASSERT_EQ(addresses.size(), expected.size());
+    IndexType compared = 0;
+    for (IndexType i = 0; i < addresses.size(); ++i) {
+        String output;
+        if (symbolizer.resolve((unsigned int)addresses[i], output)) {
+            EXPECT_EQ(expected[i], output);
+            compared++;
+        }
+    }
+    // The functions of both source files are in the line table.
+    EXPECT_GE(compared, 4u);
+
+    String output;
+    for (IndexType i = 0; i < addresses.size(); ++i) {
+        if (expected[i].find("fixture::square(int)") == 0) {
+            EXPECT_TRUE(symbolizer.resolve((unsigned int)addresses[i], output));
+            EXPECT_EQ(expected[i], output);
+            EXPECT_NE(String::npos, output.find(dir + "/sub/helper.cpp:"));
+        }
+    }
+    boost::filesystem::remove(binary);
+}
+
+} // namespace
+
+TEST(CElfSymbolizer, Dwarf4SameAsAddr2line)
+{
+    compareWithAddr2line("4");
+}
+
+TEST(CElfSymbolizer, Dwarf5SameAsAddr2line)
+{
+    compareWithAddr2line("5");
+}
+
+TEST(CElfSymbolizer, NotElfFile)
+{
+    CElfSymbolizer symbolizer;
+    EXPECT_FALSE(symbolizer.load("sample/ElfSymbolizerSampleDir/main.cpp"));
+    EXPECT_FALSE(symbolizer.load("sample/notexists"));
+}
+
+TEST(CAddressResolver, ResolveManyAddresses)
+{
+    // More addresses than fit on one command line of addr2line.
+    std::vector<int> addresses(20000, 0x10);
+    StringVector output = CAddressResolver::resolve("/bin/sh", addresses);
+    ASSERT_EQ(addresses.size(), output.size());
+    EXPECT_EQ(output.front(), output.back());
+}
+
+TEST(CAddressResolver, PrivateCacheDir)
+{
+    boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    String cacheDir = (dir / "symbols").string();
+
+    // The missing directory is created for the current user only.
+    ASSERT_TRUE(CAddressResolver::openCacheDir(cacheDir));
+    EXPECT_EQ(boost::filesystem::owner_all, boost::filesystem::status(cacheDir).permissions());
+    EXPECT_TRUE(CAddressResolver::openCacheDir(cacheDir));
+
+    // A directory which other users can write is rejected.
+    boost::filesystem::permissions(cacheDir, boost::filesystem::all_all);
+    EXPECT_FALSE(CAddressResolver::openCacheDir(cacheDir));
+    boost::filesystem::remove_all(dir);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "boost/thread.hpp"
+#include "gtest/gtest.h"
+#include "instrumenter/instrument_ring.h"
+
+TEST(InstrumentRing, PushAndRelease)
+{
+    instrument_ring_t *ring = new instrument_ring_t();
+
+    // The ring is filled and drained a few times, so the indices wrap around.
+    for (uint64_t round = 0; round < 3; ++round) {
+        for (uint64_t i = 0; i < INSTRUMENT_RING_CAPACITY; ++i) {
+            EXPECT_EQ(1, instrument_ring_push(ring, (uint32_t)round, i));
+        }
+        EXPECT_EQ(0, instrument_ring_push(ring, 0, 0));
+        EXPECT_EQ((uint64_t)INSTRUMENT_RING_CAPACITY, instrument_ring_available(ring));
+
+        for (uint64_t i = 0; i < INSTRUMENT_RING_CAPACITY; ++i) {
+            EXPECT_EQ(i, instrument_ring_peek(ring, 0)->address);
+            EXPECT_EQ(round, instrument_ring_peek(ring, 0)->module);
+            instrument_ring_release(ring, 1);
+            // The released slot can be written again.
+            if (i == 0) {
+                EXPECT_EQ(1, instrument_ring_push(ring, 0, 0));
+                EXPECT_EQ(0, instrument_ring_push(ring, 0, 0));
+            }
+        }
+        EXPECT_EQ(1u, instrument_ring_available(ring));
+        instrument_ring_release(ring, 1);
+        EXPECT_EQ(0u, instrument_ring_available(ring));
+    }
+
+    delete ring;
+}
+
+TEST(InstrumentRing, ProducerAndConsumer)
+{
+    instrument_ring_t *ring = new instrument_ring_t();
+    const uint64_t numOfEvents = 200000;
+
+    boost::thread producer([ring, numOfEvents]() {
+        for (uint64_t i = 0; i < numOfEvents; ++i) {
+            while (!instrument_ring_push(ring, (uint32_t)(i % 7), i)) {
+                boost::this_thread::yield();
+            }
+        }
+    });
+
+    // The events are read in batches like the instrument server does.
+    uint64_t next = 0;
+    bool ordered = true;
+    while (next < numOfEvents) {
+        uint64_t available = instrument_ring_available(ring);
+        EXPECT_LE(available, (uint64_t)INSTRUMENT_RING_CAPACITY);
+        for (uint64_t k = 0; k < available; ++k) {
+            const instrument_event_t *event = instrument_ring_peek(ring, k);
+            ordered = ordered && event->address == next && event->module == next % 7;
+            ++next;
+        }
+        instrument_ring_release(ring, available);
+    }
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(numOfEvents, next);
+    EXPECT_EQ(0u, instrument_ring_available(ring));
+    delete ring;
+}
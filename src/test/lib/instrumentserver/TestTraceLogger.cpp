@@ -0,0 +1,108 @@
+/*
+ * Copyright (C): 2013-2014 Department of Software Engineering, University of Szeged
+ *
+ * Authors:
+ *
+ * This file is part of SoDA.
+ *
+ *  SoDA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  SoDA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with SoDA.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "CTraceLogger.h"
+
+using namespace soda;
+
+namespace {
+
+const char TEST_MSG = 1;
+const char CLOSE_MSG = 4;
+const char SHM_MSG = 5;
+
+void writeMessage(int socket, char type, const String &text)
+{
+    size_t length = text.length() + 1;
+    ASSERT_EQ(1, write(socket, &type, sizeof(type)));
+    ASSERT_EQ((ssize_t)sizeof(length), write(socket, &length, sizeof(length)));
+    ASSERT_EQ((ssize_t)length, write(socket, text.c_str(), length));
+}
+
+} // namespace
+
+TEST(CTraceLogger, RefusedSharedMemory)
+{
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+
+    // The first name is too long, the second does not exist. Both are refused
+    // and the messages after them are read from their beginning.
+    writeMessage(sockets[0], TEST_MSG, "test");
+    writeMessage(sockets[0], SHM_MSG, String(INSTRUMENT_SHM_NAME + 36, 'x'));
+    writeMessage(sockets[0], SHM_MSG, "/soda-instrument-test-missing");
+    ASSERT_EQ(1, write(sockets[0], &CLOSE_MSG, sizeof(CLOSE_MSG)));
+
+    CTraceData data("", "");
+    CAddressResolver resolver("", "", CAddressResolver::ResolvedCallback());
+    CTraceLogger logger(sockets[1], &data, &resolver);
+    logger();
+
+    char acks[4];
+    EXPECT_EQ(2, read(sockets[0], acks, sizeof(acks)));
+    EXPECT_EQ(0, acks[0]);
+    EXPECT_EQ(0, acks[1]);
+    close(sockets[0]);
+}
+
+TEST(CTraceLogger, OverflowedEvents)
+{
+    const char *name = "/soda-instrument-test-overflow";
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    ASSERT_LE(0, fd);
+    ASSERT_EQ(0, ftruncate(fd, sizeof(instrument_shm_t)));
+    void *memory = mmap(NULL, sizeof(instrument_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    ASSERT_NE(MAP_FAILED, memory);
+    instrument_shm_t *shm = static_cast<instrument_shm_t*>(memory);
+    shm->magic = INSTRUMENT_SHM_MAGIC;
+    shm->version = INSTRUMENT_SHM_VERSION;
+    shm->numOfOverflowedEvents = 3;
+
+    int sockets[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+    writeMessage(sockets[0], TEST_MSG, "test");
+    writeMessage(sockets[0], SHM_MSG, name);
+    ASSERT_EQ(1, write(sockets[0], &CLOSE_MSG, sizeof(CLOSE_MSG)));
+
+    CTraceData data("", "");
+    CAddressResolver resolver("", "", CAddressResolver::ResolvedCallback());
+    CTraceLogger logger(sockets[1], &data, &resolver);
+    testing::internal::CaptureStderr();
+    logger();
+    String output = testing::internal::GetCapturedStderr();
+
+    char ack = 0;
+    EXPECT_EQ(1, read(sockets[0], &ack, sizeof(ack)));
+    EXPECT_EQ(1, ack);
+    EXPECT_NE(String::npos, output.find("[WARNING] 3 events of test test"));
+
+    close(sockets[0]);
+    munmap(memory, sizeof(instrument_shm_t));
+    shm_unlink(name);
+}
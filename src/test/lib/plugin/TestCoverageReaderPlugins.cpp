@@ -116,6 +116,66 @@ TEST_F(CoverageReaderPluginsTest, GcovCoverageReaderPluginFilter)
     EXPECT_EQ(328, coverageMatrix->getNumOfCodeElements());
 }
 
+TEST_F(CoverageReaderPluginsTest, GcovCoverageReaderPluginJobs)
+{
+    EXPECT_NO_THROW(plugin = kernel.getCoverageReaderPluginManager().getPlugin("gcov"));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("path", variable_value(String("sample/CoverageMatrixGcovSampleDir"), ""))));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("cut-source-path", variable_value(String("github/soda"), ""))));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("filter-input-files", variable_value(String(""), ""))));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("jobs", variable_value(2u, ""))));
+    EXPECT_NO_THROW(notify(vm));
+
+    EXPECT_NO_THROW(coverageMatrix = plugin->read(vm));
+
+    EXPECT_EQ(1u, coverageMatrix->getNumOfTestcases());
+    EXPECT_EQ("/src/lib/SoDA/src/io/CBinaryIO.cpp:28", coverageMatrix->getCodeElements().getValue(0));
+    EXPECT_EQ(542, coverageMatrix->getNumOfCodeElements());
+}
+
+TEST_F(CoverageReaderPluginsTest, GcovCoverageReaderPluginJobsMultipleTestcases)
+{
+    EXPECT_NO_THROW(plugin = kernel.getCoverageReaderPluginManager().getPlugin("gcov"));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("path", variable_value(String("sample/CoverageMatrixGcovMultiTestSampleDir"), ""))));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("cut-source-path", variable_value(String("github/soda"), ""))));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("filter-input-files", variable_value(String(""), ""))));
+    EXPECT_NO_THROW(vm.insert(std::make_pair("jobs", variable_value(1u, ""))));
+    EXPECT_NO_THROW(notify(vm));
+    EXPECT_NO_THROW(coverageMatrix = plugin->read(vm));
+
+    variables_map parallelVm;
+    EXPECT_NO_THROW(parallelVm.insert(std::make_pair("path", variable_value(String("sample/CoverageMatrixGcovMultiTestSampleDir"), ""))));
+    EXPECT_NO_THROW(parallelVm.insert(std::make_pair("cut-source-path", variable_value(String("github/soda"), ""))));
+    EXPECT_NO_THROW(parallelVm.insert(std::make_pair("filter-input-files", variable_value(String(""), ""))));
+    EXPECT_NO_THROW(parallelVm.insert(std::make_pair("jobs", variable_value(4u, ""))));
+    EXPECT_NO_THROW(notify(parallelVm));
+    CCoverageMatrix *parallelMatrix = NULL;
+    EXPECT_NO_THROW(parallelMatrix = plugin->read(parallelVm));
+    ASSERT_TRUE(coverageMatrix != NULL && parallelMatrix != NULL);
+
+    // The result does not depend on the number of threads.
+    ASSERT_EQ(5u, coverageMatrix->getNumOfTestcases());
+    ASSERT_EQ(coverageMatrix->getNumOfTestcases(), parallelMatrix->getNumOfTestcases());
+    ASSERT_EQ(coverageMatrix->getNumOfCodeElements(), parallelMatrix->getNumOfCodeElements());
+    for (IndexType i = 0; i < coverageMatrix->getNumOfTestcases(); ++i) {
+        EXPECT_EQ(coverageMatrix->getTestcases().getValue(i), parallelMatrix->getTestcases().getValue(i));
+    }
+    for (IndexType i = 0; i < coverageMatrix->getNumOfCodeElements(); ++i) {
+        EXPECT_EQ(coverageMatrix->getCodeElements().getValue(i), parallelMatrix->getCodeElements().getValue(i));
+    }
+    IndexType differences = 0;
+    IndexType covered = 0;
+    for (IndexType i = 0; i < coverageMatrix->getNumOfTestcases(); ++i) {
+        for (IndexType j = 0; j < coverageMatrix->getNumOfCodeElements(); ++j) {
+            bool relation = coverageMatrix->getBitMatrix().get(i, j);
+            differences += relation != parallelMatrix->getBitMatrix().get(i, j);
+            covered += relation;
+        }
+    }
+    EXPECT_EQ(0u, differences);
+    EXPECT_GT(covered, 0u);
+    delete parallelMatrix;
+}
+
 TEST_F(CoverageReaderPluginsTest, EmmaJavaCoverageReaderPluginMetaInfo)
 {
     EXPECT_NO_THROW(plugin = kernel.getCoverageReaderPluginManager().getPlugin("emma-java"));
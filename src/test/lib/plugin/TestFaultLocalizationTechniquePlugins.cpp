@@ -26,6 +26,7 @@
 #include "engine/plugin/IFaultLocalizationTechniquePlugin.h"
 #include "engine/plugin/ITestSuiteClusterPlugin.h"
 #include "engine/CKernel.h"
+#include "exception/CException.h"
 #include "rapidjson/writer.h"
 #include "rapidjson/stringbuffer.h"
 using namespace soda;
@@ -83,6 +84,73 @@ TEST_F(FaultLocalizationTechniquePluginsTest, Ochiai)
     EXPECT_DOUBLE_EQ(0.67171717171717171, CTestSuiteScore::flScore(clusterList["full"], results["full"]["0"]["ochiai"].GetDouble(), plugin->getDistribution()));
 }
 
+TEST_F(FaultLocalizationTechniquePluginsTest, MetricTables)
+{
+    FLMetricTables tables;
+    IntVector failedCodeElements = { 0, 2 };
+    EXPECT_THROW(kernel.getFaultLocalizationTechniquePluginManager().getPlugin("ochiai")->calculate(tables), CException);
+
+    plugin = kernel.getFaultLocalizationTechniquePluginManager().getPlugin("common");
+    plugin->init(&selection, &clusterList, 12345, failedCodeElements);
+    plugin->calculate(tables);
+
+    plugin = kernel.getFaultLocalizationTechniquePluginManager().getPlugin("ochiai");
+    plugin->init(&selection, &clusterList, 12345, failedCodeElements);
+    plugin->calculate(tables);
+
+    CFLMetricTable &table = tables["full"];
+    EXPECT_EQ(100u, table.getNumOfRows());
+    EXPECT_EQ(3u, table.getUIntColumn("nf")[table.getRow(98)]);
+    EXPECT_EQ(1u, table.getUIntColumn("np")[table.getRow(98)]);
+    EXPECT_DOUBLE_EQ(0.5, table.getDoubleColumn("ef/(ef+ep)")[table.getRow(55)]);
+    EXPECT_DOUBLE_EQ(0.57735026918962584, table.getDoubleColumn("ochiai")[table.getRow(0)]);
+    EXPECT_DOUBLE_EQ(0.40824829046386307, table.getDoubleColumn("ochiai")[table.getRow(2)]);
+    EXPECT_DOUBLE_EQ(0.67171717171717171, plugin->getFlScore()["full"][0]);
+}
+
+TEST_F(FaultLocalizationTechniquePluginsTest, ParallelClusters)
+{
+    ClusterMap clusters;
+    const IntVector &testcases = clusterList["full"].getTestCases();
+    const IntVector &codeElements = clusterList["full"].getCodeElements();
+    for (IndexType i = 0; i < 5; i++) {
+        CClusterDefinition &cluster = clusters["cluster" + std::to_string(i)];
+        for (IndexType j = 0; j < testcases.size(); j++) {
+            if ((j + i) % 3 != 0) {
+                cluster.addTestCase(testcases[j]);
+            }
+        }
+        for (IndexType j = i; j < codeElements.size(); j += 2) {
+            cluster.addCodeElement(codeElements[j]);
+        }
+    }
+    IntVector failedCodeElements = { 0, 1, 2, 3 };
+
+    FLMetricTables serial, parallel;
+    IFaultLocalizationTechniquePlugin::FLScore serialScores, parallelScores;
+    for (unsigned int threads = 1; threads <= 4; threads += 3) {
+        FLMetricTables &tables = threads == 1 ? serial : parallel;
+        for (auto name : { "common", "tarantula" }) {
+            plugin = kernel.getFaultLocalizationTechniquePluginManager().getPlugin(name);
+            plugin->init(&selection, &clusters, 12345, failedCodeElements);
+            plugin->setNumOfThreads(threads);
+            plugin->calculate(tables);
+        }
+        (threads == 1 ? serialScores : parallelScores) = plugin->getFlScore();
+    }
+
+    ASSERT_EQ(5u, parallel.size());
+    for (auto &it : serial) {
+        CFLMetricTable &table = parallel[it.first];
+        EXPECT_EQ(it.second.getCodeElements(), table.getCodeElements());
+        EXPECT_EQ(it.second.getColumnNames(), table.getColumnNames());
+        EXPECT_EQ(it.second.getUIntColumn("ef"), table.getUIntColumn("ef"));
+        EXPECT_EQ(it.second.getUIntColumn("np"), table.getUIntColumn("np"));
+        EXPECT_EQ(it.second.getDoubleColumn("tarantula"), table.getDoubleColumn("tarantula"));
+        EXPECT_EQ(serialScores[it.first], parallelScores[it.first]);
+    }
+}
+
 TEST_F(FaultLocalizationTechniquePluginsTest, TarantulaMetaInfo)
 {
     EXPECT_NO_THROW(plugin = kernel.getFaultLocalizationTechniquePluginManager().getPlugin("tarantula"));
@@ -109,6 +109,24 @@ TEST_F(TestSuiteClusterPluginsTest, TestSuiteHamming02ClusterPlugin)
 }
 
 
+TEST_F(TestSuiteClusterPluginsTest, TestSuiteHammingThreadsClusterPlugin)
+{
+    doc.AddMember("hamming_dist_row(%)", 20, doc.GetAllocator());
+    doc.AddMember("hamming_dist_cols(%)", 50, doc.GetAllocator());
+    doc.AddMember("0cluster(%)", 90, doc.GetAllocator());
+    doc.AddMember("threads", 4, doc.GetAllocator());
+
+    EXPECT_NO_THROW(plugin = kernel.getTestSuiteClusterPluginManager().getPlugin("hamming"));
+    EXPECT_NO_THROW(plugin->init(doc));
+    EXPECT_NO_THROW(plugin->execute(data, clusterList));
+
+    // The same clusters as on one thread.
+    EXPECT_EQ(6, clusterList.size());
+    EXPECT_EQ(10, clusterList["0"].getCodeElements().size());
+    EXPECT_EQ(50, clusterList["1"].getCodeElements().size());
+    EXPECT_EQ(20, clusterList["2"].getTestCases().size());
+}
+
 TEST_F(TestSuiteClusterPluginsTest, TestSuiteOchiaiDiceJaccardClusterPluginMetaInfo)
 {
     EXPECT_NO_THROW(plugin = kernel.getTestSuiteClusterPluginManager().getPlugin("ochiai-dice-jaccard"));
@@ -180,6 +198,60 @@ TEST_F(TestSuiteClusterPluginsTest, TestSuiteJaccardClusterPlugin)
 
 
 
+TEST_F(TestSuiteClusterPluginsTest, TestSuiteOchiaiTopKClusterPlugin)
+{
+    doc.AddMember("alg.index", 0, doc.GetAllocator());
+    doc.AddMember("limit", -1.0, doc.GetAllocator());
+    doc.AddMember("0cluster(%)", 100, doc.GetAllocator());
+    doc.AddMember("cluster-number", 2, doc.GetAllocator());
+    doc.AddMember("top-k", 10, doc.GetAllocator());
+
+    EXPECT_NO_THROW(plugin = kernel.getTestSuiteClusterPluginManager().getPlugin("ochiai-dice-jaccard"));
+    EXPECT_NO_THROW(plugin->init(doc));
+    EXPECT_NO_THROW(plugin->execute(data, clusterList));
+
+    EXPECT_EQ(3, clusterList.size());
+    EXPECT_EQ(0, clusterList["0"].getTestCases().size());
+    EXPECT_EQ(100, clusterList["1"].getTestCases().size() + clusterList["2"].getTestCases().size());
+    EXPECT_EQ(100, clusterList["1"].getCodeElements().size() + clusterList["2"].getCodeElements().size());
+}
+
+
+TEST_F(TestSuiteClusterPluginsTest, TestSuiteKMedoidsClusterPlugin)
+{
+    doc.AddMember("alg.index", 0, doc.GetAllocator());
+    doc.AddMember("limit", -1.0, doc.GetAllocator());
+    doc.AddMember("0cluster(%)", 95, doc.GetAllocator());
+    doc.AddMember("cluster-number", 3, doc.GetAllocator());
+    doc.AddMember("method", "k-medoids", doc.GetAllocator());
+    doc.AddMember("distance", "hamming", doc.GetAllocator());
+    doc.AddMember("seed", 42, doc.GetAllocator());
+
+    EXPECT_NO_THROW(plugin = kernel.getTestSuiteClusterPluginManager().getPlugin("ochiai-dice-jaccard"));
+    EXPECT_NO_THROW(plugin->init(doc));
+    EXPECT_NO_THROW(plugin->execute(data, clusterList));
+
+    EXPECT_EQ(4, clusterList.size());
+    EXPECT_EQ(5, clusterList["0"].getTestCases().size());
+    EXPECT_EQ(5, clusterList["0"].getCodeElements().size());
+
+    // the Hamming distance of two tests is the difference of their indices, so the clusters are intervals
+    for (int i = 1; i <= 3; i++) {
+        const IntVector &tests = clusterList[std::to_string(i)].getTestCases();
+        ASSERT_FALSE(tests.empty());
+        EXPECT_EQ(tests.size() - 1, *std::max_element(tests.begin(), tests.end()) - *std::min_element(tests.begin(), tests.end()));
+    }
+
+    // the same seed gives the same clusters
+    ClusterMap clusterList2;
+    EXPECT_NO_THROW(plugin->execute(data, clusterList2));
+    for (int i = 0; i <= 3; i++) {
+        EXPECT_EQ(clusterList[std::to_string(i)].getTestCases(), clusterList2[std::to_string(i)].getTestCases());
+        EXPECT_EQ(clusterList[std::to_string(i)].getCodeElements(), clusterList2[std::to_string(i)].getCodeElements());
+    }
+}
+
+
 TEST_F(TestSuiteClusterPluginsTest, TestSuiteOneClusterPluginMetaInfo)
 {
     EXPECT_NO_THROW(plugin = kernel.getTestSuiteClusterPluginManager().getPlugin("one-cluster"));
@@ -92,6 +92,21 @@ TEST_F(TestSuitePrioritizationPluginsTest, AdditionalGeneralIgnorePrioritization
     EXPECT_EQ(2u, result[4]);
 }
 
+TEST_F(TestSuitePrioritizationPluginsTest, AdditionalGeneralIgnorePrioritizationPluginNext)
+{
+    EXPECT_NO_THROW(plugin = kernel.getTestSuitePrioritizationPluginManager().getPlugin("additional-general-ignore"));
+    EXPECT_NO_THROW(plugin->init(data, &kernel));
+    EXPECT_NO_THROW(plugin->fillSelection(result, 2));
+
+    EXPECT_EQ(2u, result.size());
+    EXPECT_EQ(3u, result[0]);
+    EXPECT_EQ(1u, result[1]);
+    EXPECT_EQ(4u, plugin->next());
+    EXPECT_EQ(0u, plugin->next());
+    EXPECT_EQ(2u, plugin->next());
+    EXPECT_THROW(plugin->next(), std::out_of_range);
+}
+
 TEST_F(TestSuitePrioritizationPluginsTest, AdditionalWithResetsPrioritizationPlugin)
 {
     CSelectionData csdata;
@@ -469,6 +484,25 @@ TEST_F(TestSuitePrioritizationPluginsTest, DISABLED_PartitionWithResetsPrioritiz
     EXPECT_EQ(plugin->next(), 29);
 }
 
+TEST_F(TestSuitePrioritizationPluginsTest, RaptorPrioritizationPluginThreads)
+{
+    CSelectionData selectionData;
+    selectionData.loadCoverage("sample/raptor.cov.SoDA");
+
+    EXPECT_NO_THROW(plugin = kernel.getTestSuitePrioritizationPluginManager().getPlugin("raptor"));
+    plugin->setNumOfThreads(4);
+    EXPECT_NO_THROW(plugin->init(&selectionData, &kernel));
+    EXPECT_NO_THROW(plugin->fillSelection(result, 100));
+    plugin->setNumOfThreads(1);
+
+    // The order does not depend on the number of threads.
+    IndexType expected[] = { 4, 7, 5, 1, 6, 3, 2, 0 };
+    ASSERT_EQ(8u, result.size());
+    for (IndexType i = 0; i < result.size(); i++) {
+        EXPECT_EQ(expected[i], (IndexType)result[i]);
+    }
+}
+
 /*TEST_F(TestSuitePrioritizationPluginsTest, DuplationPrioritizationPluginFillSelection)
 {
     CSelectionData selectionData;
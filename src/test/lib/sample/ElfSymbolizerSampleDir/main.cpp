@@ -0,0 +1,11 @@
+#include "sub/helper.h"
+
+static int add(int a, int b)
+{
+    return a + b;
+}
+
+int main(int argc, char **argv)
+{
+    return add(fixture::square(argc), fixture::twice<long>(argc)) > 100 ? 1 : 0;
+}
@@ -0,0 +1,10 @@
+#include "helper.h"
+
+namespace fixture {
+
+int square(int value)
+{
+    return value * value;
+}
+
+}
@@ -0,0 +1,16 @@
+#ifndef HELPER_H
+#define HELPER_H
+
+namespace fixture {
+
+int square(int value);
+
+template<class T>
+T twice(T value)
+{
+    return value + value;
+}
+
+}
+
+#endif